@@ -0,0 +1,78 @@
+// allin_ev.cpp
+// オールインEVの夜間バッチCLI（step54のC ABIを呼ぶ）
+//   allin_ev [--threads N] STORE
+// 前回の続き（新しく取り込まれたハンド）だけを処理し、ストア全体の集計を表示する。
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "poker_engine.h"
+
+namespace {
+
+void usage(const char* program) {
+    std::fprintf(stderr, "usage: %s [--threads N] STORE\n", program);
+}
+
+double dollars(int64_t cents) {
+    return cents / 100.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* store_path = nullptr;
+    int threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strncmp(arg, "--", 2) != 0 && store_path == nullptr) {
+            store_path = arg;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (store_path == nullptr) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // ストアは読み取り専用で開く（取り込み中でも実行できる）
+    void* store = hand_store_open(store_path, 1, 0);
+    if (store == nullptr) return 1;
+    void* job = allin_ev_open(store, 0);
+    if (job == nullptr) {
+        std::fprintf(stderr, "allin_ev: %s\n", allin_ev_error());
+        hand_store_close(store);
+        return 1;
+    }
+
+    int status = 0;
+    int64_t processed = allin_ev_update(job, threads);
+    if (processed < 0) {
+        std::fprintf(stderr, "allin_ev: %s\n", allin_ev_error());
+        status = 1;
+    } else {
+        PokerAllInSummary s;
+        allin_ev_summary(job, nullptr, &s);
+        std::printf("processed %lld new hands (%llu total), %llu all-in computed, %llu skipped\n",
+                    static_cast<long long>(processed), static_cast<unsigned long long>(s.hands),
+                    static_cast<unsigned long long>(s.allin_hands),
+                    static_cast<unsigned long long>(s.skipped));
+        std::printf("profit %.2f, all-in adjusted %.2f, luck %.2f, avg all-in equity %.3f\n",
+                    dollars(s.profit), dollars(s.ev_profit), dollars(s.luck),
+                    s.allin_hands > 0 ? s.allin_equity_sum / double(s.allin_hands) : 0.0);
+        static const char* streets[] = {"preflop", "flop", "turn", "river"};
+        for (int t = 0; t < 4; ++t) {
+            std::printf("  %-8s luck %10.2f  ev loss %10.2f\n", streets[t],
+                        dollars(s.street_luck[t]), dollars(s.ev_loss[t]));
+        }
+    }
+    allin_ev_close(job);
+    hand_store_close(store);
+    return status;
+}
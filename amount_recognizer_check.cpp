@@ -0,0 +1,164 @@
+// amount_recognizer_check.cpp
+// 金額の認識(step61)の回帰チェック（C ABI経由。ctestから実行する）
+//   amount_recognizer_check
+// 5x7のビットマップフォントを1-3倍で描き、学習した後に読む:
+// 1. 1倍の'.'（1画素）と','（1画素だけ下に出る）を含む金額が、全ての倍率で正しい値になること
+// 2. ','の無い"1.250"と、','の後が3桁でない"1,25"などは金額として受け付けないこと
+// 3. '.'と','を取り違えたラベルでの学習は拒否されること
+// どれか一つでも外れれば終了コード1を返す。
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "poker_engine.h"
+
+namespace {
+
+constexpr int CHANNELS = 3;
+constexpr int PAD = 4;
+constexpr uint8_t INK = 240;
+constexpr uint8_t PAPER[CHANNELS] = {30, 60, 40};
+
+struct Pattern {
+    char c;
+    std::vector<const char*> rows;   // 上から。数字は7行、下に出る文字は8行
+};
+
+const std::vector<Pattern>& font() {
+    static const std::vector<Pattern> patterns = {
+        {'0', {"01110", "10001", "10011", "10101", "11001", "10001", "01110"}},
+        {'1', {"00100", "01100", "00100", "00100", "00100", "00100", "01110"}},
+        {'2', {"01110", "10001", "00001", "00010", "00100", "01000", "11111"}},
+        {'3', {"11110", "00001", "00001", "01110", "00001", "00001", "11110"}},
+        {'4', {"00010", "00110", "01010", "10010", "11111", "00010", "00010"}},
+        {'5', {"11111", "10000", "11110", "00001", "00001", "10001", "01110"}},
+        {'6', {"00110", "01000", "10000", "11110", "10001", "10001", "01110"}},
+        {'7', {"11111", "00001", "00010", "00100", "01000", "01000", "01000"}},
+        {'8', {"01110", "10001", "10001", "01110", "10001", "10001", "01110"}},
+        {'9', {"01110", "10001", "10001", "01111", "00001", "00010", "01100"}},
+        {'K', {"10001", "10010", "10100", "11000", "10100", "10010", "10001"}},
+        {'M', {"10001", "11011", "10101", "10101", "10001", "10001", "10001"}},
+        {'$', {"00100", "01111", "10100", "01110", "00101", "11110", "00100", "00100"}},
+        {'.', {"0", "0", "0", "0", "0", "0", "1"}},
+        {',', {"00", "00", "00", "00", "00", "01", "01", "10"}},   // 2x3、1行だけ下に出る
+    };
+    return patterns;
+}
+
+const Pattern* glyph(char c) {
+    for (const Pattern& p : font()) {
+        if (p.c == c) return &p;
+    }
+    return nullptr;
+}
+
+struct Image {
+    std::vector<uint8_t> pixels;
+    int width = 0, height = 0;
+
+    PokerImageView view() const { return {pixels.data(), width, height, width * CHANNELS, CHANNELS}; }
+};
+
+Image render(const std::string& text, int scale) {
+    Image image;
+    image.width = 2 * PAD;
+    for (char c : text) image.width += (static_cast<int>(std::strlen(glyph(c)->rows[0])) + 1) * scale;
+    image.height = 2 * PAD + 9 * scale;
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height * CHANNELS);
+    for (size_t i = 0; i < image.pixels.size(); ++i) image.pixels[i] = PAPER[i % CHANNELS];
+    int x = PAD;
+    for (char c : text) {
+        const Pattern& p = *glyph(c);
+        const int columns = static_cast<int>(std::strlen(p.rows[0]));
+        for (size_t r = 0; r < p.rows.size(); ++r) {
+            for (int col = 0; col < columns; ++col) {
+                if (p.rows[r][col] != '1') continue;
+                for (int dy = 0; dy < scale; ++dy) {
+                    for (int dx = 0; dx < scale; ++dx) {
+                        int px = x + col * scale + dx, py = PAD + static_cast<int>(r) * scale + dy;
+                        uint8_t* pixel = image.pixels.data() + (static_cast<size_t>(py) * image.width + px) * CHANNELS;
+                        std::memset(pixel, INK, CHANNELS);
+                    }
+                }
+            }
+        }
+        x += (columns + 1) * scale;
+    }
+    return image;
+}
+
+bool read(void* recognizer, const std::string& text, int scale, PokerAmountMatch& match) {
+    Image image = render(text, scale);
+    PokerImageView view = image.view();
+    PokerImageBox box = {0, 0, image.width, image.height};
+    return amount_recognizer_read(recognizer, &view, &box, 1, &match) == 1;
+}
+
+}  // namespace
+
+int main() {
+    void* recognizer = amount_recognizer_create();
+    bool ok = true;
+    for (const char* label : {"$1,234.56", "7,890K", "0M", "$98.76"}) {
+        for (int scale = 1; scale <= 3; ++scale) {
+            Image image = render(label, scale);
+            PokerImageView view = image.view();
+            if (amount_recognizer_learn(recognizer, &view, nullptr, label) != 0) {
+                std::fprintf(stderr, "amount_recognizer_check: learn \"%s\" x%d: %s\n", label, scale,
+                             amount_recognizer_error());
+                ok = false;
+            }
+        }
+    }
+
+    static const struct { const char* text; double value; } CASES[] = {
+        {"1,250", 1250.0}, {"88,000", 88000.0}, {"$1,250.50", 1250.5}, {"12,345,678", 12345678.0},
+        {"1.5", 1.5}, {"12.75", 12.75}, {"0.5K", 500.0}, {"$3,000K", 3000000.0},
+    };
+    int failures = 0;
+    for (const auto& c : CASES) {
+        for (int scale = 1; scale <= 3; ++scale) {
+            PokerAmountMatch match;
+            if (!read(recognizer, c.text, scale, match) || std::fabs(match.value - c.value) > 1e-9) {
+                std::fprintf(stderr, "amount_recognizer_check: \"%s\" x%d read as \"%s\" (%g)\n", c.text, scale,
+                             match.text, match.value);
+                ++failures;
+            }
+        }
+    }
+    std::printf("%-12s %s\n", "read", failures == 0 ? "ok" : "FAILED");
+    ok = ok && failures == 0;
+
+    // ','を'.'と読んだ時と同じ表記は金額にしない
+    PokerAmountMatch match;
+    bool rejected = !read(recognizer, "1.250", 1, match) && std::strcmp(match.text, "1.250") == 0;
+    std::printf("%-12s %s\n", "lone-point", rejected ? "ok" : "FAILED");
+    ok = ok && rejected;
+
+    // '.'を','と読んだ時と同じ表記（','の後が3桁でない）も金額にしない
+    rejected = true;
+    for (const char* text : {"1,25", "0,5", "12,3456", "1,2,3", "1,25.50", "1,2345K"}) {
+        for (int scale = 1; scale <= 3; ++scale) {
+            if (read(recognizer, text, scale, match) || std::strcmp(match.text, text) != 0) {
+                std::fprintf(stderr, "amount_recognizer_check: \"%s\" x%d accepted as %g (read \"%s\")\n",
+                             text, scale, match.value, match.text);
+                rejected = false;
+            }
+        }
+    }
+    std::printf("%-12s %s\n", "comma-group", rejected ? "ok" : "FAILED");
+    ok = ok && rejected;
+
+    // 分割した句読点とラベルの句読点が違えば学習しない
+    Image image = render("1,250", 1);
+    PokerImageView view = image.view();
+    bool refused = amount_recognizer_learn(recognizer, &view, nullptr, "1.250") != 0;
+    std::printf("%-12s %s\n", "learn-punct", refused ? "ok" : "FAILED");
+    ok = ok && refused;
+
+    amount_recognizer_close(recognizer);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+// capture_pipeline_check.cpp
+// キャプチャパイプライン(step60)のバッファのプールの回帰チェック（C ABI経由。ctestから実行する）
+//   capture_pipeline_check
+// 1080pのBGRAフレームで毎回再検出を依頼し、テーブルの領域を毎フレーム変えながら、抽出を
+// 数フレームおきにまとめて処理する。プールが確保する画素の総量が、再検出用のフレーム2枚と
+// テーブルごと4枚のテーブル画像を超えないこと（フレーム大のバッファがプール全体に広がらないこと）。
+// 超えれば終了コード1を返す。
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#include "poker_engine.h"
+
+namespace {
+
+constexpr int WIDTH = 1920;
+constexpr int HEIGHT = 1080;
+constexpr int CHANNELS = 4;
+constexpr int TABLES = 6;
+constexpr int TABLE_WIDTH = 640;
+constexpr int TABLE_HEIGHT = 360;
+constexpr int FRAMES = 600;
+constexpr int DRAIN_EVERY = 3;     // 抽出はこのフレーム数ごとにまとめて処理する
+
+void fill(std::vector<uint8_t>& frame, const PokerImageBox& box, uint8_t value) {
+    for (int y = box.y; y < box.y + box.height; ++y) {
+        std::fill_n(frame.begin() + (static_cast<size_t>(y) * WIDTH + box.x) * CHANNELS,
+                    static_cast<size_t>(box.width) * CHANNELS, value);
+    }
+}
+
+// 取り出せる依頼を全て処理する
+int drain(void* pipeline) {
+    int jobs = 0;
+    PokerCaptureJob job;
+    while (capture_pipeline_next_job(pipeline, 0, &job) == 1) {
+        capture_pipeline_release(pipeline, job.buffer);
+        capture_pipeline_complete(pipeline, &job, -1, 0);
+        ++jobs;
+    }
+    return jobs;
+}
+
+}  // namespace
+
+int main() {
+    void* pipeline = capture_pipeline_create(0, 0.5);
+    std::vector<PokerImageBox> tables, regions;
+    std::vector<int32_t> region_counts;
+    for (int t = 0; t < TABLES; ++t) {
+        PokerImageBox table = {(t % 3) * TABLE_WIDTH, (t / 3) * TABLE_HEIGHT, TABLE_WIDTH, TABLE_HEIGHT};
+        tables.push_back(table);
+        regions.push_back({table.x + 32, table.y + 32, 128, 64});     // ポット
+        regions.push_back({table.x + 320, table.y + 256, 128, 64});   // スタック
+        region_counts.push_back(2);
+    }
+    if (capture_pipeline_set_tables(pipeline, tables.data(), TABLES, regions.data(), region_counts.data()) < 0) {
+        std::fprintf(stderr, "capture_pipeline_check: set_tables failed\n");
+        return 1;
+    }
+
+    std::vector<uint8_t> frame(static_cast<size_t>(WIDTH) * HEIGHT * CHANNELS, 40);
+    PokerImageView view = {frame.data(), WIDTH, HEIGHT, WIDTH * CHANNELS, CHANNELS};
+    uint64_t jobs = 0;
+    for (int f = 0; f < FRAMES; ++f) {
+        for (const PokerImageBox& region : regions) fill(frame, region, f % 2 ? 230 : 20);
+        if (capture_pipeline_submit(pipeline, &view) < 0) {
+            std::fprintf(stderr, "capture_pipeline_check: submit failed\n");
+            return 1;
+        }
+        if (f % DRAIN_EVERY == DRAIN_EVERY - 1) jobs += static_cast<uint64_t>(drain(pipeline));
+    }
+    jobs += static_cast<uint64_t>(drain(pipeline));
+
+    PokerCaptureStats stats;
+    capture_pipeline_stats(pipeline, &stats);
+    capture_pipeline_destroy(pipeline);
+
+    const uint64_t frame_bytes = uint64_t(WIDTH) * HEIGHT * CHANNELS;
+    const uint64_t table_bytes = uint64_t(TABLE_WIDTH) * TABLE_HEIGHT * CHANNELS;
+    const uint64_t limit = 2 * frame_bytes + 4 * TABLES * table_bytes;
+    bool ok = stats.buffer_bytes <= limit && stats.buffers_in_use == 0 && stats.layout_jobs > 0 &&
+              stats.extract_jobs > 0;
+    std::printf("%-12s %s (%llu jobs, %.1f MB pooled, limit %.1f MB, %u buffers in use)\n", "buffer-pool",
+                ok ? "ok" : "FAILED", static_cast<unsigned long long>(jobs), double(stats.buffer_bytes) / 1e6,
+                double(limit) / 1e6, stats.buffers_in_use);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+// cfr_check.cpp
+// CFRソルバー(step6_7)の回帰チェック（ctestから実行する）
+//   cfr_check
+// 1. クーン・ポーカーを長時間学習しても後悔値・戦略の累計が有限のままであること
+// 2. 平均戦略のゲーム価値が均衡値 -1/18 に収束し、最適反応によるエクスプロイタビリティが0に近づくこと
+// 3. 学習前のエクスプロイタビリティは0（情報セットが無い）、1回学習した後は大きいこと
+// 4. レデュック・ホールデムでも平均戦略のゲーム価値とエクスプロイタビリティが有限であること
+// 外れれば終了コード1を返す。
+#include <cmath>
+#include <cstdio>
+
+#include "step6_7_cfr_engine_complete.cpp"
+
+namespace {
+
+using namespace CFREngine;
+
+constexpr int KUHN_ITERATIONS = 120000;   // 旧実装では約102,000回でstrategy_sumがinfになった
+constexpr double KUHN_VALUE = -1.0 / 18.0;
+constexpr double KUHN_TOLERANCE = 2e-3;
+constexpr double KUHN_EXPLOITABILITY = 2e-3;   // チップ/ゲーム
+
+bool check_kuhn() {
+    CFRSolver solver(GAME_KUHN);
+    const double untrained = solver.compute_exploitability();
+    solver.train(1);
+    const double first = solver.compute_exploitability();
+    bool ok = untrained == 0.0 && first > 0.1;
+    std::printf("%-12s %s (untrained %.5f, 1 iteration %.5f)\n", "kuhn-start", ok ? "ok" : "FAILED",
+                untrained, first);
+
+    solver.train(KUHN_ITERATIONS - 1);
+    const double value = solver.game_value();
+    const double exploit = solver.compute_exploitability();
+    bool converged = std::isfinite(value) && std::isfinite(exploit) &&
+                     std::fabs(value - KUHN_VALUE) <= KUHN_TOLERANCE &&
+                     exploit >= 0.0 && exploit <= KUHN_EXPLOITABILITY;
+    std::printf("%-12s %s (value %.5f, expected %.5f, exploitability %.5f)\n", "kuhn",
+                converged ? "ok" : "FAILED", value, KUHN_VALUE, exploit);
+    return ok && converged;
+}
+
+bool check_leduc() {
+    CFRSolver solver(GAME_LEDUC);
+    solver.train(300);
+    const double value = solver.game_value();
+    const double exploit = solver.compute_exploitability();
+    bool ok = std::isfinite(value) && std::fabs(value) < 1.0 && std::isfinite(exploit) && exploit >= 0.0;
+    std::printf("%-12s %s (value %.5f, exploitability %.5f)\n", "leduc", ok ? "ok" : "FAILED", value, exploit);
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = check_kuhn();
+    ok = check_leduc() && ok;
+    return ok ? 0 : 1;
+}
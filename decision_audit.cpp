@@ -0,0 +1,103 @@
+// decision_audit.cpp
+// 判断の監査（リークレポート）CLI（step55のC ABIを呼ぶ）
+//   decision_audit [--threads N] [--top N] [--model FILE] STORE
+// ストリート × 実際のアクションごとの判断数・ミス・EV損失と、損失の大きい判断を表示する。
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "poker_engine.h"
+
+namespace {
+
+const char* const STREETS[] = {"preflop", "flop", "turn", "river"};
+const char* const ACTIONS[] = {"fold", "check", "call", "bet", "raise"};
+
+void usage(const char* program) {
+    std::fprintf(stderr, "usage: %s [--threads N] [--top N] [--model FILE] STORE\n", program);
+}
+
+double dollars(int64_t cents) {
+    return cents / 100.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* store_path = nullptr;
+    const char* model_path = nullptr;
+    int threads = 0;
+    int top = 20;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--top") == 0 && i + 1 < argc) {
+            top = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--model") == 0 && i + 1 < argc) {
+            model_path = argv[++i];
+        } else if (std::strncmp(arg, "--", 2) != 0 && store_path == nullptr) {
+            store_path = arg;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (store_path == nullptr) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    void* store = hand_store_open(store_path, 1, 0);
+    if (store == nullptr) return 1;
+    void* model = nullptr;
+    if (model_path != nullptr) {
+        model = eqr_model_open(model_path);
+        if (model == nullptr) {
+            hand_store_close(store);
+            return 1;
+        }
+    }
+
+    std::vector<PokerAuditDecision> worst(static_cast<size_t>(top));
+    PokerAuditSummary s;
+    int64_t n = decision_audit(store, model, nullptr, threads, worst.data(), top, &s);
+
+    std::printf("%llu decisions in %llu hands (%llu board groups), %llu mistakes, ev loss %.2f\n",
+                static_cast<unsigned long long>(s.decisions), static_cast<unsigned long long>(s.hands),
+                static_cast<unsigned long long>(s.groups), static_cast<unsigned long long>(s.mistakes),
+                dollars(s.ev_loss));
+    std::printf("%-8s %-6s %9s %8s %10s   best: fold/check/call/bet/raise\n",
+                "street", "action", "decisions", "mistakes", "ev loss");
+    for (int t = 0; t < 4; ++t) {
+        for (int a = 0; a < 5; ++a) {
+            const PokerAuditCell& c = s.cells[t][a];
+            if (c.decisions == 0) continue;
+            std::printf("%-8s %-6s %9llu %8llu %10.2f   %llu/%llu/%llu/%llu/%llu\n", STREETS[t], ACTIONS[a],
+                        static_cast<unsigned long long>(c.decisions),
+                        static_cast<unsigned long long>(c.mistakes), dollars(c.ev_loss),
+                        static_cast<unsigned long long>(c.recommended[0]),
+                        static_cast<unsigned long long>(c.recommended[1]),
+                        static_cast<unsigned long long>(c.recommended[2]),
+                        static_cast<unsigned long long>(c.recommended[3]),
+                        static_cast<unsigned long long>(c.recommended[4]));
+        }
+    }
+    if (n > 0) std::printf("worst decisions:\n");
+    for (int64_t i = 0; i < n; ++i) {
+        const PokerAuditDecision& d = worst[static_cast<size_t>(i)];
+        std::printf("  hand %llu %-7s pot %.2f to call %.2f: %s %.2f (ev %.2f), best %s %.2f (ev %.2f), "
+                    "equity %.3f, loss %.2f\n",
+                    static_cast<unsigned long long>(d.hand_id), STREETS[d.street], dollars(d.pot),
+                    dollars(d.to_call), ACTIONS[d.action], dollars(d.amount), dollars(d.ev_actual),
+                    ACTIONS[d.best_action], dollars(d.best_amount), dollars(d.ev_best), d.equity,
+                    dollars(d.ev_loss));
+    }
+    if (model != nullptr) eqr_model_close(model);
+    hand_store_close(store);
+    return 0;
+}
@@ -0,0 +1,76 @@
+// eqr_calibrate.cpp
+// EQRモデルのキャリブレーションCLI（step45のC ABIを呼ぶ）
+//   eqr_calibrate (--solver-csv FILE | --hand-history DB) --output MODEL
+//                 [--prior MODEL] [--prior-strength K] [--threads N]
+//                 [--default-spr X] [--model-version V]
+// 出力はstep44の形式なので、稼働中のエンジンは eqr_model_reload でそのまま差し替えられる。
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "poker_engine.h"
+
+namespace {
+
+void usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s (--solver-csv FILE | --hand-history DB) --output MODEL\n"
+                 "          [--prior MODEL] [--prior-strength K] [--threads N]\n"
+                 "          [--default-spr X] [--model-version V]\n",
+                 program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int source_kind = -1;
+    const char* input = nullptr;
+    const char* output = nullptr;
+    const char* prior = nullptr;
+    double prior_strength = 20.0;
+    int threads = 0;
+    double default_spr = 13.0;
+    uint64_t model_version = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (std::strcmp(arg, "--solver-csv") == 0) {
+            source_kind = 0;
+            input = value;
+        } else if (std::strcmp(arg, "--hand-history") == 0) {
+            source_kind = 1;
+            input = value;
+        } else if (std::strcmp(arg, "--output") == 0) {
+            output = value;
+        } else if (std::strcmp(arg, "--prior") == 0) {
+            prior = value;
+        } else if (std::strcmp(arg, "--prior-strength") == 0) {
+            prior_strength = std::atof(value);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            threads = std::atoi(value);
+        } else if (std::strcmp(arg, "--default-spr") == 0) {
+            default_spr = std::atof(value);
+        } else if (std::strcmp(arg, "--model-version") == 0) {
+            model_version = std::strtoull(value, nullptr, 10);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (input == nullptr || output == nullptr) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int64_t used = eqr_calibrate(source_kind, input, output, prior, prior_strength,
+                                 threads, default_spr, model_version);
+    if (used < 0) return 1;
+    std::printf("calibrated %s from %lld samples\n", output, static_cast<long long>(used));
+    return 0;
+}
@@ -0,0 +1,207 @@
+// evaluator_check.cpp
+// 役判定の回帰チェック（C ABI経由。ctestから実行する）
+//   evaluator_check [--threads N]
+// 1. 5枚の全2,598,960ハンド: 役ごとの数と、異なる評価値の数（7462）が既知の値と一致すること
+// 2. 7枚の全133,784,560ハンド: 役ごとの数と、異なる評価値の数（4824）が既知の値と一致すること
+// 3. ランダムな7枚: 評価値が21通りの5枚の組の最大値と一致すること（キッカーの取り違えを検出）
+// どれか一つでも外れれば終了コード1を返す。
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "poker_engine.h"
+
+namespace {
+
+constexpr int CATEGORIES = 9;
+constexpr uint32_t SCORE_LIMIT = uint32_t(CATEGORIES) << 20;
+
+// 役ごとの数（ハイカード .. ストレートフラッシュ）
+constexpr uint64_t FIVE_CARD_COUNTS[CATEGORIES] = {
+    1302540, 1098240, 123552, 54912, 10200, 5108, 3744, 624, 40,
+};
+constexpr uint64_t SEVEN_CARD_COUNTS[CATEGORIES] = {
+    23294460, 58627800, 31433400, 6461620, 6180020, 4047644, 3473184, 224848, 41584,
+};
+constexpr uint64_t FIVE_CARD_CLASSES = 7462;
+constexpr uint64_t SEVEN_CARD_CLASSES = 4824;
+
+constexpr int CHUNK = 4096;
+constexpr int RANDOM_HANDS = 200000;
+
+struct Tally {
+    uint64_t categories[CATEGORIES] = {};
+    std::vector<uint8_t> seen = std::vector<uint8_t>(SCORE_LIMIT, 0);
+
+    bool add(uint32_t score) {
+        if (score >= SCORE_LIMIT) return false;
+        ++categories[score >> 20];
+        seen[score] = 1;
+        return true;
+    }
+    void merge(const Tally& other) {
+        for (int k = 0; k < CATEGORIES; ++k) categories[k] += other.categories[k];
+        for (uint32_t s = 0; s < SCORE_LIMIT; ++s) seen[s] |= other.seen[s];
+    }
+    uint64_t classes() const {
+        return static_cast<uint64_t>(std::count(seen.begin(), seen.end(), uint8_t(1)));
+    }
+};
+
+bool verify(const char* name, const Tally& tally, const uint64_t* expected, uint64_t expected_classes) {
+    bool ok = true;
+    for (int k = 0; k < CATEGORIES; ++k) {
+        if (tally.categories[k] != expected[k]) {
+            std::fprintf(stderr, "evaluator_check: %s: category %d: %llu hands, expected %llu\n", name, k,
+                         static_cast<unsigned long long>(tally.categories[k]),
+                         static_cast<unsigned long long>(expected[k]));
+            ok = false;
+        }
+    }
+    uint64_t classes = tally.classes();
+    if (classes != expected_classes) {
+        std::fprintf(stderr, "evaluator_check: %s: %llu distinct scores, expected %llu\n", name,
+                     static_cast<unsigned long long>(classes),
+                     static_cast<unsigned long long>(expected_classes));
+        ok = false;
+    }
+    std::printf("%-12s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+bool check_five_cards() {
+    Tally tally;
+    bool in_range = true;
+    uint8_t hand[5];
+    for (hand[0] = 0; hand[0] < 48; ++hand[0])
+    for (hand[1] = hand[0] + 1; hand[1] < 49; ++hand[1])
+    for (hand[2] = hand[1] + 1; hand[2] < 50; ++hand[2])
+    for (hand[3] = hand[2] + 1; hand[3] < 51; ++hand[3])
+    for (hand[4] = hand[3] + 1; hand[4] < 52; ++hand[4]) {
+        in_range &= tally.add(evaluate_cards(hand, 5));
+    }
+    if (!in_range) std::fprintf(stderr, "evaluator_check: 5-card: score out of range\n");
+    return verify("5-card", tally, FIVE_CARD_COUNTS, FIVE_CARD_CLASSES) && in_range;
+}
+
+// 先頭2枚の組をスレッドに配り、残り5枚をバッチ評価で数える
+bool check_seven_cards(int threads) {
+    std::vector<std::pair<uint8_t, uint8_t>> prefixes;
+    for (uint8_t a = 0; a < 46; ++a) {
+        for (uint8_t b = a + 1; b < 47; ++b) prefixes.emplace_back(a, b);
+    }
+    std::atomic<size_t> next{0};
+    std::atomic<bool> in_range{true};
+    std::vector<Tally> tallies(static_cast<size_t>(threads));
+
+    auto worker = [&](int t) {
+        Tally& tally = tallies[static_cast<size_t>(t)];
+        std::vector<uint8_t> hands(CHUNK * 7);
+        std::vector<uint32_t> scores(CHUNK);
+        int filled = 0;
+        auto flush = [&] {
+            evaluate_7cards_batch(hands.data(), filled, scores.data());
+            for (int i = 0; i < filled; ++i) {
+                if (!tally.add(scores[i])) in_range = false;
+            }
+            filled = 0;
+        };
+        for (size_t p; (p = next.fetch_add(1)) < prefixes.size();) {
+            const uint8_t a = prefixes[p].first;
+            const uint8_t b = prefixes[p].second;
+            for (uint8_t c = b + 1; c < 48; ++c)
+            for (uint8_t d = c + 1; d < 49; ++d)
+            for (uint8_t e = d + 1; e < 50; ++e)
+            for (uint8_t f = e + 1; f < 51; ++f)
+            for (uint8_t g = f + 1; g < 52; ++g) {
+                uint8_t* hand = hands.data() + filled * 7;
+                hand[0] = a; hand[1] = b; hand[2] = c; hand[3] = d;
+                hand[4] = e; hand[5] = f; hand[6] = g;
+                if (++filled == CHUNK) flush();
+            }
+        }
+        if (filled > 0) flush();
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+    for (auto& thread : pool) thread.join();
+
+    for (int t = 1; t < threads; ++t) tallies[0].merge(tallies[static_cast<size_t>(t)]);
+    if (!in_range) std::fprintf(stderr, "evaluator_check: 7-card: score out of range\n");
+    return verify("7-card", tallies[0], SEVEN_CARD_COUNTS, SEVEN_CARD_CLASSES) && in_range;
+}
+
+// 7枚の評価値 = 5枚の組の最大値。単体・バッチ両方の経路を比べる
+bool check_best_five() {
+    std::mt19937_64 rng(62);
+    std::vector<uint8_t> hands(static_cast<size_t>(RANDOM_HANDS) * 7);
+    for (int i = 0; i < RANDOM_HANDS; ++i) {
+        uint8_t deck[52];
+        for (int c = 0; c < 52; ++c) deck[c] = static_cast<uint8_t>(c);
+        for (int k = 0; k < 7; ++k) {
+            int j = k + static_cast<int>(rng() % static_cast<uint64_t>(52 - k));
+            std::swap(deck[k], deck[j]);
+        }
+        std::memcpy(hands.data() + static_cast<size_t>(i) * 7, deck, 7);
+    }
+    std::vector<uint32_t> batch(RANDOM_HANDS);
+    evaluate_7cards_batch(hands.data(), RANDOM_HANDS, batch.data());
+
+    int mismatches = 0;
+    for (int i = 0; i < RANDOM_HANDS; ++i) {
+        const uint8_t* hand = hands.data() + static_cast<size_t>(i) * 7;
+        uint32_t best = 0;
+        for (int skip1 = 0; skip1 < 7; ++skip1) {
+            for (int skip2 = skip1 + 1; skip2 < 7; ++skip2) {
+                uint8_t five[5];
+                int n = 0;
+                for (int k = 0; k < 7; ++k) {
+                    if (k != skip1 && k != skip2) five[n++] = hand[k];
+                }
+                best = std::max(best, evaluate_cards(five, 5));
+            }
+        }
+        uint32_t single = evaluate_7cards_perfect(hand);
+        uint32_t seven = evaluate_cards(hand, 7);
+        if (single != best || seven != best || batch[static_cast<size_t>(i)] != best) {
+            if (mismatches++ < 5) {
+                std::fprintf(stderr, "evaluator_check: hand");
+                for (int k = 0; k < 7; ++k) std::fprintf(stderr, " %d", hand[k]);
+                std::fprintf(stderr, ": single %08x, batch %08x, best of 5 %08x\n", single,
+                             batch[static_cast<size_t>(i)], best);
+            }
+        }
+    }
+    if (mismatches > 0) {
+        std::fprintf(stderr, "evaluator_check: best-of-5: %d / %d hands differ\n", mismatches, RANDOM_HANDS);
+    }
+    std::printf("%-12s %s\n", "best-of-5", mismatches == 0 ? "ok" : "FAILED");
+    return mismatches == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: evaluator_check [--threads N]\n");
+            return 2;
+        }
+    }
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    bool ok = check_five_cards();
+    ok = check_best_five() && ok;
+    ok = check_seven_cards(threads) && ok;
+    return ok ? 0 : 1;
+}
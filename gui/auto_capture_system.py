@@ -4,9 +4,70 @@ import numpy as np
 import mss
 import pytesseract
 from PIL import Image
+import os
 import threading
 import time
-from typing import Dict, Optional, Tuple
+from typing import Dict, List, Optional, Tuple
+
+try:
+    # スキンごとのテンプレートによるカード・金額の認識（step58・step61）・フレームの変化検出（step59）
+    import poker_engine as _native
+except ImportError:
+    _native = None
+
+# 学習済みテンプレートの保存先（<スキン名>.cardtm・<スキン名>.amounttm）
+TEMPLATE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'card_templates')
+RANKS = '23456789TJQKA'
+SUITS = 'shdc'
+AMOUNT_CHARS = '0123456789'     # 金額のテンプレートが揃ったとみなす文字（$・K・Mは無いスキンもある）
+
+# プレイヤー席の位置（テーブルに対する比率）
+SEAT_POSITIONS = [
+    (0.5, 0.85),   # Hero
+    (0.3, 0.6),    # Left 1
+    (0.15, 0.4),   # Left 2
+    (0.2, 0.15),   # Top Left
+    (0.5, 0.05),   # Top
+    (0.8, 0.15),   # Top Right
+    (0.85, 0.4),   # Right 2
+    (0.7, 0.6),    # Right 1
+]
+
+# 変化検出の注目領域: (x0, y0, x1, y1)はテーブルに対する比率、変化したら抽出し直す項目
+GATE_REGIONS = [
+    ((0.4, 0.75, 0.6, 1.0), ('my_hand', 'position', 'in_position')),
+    ((0.25, 0.35, 0.75, 0.5), ('board',)),
+    ((0.45, 0.45, 0.55, 0.55), ('pot',)),
+    ((0.7, 0.7, 0.9, 0.85), ('call_amount', 'hero_to_act')),
+    ((0.45, 0.8, 0.55, 0.95), ('my_stack',)),
+]
+# 金額の項目の領域（テーブルに対する比率）。各席のスタック（'stacks'）は席の領域の下半分で、
+# テンプレートが揃っている時だけ読む（OCRでは1回の抽出で席の数だけTesseractを呼ぶことになる）
+AMOUNT_REGIONS = {
+    'pot': (0.45, 0.45, 0.55, 0.55),
+    'call_amount': (0.7, 0.7, 0.9, 0.85),
+    'my_stack': (0.45, 0.8, 0.55, 0.95),
+}
+AMOUNT_FIELDS = tuple(AMOUNT_REGIONS) + ('stacks',)
+SEAT_HALF_SIZE = 30             # 席の領域（ピクセル、中心からの半分の幅）
+TABLE_REDETECT_INTERVAL = 5.0   # テーブル位置の再検出の間隔（秒）
+ACTION_REGION = (0.7, 0.7, 0.9, 0.85)   # アクションボタン（表示中はヒーローの手番）
+
+def table_gate_regions(table_region: Dict) -> List[Tuple[Tuple[int, int, int, int], tuple]]:
+    """テーブルの注目領域（フレーム上の (x, y, width, height)）とその項目"""
+    x, y, w, h = table_region['x'], table_region['y'], table_region['width'], table_region['height']
+    regions = []
+    
+    for (x0, y0, x1, y1), fields in GATE_REGIONS:
+        box = (x + int(w*x0), y + int(h*y0), max(1, int(w*(x1-x0))), max(1, int(h*(y1-y0))))
+        regions.append((box, fields))
+    
+    for px, py in SEAT_POSITIONS:
+        cx, cy = x + int(w*px), y + int(h*py)
+        box = (cx - SEAT_HALF_SIZE, cy - SEAT_HALF_SIZE, 2*SEAT_HALF_SIZE, 2*SEAT_HALF_SIZE)
+        regions.append((box, ('opponents', 'stacks')))
+    
+    return regions
 
 class AutoCaptureSystem:
     """完全自動画面キャプチャ＆認識システム"""
@@ -18,31 +79,82 @@ class AutoCaptureSystem:
         
         # 認識設定
         self.screen_region = None  # 自動検出
-        self.card_templates = self.load_card_templates()
+        self.table_skin = 'default'
+        self.card_recognizer = self.load_card_templates(self.table_skin)
+        self.min_card_confidence = 0.5
+        self.amount_recognizer = self.load_amount_templates(self.table_skin)
+        self.min_amount_confidence = 0.6
         self.last_game_state = {}
         
+        # 変化検出（テーブルが見つかったら領域を設定）
+        self.table_region = None
+        self.table_detected_at = 0.0
+        self.frame_gate = None
+        self.gate_fields = []
+        self.current_state = {}
+        
         # OCR設定
         pytesseract.pytesseract.tesseract_cmd = r'C:\Program Files\Tesseract-OCR\tesseract.exe'
     
-    def load_card_templates(self) -> Dict:
-        """カードテンプレート読み込み（事前学習済み）"""
-        templates = {}
-        ranks = '23456789TJQKA'
-        suits = 'shdc'
-        
-        # 各カードの特徴パターン（簡易版）
-        for rank in ranks:
-            for suit in suits:
-                card_name = f"{rank}{suit}"
-                # 実際には画像ファイルを読み込む
-                templates[card_name] = self.create_template_pattern(rank, suit)
-        
-        return templates
+    def load_card_templates(self, skin: str):
+        """スキンのカードテンプレート読み込み（未学習なら空の認識器）"""
+        if _native is None:
+            return None
+        path = os.path.join(TEMPLATE_DIR, f"{skin}.cardtm")
+        if os.path.exists(path):
+            return _native.CardRecognizer(path)
+        return _native.CardRecognizer()
+    
+    def set_table_skin(self, skin: str):
+        """テーブルのスキンを切り替える"""
+        self.table_skin = skin
+        self.card_recognizer = self.load_card_templates(skin)
+        self.amount_recognizer = self.load_amount_templates(skin)
+    
+    def learn_card(self, card_img: np.ndarray, card_name: str):
+        """ラベル付きのカード画像（保存済みスクリーンショットの切り出し）をテンプレートに加える"""
+        if self.card_recognizer is None:
+            raise RuntimeError("card templates require the poker_engine extension module")
+        self.card_recognizer.learn(np.ascontiguousarray(card_img), card_name)
+    
+    def save_card_templates(self):
+        """現在のスキンのテンプレートを保存"""
+        os.makedirs(TEMPLATE_DIR, exist_ok=True)
+        self.card_recognizer.save(os.path.join(TEMPLATE_DIR, f"{self.table_skin}.cardtm"))
+    
+    def templates_ready(self) -> bool:
+        """全てのランク・スートが学習済みか"""
+        if self.card_recognizer is None:
+            return False
+        samples = self.card_recognizer.samples()
+        return min(samples['ranks']) > 0 and min(samples['suits']) > 0
     
-    def create_template_pattern(self, rank: str, suit: str) -> np.ndarray:
-        """テンプレートパターン生成"""
-        # 簡易的な特徴ベクトル（実際にはCNNや画像特徴を使用）
-        return np.random.rand(64, 64, 3)
+    def load_amount_templates(self, skin: str):
+        """スキンの金額の文字テンプレート読み込み（未学習なら空の認識器）"""
+        if _native is None:
+            return None
+        path = os.path.join(TEMPLATE_DIR, f"{skin}.amounttm")
+        if os.path.exists(path):
+            return _native.AmountRecognizer(path)
+        return _native.AmountRecognizer()
+    
+    def learn_amount(self, amount_img: np.ndarray, text: str):
+        """ラベル付きの金額画像（'$1,250'のような表示どおりの文字列）の各文字をテンプレートに加える"""
+        if self.amount_recognizer is None:
+            raise RuntimeError("amount templates require the poker_engine extension module")
+        self.amount_recognizer.learn(np.ascontiguousarray(amount_img), text)
+    
+    def save_amount_templates(self):
+        """現在のスキンの金額テンプレートを保存"""
+        os.makedirs(TEMPLATE_DIR, exist_ok=True)
+        self.amount_recognizer.save(os.path.join(TEMPLATE_DIR, f"{self.table_skin}.amounttm"))
+    
+    def amount_templates_ready(self) -> bool:
+        """全ての数字が学習済みか"""
+        if self.amount_recognizer is None:
+            return False
+        samples = self.amount_recognizer.samples()
+        return all(samples[c] > 0 for c in AMOUNT_CHARS)
     
     def start_auto_capture(self):
         """自動キャプチャ開始"""
@@ -69,16 +181,25 @@ class AutoCaptureSystem:
                     # 画面キャプチャ
                     screenshot = self.capture_screen(sct)
                     
-                    # ポーカーテーブル検出
-                    table_region = self.detect_poker_table(screenshot)
+                    # ポーカーテーブル検出（見つかった後は一定間隔で再検出）
+                    now = time.time()
+                    if self.table_region is None or now - self.table_detected_at > TABLE_REDETECT_INTERVAL:
+                        self.table_detected_at = now
+                        table_region = self.detect_poker_table(screenshot)
+                        if table_region != self.table_region:
+                            self.table_region = table_region
+                            self.configure_frame_gate(table_region)
                     
-                    if table_region:
-                        # ゲーム状態を抽出
-                        game_state = self.extract_game_state(screenshot, table_region)
+                    if self.table_region:
+                        # 画面が変化した領域の項目だけ抽出し直す（Noneなら変化検出が無いので全項目）
+                        fields = self.changed_fields(screenshot)
                         
-                        # 変化があれば自動分析
-                        if self.has_changed(game_state):
-                            self.auto_analyze(game_state)
+                        if fields is None or fields:
+                            game_state = self.extract_game_state(screenshot, self.table_region, fields)
+                            
+                            # 変化があれば自動分析
+                            if self.has_changed(game_state):
+                                self.auto_analyze(game_state)
                     
                     time.sleep(0.1)  # 10FPS
                     
@@ -97,7 +218,16 @@ class AutoCaptureSystem:
         return cv2.cvtColor(img, cv2.COLOR_BGRA2BGR)
     
     def detect_poker_table(self, screenshot: np.ndarray) -> Optional[Dict]:
-        """ポーカーテーブル検出"""
+        """ポーカーテーブル検出（最大のテーブル）"""
+        tables = self.detect_poker_tables(screenshot)
+        
+        if tables:
+            return max(tables, key=lambda t: t['width'] * t['height'])
+        
+        return None
+    
+    def detect_poker_tables(self, screenshot: np.ndarray) -> List[Dict]:
+        """画面上の全てのポーカーテーブル（上から、左から順）"""
         # 緑のテーブルを検出（HSV色空間）
         hsv = cv2.cvtColor(screenshot, cv2.COLOR_BGR2HSV)
         
@@ -110,33 +240,79 @@ class AutoCaptureSystem:
         # 輪郭検出
         contours, _ = cv2.findContours(mask, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
         
-        if contours:
-            # 最大の輪郭（テーブル）
-            largest = max(contours, key=cv2.contourArea)
-            x, y, w, h = cv2.boundingRect(largest)
+        tables = []
+        for contour in contours:
+            x, y, w, h = cv2.boundingRect(contour)
             
             # 楕円形状チェック
             if w > 200 and h > 150 and 0.5 < w/h < 2.0:
-                return {'x': x, 'y': y, 'width': w, 'height': h}
+                tables.append({'x': x, 'y': y, 'width': w, 'height': h})
         
-        return None
+        tables.sort(key=lambda t: (t['y'], t['x']))
+        return tables
     
-    def extract_game_state(self, screenshot: np.ndarray, table_region: Dict) -> Dict:
-        """ゲーム状態抽出"""
+    def configure_frame_gate(self, table_region: Optional[Dict]):
+        """テーブルの注目領域を変化検出に登録"""
+        self.current_state = {}
+        self.frame_gate = None
+        self.gate_fields = []
+        
+        if _native is None or not table_region:
+            return
+        
+        self.frame_gate = _native.FrameGate()
+        
+        for box, fields in table_gate_regions(table_region):
+            self.frame_gate.add_region(box)
+            self.gate_fields.append(fields)
+    
+    def changed_fields(self, screenshot: np.ndarray) -> Optional[set]:
+        """前のフレームから画面が変化した領域の項目（変化検出が無ければ全項目）"""
+        if self.frame_gate is None:
+            return None
+        
+        fields = set()
+        for index in self.frame_gate.update(screenshot):
+            fields.update(self.gate_fields[index])
+        
+        return fields
+    
+    def extract_game_state(self, screenshot: np.ndarray, table_region: Dict, fields=None) -> Dict:
+        """ゲーム状態抽出（fieldsを指定すればその項目だけ抽出し、他は前回の値）"""
         x, y, w, h = table_region['x'], table_region['y'], table_region['width'], table_region['height']
         table_img = screenshot[y:y+h, x:x+w]
         
-        game_state = {
-            'my_hand': self.detect_hero_cards(table_img),
-            'board': self.detect_board_cards(table_img),
-            'pot': self.detect_pot_size(table_img),
-            'call_amount': self.detect_bet_amount(table_img),
-            'my_stack': self.detect_stack(table_img, 'hero'),
-            'position': self.detect_position(table_img),
-            'opponents': self.count_active_players(table_img),
-            'in_position': self.determine_position_advantage(table_img)
+        self.current_state = self.extract_fields(table_img, self.current_state, fields)
+        return self.current_state
+    
+    def extract_fields(self, table_img: np.ndarray, previous: Dict, fields=None) -> Dict:
+        """テーブル画像から項目を抽出（previousが空かfieldsがNoneなら全項目）"""
+        extractors = {
+            'my_hand': lambda: self.detect_hero_cards(table_img),
+            'board': lambda: self.detect_board_cards(table_img),
+            'pot': lambda: self.detect_pot_size(table_img),
+            'call_amount': lambda: self.detect_bet_amount(table_img),
+            'my_stack': lambda: self.detect_stack(table_img, 'hero'),
+            'position': lambda: self.detect_position(table_img),
+            'opponents': lambda: self.count_active_players(table_img),
+            'in_position': lambda: self.determine_position_advantage(table_img),
+            'hero_to_act': lambda: self.detect_hero_to_act(table_img)
         }
         
+        if fields is None or not previous:
+            fields = list(extractors) + ['stacks']
+        
+        game_state = dict(previous)
+        # 金額の項目は全ての席の分も含めて1回の呼び出しで読む
+        amount_fields = [field for field in fields if field in AMOUNT_FIELDS]
+        if amount_fields and self.amount_templates_ready():
+            game_state.update(self.read_amounts(table_img, amount_fields))
+            fields = [field for field in fields if field not in AMOUNT_FIELDS]
+        
+        for field in fields:
+            if field in extractors:
+                game_state[field] = extractors[field]()
+        
         return game_state
     
     def detect_hero_cards(self, table_img: np.ndarray) -> Tuple[int, int]:
@@ -170,29 +346,56 @@ class AutoCaptureSystem:
     
     def detect_cards_in_region(self, region: np.ndarray) -> list:
         """領域内のカード検出"""
-        detected_cards = []
-        
         # エッジ検出でカード形状を見つける
         gray = cv2.cvtColor(region, cv2.COLOR_BGR2GRAY)
         edges = cv2.Canny(gray, 50, 150)
         
         contours, _ = cv2.findContours(edges, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
         
+        boxes = []
         for contour in contours:
             x, y, w, h = cv2.boundingRect(contour)
             
             # カードの縦横比チェック（約2:3）
             if 30 < w < 150 and 40 < h < 200 and 0.5 < w/h < 0.8:
-                card_img = region[y:y+h, x:x+w]
-                card_name = self.recognize_card(card_img)
-                
-                if card_name:
-                    detected_cards.append(card_name)
+                boxes.append((x, y, w, h))
+        
+        if not boxes:
+            return []
+        
+        # 学習済みならフレーム内の全カードをまとめて認識
+        if self.templates_ready():
+            return self.recognize_cards(region, boxes)
+        
+        detected_cards = []
+        for x, y, w, h in boxes:
+            card_name = self.recognize_card_ocr(region[y:y+h, x:x+w])
+            
+            if card_name:
+                detected_cards.append(card_name)
         
         return detected_cards
     
+    def recognize_cards(self, image: np.ndarray, boxes: List[Tuple[int, int, int, int]]) -> list:
+        """テンプレートによる一括認識（確信度の低いカードは除く）"""
+        results = self.card_recognizer.recognize(np.ascontiguousarray(image), boxes)
+        return [
+            f"{RANKS[card % 13]}{SUITS[card // 13]}"
+            for card, confidence in results
+            if card is not None and confidence >= self.min_card_confidence
+        ]
+    
     def recognize_card(self, card_img: np.ndarray) -> Optional[str]:
-        """カード認識（テンプレートマッチング + OCR）"""
+        """カード認識（学習済みテンプレート、未学習のスキンはOCR）"""
+        if self.templates_ready():
+            h, w = card_img.shape[:2]
+            cards = self.recognize_cards(card_img, [(0, 0, w, h)])
+            return cards[0] if cards else None
+        
+        return self.recognize_card_ocr(card_img)
+    
+    def recognize_card_ocr(self, card_img: np.ndarray) -> Optional[str]:
+        """カード認識（Tesseract OCR + 形状）"""
         # リサイズ
         card_resized = cv2.resize(card_img, (64, 96))
         
@@ -275,7 +478,48 @@ class AutoCaptureSystem:
         
         return self.extract_amount(stack_region)
     
+    def seat_stack_boxes(self, w: int, h: int) -> List[Tuple[int, int, int, int]]:
+        """各席のスタックの領域（テーブル画像上の (x, y, width, height)）"""
+        return [(int(w*px) - SEAT_HALF_SIZE, int(h*py), 2*SEAT_HALF_SIZE, SEAT_HALF_SIZE)
+                for px, py in SEAT_POSITIONS]
+    
+    def read_amounts(self, table_img: np.ndarray, fields: List[str]) -> Dict:
+        """テンプレートによる金額の一括読み取り（読めない・確信度の低い金額は0）"""
+        h, w = table_img.shape[:2]
+        boxes = []
+        for field in fields:
+            if field == 'stacks':
+                boxes.extend(self.seat_stack_boxes(w, h))
+            else:
+                x0, y0, x1, y1 = AMOUNT_REGIONS[field]
+                boxes.append((int(w*x0), int(h*y0), max(1, int(w*(x1-x0))), max(1, int(h*(y1-y0)))))
+        
+        # テーブルの端にかかる席の領域は画像内に切り詰める
+        boxes = [(max(0, x), max(0, y), max(1, min(w, x+bw) - max(0, x)), max(1, min(h, y+bh) - max(0, y)))
+                 for x, y, bw, bh in boxes]
+        amounts = [
+            amount if amount is not None and confidence >= self.min_amount_confidence else 0.0
+            for amount, confidence, _ in self.amount_recognizer.read(np.ascontiguousarray(table_img), boxes)
+        ]
+        
+        result = {}
+        for field in fields:
+            if field == 'stacks':
+                result[field], amounts = amounts[:len(SEAT_POSITIONS)], amounts[len(SEAT_POSITIONS):]
+            else:
+                result[field], amounts = amounts[0], amounts[1:]
+        return result
+    
     def extract_amount(self, region: np.ndarray) -> float:
+        """金額抽出（学習済みテンプレート、未学習のスキンはOCR）"""
+        if self.amount_templates_ready():
+            h, w = region.shape[:2]
+            amount, confidence, _ = self.amount_recognizer.read(np.ascontiguousarray(region), [(0, 0, w, h)])[0]
+            return amount if amount is not None and confidence >= self.min_amount_confidence else 0.0
+        
+        return self.extract_amount_ocr(region)
+    
+    def extract_amount_ocr(self, region: np.ndarray) -> float:
         """金額抽出（OCR）"""
         gray = cv2.cvtColor(region, cv2.COLOR_BGR2GRAY)
         
@@ -342,23 +586,13 @@ class AutoCaptureSystem:
     def count_active_players(self, table_img: np.ndarray) -> int:
         """アクティブプレイヤー数をカウント"""
         # プレイヤー席の各位置をチェック
-        player_positions = [
-            (0.5, 0.85),   # Hero
-            (0.3, 0.6),    # Left 1
-            (0.15, 0.4),   # Left 2
-            (0.2, 0.15),   # Top Left
-            (0.5, 0.05),   # Top
-            (0.8, 0.15),   # Top Right
-            (0.85, 0.4),   # Right 2
-            (0.7, 0.6),    # Right 1
-        ]
-        
         h, w = table_img.shape[:2]
         active_count = 0
         
-        for px, py in player_positions:
+        for px, py in SEAT_POSITIONS:
             x, y = int(w * px), int(h * py)
-            region = table_img[max(0, y-30):min(h, y+30), max(0, x-30):min(w, x+30)]
+            region = table_img[max(0, y-SEAT_HALF_SIZE):min(h, y+SEAT_HALF_SIZE),
+                               max(0, x-SEAT_HALF_SIZE):min(w, x+SEAT_HALF_SIZE)]
             
             if self.has_player_at_position(region):
                 active_count += 1
@@ -376,6 +610,21 @@ class AutoCaptureSystem:
         
         return white_ratio > 0.1
     
+    def detect_hero_to_act(self, table_img: np.ndarray) -> bool:
+        """ヒーローの手番か（アクションボタンが表示されているか）"""
+        h, w = table_img.shape[:2]
+        x0, y0, x1, y1 = ACTION_REGION
+        region = table_img[int(h*y0):int(h*y1), int(w*x0):int(w*x1)]
+        if region.size == 0:
+            return False
+        
+        # ボタンはテーブルの緑以外の鮮やかな塗りつぶし
+        hsv = cv2.cvtColor(region, cv2.COLOR_BGR2HSV)
+        hue, sat, val = hsv[..., 0], hsv[..., 1], hsv[..., 2]
+        button = (sat > 80) & (val > 120) & ((hue < 35) | (hue > 85))
+        
+        return button.mean() > 0.15
+    
     def determine_position_advantage(self, table_img: np.ndarray) -> bool:
         """ポジションアドバンテージ判定"""
         position = self.detect_position(table_img)
@@ -383,22 +632,25 @@ class AutoCaptureSystem:
     
     def has_changed(self, game_state: Dict) -> bool:
         """ゲーム状態が変化したか"""
-        if not self.last_game_state:
-            self.last_game_state = game_state
-            return True
-        
-        # 重要な要素の変化をチェック
-        changed = (
-            game_state['my_hand'] != self.last_game_state.get('my_hand') or
-            game_state['board'] != self.last_game_state.get('board') or
-            abs(game_state['pot'] - self.last_game_state.get('pot', 0)) > 5
-        )
+        changed = self.state_changed(self.last_game_state, game_state)
         
         if changed:
             self.last_game_state = game_state
         
         return changed
     
+    def state_changed(self, previous: Dict, game_state: Dict) -> bool:
+        """分析し直すべき変化か"""
+        if not previous:
+            return True
+        
+        # 重要な要素の変化をチェック
+        return (
+            game_state['my_hand'] != previous.get('my_hand') or
+            game_state['board'] != previous.get('board') or
+            abs(game_state['pot'] - previous.get('pot', 0)) > 5
+        )
+    
     def auto_analyze(self, game_state: Dict):
         """自動分析実行"""
         try:
@@ -1,6 +1,6 @@
 # gui/auto_input_panel.py
 import customtkinter as ctk
-from gui.auto_capture_system import AutoCaptureSystem
+from gui.multi_table_capture import MultiTableCapture
 
 class AutoInputPanel(ctk.CTkFrame):
     """自動入力パネル"""
@@ -10,8 +10,8 @@ class AutoInputPanel(ctk.CTkFrame):
         self.system = poker_system
         self.analysis_panel = analysis_panel
         
-        # 自動キャプチャシステム
-        self.auto_capture = AutoCaptureSystem(poker_system)
+        # 自動キャプチャシステム（複数テーブル）
+        self.auto_capture = MultiTableCapture(poker_system)
         self.auto_capture.on_auto_analysis = self.on_analysis_complete
         
         self.pack(fill="both", expand=True, padx=10, pady=10)
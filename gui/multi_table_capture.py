@@ -0,0 +1,186 @@
+# gui/multi_table_capture.py
+import cv2
+import numpy as np
+import mss
+import os
+import threading
+import time
+from typing import Dict, List, Optional
+
+from gui.auto_capture_system import AutoCaptureSystem, table_gate_regions, _native
+
+CAPTURE_FPS = 30                # 取り込み段のフレームレート（変化の無いフレームはネイティブ側で捨てる）
+REDETECT_INTERVAL = 2.0         # レイアウトが変わらなくてもテーブルを再検出する間隔（秒）
+LAYOUT_THRESHOLD = 0.6          # テーブル全体のタイルのこの割合が一度に変わったら再検出
+JOB_TIMEOUT = 0.2               # ワーカーが停止を確認する間隔（秒）
+
+class MultiTableCapture(AutoCaptureSystem):
+    """複数テーブルのパイプライン化した自動キャプチャ
+
+    取り込み(1スレッド) → 抽出(複数ワーカー) → 分析(ヒーローの手番のテーブルが先)の段に分け、
+    段の間の受け渡しはネイティブのCapturePipeline（step60）が行う:
+    - 変化の無いフレームは取り込み段で捨て、変化したテーブルの矩形だけを抽出待ちにする
+    - 抽出待ちはテーブルごとに最新の1フレームだけ（古いフレームは変化した領域を合わせて捨てる）
+    - テーブルの検出はウィンドウの移動・開閉のような大きな変化の時と一定間隔でだけ行う
+    """
+
+    def __init__(self, poker_system, extract_workers: Optional[int] = None, analysis_workers: int = 1):
+        super().__init__(poker_system)
+        self.extract_workers = extract_workers or max(2, min(8, (os.cpu_count() or 2) - 1))
+        self.analysis_workers = analysis_workers
+        self.pipeline = None
+        self.threads = []
+
+        # テーブル構成（抽出ワーカー・分析ワーカーから参照）
+        self.state_lock = threading.Lock()
+        self.tables = []            # テーブルごとの位置
+        self.table_fields = []      # テーブルごとの領域の項目（set_tablesに渡した順）
+        self.generation = 0
+        self.table_states = {}      # テーブル番号 -> 最新のゲーム状態
+        self.analyzed_states = {}   # テーブル番号 -> 最後に分析したゲーム状態
+
+    def start_auto_capture(self):
+        """自動キャプチャ開始（拡張モジュールが無ければ1テーブルの逐次処理）"""
+        if _native is None:
+            super().start_auto_capture()
+            return
+        if self.running:
+            return
+
+        self.running = True
+        self.pipeline = _native.CapturePipeline(REDETECT_INTERVAL, LAYOUT_THRESHOLD)
+        self.set_tables([])
+
+        self.threads = [threading.Thread(target=self.grab_loop, daemon=True)]
+        self.threads += [threading.Thread(target=self.extract_loop, daemon=True)
+                         for _ in range(self.extract_workers)]
+        self.threads += [threading.Thread(target=self.analysis_loop, daemon=True)
+                         for _ in range(self.analysis_workers)]
+        for thread in self.threads:
+            thread.start()
+        print(f"✓ Multi-table auto-capture started ({self.extract_workers} extract workers)")
+
+    def stop_auto_capture(self):
+        """自動キャプチャ停止"""
+        if self.pipeline is None:
+            super().stop_auto_capture()
+            return
+
+        self.running = False
+        self.pipeline.stop()
+        for thread in self.threads:
+            thread.join()
+        self.threads = []
+        print(f"✓ Auto-capture stopped: {self.pipeline.stats()}")
+        self.pipeline = None
+
+    def pipeline_stats(self) -> Dict:
+        """段ごとの件数と、取り込みから分析までの遅延（ミリ秒）"""
+        return self.pipeline.stats() if self.pipeline else {}
+
+    # ===== 取り込み段 =====
+
+    def grab_loop(self):
+        """画面を取り込んでパイプラインに渡す（BGRAのまま、変換は抽出段でテーブルごとに行う）"""
+        interval = 1.0 / CAPTURE_FPS
+        with mss.mss() as sct:
+            monitor = self.screen_region or sct.monitors[1]
+            while self.running:
+                started = time.perf_counter()
+                try:
+                    self.pipeline.submit(np.asarray(sct.grab(monitor)))
+                except Exception as e:
+                    print(f"Capture error: {e}")
+                    time.sleep(1)
+                time.sleep(max(0.0, interval - (time.perf_counter() - started)))
+
+    # ===== 抽出段 =====
+
+    def extract_loop(self):
+        """抽出ワーカー: 同じテーブルが2つのワーカーに同時に渡ることは無い"""
+        while self.running:
+            job = self.pipeline.next_job(JOB_TIMEOUT)
+            if job is None:
+                continue
+            try:
+                image = np.asarray(job)
+                image = cv2.cvtColor(image, cv2.COLOR_BGRA2BGR) if image.shape[2] == 4 else image.copy()
+                job.release()
+
+                if job.kind == 'layout':
+                    self.update_tables(image)
+                    job.complete()
+                else:
+                    self.extract_table(job, image)
+            except Exception as e:
+                print(f"Extraction error: {e}")
+            finally:
+                # 完了していなければ手番は不明のまま完了し、バッファを返す
+                del job
+
+    def update_tables(self, screenshot: np.ndarray):
+        """テーブルを再検出し、位置が変わっていればパイプラインの構成を置き換える"""
+        tables = self.detect_poker_tables(screenshot)
+        if tables != self.tables:
+            self.set_tables(tables)
+
+    def set_tables(self, tables: List[Dict]):
+        """テーブル構成を置き換える（状態は新しいテーブルで取り直す）"""
+        layout = []
+        fields = []
+        for table in tables:
+            regions = table_gate_regions(table)
+            layout.append(((table['x'], table['y'], table['width'], table['height']),
+                           [box for box, _ in regions]))
+            fields.append([region_fields for _, region_fields in regions])
+
+        with self.state_lock:
+            self.generation = self.pipeline.set_tables(layout)
+            self.tables = tables
+            self.table_fields = fields
+            self.table_states = {}
+            self.analyzed_states = {}
+
+    def extract_table(self, job, table_img: np.ndarray):
+        """変化した領域の項目だけ抽出し直し、分析し直すべき変化なら分析待ちにする"""
+        with self.state_lock:
+            if job.generation != self.generation:
+                job.complete()
+                return
+            previous = self.table_states.get(job.table, {})
+            fields = set()
+            for region in job.regions:
+                fields.update(self.table_fields[job.table][region])
+
+        game_state = self.extract_fields(table_img, previous, fields)
+
+        with self.state_lock:
+            if job.generation != self.generation:
+                job.complete()
+                return
+            self.table_states[job.table] = game_state
+            # 手番が回ってきた時は状態が同じでも分析し直す
+            turn_started = game_state['hero_to_act'] and not previous.get('hero_to_act', False)
+            changed = turn_started or self.state_changed(self.analyzed_states.get(job.table), game_state)
+
+        job.complete(hero_to_act=game_state['hero_to_act'], changed=changed)
+
+    # ===== 分析段 =====
+
+    def analysis_loop(self):
+        """分析ワーカー: テーブルごとに最新の状態だけを分析する"""
+        while self.running:
+            request = self.pipeline.next_analysis(JOB_TIMEOUT)
+            if request is None:
+                continue
+
+            with self.state_lock:
+                if request['generation'] != self.generation or request['table'] not in self.table_states:
+                    continue
+                game_state = dict(self.table_states[request['table']])
+                self.analyzed_states[request['table']] = game_state
+
+            game_state['table'] = request['table']
+            game_state['latency_ms'] = request['latency_ms']
+            self.last_game_state = game_state
+            self.auto_analyze(game_state)
@@ -0,0 +1,107 @@
+// hh_import.cpp
+// ハンド履歴取り込みCLI（step51のC ABIを呼ぶ）
+//   hh_import [--stats FILE] [--history DB] [--store PATH] [--threads N] FILE...
+// --statsのファイルが既にあれば読み込んで追記し、終了時に保存する。
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "poker_engine.h"
+
+namespace {
+
+void usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--stats FILE] [--history DB] [--store PATH] [--threads N] FILE...\n",
+                 program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* stats_path = nullptr;
+    const char* history = nullptr;
+    const char* store_path = nullptr;
+    int threads = 0;
+    std::vector<const char*> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strncmp(arg, "--", 2) != 0) {
+            inputs.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (std::strcmp(arg, "--stats") == 0) {
+            stats_path = value;
+        } else if (std::strcmp(arg, "--history") == 0) {
+            history = value;
+        } else if (std::strcmp(arg, "--store") == 0) {
+            store_path = value;
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            threads = std::atoi(value);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (inputs.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    void* stats = nullptr;
+    if (stats_path != nullptr) {
+        if (std::FILE* probe = std::fopen(stats_path, "rb")) {
+            std::fclose(probe);
+            stats = hud_stats_open(stats_path);
+            if (stats == nullptr) return 1;
+        } else {
+            stats = hud_stats_create();
+        }
+    }
+
+    void* store = nullptr;
+    if (store_path != nullptr) {
+        store = hand_store_open(store_path, 0, 1);
+        if (store == nullptr) {
+            if (stats != nullptr) hud_stats_destroy(stats);
+            return 1;
+        }
+    }
+
+    PokerImportResult result = {};
+    int64_t hands = hh_import(inputs.data(), static_cast<int>(inputs.size()), stats,
+                              history, store, threads, &result);
+    int status = 0;
+    if (hands < 0) {
+        std::fprintf(stderr, "import failed\n");
+        status = 1;
+    } else {
+        std::printf("imported %llu hands from %llu files (%.1f MB) in %.2fs, %llu errors, "
+                    "%llu history rows, %llu store rows\n",
+                    static_cast<unsigned long long>(result.hands),
+                    static_cast<unsigned long long>(result.files),
+                    result.bytes / 1048576.0, result.seconds,
+                    static_cast<unsigned long long>(result.errors),
+                    static_cast<unsigned long long>(result.history_rows),
+                    static_cast<unsigned long long>(result.store_rows));
+        if (stats != nullptr) {
+            if (hud_stats_save(stats, stats_path) != 0) {
+                std::fprintf(stderr, "failed to save %s\n", stats_path);
+                status = 1;
+            } else {
+                std::printf("%u players in %s\n", hud_stats_player_count(stats), stats_path);
+            }
+        }
+    }
+    if (stats != nullptr) hud_stats_destroy(stats);
+    if (store != nullptr) hand_store_close(store);
+    return status;
+}
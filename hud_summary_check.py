@@ -0,0 +1,41 @@
+# hud_summary_check.py
+# HUDトラッカー(step13)の回帰チェック（ctestから実行する。poker_engine.soのあるディレクトリをPYTHONPATHに入れる）
+#   python3 hud_summary_check.py
+# 1. 作成済みでイベントの無いプレイヤーのサマリーが取得できること（ネイティブIDが作成時に登録されること）
+# 2. get_table_summariesにそのプレイヤーが含まれていても取得できること
+# 3. detect_exploits(step17)がそのプレイヤーで例外を投げないこと
+# 外れれば終了コード1を返す。
+import sys
+
+import step13_advanced_hud as hud
+from step17_exploit_engine_complete import AdvancedExploitEngine
+
+
+def main() -> int:
+    if hud._native is None:
+        print("hud_summary_check: poker_engine extension not importable", file=sys.stderr)
+        return 1
+
+    ok = True
+    tracker = hud.AdvancedHUDTracker()
+    tracker.get_or_create_player('villain1')
+    tracker.record_preflop_action('hero', 'raise', 'BTN')
+
+    summary = tracker.get_player_summary('villain1')
+    good = summary.get('player_id') == 'villain1' and summary.get('hands') == 0
+    print(f"{'no-events':<12} {'ok' if good else 'FAILED'}")
+    ok = ok and good
+
+    table = tracker.get_table_summaries(['hero', 'villain1', 'unknown'])
+    good = ([s.get('player_id') for s in table[:2]] == ['hero', 'villain1']
+            and table[0]['hands'] == 1 and table[2] == {'error': 'Player not found'})
+    print(f"{'table':<12} {'ok' if good else 'FAILED'}")
+    ok = ok and good
+
+    AdvancedExploitEngine(tracker).detect_exploits('villain1')
+    print(f"{'exploits':<12} ok")
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,62 @@
+// pgo_training.cpp
+// PGO用の学習ワークロード（C ABI経由でホットパスを実行する）
+// POKER_ENGINE_PGO=GENERATE でビルドし、`cmake --build <dir> --target pgo-train` で実行する。
+#include <cstdio>
+#include <cstdint>
+#include <random>
+
+#include "poker_engine.h"
+
+namespace {
+
+// 重複のないカードをcount枚引く
+void draw_cards(std::mt19937_64& rng, uint8_t* out, int count) {
+    uint64_t used = 0;
+    for (int i = 0; i < count; ++i) {
+        uint8_t card;
+        do {
+            card = static_cast<uint8_t>(rng() % 52);
+        } while (used & (1ULL << card));
+        used |= 1ULL << card;
+        out[i] = card;
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(20240601);
+
+    // ハンド評価
+    constexpr int EVAL_HANDS = 1 << 20;
+    static uint8_t hands[EVAL_HANDS * 7];
+    static uint32_t scores[EVAL_HANDS];
+    for (int i = 0; i < EVAL_HANDS; ++i) {
+        draw_cards(rng, hands + i * 7, 7);
+    }
+    evaluate_7cards_batch(hands, EVAL_HANDS, scores);
+
+    // エクイティ（プリフロップ/フロップ/ターン/リバー × 相手人数）
+    double equity_sum = 0.0;
+    for (int board_count : {0, 3, 4, 5}) {
+        for (int opponents = 1; opponents <= 5; opponents += 2) {
+            uint8_t cards[7];
+            draw_cards(rng, cards, 2 + board_count);
+            equity_sum += calculate_equity_optimized(
+                cards[0], cards[1], cards + 2, board_count, opponents, 200000);
+        }
+    }
+
+    // EQR
+    double eqr_sum = 0.0;
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (int i = 0; i < 100000; ++i) {
+        eqr_sum += calculate_eqr_advanced(
+            unit(rng), i % 9, 10.0 + unit(rng) * 190.0, 1.0 + unit(rng) * 50.0,
+            i % 3, 1 + i % 5, (i & 1) != 0, unit(rng));
+    }
+
+    std::printf("pgo training done: score[0]=%u equity_sum=%.3f eqr_sum=%.3f\n",
+                scores[0], equity_sum, eqr_sum);
+    return 0;
+}
@@ -0,0 +1,632 @@
+// poker_bench.cpp
+// エンジンのベンチマーク（C ABI経由で計測し、結果をJSONで出力する）
+//   poker_bench [--quick] [--filter TEXT] [--repeat N] [--threads N] [--out FILE]
+//               [--baseline FILE] [--tolerance PCT]
+//   poker_bench --compare BASELINE CURRENT [--tolerance PCT]
+// 各項目はrepeat回計測した中央値。基準の結果と比べてtolerance%以上悪化した項目を退行として表示し、
+// 退行があれば終了コード1を返す（--baselineは計測の直後に比べ、表は標準エラーへ出す）。
+// 変化率は良くなる向きを正とする（処理量は増加、レイテンシは減少）。
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+#include "poker_engine.h"
+
+namespace {
+
+constexpr uint64_t ALL_7CARD_HANDS = 133784560;     // C(52, 7)
+
+// 7枚の全ハンドの役ごとの数（ハイカード .. ストレートフラッシュ）
+constexpr uint64_t CATEGORY_COUNTS[9] = {
+    23294460, 58627800, 31433400, 6461620, 6180020, 4047644, 3473184, 224848, 41584,
+};
+
+struct Options {
+    bool quick = false;
+    const char* filter = nullptr;
+    int repeat = 5;
+    int threads = 0;
+    const char* out_path = nullptr;
+    const char* baseline_path = nullptr;
+    double tolerance = 10.0;        // %
+};
+
+struct Result {
+    std::string name;
+    std::string unit;
+    bool higher_is_better;
+    std::vector<double> samples;    // 各回の値
+    double value;                   // 中央値
+};
+
+void usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--quick] [--filter TEXT] [--repeat N] [--threads N] [--out FILE]\n"
+                 "          [--baseline FILE] [--tolerance PCT]\n"
+                 "       %s --compare BASELINE CURRENT [--tolerance PCT]\n",
+                 program, program);
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+// fnをrepeat回実行し、各回の秒数を返す
+template <typename F>
+std::vector<double> time_runs(int repeat, F&& fn) {
+    std::vector<double> seconds;
+    for (int i = 0; i < repeat; ++i) {
+        auto started = std::chrono::steady_clock::now();
+        fn();
+        seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    }
+    return seconds;
+}
+
+class Bench {
+public:
+    explicit Bench(const Options& options) : options(options) {}
+
+    bool selected(const std::string& name) const {
+        return options.filter == nullptr || name.find(options.filter) != std::string::npos;
+    }
+
+    // 1回あたりworkの処理量（件/秒）
+    void add_rate(const std::string& name, const char* unit, double work, const std::vector<double>& seconds) {
+        std::vector<double> rates;
+        for (double s : seconds) rates.push_back(work / s);
+        add(name, unit, true, rates);
+    }
+
+    // 1回あたりのミリ秒
+    void add_latency(const std::string& name, const std::vector<double>& seconds, int calls) {
+        std::vector<double> ms;
+        for (double s : seconds) ms.push_back(s * 1e3 / calls);
+        add(name, "ms", false, ms);
+    }
+
+    const std::vector<Result>& results() const { return all; }
+
+private:
+    const Options& options;
+    std::vector<Result> all;
+
+    void add(const std::string& name, const char* unit, bool higher_is_better, std::vector<double> samples) {
+        Result r{name, unit, higher_is_better, samples, median(samples)};
+        std::fprintf(stderr, "  %-32s %14.6g %s\n", name.c_str(), r.value, unit);
+        all.push_back(std::move(r));
+    }
+};
+
+// 重複のないカードをcount枚引く
+void draw_cards(std::mt19937_64& rng, uint8_t* out, int count) {
+    uint64_t used = 0;
+    for (int i = 0; i < count; ++i) {
+        uint8_t card;
+        do {
+            card = static_cast<uint8_t>(rng() % 52);
+        } while (used & (1ULL << card));
+        used |= 1ULL << card;
+        out[i] = card;
+    }
+}
+
+// ===== ハンド評価 =====
+
+void bench_evaluator_random(Bench& bench, const Options& options) {
+    if (!bench.selected("evaluator.random7")) return;
+    const int count = options.quick ? 1 << 18 : 1 << 21;
+    std::mt19937_64 rng(20240601);
+    std::vector<uint8_t> hands(static_cast<size_t>(count) * 7);
+    std::vector<uint32_t> scores(count);
+    for (int i = 0; i < count; ++i) draw_cards(rng, hands.data() + static_cast<size_t>(i) * 7, 7);
+
+    auto seconds = time_runs(options.repeat, [&] { evaluate_7cards_batch(hands.data(), count, scores.data()); });
+    bench.add_rate("evaluator.random7", "hands/s", count, seconds);
+}
+
+// 先頭2枚(a, b)を1単位として各スレッドが取り、残り5枚を列挙してまとめて評価する
+void enumerate_hands(int threads, uint64_t* categories) {
+    constexpr int CHUNK = 4096;
+    std::vector<std::pair<int, int>> prefixes;
+    for (int a = 0; a < 46; ++a) {
+        for (int b = a + 1; b < 47; ++b) prefixes.emplace_back(a, b);
+    }
+    std::atomic<size_t> next{0};
+    std::vector<uint64_t> counts(static_cast<size_t>(threads) * 9, 0);
+
+    auto worker = [&](int t) {
+        std::vector<uint8_t> hands(CHUNK * 7);
+        std::vector<uint32_t> scores(CHUNK);
+        uint64_t* local = counts.data() + static_cast<size_t>(t) * 9;
+        int filled = 0;
+        auto flush = [&] {
+            evaluate_7cards_batch(hands.data(), filled, scores.data());
+            for (int i = 0; i < filled; ++i) ++local[scores[i] >> 20];
+            filled = 0;
+        };
+        for (size_t p; (p = next.fetch_add(1)) < prefixes.size();) {
+            const uint8_t a = static_cast<uint8_t>(prefixes[p].first);
+            const uint8_t b = static_cast<uint8_t>(prefixes[p].second);
+            for (uint8_t c = b + 1; c < 48; ++c)
+            for (uint8_t d = c + 1; d < 49; ++d)
+            for (uint8_t e = d + 1; e < 50; ++e)
+            for (uint8_t f = e + 1; f < 51; ++f)
+            for (uint8_t g = f + 1; g < 52; ++g) {
+                uint8_t* hand = hands.data() + filled * 7;
+                hand[0] = a; hand[1] = b; hand[2] = c; hand[3] = d;
+                hand[4] = e; hand[5] = f; hand[6] = g;
+                if (++filled == CHUNK) flush();
+            }
+        }
+        if (filled > 0) flush();
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+    for (auto& thread : pool) thread.join();
+
+    std::fill(categories, categories + 9, 0);
+    for (int t = 0; t < threads; ++t) {
+        for (int k = 0; k < 9; ++k) categories[k] += counts[static_cast<size_t>(t) * 9 + k];
+    }
+}
+
+// 全133,784,560ハンド。役ごとの数が既知の値と一致しなければ失敗
+bool bench_evaluator_enumerate(Bench& bench, const Options& options, int threads) {
+    if (options.quick || !bench.selected("evaluator.enumerate")) return true;
+    bool valid = true;
+    auto seconds = time_runs(std::min(options.repeat, 3), [&] {
+        uint64_t categories[9];
+        enumerate_hands(threads, categories);
+        for (int k = 0; k < 9; ++k) {
+            if (categories[k] != CATEGORY_COUNTS[k]) {
+                std::fprintf(stderr, "poker_bench: category %d: %llu hands, expected %llu\n", k,
+                             static_cast<unsigned long long>(categories[k]),
+                             static_cast<unsigned long long>(CATEGORY_COUNTS[k]));
+                valid = false;
+            }
+        }
+    });
+    bench.add_rate("evaluator.enumerate", "hands/s", double(ALL_7CARD_HANDS), seconds);
+    return valid;
+}
+
+// ===== エクイティ =====
+
+void bench_equity(Bench& bench, const Options& options, int threads) {
+    static const struct { const char* street; const char* board; } STREETS[] = {
+        {"preflop", ""}, {"flop", "Qh7c2d"}, {"turn", "Qh7c2dTs"}, {"river", "Qh7c2dTs4s"},
+    };
+    const int iterations = options.quick ? 20000 : 100000;
+    uint8_t hero[2];
+    parse_cards_string("AhKh", hero, 2);
+
+    for (const auto& street : STREETS) {
+        uint8_t board[5];
+        int board_count = parse_cards_string(street.board, board, 5);
+        for (int opponents : {1, 3, 5}) {
+            std::string name = std::string("equity.") + street.street + "." + std::to_string(opponents) + "opp";
+            if (!bench.selected(name)) continue;
+            auto seconds = time_runs(options.repeat, [&] {
+                calculate_equity_threads(hero[0], hero[1], board, board_count, opponents, iterations, threads);
+            });
+            bench.add_rate(name, "trials/s", iterations, seconds);
+            bench.add_latency(name + ".latency", seconds, 1);
+        }
+    }
+}
+
+// ===== EQR =====
+
+void bench_eqr(Bench& bench, const Options& options) {
+    const int count = options.quick ? 1 << 14 : 1 << 17;
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<double> equity(count), stack(count), pot(count), skill(count);
+    std::vector<int32_t> position(count), texture(count), opponents(count);
+    std::vector<uint8_t> in_position(count);
+    for (int i = 0; i < count; ++i) {
+        equity[i] = unit(rng);
+        position[i] = i % 9;
+        stack[i] = 10.0 + unit(rng) * 190.0;
+        pot[i] = 1.0 + unit(rng) * 50.0;
+        texture[i] = i % 3;
+        opponents[i] = 1 + i % 5;
+        in_position[i] = i & 1;
+        skill[i] = unit(rng);
+    }
+
+    if (bench.selected("eqr.batch")) {
+        std::vector<double> out(static_cast<size_t>(count) * 6);
+        auto seconds = time_runs(options.repeat, [&] {
+            calculate_eqr_batch(count, equity.data(), position.data(), stack.data(), pot.data(),
+                                texture.data(), opponents.data(), in_position.data(), skill.data(),
+                                out.data(), out.data() + count, out.data() + 2 * count,
+                                out.data() + 3 * count, out.data() + 4 * count, out.data() + 5 * count);
+        });
+        bench.add_rate("eqr.batch", "rows/s", count, seconds);
+    }
+    if (bench.selected("eqr.scalar")) {
+        volatile double sink = 0.0;
+        auto seconds = time_runs(options.repeat, [&] {
+            double sum = 0.0;
+            for (int i = 0; i < count; ++i) {
+                sum += calculate_eqr_advanced(equity[i], position[i], stack[i], pot[i], texture[i],
+                                              opponents[i], in_position[i] != 0, skill[i]);
+            }
+            sink = sum;
+        });
+        (void)sink;
+        bench.add_rate("eqr.scalar", "rows/s", count, seconds);
+    }
+}
+
+// ===== CFR・MCTS =====
+
+// ソルバーを作れなければ失敗として結果に含めない
+bool bench_cfr(Bench& bench, const Options& options) {
+    static const struct { const char* name; int game; int iterations; } GAMES[] = {
+        {"cfr.kuhn", 0, 20000},
+        {"cfr.leduc", 1, 200},
+    };
+    bool valid = true;
+    for (const auto& game : GAMES) {
+        if (!bench.selected(game.name)) continue;
+        const int iterations = options.quick ? game.iterations / 10 : game.iterations;
+        // 情報セットの作成を含めないよう、計測ごとに作り直して1回学習してから測る
+        std::vector<double> seconds;
+        for (int r = 0; r < options.repeat; ++r) {
+            void* solver = create_cfr_solver_game(game.game);
+            if (solver == nullptr) break;
+            cfr_train(solver, 1);
+            auto run = time_runs(1, [&] { cfr_train(solver, iterations); });
+            seconds.push_back(run[0]);
+            destroy_cfr_solver(solver);
+        }
+        if (seconds.size() != static_cast<size_t>(options.repeat)) {
+            std::fprintf(stderr, "poker_bench: %s: cannot create solver for game %d\n", game.name, game.game);
+            valid = false;
+            continue;
+        }
+        bench.add_rate(game.name, "iterations/s", iterations, seconds);
+    }
+    return valid;
+}
+
+bool bench_mcts(Bench& bench, const Options& options) {
+    if (!bench.selected("mcts.simulations")) return true;
+    const int simulations = options.quick ? 100000 : 1000000;
+    const int32_t actions[] = {0, 1, 2, 3, 4};
+    std::vector<double> seconds;
+    for (int r = 0; r < options.repeat; ++r) {
+        void* search = create_mcts_search(actions, 5, 1 + r);
+        if (search == nullptr) {
+            std::fprintf(stderr, "poker_bench: mcts.simulations: cannot create search\n");
+            return false;
+        }
+        auto run = time_runs(1, [&] { mcts_search(search, simulations); });
+        seconds.push_back(run[0]);
+        destroy_mcts_search(search);
+    }
+    bench.add_rate("mcts.simulations", "simulations/s", simulations, seconds);
+    return true;
+}
+
+// ===== マシン情報 =====
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+std::string cpu_model() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) return line.substr(line.find_first_not_of(' ', colon + 1));
+        }
+    }
+    return "unknown";
+}
+
+// 対応する命令セット拡張と、POKER_HOT_KERNELのクローンのうち選ばれる水準
+std::vector<std::string> cpu_features(std::string& isa_level) {
+    std::vector<std::string> features;
+    isa_level = "baseline";
+#if defined(__x86_64__) && defined(__GNUC__)
+    __builtin_cpu_init();
+#define POKER_BENCH_FEATURE(name) if (__builtin_cpu_supports(name)) features.push_back(name)
+    POKER_BENCH_FEATURE("popcnt");
+    POKER_BENCH_FEATURE("sse4.2");
+    POKER_BENCH_FEATURE("avx");
+    POKER_BENCH_FEATURE("avx2");
+    POKER_BENCH_FEATURE("bmi2");
+    POKER_BENCH_FEATURE("fma");
+    POKER_BENCH_FEATURE("avx512f");
+    POKER_BENCH_FEATURE("avx512bw");
+    POKER_BENCH_FEATURE("avx512vl");
+#undef POKER_BENCH_FEATURE
+    if (__builtin_cpu_supports("x86-64-v4")) {
+        isa_level = "x86-64-v4";
+    } else if (__builtin_cpu_supports("x86-64-v3")) {
+        isa_level = "x86-64-v3";
+    } else if (__builtin_cpu_supports("x86-64-v2")) {
+        isa_level = "x86-64-v2";
+    }
+#endif
+    return features;
+}
+
+std::string machine_json(int threads) {
+    std::ostringstream out;
+    char hostname[256] = "unknown";
+    std::string os = "unknown";
+#if defined(__unix__) || defined(__APPLE__)
+    gethostname(hostname, sizeof(hostname) - 1);
+    struct utsname name;
+    if (uname(&name) == 0) os = std::string(name.sysname) + " " + name.release + " " + name.machine;
+#endif
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::string isa_level;
+    std::vector<std::string> features = cpu_features(isa_level);
+    out << "  \"machine\": {\n"
+        << "    \"hostname\": \"" << json_escape(hostname) << "\",\n"
+        << "    \"os\": \"" << json_escape(os) << "\",\n"
+        << "    \"cpu_model\": \"" << json_escape(cpu_model()) << "\",\n"
+        << "    \"logical_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"threads\": " << threads << ",\n"
+        << "    \"cpu_features\": [";
+    for (size_t i = 0; i < features.size(); ++i) out << (i ? ", " : "") << '"' << features[i] << '"';
+    out << "],\n"
+        << "    \"isa_level\": \"" << isa_level << "\",\n"
+#ifdef __VERSION__
+        << "    \"compiler\": \"" << json_escape(__VERSION__) << "\",\n"
+#endif
+#ifdef POKER_ENGINE_CPU_DISPATCH
+        << "    \"cpu_dispatch\": true,\n"
+#else
+        << "    \"cpu_dispatch\": false,\n"
+#endif
+        << "    \"lto\": \"" << POKER_BENCH_LTO << "\",\n"
+        << "    \"pgo\": \"" << POKER_BENCH_PGO << "\",\n"
+        << "    \"timestamp\": \"" << timestamp << "\"\n"
+        << "  }";
+    return out.str();
+}
+
+std::string results_json(const Options& options, int threads, const std::vector<Result>& results) {
+    std::ostringstream out;
+    out.precision(9);
+    out << "{\n  \"schema\": 1,\n  \"quick\": " << (options.quick ? "true" : "false") << ",\n"
+        << machine_json(threads) << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\", \"value\": " << r.value
+            << ", \"higher_is_better\": " << (r.higher_is_better ? "true" : "false") << ", \"samples\": [";
+        for (size_t k = 0; k < r.samples.size(); ++k) out << (k ? ", " : "") << r.samples[k];
+        out << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+// ===== 比較 =====
+// 読むのはこのツールが書いた形式だけ（空白・改行の整形は問わない）:
+// "benchmarks"配列の各オブジェクトの name / value / higher_is_better と quick・machine.cpu_model
+
+struct Entry {
+    std::string name;
+    double value = 0.0;
+    bool higher_is_better = true;
+};
+
+// textのbegin以降で最初の "key": の値の開始位置（見つからなければnpos）
+size_t find_value(const std::string& text, const char* key, size_t begin, size_t end) {
+    std::string quoted = std::string("\"") + key + "\"";
+    size_t at = text.find(quoted, begin);
+    if (at == std::string::npos || at >= end) return std::string::npos;
+    at = text.find(':', at + quoted.size());
+    if (at == std::string::npos || at >= end) return std::string::npos;
+    return text.find_first_not_of(" \t\r\n", at + 1);
+}
+
+std::string string_value(const std::string& text, const char* key, size_t begin, size_t end) {
+    size_t at = find_value(text, key, begin, end);
+    if (at == std::string::npos || text[at] != '"') return "";
+    size_t close = text.find('"', at + 1);
+    return close == std::string::npos ? "" : text.substr(at + 1, close - at - 1);
+}
+
+bool read_results(const std::string& text, std::vector<Entry>& entries, std::string& cpu, bool& quick) {
+    cpu = string_value(text, "cpu_model", 0, text.size());
+    size_t quick_value = find_value(text, "quick", 0, text.size());
+    quick = quick_value != std::string::npos && text.compare(quick_value, 4, "true") == 0;
+    size_t at = find_value(text, "benchmarks", 0, text.size());
+    if (at == std::string::npos || text[at] != '[') return false;
+    const size_t end = text.find(']', text.rfind('}'));
+    while ((at = text.find('{', at)) != std::string::npos && at < end) {
+        size_t close = text.find('}', at);
+        if (close == std::string::npos) return false;
+        Entry entry;
+        entry.name = string_value(text, "name", at, close);
+        size_t value = find_value(text, "value", at, close);
+        size_t higher = find_value(text, "higher_is_better", at, close);
+        if (entry.name.empty() || value == std::string::npos) return false;
+        entry.value = std::strtod(text.c_str() + value, nullptr);
+        entry.higher_is_better = higher == std::string::npos || text.compare(higher, 4, "true") == 0;
+        entries.push_back(entry);
+        at = close + 1;
+    }
+    return true;
+}
+
+bool read_file(const char* path, std::string& text) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+// 退行した項目の数（読めなければ-1）
+int compare(const std::string& baseline_text, const std::string& current_text, double tolerance, FILE* out) {
+    std::vector<Entry> baseline, current;
+    std::string baseline_cpu, current_cpu;
+    bool baseline_quick, current_quick;
+    if (!read_results(baseline_text, baseline, baseline_cpu, baseline_quick) ||
+        !read_results(current_text, current, current_cpu, current_quick)) {
+        std::fprintf(stderr, "poker_bench: malformed results file\n");
+        return -1;
+    }
+    if (baseline_cpu != current_cpu) {
+        std::fprintf(out, "note: baseline CPU \"%s\" differs from \"%s\"\n", baseline_cpu.c_str(), current_cpu.c_str());
+    }
+    if (baseline_quick != current_quick) {
+        std::fprintf(out, "note: comparing a --quick run with a full run (workload sizes differ)\n");
+    }
+
+    int regressions = 0;
+    std::fprintf(out, "%-32s %14s %14s %9s\n", "benchmark", "baseline", "current", "change");
+    for (const Entry& now : current) {
+        auto before = std::find_if(baseline.begin(), baseline.end(),
+                                   [&](const Entry& e) { return e.name == now.name; });
+        if (before == baseline.end() || before->value <= 0.0) {
+            std::fprintf(out, "%-32s %14s %14.6g %9s  new\n", now.name.c_str(), "-", now.value, "");
+            continue;
+        }
+        // 良くなる向きを正にした変化率
+        double change = (now.value / before->value - 1.0) * 100.0;
+        if (!now.higher_is_better) change = -change;
+        const char* status = "";
+        if (change < -tolerance) {
+            status = "  REGRESSION";
+            ++regressions;
+        } else if (change > tolerance) {
+            status = "  improved";
+        }
+        std::fprintf(out, "%-32s %14.6g %14.6g %+8.1f%%%s\n", now.name.c_str(), before->value, now.value, change, status);
+    }
+    for (const Entry& before : baseline) {
+        bool present = std::any_of(current.begin(), current.end(),
+                                   [&](const Entry& e) { return e.name == before.name; });
+        if (!present) std::fprintf(out, "%-32s %14.6g %14s %9s  missing\n", before.name.c_str(), before.value, "-", "");
+    }
+    std::fprintf(out, "%d regression(s) beyond %.1f%%\n", regressions, tolerance);
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    const char* compare_paths[2] = {nullptr, nullptr};
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--quick") == 0) {
+            options.quick = true;
+        } else if (std::strcmp(arg, "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(arg, "--repeat") == 0 && i + 1 < argc) {
+            options.repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--out") == 0 && i + 1 < argc) {
+            options.out_path = argv[++i];
+        } else if (std::strcmp(arg, "--baseline") == 0 && i + 1 < argc) {
+            options.baseline_path = argv[++i];
+        } else if (std::strcmp(arg, "--tolerance") == 0 && i + 1 < argc) {
+            options.tolerance = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--compare") == 0 && i + 2 < argc) {
+            compare_paths[0] = argv[++i];
+            compare_paths[1] = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (compare_paths[0] != nullptr) {
+        std::string baseline, current;
+        for (const char* path : compare_paths) {
+            if (!read_file(path, path == compare_paths[0] ? baseline : current)) {
+                std::fprintf(stderr, "poker_bench: cannot read %s\n", path);
+                return 2;
+            }
+        }
+        int regressions = compare(baseline, current, options.tolerance, stdout);
+        return regressions < 0 ? 2 : regressions > 0 ? 1 : 0;
+    }
+
+    // 基準の結果は計測の前に読む（読めなければ計測しない）
+    std::string baseline;
+    if (options.baseline_path != nullptr && !read_file(options.baseline_path, baseline)) {
+        std::fprintf(stderr, "poker_bench: cannot read %s\n", options.baseline_path);
+        return 2;
+    }
+    if (options.quick) options.repeat = std::min(options.repeat, 3);
+    const int threads = options.threads > 0 ? options.threads
+                                            : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    Bench bench(options);
+    bench_evaluator_random(bench, options);
+    bool valid = bench_evaluator_enumerate(bench, options, threads);
+    bench_equity(bench, options, threads);
+    bench_eqr(bench, options);
+    valid = bench_cfr(bench, options) && valid;
+    valid = bench_mcts(bench, options) && valid;
+
+    std::string json = results_json(options, threads, bench.results());
+    if (options.out_path != nullptr) {
+        std::ofstream out(options.out_path, std::ios::binary);
+        out << json;
+        if (!out) {
+            std::fprintf(stderr, "poker_bench: cannot write %s\n", options.out_path);
+            return 2;
+        }
+    } else {
+        std::fputs(json.c_str(), stdout);
+    }
+    if (!valid) return 1;
+
+    if (!baseline.empty()) {
+        int regressions = compare(baseline, json, options.tolerance, stderr);
+        return regressions < 0 ? 2 : regressions > 0 ? 1 : 0;
+    }
+    return 0;
+}
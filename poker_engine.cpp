@@ -0,0 +1,30 @@
+// poker_engine.cpp
+// poker_engine.so のユニティビルド単位
+// 各ステップはヘッダを持たないため、依存順に1つの翻訳単位へまとめてコンパイルする。
+// C ABIの宣言(poker_engine.h)を先に読み込み、各ステップの定義と突き合わせる。
+#include "poker_engine.h"
+
+#include "step1_card_system_advanced.cpp"
+#include "step2_3_perfect_evaluator.cpp"
+#include "step4_5_optimized_monte_carlo.cpp"
+#include "step6_7_cfr_engine_complete.cpp"
+#include "step8_mcts_complete.cpp"
+#include "step9_eqr_complete.cpp"
+#include "step44_eqr_model.cpp"
+#include "step45_eqr_calibration.cpp"
+#include "step46_range_parser.cpp"
+#include "step47_range.cpp"
+#include "step48_board_features.cpp"
+#include "step49_outs.cpp"
+#include "step50_hud_stats.cpp"
+#include "step51_hh_import.cpp"
+#include "step52_hand_store.cpp"
+#include "step53_hand_query.cpp"
+#include "step54_allin_ev.cpp"
+#include "step55_decision_audit.cpp"
+#include "step56_aggregate_cube.cpp"
+#include "step57_performance_stream.cpp"
+#include "step58_card_recognizer.cpp"
+#include "step59_frame_gate.cpp"
+#include "step60_capture_pipeline.cpp"
+#include "step61_amount_recognizer.cpp"
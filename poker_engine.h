@@ -0,0 +1,628 @@
+/* poker_engine.h
+ * poker_engine.so の C ABI 宣言
+ * Python側 (ctypes / step43拡張モジュール) とC++ツールはこの境界のみを使う。
+ * カードIDは 0-51 (suit*13 + rank)。
+ */
+#ifndef POKER_ENGINE_H
+#define POKER_ENGINE_H
+
+#include <stdint.h>
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* step48: ボード特徴量 */
+typedef struct {
+    uint8_t card_count;
+    uint8_t paired;          /* 同ランク2枚以上 */
+    uint8_t trips;           /* 同ランク3枚以上 */
+    uint8_t high_cards;      /* T以上の枚数 */
+    uint8_t max_suit;        /* 最多スートの枚数 */
+    uint8_t flush_class;     /* 0=レインボー, 1=フラッシュドロー, 2=フラッシュ可能 */
+    uint8_t straight_class;  /* 0=なし, 1=ガットショット, 2=ドロー, 3=ストレート可能 */
+    uint8_t texture;         /* 0=DRY, 1=SEMI_WET, 2=WET, 3=ULTRA_WET (step16) */
+    uint8_t eqr_texture;     /* EQR用 0-2 */
+    float connectivity;      /* 0-1 */
+    float eqr_factor;        /* step16のテクスチャEQR係数 */
+    uint64_t danger_cards;   /* 次のストリートで危険なカード (bit = カードID) */
+} PokerBoardFeatures;
+
+/* step49: アウツ分析（配列はカードID順） */
+typedef struct {
+    uint64_t outs;                  /* アウツ (bit = カードID) */
+    uint64_t clean_outs;            /* 相手レンジに上回られないアウツ */
+    uint64_t nut_outs;              /* ナッツになるアウツ */
+    uint8_t category[52];           /* 改善後の役 (0=アウツではない, 1=ワンペア .. 8=ストレートフラッシュ) */
+    uint8_t next_street_outs[52];   /* フロップのみ: そのカードの後のリバーのアウツ数 */
+    float villain_better[52];       /* 改善後に上回る相手コンボの重み付き割合 */
+    int32_t counts[9];              /* 改善後の役ごとのアウツ数 */
+} PokerOutsReport;
+
+/* step50: HUD統計ストアのイベント（step13のrecord_*に対応） */
+typedef struct {
+    uint32_t player;      /* hud_stats_player_idの番号 */
+    uint8_t kind;         /* 0=preflop, 1=postflop, 2=cbet, 3=faced_cbet, 4=showdown, 5=timing */
+    uint8_t position;     /* 0-5 (UTG, MP, CO, BTN, SB, BB) */
+    uint8_t street;       /* 0=preflop .. 3=river */
+    uint8_t action;       /* 0=fold, 1=check, 2=call, 3=bet, 4=raise */
+    uint8_t flag;         /* preflop: レイズに直面, cbet: 実行, faced_cbet: フォールド, showdown: 勝利 */
+    uint8_t reserved[3];
+    float value;          /* postflop: ベット額/ポット, timing: 秒 */
+} PokerHudEvent;
+
+typedef struct {
+    uint32_t hands;
+    int32_t player_type;          /* step13 PlayerType順 0=UNKNOWN, TAG, LAG, ROCK, FISH, MANIAC, NIT */
+    float vpip, pfr, threeb;
+    float af, agg_freq;
+    float cbet[3];                /* flop, turn, river */
+    float fold_to_cbet[3];
+    float wtsd, wssd;
+    float avg_bet_size;           /* ポット比 */
+    float fast_ratio;             /* 2秒未満のアクションの割合 */
+    float vpip_by_position[6];
+} PokerHudSummary;
+
+/* step51: ハンド履歴取り込みの結果 */
+typedef struct {
+    uint64_t files;
+    uint64_t bytes;
+    uint64_t hands;          /* パースできたハンド数 */
+    uint64_t errors;         /* パースできなかったハンド数 */
+    uint64_t history_rows;   /* 履歴DBに追加したハンド数（ヒーローの参加ハンドのみ） */
+    uint64_t store_rows;     /* ハンドストア(step52)に追加したハンド数（同上） */
+    double seconds;
+} PokerImportResult;
+
+/* step52: ハンドストアのレコード（ヒーロー視点、金額はセント）
+ * hand_idが0ならストアが (1<<63 | ハンド番号) を採番する。action_offset/action_count/hole_class/texture/boardはストアが設定 */
+typedef struct {
+    uint64_t hand_id;
+    int64_t timestamp;        /* UNIX秒（0なら追加時刻） */
+    uint64_t hole;            /* ホールカード (bit = カードID) */
+    uint64_t board;           /* ボード (bit = カードID) */
+    int64_t pot;
+    int64_t profit;
+    uint64_t action_offset;   /* アクションログ内の位置 */
+    float equity, eqr, ev;
+    uint32_t session;         /* hand_store_sessionの番号 */
+    uint16_t action_count;
+    uint8_t position;         /* 0-5 (UTG, MP, CO, BTN, SB, BB), 255=不明 */
+    uint8_t hole_class;       /* 169クラス (step47), 255=不明 */
+    uint8_t texture;          /* フロップのテクスチャ (step48) 0-3, 255=フロップなし */
+    uint8_t flags;            /* bit0=勝ち, bit1=ショーダウン */
+    uint8_t opponents;
+    uint8_t board_count;
+    uint8_t board_cards[5];   /* 配られた順 */
+    uint8_t pot_type;         /* 0=不明, 1=リンプ, 2=シングルレイズ, 3=3bet, 4=4bet以上 */
+    uint8_t villain;          /* 主な相手のポジション+1 (0=不明) */
+    uint8_t flop_players;     /* フロップを見た人数 (0=フロップなし/不明) */
+    uint8_t villain_cards[2]; /* オールインの相手が見せたカード（255=不明） */
+    uint8_t allin_street;     /* リバー前にオールインになったストリート+1 (0=なし) */
+    uint8_t reserved[1];
+    int32_t big_blind;        /* ステーク（ビッグブラインド、0=不明） */
+    int32_t invested;         /* ヒーローの投入額（返却されたベットを除く） */
+    int32_t rake;             /* potのうちレーキ */
+} PokerStoredHand;
+
+typedef struct {
+    uint8_t street;           /* 0=preflop .. 3=river */
+    uint8_t action;           /* 0=fold, 1=check, 2=call, 3=bet, 4=raise, 5=post */
+    uint8_t all_in;
+    uint8_t reserved;
+    int32_t amount;           /* セント */
+    int32_t pot_before;
+    int32_t to_call;          /* このアクションの直前にコールに必要だった額 */
+    int32_t stack;            /* このアクションの直前の有効スタック (0=不明) */
+} PokerStoredAction;
+
+/* 検索条件。各項目は指定しなければ全件（0 / -1） */
+typedef struct {
+    int64_t session;          /* -1=全て */
+    uint32_t position_mask;   /* bit=ポジション(0-5), bit6=不明 */
+    uint32_t texture_mask;    /* bit=テクスチャ(0-3), bit4=フロップなし */
+    uint64_t class_mask[3];   /* 169クラスのビット集合 */
+    int64_t min_pot;
+    int64_t start_time;       /* UNIX秒、end_timeは含まない */
+    int64_t end_time;
+    int32_t won;              /* -1=全て, 0, 1 */
+    int32_t showdown;         /* -1=全て, 0, 1 */
+} PokerHandQuery;
+
+/* ポジション別集計（添字6はポジション不明） */
+typedef struct {
+    uint64_t hands;
+    uint64_t won;
+    int64_t profit;
+    double equity_sum;
+} PokerPositionStats;
+
+/* step53: 条件式検索の集計（1グループ分） */
+typedef struct {
+    uint64_t hands;
+    uint64_t won;
+    uint64_t showdown;
+    int64_t profit;
+    double equity_sum;
+} PokerQueryGroup;
+
+/* step54: オールインEVの結果（ハンドストアのハンド番号と同じ順の列、金額はセント） */
+typedef struct {
+    uint64_t hand_id;
+    int64_t ev_profit;        /* オールイン時のエクイティで調整した収支（対象外は実際の収支） */
+    int64_t luck;             /* 実際の収支 - ev_profit */
+    float equity;             /* オールイン時点のエクイティ */
+    uint8_t status;           /* 0=対象外, 1=計算済み, 2=判定不能（マルチウェイ・相手のカード不明） */
+    uint8_t street;           /* オールインになったストリート 0-2（対象外は255） */
+    uint8_t reserved[2];
+    float street_equity[4];   /* 各ストリートのボードが配られた時点のエクイティ（リバーは結果） */
+    int32_t street_luck[4];   /* そのストリートで配られたカードによるEVの変動 */
+    int32_t ev_loss[4];       /* そのストリートで相手のハンドに対して不利なまま投入したチップの期待損失 */
+} PokerAllInResult;
+
+typedef struct {
+    uint64_t hands;
+    uint64_t allin_hands;     /* 計算できたオールイン */
+    uint64_t skipped;         /* 判定不能のオールイン */
+    int64_t profit;
+    int64_t ev_profit;
+    int64_t luck;
+    int64_t street_luck[4];
+    int64_t ev_loss[4];
+    double allin_equity_sum;
+} PokerAllInSummary;
+
+/* step55: 判断の監査（ヒーローの1アクション分、金額はセント） */
+typedef struct {
+    uint64_t hand_id;
+    uint32_t hand_index;      /* ハンドストアのハンド番号 */
+    uint16_t action_index;    /* そのハンドのアクション列での位置 */
+    uint8_t street;
+    uint8_t action;           /* 実際のアクション 0=fold, 1=check, 2=call, 3=bet, 4=raise */
+    uint8_t best_action;      /* EV最大のアクション */
+    uint8_t reserved[3];
+    float equity;             /* 想定レンジに対するエクイティ */
+    float realized;           /* EQRを掛けた実現エクイティ */
+    int32_t pot;              /* 判断時のポット */
+    int32_t to_call;
+    int32_t amount;           /* 実際の投入額 */
+    int32_t best_amount;      /* EV最大のアクションの投入額 */
+    int32_t ev_actual;
+    int32_t ev_best;
+    int32_t ev_loss;          /* ev_best - ev_actual */
+} PokerAuditDecision;
+
+typedef struct {
+    uint64_t decisions;
+    uint64_t mistakes;        /* 損失がポット(+コール額)の5%以上 */
+    int64_t ev_loss;
+    uint64_t recommended[5];  /* EV最大のアクション別の件数 */
+} PokerAuditCell;
+
+typedef struct {
+    uint64_t hands;           /* 判断を1つ以上監査したハンド */
+    uint64_t decisions;
+    uint64_t mistakes;
+    int64_t ev_loss;
+    uint64_t groups;          /* 共有計算の単位（ボード、プリフロップは169クラス）の数 */
+    PokerAuditCell cells[4][5];   /* [ストリート][実際のアクション] */
+} PokerAuditSummary;
+
+/* step56: 集計キューブに入れる1ハンド分の事実（金額はセント） */
+typedef struct {
+    int64_t timestamp;        /* UNIX秒（日付バケットに丸める） */
+    int64_t profit;
+    uint32_t session;
+    int32_t big_blind;        /* ステーク（0=不明） */
+    uint8_t position;         /* 0-5, 255=不明 */
+    uint8_t hole_class;       /* 0-168, 255=不明 */
+    uint8_t won;
+    uint8_t reserved[5];
+} PokerCubeFact;
+
+typedef struct {
+    uint64_t count;
+    uint64_t won;
+    int64_t sum;              /* 収支の合計 */
+    int64_t min;              /* count=0なら0 */
+    int64_t max;
+    double sum_sq;            /* 収支の二乗和 */
+} PokerCubeCell;
+
+/* 各次元の絞り込み（-1=全て） */
+typedef struct {
+    int64_t session;
+    int32_t position;         /* 0-5, 6=不明 */
+    int32_t hole_class;       /* 0-168, 169=不明 */
+    int64_t big_blind;        /* 0=不明 */
+    int64_t start_time;       /* UNIX秒、日付バケット単位に丸める（0=制限なし） */
+    int64_t end_time;         /* 含まない（end_timeの1秒前を含む日まで） */
+} PokerCubeQuery;
+
+/* step57: 収支の逐次集計（金額は呼び出し側の単位） */
+typedef struct {
+    uint64_t hands;
+    double total;                     /* 収支の合計 */
+    double mean, std_dev, min, max;   /* 全体（Welford、母標準偏差） */
+    double mean_low, mean_high;       /* 平均の95%信頼区間 */
+    uint32_t rolling_count;           /* 直近window件（満たなければ全件） */
+    uint32_t trend_count;             /* 直近trend_window件 */
+    double rolling_mean, rolling_std, rolling_low, rolling_high;
+    double ewma, ewma_std;            /* 指数移動平均と指数加重標準偏差 */
+    double slope, intercept, r_squared, p_value;   /* 直近trend_window件の線形回帰 */
+    double trend_mean, trend_std;     /* 同じ窓の平均・母標準偏差 */
+    int64_t streak;                   /* >0 連勝中, <0 連敗中 */
+    uint64_t max_win_streak, max_lose_streak;
+} PokerPerformanceState;
+
+/* step58: 画面キャプチャの画像（8bit、channels=1:グレー, 3:BGR, 4:BGRA。strideはバイト数） */
+typedef struct {
+    const uint8_t* pixels;
+    int32_t width;
+    int32_t height;
+    int32_t stride;
+    int32_t channels;
+} PokerImageView;
+
+/* 画像内の矩形（ピクセル） */
+typedef struct {
+    int32_t x, y, width, height;
+} PokerImageBox;
+
+/* カード画像内のランク・スートの位置（カードの幅・高さに対する比率 x0, y0, x1, y1） */
+typedef struct {
+    float rank_box[4];
+    float suit_box[4];
+} PokerCardLayout;
+
+/* カード認識の結果 */
+typedef struct {
+    int32_t card;             /* 0-51、認識できなければ-1 */
+    float confidence;         /* 0-1（ランクとスートの低い方） */
+    float rank_score;         /* 最も近いテンプレートとの類似度（-1〜1） */
+    float suit_score;
+    int8_t rank;              /* 0-12、-1=不明 */
+    int8_t suit;              /* 0-3、-1=不明 */
+    uint8_t reserved[6];
+} PokerCardMatch;
+
+/* step60: キャプチャパイプラインの抽出・再検出の依頼 */
+typedef struct {
+    int32_t kind;             /* 0=抽出, 1=再検出（フレーム全体） */
+    int32_t table;            /* テーブル番号（再検出は-1） */
+    uint32_t generation;      /* set_tablesの世代 */
+    uint32_t buffer;          /* 画像のバッファ（capture_pipeline_bufferで読み、releaseで返す） */
+    uint64_t sequence;        /* フレームの通し番号 */
+    uint64_t regions;         /* 変化した領域のビット（処理待ちの間に捨てたフレームの分も含む） */
+    int64_t grabbed_ns;       /* 取り込んだ時刻（steady_clock） */
+    PokerImageBox box;        /* バッファのフレーム上の位置 */
+} PokerCaptureJob;
+
+/* 分析の依頼（テーブルごとに最新の状態のみ） */
+typedef struct {
+    int32_t table;
+    uint32_t generation;
+    int32_t hero_to_act;
+    int32_t reserved;
+    uint64_t sequence;
+    int64_t grabbed_ns;
+    double latency_ms;        /* 取り込みから分析の取り出しまで */
+} PokerCaptureAnalysis;
+
+typedef struct {
+    uint64_t frames, unchanged, dropped, superseded;
+    uint64_t extract_jobs, layout_jobs, analyses, urgent_analyses;
+    double mean_latency_ms, max_latency_ms;
+    double urgent_mean_latency_ms, urgent_max_latency_ms;   /* ヒーローの手番のテーブル */
+    uint32_t tables;
+    uint32_t buffers_in_use;
+    uint64_t buffer_bytes;    /* バッファのプールが確保している画素の総量 */
+} PokerCaptureStats;
+
+/* step61: 金額の認識結果 */
+typedef struct {
+    double value;             /* K/Mの倍率を掛けた金額（validが0なら0） */
+    float confidence;         /* 0-1（文字ごとの確信度の最小） */
+    int16_t glyphs;           /* 読んだ文字数 */
+    int8_t valid;             /* 1=金額として解釈できた */
+    int8_t reserved;
+    char text[24];            /* 読んだ文字列（識別できない文字は'?'） */
+} PokerAmountMatch;
+
+/* step1: カードシステム */
+uint8_t create_card_c(int rank, int suit);
+int get_rank_c(uint8_t card);
+int get_suit_c(uint8_t card);
+
+/* step2_3: ハンド評価 */
+/* 評価値 = (役 << 20) | 比較用ランク5ニブル（上位ニブルほど優先）。大きいほど強い。
+   役は0=ハイカード .. 8=ストレートフラッシュ。旧版の(役 << 12)とは互換性がない */
+uint32_t evaluate_7cards_perfect(const uint8_t cards[7]);
+void evaluate_7cards_batch(const uint8_t* cards, int count, uint32_t* out);
+uint32_t evaluate_cards(const uint8_t* cards, int count);   /* 5-7枚（重複なし）。範囲外なら0 */
+
+/* step4_5: モンテカルロ・エクイティ */
+float calculate_equity_optimized(uint8_t h1, uint8_t h2,
+                                 const uint8_t* board, int board_count,
+                                 int opponents, int iterations);
+/* threads: 使うスレッド数（0 = hardware_concurrency） */
+void calculate_equity_batch(const uint8_t* hands, int count,          /* hands[count*2] → out[count] */
+                            const uint8_t* board, int board_count,
+                            int opponents, int iterations, int threads, float* out);
+float calculate_equity_threads(uint8_t h1, uint8_t h2,
+                               const uint8_t* board, int board_count,
+                               int opponents, int iterations, int threads);
+
+/* step6_7: CFRソルバー（create_cfr_solverはクーン・ポーカー） */
+void* create_cfr_solver(void);
+void* create_cfr_solver_game(int game);      /* 0=クーン・ポーカー, 1=レデュック・ホールデム。不正ならNULL */
+void destroy_cfr_solver(void* solver);
+void cfr_train(void* solver, int iterations);
+double cfr_exploitability(void* solver);   /* 平均戦略の最適反応による値（チップ/ゲーム）。学習前は0 */
+int cfr_info_set_count(void* solver);
+
+/* step8: MCTS */
+void* create_mcts_search(const int32_t* legal_actions, int count, uint64_t seed);   /* seed=0なら乱数。合法手が無ければNULL */
+void destroy_mcts_search(void* search);
+void mcts_search(void* search, int iterations);
+int mcts_best_action(void* search);          /* 未探索なら-1 */
+
+/* step9: EQR */
+double calculate_eqr_advanced(double raw_equity, int position,
+                              double stack, double pot,
+                              int board_texture, int opponents,
+                              bool in_position, double opponent_skill);
+/* SoA入力のバッチEQR。out_* は全ファクター列 (入力と重ならないこと) */
+void calculate_eqr_batch(int count,
+                         const double* raw_equity, const int32_t* position,
+                         const double* stack, const double* pot,
+                         const int32_t* board_texture, const int32_t* opponents,
+                         const uint8_t* in_position, const double* opponent_skill,
+                         double* out_eqr, double* out_position_factor,
+                         double* out_stack_factor, double* out_board_factor,
+                         double* out_multiway_factor, double* out_skill_factor);
+
+/* step44: キャリブレーション済みEQRモデル (mmap, ホットリロード) */
+void* eqr_model_open(const char* path);
+void eqr_model_close(void* handle);
+int eqr_model_reload(void* handle);
+uint64_t eqr_model_version(void* handle);
+double eqr_model_calculate(void* handle,
+                           double raw_equity, int position, double stack, double pot,
+                           int board_texture, int opponents, bool in_position,
+                           int street, double opponent_skill);
+void eqr_model_calculate_batch(void* handle, int count,
+                               const double* raw_equity, const int32_t* position,
+                               const double* stack, const double* pot,
+                               const int32_t* board_texture, const int32_t* opponents,
+                               const uint8_t* in_position, const int32_t* street,
+                               const double* opponent_skill, double* out_eqr);
+int eqr_model_write_builtin(const char* path, uint64_t model_version);
+
+/* step45: EQRキャリブレーション (source_kind: 0=ソルバーCSV, 1=ハンド履歴SQLite)
+ * 戻り値は使用したサンプル数、失敗時-1 */
+int64_t eqr_calibrate(int source_kind, const char* input_path, const char* output_path,
+                      const char* prior_path, double prior_strength, int threads,
+                      double default_spr, uint64_t model_version);
+
+/* step46: カード・ボード・レンジ文字列の解析
+ * コンボ番号 = 2枚のcolex順位 (low + high*(high-1)/2, 0..1325) */
+int parse_card_string(const char* text);
+int parse_cards_string(const char* text, uint8_t* out, int max_cards);
+int parse_range_string(const char* text, float* out_weights);
+int parse_range_batch(int count, const char* const* texts,
+                      float* out_weights, int32_t* out_combos);
+const char* range_parse_error(void);
+int combo_index_c(uint8_t card1, uint8_t card2);
+void combo_cards_c(int index, uint8_t* out);
+
+/* step47: レンジ（1326コンボの重み配列）の演算。outは入力と同じ配列でもよい */
+void range_union(const float* a, const float* b, float* out);
+void range_intersect(const float* a, const float* b, float* out);
+void range_scale(float* weights, float factor);
+double range_normalize(float* weights);
+void range_remove_cards(float* weights, const uint8_t* dead, int dead_count);
+void range_to_classes(const float* weights, float* out, int frequencies);
+double range_combo_count(const float* weights);
+
+/* step48: 戻り値は正規ボード番号（3-5枚以外は-1） */
+int32_t board_features_c(const uint8_t* board, int count, PokerBoardFeatures* out);
+void board_texture_batch(int count, const uint8_t* boards, int cards_per_board,
+                         int32_t* out_texture);
+
+/* step49: boardは3-4枚。villain_weightsはNULLなら全コンボ均等。戻り値はアウツ枚数（不正な入力は-1） */
+int outs_analyze(uint8_t h1, uint8_t h2, const uint8_t* board, int board_count,
+                 const float* villain_weights, PokerOutsReport* out);
+/* out_masks: 1326要素, out_category_counts: 9要素（レンジ重み付き平均）。戻り値 0=成功, -1=不正なボード */
+int outs_analyze_range(const float* hero_weights, const uint8_t* board, int board_count,
+                       uint64_t* out_masks, double* out_category_counts);
+
+/* step50: HUD統計ストア（列指向）。ハンドルはhud_stats_destroyで解放 */
+void* hud_stats_create(void);
+void* hud_stats_open(const char* path);          /* mmapで開く。失敗時NULL */
+void hud_stats_destroy(void* handle);
+int hud_stats_save(void* handle, const char* path);
+void* hud_stats_snapshot(void* handle);          /* 現時点の複製 */
+uint32_t hud_stats_player_id(void* handle, const char* name);   /* 未登録なら追加 */
+int64_t hud_stats_find(void* handle, const char* name);         /* 未登録なら-1 */
+uint32_t hud_stats_player_count(void* handle);
+void hud_stats_apply(void* handle, const PokerHudEvent* events, int count);
+int hud_stats_summary(void* handle, uint32_t player, PokerHudSummary* out);
+void hud_stats_summaries(void* handle, const uint32_t* players, int count, PokerHudSummary* out);
+/* out: 23カウンタの合計。playersがNULLなら全プレイヤー。maskはbit=ポジション/ストリート */
+void hud_stats_aggregate(void* handle, const uint32_t* players, int count,
+                         uint32_t position_mask, uint32_t street_mask, uint64_t* out);
+
+/* step51: PokerStars形式のハンド履歴を並列に取り込み、統計ストア(step50)・履歴DB(step33)・
+ * ハンドストア(step52)へ書き込む。stats_handle / history_path / store_handle はNULL可。
+ * threads=0はCPU数。戻り値はハンド数（失敗時-1） */
+int64_t hh_import(const char* const* paths, int path_count, void* stats_handle,
+                  const char* history_path, void* store_handle, int threads,
+                  PokerImportResult* out);
+
+/* step52: 追記型ハンドストア（path.hands / path.actions / path.sessions）。
+ * 追加はバックグラウンドでまとめて書き込み、書き込み後に検索対象になる */
+void* hand_store_open(const char* path, int read_only, int sync);   /* 失敗時NULL */
+void hand_store_close(void* handle);                                 /* 未書き込み分を書いてから閉じる */
+int64_t hand_store_session(void* handle, const char* name);          /* 未登録なら追加。読み取り専用で未登録なら-1 */
+const char* hand_store_session_name(void* handle, uint32_t session); /* 未登録ならNULL */
+/* 戻り値はハンド番号（追加順）。同じhand_idが既にあればその番号、失敗時-1 */
+int64_t hand_store_append(void* handle, const PokerStoredHand* hand,
+                          const PokerStoredAction* actions, int action_count);
+int hand_store_flush(void* handle);                  /* 追加済みの全ハンドの書き込みを待つ。0=成功 */
+int64_t hand_store_refresh(void* handle);            /* 読み取り専用: 他プロセスの追記を反映。戻り値はハンド数 */
+uint64_t hand_store_count(void* handle);             /* 検索可能なハンド数 */
+int64_t hand_store_find(void* handle, uint64_t hand_id);   /* 未登録なら-1 */
+/* 戻り値はアクション数（actionsにはcapacityまで書く）。範囲外は-1 */
+int hand_store_get(void* handle, uint64_t index, PokerStoredHand* out,
+                   PokerStoredAction* actions, int capacity);
+/* 条件に合うハンド番号を昇順にoutへ（capacityまで）。戻り値は該当総数 */
+int64_t hand_store_query(void* handle, const PokerHandQuery* query, uint32_t* out, int64_t capacity);
+/* out: 7要素 */
+void hand_store_position_stats(void* handle, const PokerHandQuery* query, PokerPositionStats* out);
+
+/* step53: ハンドストアのビットマップ索引と条件式検索。例:
+ *   position=BTN,CO & pot=3bet & flop=monotone & (made=trips,two_pair | draw=flush) & !result=lost
+ *   hole="QQ+, AKs" & villain=BB & pot_size>=20
+ * 索引は検索のたびにストアの追加分だけ更新する。ストアはこのハンドルより後に閉じること */
+void* hand_query_open(void* store_handle);
+void hand_query_close(void* handle);
+/* 該当するハンド番号を昇順にoutへ（capacityまで）。戻り値は該当総数（構文エラーは-1） */
+int64_t hand_query_select(void* handle, const char* expression, uint32_t* out, int64_t capacity);
+/* group_by: 0=なし, 1=ポジション, 2=相手のポジション, 3=ポットの種類, 4=169クラス, 5=フロップのテクスチャ, 6=フロップでの役。
+ * outはhand_query_group_size(group_by)要素。戻り値はグループ数（エラーは-1） */
+int hand_query_aggregate(void* handle, const char* expression, int group_by, PokerQueryGroup* out);
+int hand_query_group_size(int group_by);
+uint64_t hand_query_index_bytes(void* handle);
+const char* hand_query_error(void);
+
+/* step54: オールインEVの夜間バッチ。結果はstoreのパス + ".allin" に追記する。
+ * 書き込み側は1プロセスだけ（読み取り専用で開けば他プロセスの結果を参照できる）。
+ * 失敗時NULL（理由はallin_ev_error）。ストアはこのハンドルより後に閉じること */
+void* allin_ev_open(void* store_handle, int read_only);
+void allin_ev_close(void* handle);
+/* 未処理のハンドを評価して追記する（threads=0はCPU数）。戻り値は今回処理した件数、失敗時-1。
+ * 読み取り専用では他プロセスの追記を反映し、新しく見えた件数を返す */
+int64_t allin_ev_update(void* handle, int threads);
+uint64_t allin_ev_count(void* handle);               /* 処理済みのハンド数 */
+int allin_ev_get(void* handle, uint64_t index, PokerAllInResult* out);   /* 0=成功, -1=未処理 */
+/* 処理済みのハンドのうちqueryに合うものの合計（query=NULLは全件） */
+void allin_ev_summary(void* handle, const PokerHandQuery* query, PokerAllInSummary* out);
+const char* allin_ev_error(void);
+
+/* step55: ヒーローの全ての判断を想定レンジ・EQRで評価し、EV最大のアクションとの差を集計する
+ * eqr_modelはstep44のハンドル（NULLならstep9の組み込みEQR）。queryがNULLなら全件。
+ * worstには損失の大きい順にcapacity件まで書く。戻り値は書いた件数 */
+int64_t decision_audit(void* store_handle, void* eqr_model, const PokerHandQuery* query,
+                       int threads, PokerAuditDecision* worst, int64_t capacity,
+                       PokerAuditSummary* out);
+
+
+/* step56: セッション × ポジション × ステーク × 日付 × ハンドクラスの集計キューブ
+ * 次元の全ての組み合わせ(32通り)の小計を追加時に更新するので、集計は表引き1回。
+ * utc_offsetは日付の区切り（UTCからの秒）。保存ファイルは最も細かいセルのみ */
+void* aggregate_cube_create(int32_t utc_offset);
+void* aggregate_cube_open(const char* path);      /* 失敗時NULL（理由はaggregate_cube_error） */
+void aggregate_cube_close(void* handle);
+int aggregate_cube_save(void* handle, const char* path);   /* 0=成功, -1=失敗 */
+void aggregate_cube_add(void* handle, const PokerCubeFact* facts, int64_t count);
+/* ハンドストアのうち前回以降に追加されたハンドを取り込む。戻り値は取り込んだ件数（-1=失敗） */
+int64_t aggregate_cube_sync(void* handle, void* store_handle);
+uint64_t aggregate_cube_count(void* handle);      /* 取り込んだハンド数 */
+void aggregate_cube_rollup(void* handle, const PokerCubeQuery* query, PokerCubeCell* out);
+/* dimension: 0=セッション, 1=ポジション, 2=ステーク, 3=日付（その日の0時のUNIX秒）, 4=ハンドクラス
+ * ステークは1023種まで登録し、それ以降の新しいステークはまとめてキー-1になる（big_blindでは絞り込めない）
+ * keysとcellsにはキーの昇順でcapacity件まで書く。戻り値はグループの総数（-1=不正な次元） */
+int64_t aggregate_cube_group(void* handle, const PokerCubeQuery* query, int dimension,
+                             int64_t* keys, PokerCubeCell* cells, int64_t capacity);
+const char* aggregate_cube_error(void);
+
+/* step57: 1ハンドごとO(1)で更新する移動平均・分散・EWMA・トレンド・連勝連敗 */
+void* performance_stream_create(uint32_t window, uint32_t trend_window, double ewma_alpha);
+void performance_stream_destroy(void* handle);
+/* wonがNULLならprofit > 0を勝ちとする */
+void performance_stream_push(void* handle, const double* profits, const uint8_t* won, int64_t count);
+uint64_t performance_stream_count(void* handle);
+void performance_stream_state(void* handle, PokerPerformanceState* out);
+/* 全履歴の移動平均（窓に満たない先頭は先頭からの平均）。window=0はcreate時の窓。
+ * outにはcapacity件まで書き、戻り値はハンド数 */
+int64_t performance_stream_rolling(void* handle, uint32_t window, double* out, int64_t capacity);
+/* パーセンタイル q[i] (0-100) を線形補間で求める（numpy.percentileと同じ） */
+void performance_stream_percentiles(void* handle, const double* q, int count, double* out);
+
+/* step58: テーブルのスキンごとに学習したランク・スートのテンプレートでカードを認識する
+ * layoutがNULL、または領域が全て0なら既定の配置（左上の角にランク、その下にスート） */
+void* card_recognizer_create(const PokerCardLayout* layout);
+void* card_recognizer_open(const char* path);     /* 失敗時NULL（理由はcard_recognizer_error） */
+void card_recognizer_close(void* handle);
+int card_recognizer_save(void* handle, const char* path);   /* 0=成功, -1=失敗 */
+/* ラベル付きのカード画像（boxがNULLなら画像全体）をテンプレートに加える。0=成功, -1=失敗 */
+int card_recognizer_learn(void* handle, const PokerImageView* image, const PokerImageBox* box, int card);
+/* 1フレーム内のcount枚のカードを認識する。method: 0=正規化相互相関, 1=ハッシュのハミング距離。
+ * 戻り値は認識できた枚数 */
+int64_t card_recognizer_match(void* handle, const PokerImageView* image, const PokerImageBox* boxes,
+                              int64_t count, int method, PokerCardMatch* out);
+/* 学習済みのサンプル数: ranksは13要素、suitsは4要素 */
+void card_recognizer_samples(void* handle, uint32_t* ranks, uint32_t* suits);
+const char* card_recognizer_error(void);
+
+/* step59: 注目領域ごとのタイル化した知覚ハッシュで、変化の無いキャプチャフレームを読み飛ばす
+ * hash_threshold: 平均ハッシュのハミング距離、cell_threshold: 8x8縮小のマスの輝度の差（これを超えたら変化） */
+void* frame_gate_create(int hash_threshold, int cell_threshold);
+void frame_gate_destroy(void* handle);
+/* boxはフレーム上の座標、tile_sizeは8-256ピクセル。戻り値は領域の番号（-1=空の矩形） */
+int frame_gate_add_region(void* handle, const PokerImageBox* box, int tile_size);
+void frame_gate_clear(void* handle);             /* 全ての領域を削除 */
+void frame_gate_reset(void* handle);             /* 次のupdateで全ての領域を変化ありとする */
+int frame_gate_region_count(void* handle);
+/* changed_tilesには領域ごとの変化したタイル数を書く（NULL可）。戻り値は変化した領域の数（-1=不正な画像） */
+int frame_gate_update(void* handle, const PokerImageView* frame, int32_t* changed_tiles);
+
+/* step60: 複数テーブルのキャプチャパイプライン（取り込み→抽出→分析の段の間の受け渡し）
+ * redetect_interval_ms: テーブルの再検出の間隔、layout_threshold: テーブル全体のタイルのこの割合が
+ * 一度に変わったら再検出する */
+void* capture_pipeline_create(int redetect_interval_ms, double layout_threshold);
+void capture_pipeline_destroy(void* handle);
+/* テーブル構成を置き換える（最大64テーブル、1テーブル48領域）。regionsはテーブルごとにregion_counts[i]個
+ * 並べたフレーム上の座標。戻り値は新しい世代（-1=不正な引数） */
+int capture_pipeline_set_tables(void* handle, const PokerImageBox* tables, int count,
+                                const PokerImageBox* regions, const int32_t* region_counts);
+/* 取り込み段（1スレッドから呼ぶ）。戻り値は抽出・再検出の依頼数（-1=不正な画像） */
+int capture_pipeline_submit(void* handle, const PokerImageView* frame);
+/* 1=取り出した, 0=timeout_ms以内に無かった, -1=停止済み */
+int capture_pipeline_next_job(void* handle, int timeout_ms, PokerCaptureJob* out);
+int capture_pipeline_buffer(void* handle, uint32_t buffer, PokerImageView* out);
+void capture_pipeline_release(void* handle, uint32_t buffer);
+/* 抽出の完了（バッファのreleaseとは別）。hero_to_act: 1=手番, 0=手番でない, -1=不明。
+ * changed=1なら分析待ちにする */
+void capture_pipeline_complete(void* handle, const PokerCaptureJob* job, int hero_to_act, int changed);
+int capture_pipeline_next_analysis(void* handle, int timeout_ms, PokerCaptureAnalysis* out);
+void capture_pipeline_stop(void* handle);        /* 待っているワーカーを全て起こす */
+void capture_pipeline_stats(void* handle, PokerCaptureStats* out);
+
+/* step61: スキンごとに学習した文字のテンプレートで金額（ポット・ベット・スタック）を読む
+ * 文字は0-9, $, K, M（'.'と','は形ではなく大きさと位置で判定する） */
+void* amount_recognizer_create(void);
+void* amount_recognizer_open(const char* path);   /* 失敗時NULL（理由はamount_recognizer_error） */
+void amount_recognizer_close(void* handle);
+int amount_recognizer_save(void* handle, const char* path);   /* 0=成功, -1=失敗 */
+/* ラベル付きの金額の画像（boxがNULLなら画像全体、textは画面の表記どおり "$1,250.50" など）を
+ * テンプレートに加える。分割した文字数がラベルと合わなければ-1 */
+int amount_recognizer_learn(void* handle, const PokerImageView* image, const PokerImageBox* box,
+                            const char* text);
+/* 1フレーム内のcount個の金額を読む。戻り値は金額として解釈できた数 */
+int64_t amount_recognizer_read(void* handle, const PokerImageView* image, const PokerImageBox* boxes,
+                               int64_t count, PokerAmountMatch* out);
+/* 学習済みのサンプル数（"0123456789$KM"の順に13要素） */
+void amount_recognizer_samples(void* handle, uint32_t* counts);
+const char* amount_recognizer_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POKER_ENGINE_H */
@@ -0,0 +1,109 @@
+// sampler_check.cpp
+// カードの乱択サンプリング(step1)の回帰チェック（ctestから実行する）
+//   sampler_check
+// 1. sample_cards: liveからちょうどk枚を引き、全てliveに含まれること
+// 2. sample_cards: 45枚から2枚の全990通りがカイ二乗検定で一様であること
+// 3. sample_cards: 47枚から5枚を引いた時の各カードの出現数が一様であること
+// 4. Deck::shuffle: 位置ごとのカードの分布（52x52）が一様であること
+// シードは固定なので結果は毎回同じ。閾値は期待値 + 自由度の標準偏差の5倍。外れれば終了コード1を返す。
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#include "step1_card_system_advanced.cpp"
+
+namespace {
+
+using namespace PokerCore;
+
+constexpr CardMask FULL_DECK = (1ULL << DECK_SIZE) - 1;
+
+struct Xorshift64 {
+    uint64_t state;
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+// 観測数のカイ二乗値が一様分布の期待値から外れていないか
+bool uniform(const char* name, const std::vector<uint64_t>& observed, double expected) {
+    double chi2 = 0.0;
+    for (uint64_t o : observed) chi2 += (double(o) - expected) * (double(o) - expected) / expected;
+    const double dof = double(observed.size() - 1);
+    const double limit = dof + 5.0 * std::sqrt(2.0 * dof);
+    bool ok = chi2 <= limit;
+    std::printf("%-12s %s (chi2 %.1f, dof %.0f, limit %.1f)\n", name, ok ? "ok" : "FAILED", chi2, dof, limit);
+    return ok;
+}
+
+bool check_exact() {
+    Xorshift64 rng{xorshift_seed(56)};
+    for (int trial = 0; trial < 20000; ++trial) {
+        CardMask live = sample_cards(FULL_DECK, 20 + trial % 33, rng);   // 20-52枚のlive
+        int k = static_cast<int>(rng.next() % static_cast<uint64_t>(count_cards(live) + 1));
+        CardMask drawn = sample_cards(live, k, rng);
+        if (count_cards(drawn) != k || (drawn & ~live) != 0) {
+            std::fprintf(stderr, "sampler_check: drew %d cards outside or beyond k=%d\n", count_cards(drawn), k);
+            std::printf("%-12s FAILED\n", "exact-k");
+            return false;
+        }
+    }
+    std::printf("%-12s ok\n", "exact-k");
+    return true;
+}
+
+// 7枚を除いた45枚から2枚: 全ての組を順位で数える
+bool check_pairs() {
+    const CardMask dead = 0x8000400020001ULL | (1ULL << 7) | (1ULL << 20) | (1ULL << 33);
+    const CardMask live = FULL_DECK & ~dead;
+    const uint64_t combos = binomial(count_cards(live), 2);
+    const uint64_t per_combo = 300;
+    std::vector<uint64_t> counts(combos, 0);
+    Xorshift64 rng{xorshift_seed(1)};
+    for (uint64_t i = 0; i < combos * per_combo; ++i) ++counts[colex_rank_live(sample_cards(live, 2, rng), dead)];
+    return uniform("pairs", counts, double(per_combo));
+}
+
+// 5枚を除いた47枚から5枚（ランアウト）: カードごとの出現数
+bool check_runout() {
+    const CardMask dead = 0x1FULL << 8;
+    const CardMask live = FULL_DECK & ~dead;
+    const uint64_t draws = 400000;
+    std::vector<uint64_t> counts(DECK_SIZE, 0);
+    Xorshift64 rng{xorshift_seed(2)};
+    for (uint64_t i = 0; i < draws; ++i) {
+        for (CardMask m = sample_cards(live, 5, rng); m != 0; m &= m - 1) ++counts[__builtin_ctzll(m)];
+    }
+    std::vector<uint64_t> observed;
+    for (int c = 0; c < DECK_SIZE; ++c) {
+        if (has_card(live, static_cast<Card>(c))) observed.push_back(counts[static_cast<size_t>(c)]);
+    }
+    return uniform("runout", observed, double(draws) * 5.0 / double(count_cards(live)));
+}
+
+bool check_shuffle() {
+    const uint64_t shuffles = 52 * 52 * 40;
+    std::vector<uint64_t> counts(DECK_SIZE * DECK_SIZE, 0);
+    Deck deck;
+    for (uint64_t seed = 0; seed < shuffles; ++seed) {
+        deck.shuffle(seed);
+        for (int position = 0; position < DECK_SIZE; ++position) {
+            ++counts[static_cast<size_t>(position) * DECK_SIZE + deck.deal()];
+        }
+    }
+    return uniform("shuffle", counts, double(shuffles) / DECK_SIZE);
+}
+
+}  // namespace
+
+int main() {
+    bool ok = check_exact();
+    ok = check_pairs() && ok;
+    ok = check_runout() && ok;
+    ok = check_shuffle() && ok;
+    return ok ? 0 : 1;
+}
@@ -1,11 +1,17 @@
 # step10_advanced_bridge.py
 import ctypes
 import numpy as np
-from typing import List, Tuple, Optional
+from typing import Dict, List, Tuple, Optional
 from dataclasses import dataclass
 from functools import lru_cache
 import threading
 
+try:
+    # CPython拡張モジュール（step43）: バッファプロトコルでゼロコピー、GIL解放
+    import poker_engine as _native
+except ImportError:
+    _native = None
+
 @dataclass
 class CardRepresentation:
     """カード表現の統一インターフェース"""
@@ -51,6 +57,7 @@ class OptimizedCppBridge:
         
         # 全C++ライブラリをロード
         self.evaluator = ctypes.CDLL('./poker_engine.so')
+        self.native = _native
         
         # 関数シグネチャの完全定義
         self._setup_function_signatures()
@@ -58,6 +65,9 @@ class OptimizedCppBridge:
         # キャッシュの初期化
         self._equity_cache = {}
         self._eval_cache = {}
+        
+        # キャリブレーション済みEQRモデル（load_eqr_modelで設定）
+        self.eqr_model = None
     
     def _setup_function_signatures(self):
         """全C++関数のシグネチャを設定"""
@@ -95,10 +105,20 @@ class OptimizedCppBridge:
         # CFR
         self.evaluator.create_cfr_solver.restype = ctypes.c_void_p
         self.evaluator.cfr_train.argtypes = [ctypes.c_void_p, ctypes.c_int]
+        
+        # レンジ文字列
+        self.evaluator.parse_range_string.argtypes = [
+            ctypes.c_char_p,
+            ctypes.POINTER(ctypes.c_float)
+        ]
+        self.evaluator.parse_range_string.restype = ctypes.c_int
+        self.evaluator.range_parse_error.restype = ctypes.c_char_p
     
     @lru_cache(maxsize=10000)
     def evaluate_hand_cached(self, cards_tuple: Tuple[int, ...]) -> int:
         """キャッシュ付きハンド評価"""
+        if self.native is not None:
+            return self.native.evaluate(bytes(cards_tuple))[0]
         cards_array = (ctypes.c_uint8 * 7)(*cards_tuple)
         return self.evaluator.evaluate_7cards_perfect(cards_array)
     
@@ -113,6 +133,11 @@ class OptimizedCppBridge:
         if cache_key in self._equity_cache:
             return self._equity_cache[cache_key]
         
+        if self.native is not None:
+            equity = self.native.equity(bytes(hero), bytes(board), opponents, iterations)
+            self._equity_cache[cache_key] = equity
+            return equity
+        
         board_array = (ctypes.c_uint8 * len(board))(*board) if board else None
         
         equity = self.evaluator.calculate_equity_optimized(
@@ -137,6 +162,13 @@ class OptimizedCppBridge:
                                 board: List[int],
                                 opponents: int = 1) -> np.ndarray:
         """バッチエクイティ計算（並列処理対応）"""
+        if self.native is not None:
+            # 1回のネイティブ呼び出しで全ハンドを計算（GIL解放中）
+            hands_array = np.asarray(hands, dtype=np.uint8).reshape(-1)
+            results = np.empty(len(hands), dtype=np.float32)
+            self.native.equity_batch(hands_array, bytes(board), opponents, 50000, out=results)
+            return results
+        
         results = np.zeros(len(hands), dtype=np.float32)
         
         for i, hand in enumerate(hands):
@@ -144,6 +176,90 @@ class OptimizedCppBridge:
         
         return results
     
+    def batch_eqr_calculation(self, raw_equity: np.ndarray, position: np.ndarray,
+                              stack: np.ndarray, pot: np.ndarray,
+                              board_texture: np.ndarray, opponents: np.ndarray,
+                              in_position: np.ndarray,
+                              opponent_skill: np.ndarray,
+                              with_factors: bool = False):
+        """バッチEQR計算（列ごとのnumpy配列を受け取る）
+        
+        with_factors=True の場合は各ファクター列を含む辞書を返す
+        """
+        columns = (
+            np.ascontiguousarray(raw_equity, dtype=np.float64),
+            np.ascontiguousarray(position, dtype=np.int32),
+            np.ascontiguousarray(stack, dtype=np.float64),
+            np.ascontiguousarray(pot, dtype=np.float64),
+            np.ascontiguousarray(board_texture, dtype=np.int32),
+            np.ascontiguousarray(opponents, dtype=np.int32),
+            np.ascontiguousarray(in_position, dtype=np.bool_),
+            np.ascontiguousarray(opponent_skill, dtype=np.float64),
+        )
+        if self.native is not None:
+            if with_factors:
+                names = ('eqr', 'position_factor', 'stack_factor',
+                         'board_factor', 'multiway_factor', 'skill_factor')
+                values = self.native.eqr_batch(*columns, factors=True)
+                return {name: np.asarray(v) for name, v in zip(names, values)}
+            return np.asarray(self.native.eqr_batch(*columns))
+        if with_factors:
+            raise RuntimeError("factor breakdown requires the poker_engine extension module")
+        
+        eq, pos, stk, pt, tex, opp, ip, skill = columns
+        results = np.empty(len(eq), dtype=np.float64)
+        for i in range(len(eq)):
+            results[i] = self.calculate_eqr_complete(
+                float(eq[i]), int(pos[i]), float(stk[i]), float(pt[i]),
+                int(tex[i]), int(opp[i]), bool(ip[i]), float(skill[i])
+            )
+        return results
+    
+    def load_eqr_model(self, path: str):
+        """キャリブレーション済みEQRモデル(step44)を読み込む"""
+        if self.native is None:
+            raise RuntimeError("EQR model requires the poker_engine extension module")
+        self.eqr_model = self.native.EQRModel(path)
+        return self.eqr_model.version()
+    
+    def reload_eqr_model(self) -> bool:
+        """モデルファイルが更新されていれば差し替える（失敗時は現行モデルを維持）"""
+        if self.eqr_model is None:
+            return False
+        try:
+            return self.eqr_model.reload()
+        except OSError:
+            return False
+    
+    def parse_range_weights(self, range_string: str) -> np.ndarray:
+        """レンジ文字列 ("22+, A2s+, AKs:0.5") を1326コンボの重みへ展開"""
+        if self.native is not None:
+            return np.asarray(self.native.parse_range(range_string))
+        
+        weights = np.zeros(1326, dtype=np.float32)
+        result = self.evaluator.parse_range_string(
+            range_string.encode(),
+            weights.ctypes.data_as(ctypes.POINTER(ctypes.c_float))
+        )
+        if result < 0:
+            error = self.evaluator.range_parse_error().decode()
+            raise ValueError(f"invalid range '{range_string}': {error}")
+        return weights
+    
+    def board_features(self, board: List[int]) -> Optional[Dict]:
+        """ボード特徴量（C++の事前計算テーブル）。拡張モジュールが無ければNone"""
+        if self.native is None:
+            return None
+        return self.native.board_features(bytes(board))
+    
+    def calculate_outs(self, hero_cards: List[int], board: List[int],
+                       villain_range: Optional[str] = None) -> Optional[Dict]:
+        """アウツ分析（フロップ/ターン）。villain_rangeはレンジ文字列。拡張モジュールが無ければNone"""
+        if self.native is None:
+            return None
+        villain = self.parse_range_weights(villain_range) if villain_range else None
+        return self.native.outs(bytes(hero_cards), bytes(board), villain)
+    
     def clear_cache(self):
         """キャッシュをクリア"""
         self._equity_cache.clear()
@@ -4,6 +4,19 @@ from typing import Dict, List, Optional
 from collections import deque
 from enum import Enum
 import statistics
+import array
+
+try:
+    # CPython拡張モジュール（step43）: 列指向のHUD統計ストア（step50）
+    import poker_engine as _native
+except ImportError:
+    _native = None
+
+# 統計ストアのイベント番号 (poker_engine.h PokerHudEvent)
+_POSITIONS = {'UTG': 0, 'MP': 1, 'CO': 2, 'BTN': 3, 'SB': 4, 'BB': 5}
+_STREETS = {'preflop': 0, 'flop': 1, 'turn': 2, 'river': 3}
+_ACTIONS = {'fold': 0, 'check': 1, 'call': 2, 'bet': 3, 'raise': 4}
+_EVENT_PREFLOP, _EVENT_POSTFLOP, _EVENT_CBET, _EVENT_FACED_CBET, _EVENT_SHOWDOWN, _EVENT_TIMING = range(6)
 
 class PlayerType(Enum):
     UNKNOWN = "Unknown"
@@ -169,12 +182,28 @@ class AdvancedHUDTracker:
     def __init__(self):
         self.players: Dict[str, AdvancedPlayerStats] = {}
         self.session_hands = 0
+        # ネイティブ統計ストア（あればサマリーはこちらから取得する）
+        self.native_stats = _native.HudStats() if _native is not None else None
+        self._native_ids: Dict[str, int] = {}
+        self._last_position: Dict[str, int] = {}
     
     def get_or_create_player(self, player_id: str) -> AdvancedPlayerStats:
         if player_id not in self.players:
             self.players[player_id] = AdvancedPlayerStats()
+            # イベントがまだ無くてもサマリーを引けるよう、作成時にネイティブIDを登録する
+            if self.native_stats is not None:
+                self._native_ids[player_id] = self.native_stats.player_id(player_id)
         return self.players[player_id]
     
+    def _record_native(self, player_id: str, kind: int, street: int,
+                       action: int = 0, flag: bool = False, value: float = 0.0):
+        """ネイティブストアへイベントを反映（ポジションは直近のプリフロップのもの）"""
+        if self.native_stats is None:
+            return
+        native_id = self._native_ids[player_id]
+        position = self._last_position.get(player_id, 0)
+        self.native_stats.record(native_id, kind, position, street, action, flag, value)
+    
     def record_preflop_action(self, player_id: str, action: str, 
                              position: str, facing_raise: bool = False):
         """プリフロップアクションを記録"""
@@ -197,6 +226,11 @@ class AdvancedHUDTracker:
             stats.threeb_opportunities += 1
             if action == 'raise':
                 stats.threeb_count += 1
+        
+        if position in _POSITIONS:
+            self._last_position[player_id] = _POSITIONS[position]
+        self._record_native(player_id, _EVENT_PREFLOP, 0,
+                            _ACTIONS.get(action, 0), facing_raise)
     
     def record_postflop_action(self, player_id: str, action: str, 
                               street: str, amount: float = 0, 
@@ -216,6 +250,11 @@ class AdvancedHUDTracker:
             stats.postflop_calls += 1
         elif action == 'fold':
             stats.postflop_folds += 1
+        
+        if action in _ACTIONS:
+            size = amount / pot if amount > 0 and pot > 0 else 0.0
+            self._record_native(player_id, _EVENT_POSTFLOP, _STREETS.get(street, 1),
+                                _ACTIONS[action], False, size)
     
     def record_cbet(self, player_id: str, street: str, made_cbet: bool):
         """CBetを記録"""
@@ -223,6 +262,7 @@ class AdvancedHUDTracker:
         stats.cbet_opportunities[street] += 1
         if made_cbet:
             stats.cbet_made[street] += 1
+        self._record_native(player_id, _EVENT_CBET, _STREETS[street], flag=made_cbet)
     
     def record_faced_cbet(self, player_id: str, street: str, folded: bool):
         """CBetに直面した際の行動を記録"""
@@ -230,6 +270,7 @@ class AdvancedHUDTracker:
         stats.faced_cbet[street] += 1
         if folded:
             stats.folded_to_cbet[street] += 1
+        self._record_native(player_id, _EVENT_FACED_CBET, _STREETS[street], flag=folded)
     
     def record_showdown(self, player_id: str, won: bool, hand: str = None):
         """ショーダウンを記録"""
@@ -240,6 +281,7 @@ class AdvancedHUDTracker:
             stats.showdowns_won += 1
         if hand:
             stats.shown_hands.append(hand)
+        self._record_native(player_id, _EVENT_SHOWDOWN, 3, flag=won)
     
     def record_action_timing(self, player_id: str, time_seconds: float):
         """アクション時間を記録"""
@@ -250,6 +292,7 @@ class AdvancedHUDTracker:
             stats.fast_actions += 1
         elif time_seconds > 10.0:
             stats.slow_actions += 1
+        self._record_native(player_id, _EVENT_TIMING, 0, value=time_seconds)
     
     def get_player_summary(self, player_id: str) -> Dict:
         """プレイヤーサマリーを取得"""
@@ -257,6 +300,10 @@ class AdvancedHUDTracker:
             return {'error': 'Player not found'}
         
         stats = self.players[player_id]
+        if self.native_stats is not None:
+            summary = self.native_stats.summary(self._native_ids[player_id])
+            if summary is not None:
+                return self._format_summary(player_id, summary, stats)
         player_type = stats.classify_player_type()
         
         return {
@@ -275,6 +322,37 @@ class AdvancedHUDTracker:
             'avg_bet_size': f"{stats.get_average_bet_size():.2f}x pot"
         }
     
+    def _format_summary(self, player_id: str, summary: Dict,
+                        stats: AdvancedPlayerStats) -> Dict:
+        """ネイティブストアのサマリーをget_player_summaryの形式に整形"""
+        return {
+            'player_id': player_id,
+            'hands': summary['hands'],
+            'type': list(PlayerType)[summary['player_type']].value,
+            'vpip': f"{summary['vpip']:.1%}",
+            'pfr': f"{summary['pfr']:.1%}",
+            '3bet': f"{summary['3bet']:.1%}",
+            'af': f"{summary['af']:.2f}",
+            'agg_freq': f"{summary['agg_freq']:.1%}",
+            'cbet_flop': f"{summary['cbet'][0]:.1%}",
+            'fold_to_cbet_flop': f"{summary['fold_to_cbet'][0]:.1%}",
+            'wtsd': f"{summary['wtsd']:.1%}",
+            'wssd': f"{summary['wssd']:.1%}",
+            # 直近100回のベットサイズはPython側で保持している
+            'avg_bet_size': f"{stats.get_average_bet_size():.2f}x pot"
+        }
+    
+    def get_table_summaries(self, player_ids: List[str]) -> List[Dict]:
+        """テーブル全席のサマリーを一括取得（ネイティブストアがあれば1回の呼び出し）"""
+        known = [p for p in player_ids if p in self.players]
+        if self.native_stats is None or not known:
+            return [self.get_player_summary(p) for p in player_ids]
+        
+        ids = array.array('I', [self._native_ids[p] for p in known])
+        by_player = {p: self._format_summary(p, s, self.players[p])
+                     for p, s in zip(known, self.native_stats.summaries(ids))}
+        return [by_player.get(p, {'error': 'Player not found'}) for p in player_ids]
+    
     def detect_patterns(self, player_id: str) -> List[str]:
         """プレイパターンを検出"""
         if player_id not in self.players:
@@ -1,9 +1,21 @@
 // step1_card_system_advanced.cpp
+#ifndef POKER_STEP1_CARD_SYSTEM_ADVANCED_CPP
+#define POKER_STEP1_CARD_SYSTEM_ADVANCED_CPP
+
 #include <cstdint>
 #include <array>
 #include <algorithm>
 #include <cassert>
 
+// ホットカーネルをISAレベル別(x86-64-v2/v3/v4)にクローンし、ロード時にifuncで選択する
+// (POKER_ENGINE_CPU_DISPATCHはビルドシステムが定義)
+#if defined(POKER_ENGINE_CPU_DISPATCH) && defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define POKER_HOT_KERNEL __attribute__((target_clones( \
+    "arch=x86-64-v4", "arch=x86-64-v3", "arch=x86-64-v2", "default")))
+#else
+#define POKER_HOT_KERNEL
+#endif
+
 namespace PokerCore {
 
 // カード表現: 0-51 (0-12: スペード, 13-25: ハート, 26-38: ダイヤ, 39-51: クラブ)
@@ -57,6 +69,208 @@ inline int count_cards(CardMask mask) {
     return __builtin_popcountll(mask);
 }
 
+// ===== スート・メジャー配置のマスク =====
+// 公開IDのマスク(CardMask)はスートが13bit境界に並ぶため、スート別のランク集合を得るには
+// 13/26/39のシフトが要る。内部計算用に各スートを16bitレーンに置いた配置を用意する:
+//   bit = suit*16 + rank  →  (mask >> 16*s) & 0x1FFF がスートsのランク集合
+using SuitMajorMask = uint64_t;
+
+constexpr uint64_t SUIT_LANE_BITS = 0x1FFF1FFF1FFF1FFFULL;  // 各レーンの有効13bit
+
+constexpr std::array<uint8_t, DECK_SIZE> make_suit_major_index() {
+    std::array<uint8_t, DECK_SIZE> index = {};
+    for (int c = 0; c < DECK_SIZE; ++c) {
+        index[c] = static_cast<uint8_t>((c / RANK_COUNT) * 16 + c % RANK_COUNT);
+    }
+    return index;
+}
+constexpr std::array<uint8_t, DECK_SIZE> SUIT_MAJOR_INDEX = make_suit_major_index();
+
+// カードID(0-51) -> スート・メジャー配置のビット
+inline SuitMajorMask suit_major_bit(Card card) {
+    return 1ULL << SUIT_MAJOR_INDEX[card];
+}
+
+// CardMask <-> SuitMajorMask（スートごとのシフトとマスク）
+inline SuitMajorMask to_suit_major(CardMask mask) {
+    return (mask & 0x1FFF) |
+           ((mask << 3) & (0x1FFFULL << 16)) |
+           ((mask << 6) & (0x1FFFULL << 32)) |
+           ((mask << 9) & (0x1FFFULL << 48));
+}
+
+inline CardMask from_suit_major(SuitMajorMask mask) {
+    return (mask & 0x1FFF) |
+           ((mask >> 3) & (0x1FFFULL << 13)) |
+           ((mask >> 6) & (0x1FFFULL << 26)) |
+           ((mask >> 9) & (0x1FFFULL << 39));
+}
+
+// スートsのランク集合 (bit r = ランクr)
+inline uint16_t suit_ranks(SuitMajorMask mask, int suit) {
+    return static_cast<uint16_t>((mask >> (16 * suit)) & 0x1FFF);
+}
+
+// いずれかのスートに存在するランクの集合（4レーンのOR）
+inline uint16_t rank_set(SuitMajorMask mask) {
+    mask |= mask >> 32;
+    mask |= mask >> 16;
+    return static_cast<uint16_t>(mask & 0x1FFF);
+}
+
+// 最も枚数の多いスートの枚数
+inline int max_suit_count(SuitMajorMask mask) {
+    int best = 0;
+    for (int s = 0; s < SUIT_COUNT; ++s) {
+        best = std::max(best, __builtin_popcount(suit_ranks(mask, s)));
+    }
+    return best;
+}
+
+// ===== 乱択サンプリング =====
+// RNGは64bit値を返す next() を持つ型（xorshift等）
+
+// xorshiftの初期状態。状態0からは抜け出せない（uniform_belowの棄却が終わらない）ため、
+// シードをsplitmix64で混ぜ、結果が0なら固定の定数にする
+inline uint64_t xorshift_seed(uint64_t seed) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z != 0 ? z : 0x9E3779B97F4A7C15ULL;
+}
+
+// [0, range) の一様整数（Lemireの乗算法 + 棄却。剰余によるバイアスがない）
+template <typename Rng>
+inline uint32_t uniform_below(Rng& rng, uint32_t range) {
+    // xorshiftは下位ビットが弱いので上位32bitを使う
+    uint64_t m = (rng.next() >> 32) * uint64_t(range);
+    uint32_t low = static_cast<uint32_t>(m);
+    if (low < range) {
+        uint32_t threshold = static_cast<uint32_t>(-range) % range;
+        while (low < threshold) {
+            m = (rng.next() >> 32) * uint64_t(range);
+            low = static_cast<uint32_t>(m);
+        }
+    }
+    return static_cast<uint32_t>(m >> 32);
+}
+
+// maskの下からn番目(0始まり)の立っているビットだけを残す
+inline CardMask select_bit(CardMask mask, int n) {
+    // popcountで32/16/8ビット単位に絞り込み、最後はバイト内を走査
+    int shift = 0;
+    for (int width = 32; width >= 8; width >>= 1) {
+        uint64_t low = (mask >> shift) & ((1ULL << width) - 1);
+        int c = __builtin_popcountll(low);
+        if (n >= c) {
+            n -= c;
+            shift += width;
+        }
+    }
+    uint64_t rest = mask >> shift;
+    for (; n > 0; --n) rest &= rest - 1;
+    return (rest & (0 - rest)) << shift;
+}
+
+// liveからk枚(k <= count_cards(live))を非復元で一様に引く（liveは更新しない）。結果はマスク
+// デッキ全体をシャッフルせず、必要な枚数ぶんだけ乱数と選択を行う
+template <typename Rng>
+inline CardMask sample_cards(CardMask live, int k, Rng& rng) {
+    CardMask drawn = 0;
+    for (int i = 0; i < k; ++i) {
+        CardMask bit = select_bit(live, uniform_below(rng, count_cards(live)));
+        live ^= bit;
+        drawn |= bit;
+    }
+    return drawn;
+}
+
+// liveから1枚を一様に引き、liveから取り除く
+template <typename Rng>
+inline Card draw_card(CardMask& live, Rng& rng) {
+    CardMask bit = sample_cards(live, 1, rng);
+    live ^= bit;
+    return static_cast<Card>(__builtin_ctzll(bit));
+}
+
+// ===== 組合せの順位付け（colex） =====
+// k枚の部分集合 {c1 < c2 < ... < ck} の順位 = Σ C(ci, i)。
+// 0 .. C(n,k)-1 の密な添字になるため、事前計算テーブルをハッシュなしの配列で引ける
+
+// BINOMIAL[n][k] = C(n, k)  (n, k <= 52。C(52,26)でもuint64に収まる)
+using BinomialTable = std::array<std::array<uint64_t, DECK_SIZE + 1>, DECK_SIZE + 1>;
+
+constexpr BinomialTable make_binomial_table() {
+    BinomialTable table = {};
+    for (int n = 0; n <= DECK_SIZE; ++n) {
+        table[n][0] = 1;
+        for (int k = 1; k <= n; ++k) {
+            table[n][k] = table[n - 1][k - 1] + (k < n ? table[n - 1][k] : 0);
+        }
+    }
+    return table;
+}
+constexpr BinomialTable BINOMIAL = make_binomial_table();
+
+constexpr uint64_t binomial(int n, int k) {
+    return (k < 0 || n < 0 || k > n) ? 0 : BINOMIAL[n][k];
+}
+
+// 部分集合の順位（kは集合の要素数）
+inline uint64_t colex_rank(CardMask subset) {
+    uint64_t rank = 0;
+    for (int i = 1; subset != 0; ++i) {
+        rank += BINOMIAL[__builtin_ctzll(subset)][i];
+        subset &= subset - 1;
+    }
+    return rank;
+}
+
+// 順位からk枚の部分集合を復元する
+inline CardMask colex_unrank(uint64_t rank, int k) {
+    CardMask subset = 0;
+    int c = DECK_SIZE;
+    for (int i = k; i >= 1; --i) {
+        // C(c, i) <= rank となる最大のc（cは単調減少なので前回位置から下る）
+        do { --c; } while (BINOMIAL[c][i] > rank);
+        subset |= 1ULL << c;
+        rank -= BINOMIAL[c][i];
+    }
+    return subset;
+}
+
+// maskのうちliveに含まれるビットを下位へ詰める / その逆
+inline uint64_t compress_mask(CardMask mask, CardMask live) {
+    uint64_t out = 0;
+    for (int i = 0; live != 0; ++i) {
+        CardMask low = live & (0 - live);
+        if (mask & low) out |= 1ULL << i;
+        live ^= low;
+    }
+    return out;
+}
+
+inline CardMask expand_mask(uint64_t packed, CardMask live) {
+    CardMask out = 0;
+    for (; live != 0 && packed != 0; packed >>= 1) {
+        CardMask low = live & (0 - live);
+        if (packed & 1) out |= low;
+        live ^= low;
+    }
+    return out;
+}
+
+// デッドカードを除いたデッキ上での順位（0 .. C(52-dead, k)-1）
+// ボード・ホールカードを固定したランアウトのテーブル等に使う
+inline uint64_t colex_rank_live(CardMask subset, CardMask dead) {
+    return colex_rank(compress_mask(subset, ~dead & ((1ULL << DECK_SIZE) - 1)));
+}
+
+inline CardMask colex_unrank_live(uint64_t rank, int k, CardMask dead) {
+    return expand_mask(colex_unrank(rank, k), ~dead & ((1ULL << DECK_SIZE) - 1));
+}
+
 // デッキ生成
 class Deck {
 private:
@@ -72,13 +286,21 @@ public:
     
     void shuffle(uint64_t seed) {
         // Xorshift64
+        struct Xorshift64 {
+            uint64_t state;
+            uint64_t next() {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                return state;
+            }
+        } rng{xorshift_seed(seed)};
+
+        // 残りのカードから1枚ずつdraw_cardで引いて並べる（Fisher-Yatesと同じ分布）
         position = 0;
-        for (int i = DECK_SIZE - 1; i > 0; --i) {
-            seed ^= seed << 13;
-            seed ^= seed >> 7;
-            seed ^= seed << 17;
-            int j = seed % (i + 1);
-            std::swap(cards[i], cards[j]);
+        CardMask live = (1ULL << DECK_SIZE) - 1;
+        for (int i = 0; i < DECK_SIZE; ++i) {
+            cards[i] = draw_card(live, rng);
         }
     }
     
@@ -122,3 +344,5 @@ extern "C" {
         return get_suit(card);
     }
 }
+
+#endif // POKER_STEP1_CARD_SYSTEM_ADVANCED_CPP
@@ -177,6 +177,11 @@ class PokerMasterSystemComplete:
         if len(board) < 3:
             return 0
         
+        # C++の事前計算テーブル（step48）があれば1回の参照で済む
+        features = self.cpp_bridge.board_features(board)
+        if features is not None:
+            return features['eqr_texture']
+        
         board_strings = self._cards_to_strings(board)
         analysis = self.board_analyzer.analyze_board(board_strings)
         
@@ -1,4 +1,8 @@
 // step2_3_perfect_evaluator.cpp
+#ifndef POKER_STEP2_3_PERFECT_EVALUATOR_CPP
+#define POKER_STEP2_3_PERFECT_EVALUATOR_CPP
+
+#include "step1_card_system_advanced.cpp"
 #include <array>
 #include <cstdint>
 #include <algorithm>
@@ -8,6 +12,7 @@ namespace PokerEval {
 using namespace PokerCore;
 
 // ハンドランク定数
+// 評価値 = (役 << 20) | 比較用ランク5ニブル（上位ニブルほど優先）
 constexpr int RANK_STRAIGHT_FLUSH = 8;
 constexpr int RANK_FOUR_OF_KIND = 7;
 constexpr int RANK_FULL_HOUSE = 6;
@@ -21,8 +26,8 @@ constexpr int RANK_HIGH_CARD = 0;
 // ルックアップテーブル (初期化時に生成)
 class EvaluatorTables {
 public:
-    std::array<uint16_t, 8192> flush_lookup;
-    std::array<uint16_t, 8192> unique5_lookup;
+    std::array<uint32_t, 8192> flush_lookup;
+    std::array<uint32_t, 8192> unique5_lookup;
     
     EvaluatorTables() {
         init_flush_lookup();
@@ -37,14 +42,14 @@ private:
         }
     }
     
-    uint16_t evaluate_flush_hand(int mask) {
+    uint32_t evaluate_flush_hand(int mask) {
         // ストレートフラッシュチェック
         if (is_straight(mask)) {
             int high = get_highest_straight(mask);
-            return (RANK_STRAIGHT_FLUSH << 12) | (high << 8);
+            return (RANK_STRAIGHT_FLUSH << 20) | (high << 16);
         }
         // 通常のフラッシュ
-        return (RANK_FLUSH << 12) | get_top_cards(mask, 5);
+        return (RANK_FLUSH << 20) | get_top_cards(mask, 5);
     }
     
     bool is_straight(int mask) {
@@ -63,12 +68,13 @@ private:
         return 3; // A-2-3-4-5
     }
     
+    // 上位count枚のランクを高い順にニブルへ詰める
     int get_top_cards(int mask, int count) {
         int result = 0;
         int found = 0;
         for (int i = 12; i >= 0 && found < count; --i) {
             if (mask & (1 << i)) {
-                result |= (i << (found * 4));
+                result = (result << 4) | i;
                 found++;
             }
         }
@@ -84,11 +90,11 @@ private:
         }
     }
     
-    uint16_t evaluate_unique5(int mask) {
+    uint32_t evaluate_unique5(int mask) {
         if (is_straight(mask)) {
-            return (RANK_STRAIGHT << 12) | (get_highest_straight(mask) << 8);
+            return (RANK_STRAIGHT << 20) | (get_highest_straight(mask) << 16);
         }
-        return (RANK_HIGH_CARD << 12) | get_top_cards(mask, 5);
+        return (RANK_HIGH_CARD << 20) | get_top_cards(mask, 5);
     }
 };
 
@@ -98,28 +104,45 @@ static EvaluatorTables g_tables;
 class HandEvaluator {
 public:
     static uint32_t evaluate_7cards(const Card cards[7]) {
-        // ランクとスートのビットマスク
-        std::array<uint16_t, 4> suit_masks = {0, 0, 0, 0};
+        // スート・メジャー配置のマスクとランク枚数
+        SuitMajorMask hand = 0;
         std::array<uint8_t, 13> rank_counts = {0};
-        uint16_t rank_mask = 0;
         
         for (int i = 0; i < 7; ++i) {
-            Rank r = get_rank(cards[i]);
-            Suit s = get_suit(cards[i]);
-            suit_masks[s] |= (1 << r);
-            rank_counts[r]++;
-            rank_mask |= (1 << r);
+            hand |= suit_major_bit(cards[i]);
+            rank_counts[get_rank(cards[i])]++;
         }
         
         // フラッシュチェック
         for (int s = 0; s < 4; ++s) {
-            if (__builtin_popcount(suit_masks[s]) >= 5) {
-                return g_tables.flush_lookup[suit_masks[s]];
+            uint16_t suited = suit_ranks(hand, s);
+            if (__builtin_popcount(suited) >= 5) {
+                return g_tables.flush_lookup[suited];
             }
         }
         
         // ペア系の判定
-        return evaluate_non_flush(rank_counts, rank_mask);
+        return evaluate_non_flush(rank_counts, rank_set(hand));
+    }
+    
+    // スート・メジャー配置のマスクで与えた5-7枚を評価する
+    static uint32_t evaluate_mask(SuitMajorMask hand) {
+        for (int s = 0; s < 4; ++s) {
+            uint16_t suited = suit_ranks(hand, s);
+            if (__builtin_popcount(suited) >= 5) {
+                return g_tables.flush_lookup[suited];
+            }
+        }
+        
+        std::array<uint8_t, 13> rank_counts = {0};
+        for (int s = 0; s < 4; ++s) {
+            uint16_t suited = suit_ranks(hand, s);
+            while (suited != 0) {
+                rank_counts[__builtin_ctz(suited)]++;
+                suited &= suited - 1;
+            }
+        }
+        return evaluate_non_flush(rank_counts, rank_set(hand));
     }
     
 private:
@@ -143,48 +166,55 @@ private:
         // フォーカード
         if (quads != -1) {
             int kicker = get_highest_kicker(counts, quads);
-            return (RANK_FOUR_OF_KIND << 12) | (quads << 8) | kicker;
+            return (RANK_FOUR_OF_KIND << 20) | (quads << 16) | (kicker << 12);
         }
         
         // フルハウス
-        if (trips != -1 && (pairs[0] != -1 || pair_count > 0)) {
+        if (trips != -1) {
             int pair = pairs[0];
-            // トリップスが複数ある場合、2番目のトリップスをペアとする
+            // トリップスが複数ある場合、2番目のトリップスもペアとして使える
             for (int r = 12; r >= 0; --r) {
                 if (counts[r] == 3 && r != trips) {
-                    pair = r;
+                    pair = std::max(pair, r);
                     break;
                 }
             }
-            return (RANK_FULL_HOUSE << 12) | (trips << 8) | pair;
+            if (pair != -1) {
+                return (RANK_FULL_HOUSE << 20) | (trips << 16) | (pair << 12);
+            }
         }
         
         // ストレート
         if (is_straight_from_mask(rank_mask)) {
             int high = get_straight_high(rank_mask);
-            return (RANK_STRAIGHT << 12) | (high << 8);
+            return (RANK_STRAIGHT << 20) | (high << 16);
         }
         
         // スリーカード
         if (trips != -1) {
             int kickers = get_top_kickers(counts, trips, 2);
-            return (RANK_THREE_OF_KIND << 12) | (trips << 8) | kickers;
+            return (RANK_THREE_OF_KIND << 20) | (trips << 16) | (kickers << 8);
         }
         
         // ツーペア
         if (pair_count >= 2) {
             int kicker = get_highest_kicker_exclude(counts, pairs[0], pairs[1]);
-            return (RANK_TWO_PAIR << 12) | (pairs[0] << 8) | (pairs[1] << 4) | kicker;
+            return (RANK_TWO_PAIR << 20) | (pairs[0] << 16) | (pairs[1] << 12) | (kicker << 8);
         }
         
         // ワンペア
         if (pair_count == 1) {
             int kickers = get_top_kickers(counts, pairs[0], 3);
-            return (RANK_ONE_PAIR << 12) | (pairs[0] << 8) | kickers;
+            return (RANK_ONE_PAIR << 20) | (pairs[0] << 16) | (kickers << 4);
         }
         
-        // ハイカード
-        return g_tables.unique5_lookup[rank_mask & 0x1FFF];
+        // ハイカード（6-7種類のランクがある場合は上位5枚）
+        return g_tables.unique5_lookup[top5_ranks(rank_mask & 0x1FFF)];
+    }
+    
+    static uint16_t top5_ranks(uint16_t mask) {
+        while (__builtin_popcount(mask) > 5) mask &= mask - 1;
+        return mask;
     }
     
     static bool is_straight_from_mask(uint16_t mask) {
@@ -222,7 +252,7 @@ private:
         int found = 0;
         for (int r = 12; r >= 0 && found < n; --r) {
             if (r != exclude && counts[r] > 0) {
-                result |= (r << (found * 4));
+                result = (result << 4) | r;
                 found++;
             }
         }
@@ -238,4 +268,22 @@ extern "C" {
     uint32_t evaluate_7cards_perfect(const PokerCore::Card cards[7]) {
         return HandEvaluator::evaluate_7cards(cards);
     }
+    
+    // 5-7枚（重複なし）の評価。枚数が範囲外なら0
+    uint32_t evaluate_cards(const PokerCore::Card* cards, int count) {
+        if (count < 5 || count > 7) return 0;
+        SuitMajorMask hand = 0;
+        for (int i = 0; i < count; ++i) hand |= suit_major_bit(cards[i]);
+        return HandEvaluator::evaluate_mask(hand);
+    }
+    
+    // N件の7枚ハンドを一括評価 (cards: count*7枚)
+    POKER_HOT_KERNEL
+    void evaluate_7cards_batch(const PokerCore::Card* cards, int count, uint32_t* out) {
+        for (int i = 0; i < count; ++i) {
+            out[i] = HandEvaluator::evaluate_7cards(cards + i * 7);
+        }
+    }
 }
+
+#endif // POKER_STEP2_3_PERFECT_EVALUATOR_CPP
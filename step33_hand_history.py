@@ -2,14 +2,43 @@
 from datetime import datetime
 from typing import List, Dict, Optional
 import json
+import os
 import sqlite3
 
+try:
+    # ネイティブ取り込み（step51）・ハンドストア（step52）
+    import poker_engine as _native
+except ImportError:
+    _native = None
+
+_POSITIONS = ['UTG', 'MP', 'CO', 'BTN', 'SB', 'BB']
+_STREETS = ['preflop', 'flop', 'turn', 'river']
+_ACTION_TYPES = ['fold', 'check', 'call', 'bet', 'raise', 'post']
+_POT_TYPES = ['', 'limped', 'srp', '3bet', '4bet']
+# ストアが採番するhand_id = LOCAL_ID_BIT | ハンド番号
+_LOCAL_ID_BIT = 1 << 63
+
+def _card_string(card: int) -> str:
+    return '23456789TJQKA'[card % 13] + 'shdc'[card // 13]
+
 class HandHistory:
-    """ハンド履歴の詳細記録"""
+    """ハンド履歴の詳細記録
+    
+    store_pathを指定するとSQLiteの代わりにネイティブの追記型ハンドストア(step52)へ記録する
+    （書き込みはバックグラウンドでまとめて行われ、検索は索引とmmapした配列で行う）
+    """
     
-    def __init__(self, db_path: str = 'poker_hands.db'):
+    def __init__(self, db_path: str = 'poker_hands.db', store_path: Optional[str] = None):
         self.db_path = db_path
-        self._init_database()
+        self.store_path = store_path
+        self.store = None
+        self.cube = None   # 集計キューブ（step56、初回のaggregatesで開く）
+        if store_path is not None:
+            if _native is None:
+                raise RuntimeError("hand store requires the poker_engine extension module")
+            self.store = _native.HandStore(store_path)
+        else:
+            self._init_database()
     
     def _init_database(self):
         """データベースを初期化"""
@@ -62,6 +91,9 @@ class HandHistory:
     
     def record_hand(self, hand_data: Dict) -> str:
         """ハンドを記録"""
+        if self.store is not None:
+            return self._record_native(hand_data)
+        
         hand_id = f"{datetime.now().strftime('%Y%m%d%H%M%S')}_{hand_data.get('position', 'UNK')}"
         
         conn = sqlite3.connect(self.db_path)
@@ -114,8 +146,82 @@ class HandHistory:
         
         return hand_id
     
+    def _record_native(self, hand_data: Dict) -> str:
+        """ハンドストアへ追加（書き込みを待たずに戻る）"""
+        position = hand_data.get('position', '')
+        villain = hand_data.get('villain', '')
+        pot_type = hand_data.get('pot_type', '')
+        allin_street = hand_data.get('allin_street', '')
+        villain_cards = hand_data.get('villain_cards', [])
+        actions = []
+        for action in hand_data.get('actions', []):
+            street = action.get('street', '')
+            action_type = action.get('type', '')
+            if street not in _STREETS or action_type not in _ACTION_TYPES:
+                continue
+            actions.append((_STREETS.index(street), _ACTION_TYPES.index(action_type),
+                            action.get('amount', 0), action.get('pot_before', 0),
+                            action.get('all_in', False), action.get('to_call', 0),
+                            action.get('stack', 0)))
+        
+        index = self.store.append(
+            _native.parse_cards(''.join(hand_data.get('hole_cards', []))),
+            _native.parse_cards(''.join(hand_data.get('board', []))),
+            position=_POSITIONS.index(position) if position in _POSITIONS else -1,
+            pot=hand_data.get('pot_size', 0),
+            profit=hand_data.get('profit_loss', 0),
+            session=self.store.session(hand_data.get('session_id', '')),
+            won=hand_data.get('won', False),
+            showdown=hand_data.get('showdown', False),
+            equity=hand_data.get('equity', 0) or 0,
+            eqr=hand_data.get('eqr', 0) or 0,
+            ev=hand_data.get('ev', 0) or 0,
+            opponents=len(hand_data.get('opponents', [])),
+            actions=actions,
+            pot_type=_POT_TYPES.index(pot_type) if pot_type in _POT_TYPES else 0,
+            villain=_POSITIONS.index(villain) if villain in _POSITIONS else -1,
+            flop_players=hand_data.get('flop_players', 0),
+            allin_street=_STREETS.index(allin_street) if allin_street in _STREETS[:3] else -1,
+            villain_cards=_native.parse_cards(''.join(villain_cards)) if len(villain_cards) == 2 else None,
+            rake=hand_data.get('rake', 0) or 0,
+            big_blind=hand_data.get('big_blind', 0) or 0
+        )
+        return str(_LOCAL_ID_BIT | index)
+    
+    def _stored_to_dict(self, hand: Dict) -> Dict:
+        """ハンドストアのレコードを_row_to_dictと同じ形の辞書に変換"""
+        position = hand['position']
+        return {
+            'hand_id': str(hand['hand_id']),
+            'timestamp': datetime.fromtimestamp(hand['timestamp']).isoformat(),
+            'session_id': hand['session'],
+            'position': _POSITIONS[position] if position is not None else '',
+            'hole_cards': [_card_string(c) for c in hand['hole']],
+            'board': [_card_string(c) for c in hand['board']],
+            'pot_size': hand['pot'],
+            'won': hand['won'],
+            'profit_loss': hand['profit'],
+            'actions': [{
+                'street': _STREETS[street],
+                'type': _ACTION_TYPES[action],
+                'amount': amount,
+                'pot_before': pot_before,
+                'pot_after': round(pot_before + amount, 2),
+                'to_call': to_call,
+                'stack': stack
+            } for street, action, amount, pot_before, _, to_call, stack in hand['actions']]
+        }
+    
     def get_hand(self, hand_id: str) -> Optional[Dict]:
         """特定のハンドを取得"""
+        if self.store is not None:
+            self.store.flush()
+            try:
+                index = self.store.find(int(hand_id))
+            except ValueError:
+                return None
+            return self._stored_to_dict(self.store.get(index)) if index is not None else None
+        
         conn = sqlite3.connect(self.db_path)
         cursor = conn.cursor()
         
@@ -157,6 +263,19 @@ class HandHistory:
     
     def search_hands(self, filters: Dict) -> List[Dict]:
         """フィルタ条件でハンドを検索"""
+        if self.store is not None:
+            query = {}
+            if 'position' in filters:
+                if filters['position'] not in _POSITIONS:
+                    return []
+                query['positions'] = [_POSITIONS.index(filters['position'])]
+            if 'won' in filters:
+                query['won'] = bool(filters['won'])
+            if 'min_pot' in filters:
+                query['min_pot'] = filters['min_pot']
+            self.store.flush()
+            return [self._stored_to_dict(self.store.get(i)) for i in self.store.query(**query)]
+        
         conn = sqlite3.connect(self.db_path)
         cursor = conn.cursor()
         
@@ -181,8 +300,86 @@ class HandHistory:
         
         return [self._row_to_dict(row, []) for row in rows]
     
+    def find_hands(self, expression: str) -> List[Dict]:
+        """条件式でハンドを検索（ハンドストアのみ、step53）
+        
+        例: 'position=BTN,CO & pot=3bet & (made=two_pair,trips | draw=flush) & !result=lost'
+        """
+        if self.store is None:
+            raise RuntimeError("expression search requires a hand store")
+        self.store.flush()
+        return [self._stored_to_dict(self.store.get(i)) for i in self.store.search(expression)]
+    
+    def analyze(self, expression: str = '', group_by: str = 'position') -> List[Dict]:
+        """条件式に合うハンドのグループ別集計（ハンドストアのみ）
+        
+        group_by: none / position / villain / pot / class / texture / made
+        """
+        if self.store is None:
+            raise RuntimeError("expression search requires a hand store")
+        self.store.flush()
+        return self.store.analyze(expression, group_by)
+    
+    def luck_report(self, threads: int = 0, **filters) -> Dict:
+        """オールインEVで調整した収支と運（ハンドストアのみ、step54）
+        
+        未計算のハンドを計算してから集計する。filtersはHandStore.queryと同じ条件
+        """
+        if self.store is None:
+            raise RuntimeError("all-in EV requires a hand store")
+        self.store.flush()
+        self.store.allin_ev(threads)
+        return self.store.allin_summary(**filters)
+    
+    def leak_report(self, threads: int = 0, top: int = 20, model=None, **filters) -> Dict:
+        """判断ごとのEV損失とストリート×アクション別のリーク（ハンドストアのみ、step55）
+        
+        modelはEQRModel（Noneなら組み込みEQR）。filtersはHandStore.queryと同じ条件
+        """
+        if self.store is None:
+            raise RuntimeError("decision audit requires a hand store")
+        self.store.flush()
+        report = self.store.audit(threads=threads, top=top, model=model, **filters)
+        report['leaks'].sort(key=lambda c: c['ev_loss'], reverse=True)
+        return report
+    
+    def aggregates(self, group_by: Optional[str] = None, **filters):
+        """集計キューブ(step56)からの集計（ハンドストアのみ）
+        
+        キューブはstore_path + '.cube'に保存し、前回以降に追加されたハンドだけを取り込む。
+        group_by: 'session', 'position', 'stake', 'day', 'class'（Noneなら全体の1件）
+        filters: session（番号）, position（'BTN'なども可）, hole_class, big_blind, start, end
+        """
+        if self.store is None:
+            raise RuntimeError("aggregate cube requires a hand store")
+        self.store.flush()
+        path = self.store_path + '.cube'
+        if self.cube is None:
+            self.cube = _native.AggregateCube(path if os.path.exists(path) else None)
+        if self.cube.sync(self.store) > 0:
+            self.cube.save(path)
+        
+        if isinstance(filters.get('position'), str):
+            position = filters['position']
+            filters['position'] = _POSITIONS.index(position) if position in _POSITIONS else 6
+        if group_by is None:
+            return self.cube.rollup(**filters)
+        return self.cube.group(group_by, **filters)
+    
     def get_statistics_by_position(self) -> Dict:
         """ポジション別統計"""
+        if self.store is not None:
+            self.store.flush()
+            names = _POSITIONS + ['']
+            return {
+                names[p]: {
+                    'hands': s['hands'],
+                    'profit_loss': s['profit'],
+                    'avg_equity': s['avg_equity']
+                }
+                for p, s in enumerate(self.store.position_stats()) if s['hands'] > 0
+            }
+        
         conn = sqlite3.connect(self.db_path)
         cursor = conn.cursor()
         
@@ -202,3 +399,14 @@ class HandHistory:
         
         conn.close()
         return results
+    
+    def import_files(self, paths: List[str], stats=None, threads: int = 0) -> Dict:
+        """PokerStars形式のテキスト履歴を取り込む（step51、並列パース）
+        
+        statsにHudStatsを渡すと全プレイヤーのHUD統計も更新する
+        """
+        if _native is None:
+            raise RuntimeError("hand history import requires the poker_engine extension module")
+        if self.store is not None:
+            return _native.import_hand_histories(list(paths), stats, None, threads, self.store)
+        return _native.import_hand_histories(list(paths), stats, self.db_path, threads)
@@ -109,6 +109,42 @@ class ReportGenerator:
         report.append("\n" + "=" * 80)
         return '\n'.join(report)
     
+    def generate_breakdown_report(self, group_by: str = 'position', **filters) -> str:
+        """集計キューブ(step56)を使った内訳レポート（ハンドストアのみ）
+        
+        全履歴を走査せず小計を読むだけなので、履歴の長さに関係なくすぐ返る
+        """
+        labels = {
+            'position': lambda k: ['UTG', 'MP', 'CO', 'BTN', 'SB', 'BB', '?'][k],
+            'day': lambda k: datetime.utcfromtimestamp(k).strftime('%Y-%m-%d'),
+            'stake': lambda k: f"BB {k:.2f}" if k > 0 else '?',
+            'session': lambda k: f"Session {k}",
+            'class': lambda k: f"Class {k}" if k < 169 else '?'
+        }
+        label = labels.get(group_by, str)
+        
+        report = []
+        report.append("=" * 80)
+        report.append(f"BREAKDOWN BY {group_by.upper()}")
+        report.append("=" * 80)
+        
+        total = self.hand_db.aggregates(None, **filters)
+        if total['hands'] == 0:
+            report.append("\nNo hands recorded.")
+            return '\n'.join(report)
+        report.append(f"Total Hands: {total['hands']}  P/L: ${total['profit']:+.2f}  "
+                      f"Std Dev: ${total['std_dev']:.2f}/hand")
+        report.append("")
+        report.append(f"{'':14} {'Hands':>8} {'Win%':>7} {'P/L':>12} {'Avg':>9} {'StdDev':>9} "
+                      f"{'Min':>9} {'Max':>9}")
+        for row in self.hand_db.aggregates(group_by, **filters):
+            report.append(f"{label(row['key']):14} {row['hands']:8d} {row['win_rate']:7.1%} "
+                          f"{row['profit']:+12.2f} {row['mean']:+9.2f} {row['std_dev']:9.2f} "
+                          f"{row['min']:+9.2f} {row['max']:+9.2f}")
+        
+        report.append("\n" + "=" * 80)
+        return '\n'.join(report)
+    
     def _add_text_graph(self, report: List[str], sessions: List):
         """テキストベースのグラフを追加"""
         cumulative = 0
@@ -4,12 +4,24 @@ from scipy import stats
 from typing import List, Tuple
 import matplotlib.pyplot as plt
 
+try:
+    # 集計キューブ（step56）・収支の逐次集計（step57）
+    import poker_engine as _native
+except ImportError:
+    _native = None
+
+_POSITIONS = ['UTG', 'MP', 'CO', 'BTN', 'SB', 'BB']
+
 class PerformanceTracker:
     """パフォーマンス追跡とトレンド分析"""
     
     def __init__(self):
         self.performance_data = []
         self.rolling_window = 100  # 直近100ハンド
+        # ポジション別集計はキューブで追加時に更新する（未知のポジション名が来たら走査に戻す）
+        self.cube = _native.AggregateCube() if _native is not None else None
+        # 移動平均・トレンド・連勝連敗・分散は1ハンドごとにO(1)で更新し、参照は保持値を読むだけ
+        self.stream = _native.PerformanceStream(self.rolling_window, 100) if _native is not None else None
     
     def add_result(self, hand_result: Dict):
         """ハンド結果を追加"""
@@ -21,6 +33,17 @@ class PerformanceTracker:
             'position': hand_result.get('position', ''),
             'won': hand_result.get('won', False)
         })
+        if self.stream is not None:
+            self.stream.push(hand_result.get('profit_loss', 0),
+                             bool(hand_result.get('won', False)))
+        if self.cube is not None:
+            position = hand_result.get('position', '')
+            if position and position not in _POSITIONS:
+                self.cube = None
+            else:
+                self.cube.add(hand_result.get('profit_loss', 0),
+                              position=_POSITIONS.index(position) if position else -1,
+                              won=bool(hand_result.get('won', False)))
     
     def calculate_rolling_average(self, window: int = None) -> List[float]:
         """移動平均を計算"""
@@ -28,6 +51,8 @@ class PerformanceTracker:
             return []
         
         window = window or self.rolling_window
+        if self.stream is not None:
+            return self.stream.rolling(window).tolist()
         profits = [d['profit_loss'] for d in self.performance_data]
         
         if len(profits) < window:
@@ -47,12 +72,18 @@ class PerformanceTracker:
         if len(self.performance_data) < 30:
             return {'trend': 'insufficient_data'}
         
-        recent = self.performance_data[-100:]
-        profits = [d['profit_loss'] for d in recent]
-        x = np.arange(len(profits))
-        
-        # 線形回帰
-        slope, intercept, r_value, p_value, std_err = stats.linregress(x, profits)
+        if self.stream is not None:
+            # 直近100ハンドの回帰は逐次更新済み
+            state = self.stream.state()
+            slope, r_squared, p_value = state['slope'], state['r_squared'], state['p_value']
+        else:
+            recent = self.performance_data[-100:]
+            profits = [d['profit_loss'] for d in recent]
+            x = np.arange(len(profits))
+            
+            # 線形回帰
+            slope, intercept, r_value, p_value, std_err = stats.linregress(x, profits)
+            r_squared = r_value ** 2
         
         if p_value < 0.05:  # 統計的に有意
             if slope > 0.5:
@@ -69,7 +100,7 @@ class PerformanceTracker:
         return {
             'trend': trend,
             'slope': slope,
-            'r_squared': r_value ** 2,
+            'r_squared': r_squared,
             'confidence': 1 - p_value
         }
     
@@ -78,6 +109,15 @@ class PerformanceTracker:
         if not self.performance_data:
             return {'current_streak': 0, 'type': 'none'}
         
+        if self.stream is not None:
+            state = self.stream.state()
+            return {
+                'current_streak': abs(state['streak']),
+                'type': 'winning' if state['streak'] > 0 else 'losing',
+                'max_winning_streak': state['max_win_streak'],
+                'max_losing_streak': state['max_lose_streak']
+            }
+        
         current_streak = 0
         streak_type = None
         
@@ -131,11 +171,14 @@ class PerformanceTracker:
         if len(self.performance_data) < 50:
             return 0.5
         
-        profits = [d['profit_loss'] for d in self.performance_data[-100:]]
-        
         # 標準偏差が小さく、平均がプラスなら一貫性が高い
-        mean = np.mean(profits)
-        std = np.std(profits)
+        if self.stream is not None:
+            state = self.stream.state()
+            mean, std = state['trend_mean'], state['trend_std']
+        else:
+            profits = [d['profit_loss'] for d in self.performance_data[-100:]]
+            mean = np.mean(profits)
+            std = np.std(profits)
         
         if std == 0:
             return 1.0 if mean > 0 else 0.0
@@ -147,8 +190,27 @@ class PerformanceTracker:
         
         return consistency_score
     
+    def get_live_stats(self) -> Dict:
+        """ダッシュボード用: 平均・移動平均の95%信頼区間とEWMA（ネイティブのみ、O(1)）"""
+        if self.stream is None:
+            return {}
+        return self.stream.state()
+    
     def get_position_performance(self) -> Dict:
         """ポジション別パフォーマンス"""
+        if self.cube is not None:
+            names = _POSITIONS + ['']
+            return {
+                names[g['key']]: {
+                    'hands': g['hands'],
+                    'profit': g['profit'],
+                    'wins': g['won'],
+                    'avg_profit': g['mean'],
+                    'win_rate': g['win_rate']
+                }
+                for g in self.cube.group('position')
+            }
+        
         position_stats = {}
         
         for data in self.performance_data:
@@ -176,6 +238,20 @@ class PerformanceTracker:
         if len(self.performance_data) < 30:
             return {}
         
+        if self.stream is not None:
+            state = self.stream.state()
+            median, q1, q3 = self.stream.percentiles([50, 25, 75])
+            return {
+                'mean': state['mean'],
+                'std_dev': state['std_dev'],
+                'variance': state['std_dev'] ** 2,
+                'min': state['min'],
+                'max': state['max'],
+                'median': median,
+                'q1': q1,
+                'q3': q3
+            }
+        
         profits = [d['profit_loss'] for d in self.performance_data]
         
         return {
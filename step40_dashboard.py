@@ -93,6 +93,11 @@ class IntegratedDashboard:
         trend = self.performance_tracker.detect_trend()
         report.append(f"\n📈 TREND ANALYSIS")
         report.append(f"Current Trend: {trend.get('trend', 'N/A')}")
+        live = self.performance_tracker.get_live_stats()
+        if live.get('hands'):
+            low, high = live['rolling_band']
+            report.append(f"Last {live['rolling_count']} Hands: ${live['rolling_mean']:+.2f}/hand "
+                          f"(95% CI ${low:+.2f} .. ${high:+.2f})")
         
         # 連勝/連敗
         streak = self.performance_tracker.calculate_streak()
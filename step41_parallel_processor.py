@@ -54,6 +54,16 @@ class ParallelProcessor:
                                  board: List[int], 
                                  iterations: int = 50000) -> List[float]:
         """複数ハンドのエクイティを並列計算"""
+        try:
+            import poker_engine
+        except ImportError:
+            poker_engine = None
+        
+        if poker_engine is not None:
+            # ネイティブ拡張: 1回の呼び出しで全ハンドを計算（GIL解放、内部でマルチスレッド）
+            hands_bytes = bytes(card for hand in hands for card in hand)
+            return list(poker_engine.equity_batch(hands_bytes, bytes(board), 1, iterations))
+        
         chunk_size = len(hands) // cpu_count() + 1
         chunks = [hands[i:i+chunk_size] for i in range(0, len(hands), chunk_size)]
         
@@ -0,0 +1,3620 @@
+// step43_python_extension.cpp
+// CPython拡張モジュール "poker_engine"
+// ctypesを経由せず、バッファプロトコルでnumpy配列をゼロコピーで受け渡す。
+// 重い処理は全てGILを解放して実行する。
+// エンジン本体とはC ABI (poker_engine.h) のみで接続する。
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "poker_engine.h"
+
+namespace PyEngine {
+
+constexpr int DECK_SIZE = 52;
+
+// Py_bufferのRAIIラッパー
+class BufferView {
+private:
+    Py_buffer view;
+    bool acquired = false;
+
+public:
+    BufferView() { std::memset(&view, 0, sizeof(view)); }
+    ~BufferView() { release(); }
+    BufferView(const BufferView&) = delete;
+    BufferView& operator=(const BufferView&) = delete;
+
+    // formats: 許容するstructフォーマット文字 (例: "Bb?")
+    bool acquire(PyObject* obj, const char* name, const char* formats,
+                 Py_ssize_t itemsize, bool writable = false) {
+        int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT;
+        if (writable) flags |= PyBUF_WRITABLE;
+        if (PyObject_GetBuffer(obj, &view, flags) != 0) return false;
+        acquired = true;
+
+        // バイトオーダー指定子 ('@', '=', '<') を読み飛ばす
+        const char* fmt = view.format ? view.format : "B";
+        while (*fmt == '@' || *fmt == '=' || *fmt == '<') ++fmt;
+
+        if (view.itemsize != itemsize || fmt[0] == '\0' || fmt[1] != '\0' ||
+            std::strchr(formats, fmt[0]) == nullptr) {
+            PyErr_Format(PyExc_TypeError,
+                         "%s: expected contiguous buffer of '%s' (itemsize %zd), got '%s'",
+                         name, formats, itemsize, view.format ? view.format : "B");
+            return false;
+        }
+        return true;
+    }
+
+    void release() {
+        if (acquired) {
+            PyBuffer_Release(&view);
+            acquired = false;
+        }
+    }
+
+    template <typename T>
+    T* data() const { return static_cast<T*>(view.buf); }
+
+    Py_ssize_t size() const { return view.len / view.itemsize; }
+
+    int ndim() const { return view.ndim; }
+    Py_ssize_t shape(int i) const { return view.shape ? view.shape[i] : view.len / view.itemsize; }
+
+    bool overlaps(const void* other, Py_ssize_t other_len) const {
+        const char* a = static_cast<const char*>(view.buf);
+        const char* b = static_cast<const char*>(other);
+        return a < b + other_len && b < a + view.len;
+    }
+};
+
+// 出力配列: outが指定されればそれに書き込み、無ければbytearrayを確保して
+// 指定フォーマットのmemoryviewとして返す（numpy.asarrayでゼロコピー変換可能）
+class OutputArray {
+private:
+    PyObject* owner = nullptr;
+    BufferView buffer;
+
+public:
+    ~OutputArray() { Py_XDECREF(owner); }
+
+    bool create(PyObject* out, Py_ssize_t n, const char* format, Py_ssize_t itemsize) {
+        if (out == nullptr || out == Py_None) {
+            PyObject* storage = PyByteArray_FromStringAndSize(nullptr, n * itemsize);
+            if (storage == nullptr) return false;
+            PyObject* raw = PyMemoryView_FromObject(storage);
+            Py_DECREF(storage);
+            if (raw == nullptr) return false;
+            owner = PyObject_CallMethod(raw, "cast", "s", format);
+            Py_DECREF(raw);
+            if (owner == nullptr) return false;
+        } else {
+            Py_INCREF(out);
+            owner = out;
+        }
+
+        if (!buffer.acquire(owner, "out", format, itemsize, true)) return false;
+        if (buffer.size() != n) {
+            PyErr_Format(PyExc_ValueError, "out: expected %zd elements, got %zd",
+                         n, buffer.size());
+            return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    T* data() const { return buffer.data<T>(); }
+
+    // 所有権を呼び出し側へ移す
+    PyObject* release() {
+        buffer.release();
+        PyObject* result = owner;
+        owner = nullptr;
+        return result;
+    }
+};
+
+// METH_KEYWORDS等のシグネチャをPyCFunctionへ変換
+template <typename F>
+inline PyCFunction as_cfunction(F* fn) {
+    return reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(fn));
+}
+
+static bool check_cards(const uint8_t* cards, Py_ssize_t count) {
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        if (cards[i] >= DECK_SIZE) {
+            PyErr_Format(PyExc_ValueError, "invalid card id %d", cards[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ===== ハンド評価 =====
+
+// evaluate(cards[N*7] uint8, out=None) -> uint32[N]
+static PyObject* py_evaluate(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"cards", "out", nullptr};
+    PyObject* cards_obj;
+    PyObject* out_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(kwlist),
+                                     &cards_obj, &out_obj)) {
+        return nullptr;
+    }
+
+    BufferView cards;
+    if (!cards.acquire(cards_obj, "cards", "Bb", 1)) return nullptr;
+    if (cards.size() % 7 != 0) {
+        PyErr_SetString(PyExc_ValueError, "cards: length must be a multiple of 7");
+        return nullptr;
+    }
+    if (!check_cards(cards.data<uint8_t>(), cards.size())) return nullptr;
+
+    Py_ssize_t n = cards.size() / 7;
+    OutputArray out;
+    if (!out.create(out_obj, n, "I", 4)) return nullptr;
+
+    const uint8_t* src = cards.data<uint8_t>();
+    uint32_t* dst = out.data<uint32_t>();
+
+    Py_BEGIN_ALLOW_THREADS
+    evaluate_7cards_batch(src, static_cast<int>(n), dst);
+    Py_END_ALLOW_THREADS
+
+    return out.release();
+}
+
+// ===== エクイティ計算 =====
+
+static bool parse_board(BufferView& board, PyObject* board_obj) {
+    if (board_obj == nullptr || board_obj == Py_None) return true;
+    if (!board.acquire(board_obj, "board", "Bb", 1)) return false;
+    if (board.size() > 5) {
+        PyErr_SetString(PyExc_ValueError, "board: at most 5 cards");
+        return false;
+    }
+    return check_cards(board.data<uint8_t>(), board.size());
+}
+
+// ヒーローとボードに同じカードが無く、相手全員に配れるだけのカードが残ること
+static bool check_deal(const uint8_t* hero, const uint8_t* board, int board_count, int opponents) {
+    uint64_t used = 0;
+    for (int i = 0; i < 2 + board_count; ++i) {
+        uint8_t card = i < 2 ? hero[i] : board[i - 2];
+        if (used & (1ULL << card)) {
+            PyErr_Format(PyExc_ValueError, "card id %d appears more than once in hero and board", card);
+            return false;
+        }
+        used |= 1ULL << card;
+    }
+    if (opponents < 1 || 2 + 5 + 2 * opponents > DECK_SIZE) {
+        PyErr_Format(PyExc_ValueError, "opponents must be between 1 and %d", (DECK_SIZE - 7) / 2);
+        return false;
+    }
+    return true;
+}
+
+// equity(hero[2] uint8, board=None, opponents=1, iterations=100000) -> float
+static PyObject* py_equity(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"hero", "board", "opponents", "iterations", nullptr};
+    PyObject* hero_obj;
+    PyObject* board_obj = nullptr;
+    int opponents = 1;
+    int iterations = 100000;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Oii", const_cast<char**>(kwlist),
+                                     &hero_obj, &board_obj, &opponents, &iterations)) {
+        return nullptr;
+    }
+
+    BufferView hero, board;
+    if (!hero.acquire(hero_obj, "hero", "Bb", 1)) return nullptr;
+    if (hero.size() != 2) {
+        PyErr_SetString(PyExc_ValueError, "hero: expected 2 cards");
+        return nullptr;
+    }
+    if (!check_cards(hero.data<uint8_t>(), 2)) return nullptr;
+    if (!parse_board(board, board_obj)) return nullptr;
+    if (opponents < 1 || iterations < 1) {
+        PyErr_SetString(PyExc_ValueError, "opponents and iterations must be positive");
+        return nullptr;
+    }
+
+    const uint8_t* h = hero.data<uint8_t>();
+    const uint8_t* b = board_obj && board_obj != Py_None ? board.data<uint8_t>() : nullptr;
+    int board_count = b ? static_cast<int>(board.size()) : 0;
+    if (!check_deal(h, b, board_count, opponents)) return nullptr;
+    float equity;
+
+    Py_BEGIN_ALLOW_THREADS
+    equity = calculate_equity_optimized(h[0], h[1], b, board_count, opponents, iterations);
+    Py_END_ALLOW_THREADS
+
+    return PyFloat_FromDouble(equity);
+}
+
+// equity_batch(hands[N*2] uint8, board=None, opponents=1, iterations=50000, out=None)
+//   -> float32[N]
+static PyObject* py_equity_batch(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"hands", "board", "opponents", "iterations", "out", nullptr};
+    PyObject* hands_obj;
+    PyObject* board_obj = nullptr;
+    PyObject* out_obj = nullptr;
+    int opponents = 1;
+    int iterations = 50000;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OiiO", const_cast<char**>(kwlist),
+                                     &hands_obj, &board_obj, &opponents, &iterations,
+                                     &out_obj)) {
+        return nullptr;
+    }
+
+    BufferView hands, board;
+    if (!hands.acquire(hands_obj, "hands", "Bb", 1)) return nullptr;
+    if (hands.size() % 2 != 0) {
+        PyErr_SetString(PyExc_ValueError, "hands: length must be a multiple of 2");
+        return nullptr;
+    }
+    if (!check_cards(hands.data<uint8_t>(), hands.size())) return nullptr;
+    if (!parse_board(board, board_obj)) return nullptr;
+    if (opponents < 1 || iterations < 1) {
+        PyErr_SetString(PyExc_ValueError, "opponents and iterations must be positive");
+        return nullptr;
+    }
+
+    Py_ssize_t n = hands.size() / 2;
+    const uint8_t* h = hands.data<uint8_t>();
+    const uint8_t* b = board_obj && board_obj != Py_None ? board.data<uint8_t>() : nullptr;
+    int board_count = b ? static_cast<int>(board.size()) : 0;
+    for (Py_ssize_t i = 0; i < n; ++i) {
+        if (!check_deal(h + i * 2, b, board_count, opponents)) return nullptr;
+    }
+
+    OutputArray out;
+    if (!out.create(out_obj, n, "f", 4)) return nullptr;
+    float* dst = out.data<float>();
+
+    // ハンドをワーカーに分け、各ハンドは1スレッドで計算する
+    Py_BEGIN_ALLOW_THREADS
+    calculate_equity_batch(h, static_cast<int>(n), b, board_count, opponents, iterations, 0, dst);
+    Py_END_ALLOW_THREADS
+
+    return out.release();
+}
+
+// ===== EQR計算 =====
+
+// eqr_batch(raw_equity f64[N], position i32[N], stack f64[N], pot f64[N],
+//           board_texture i32[N], opponents i32[N], in_position bool[N],
+//           opponent_skill f64[N], out=None, factors=False)
+//   -> float64[N]
+//   -> factors=True: (eqr, position, stack, board, multiway, skill) の各float64[N]
+static PyObject* py_eqr_batch(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"raw_equity", "position", "stack", "pot",
+                                   "board_texture", "opponents", "in_position",
+                                   "opponent_skill", "out", "factors", nullptr};
+    PyObject* objs[8];
+    PyObject* out_obj = nullptr;
+    int factors = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOOOOO|Op", const_cast<char**>(kwlist),
+                                     &objs[0], &objs[1], &objs[2], &objs[3],
+                                     &objs[4], &objs[5], &objs[6], &objs[7],
+                                     &out_obj, &factors)) {
+        return nullptr;
+    }
+    if (factors && out_obj != nullptr && out_obj != Py_None) {
+        PyErr_SetString(PyExc_ValueError, "out cannot be combined with factors=True");
+        return nullptr;
+    }
+
+    BufferView raw_equity, position, stack, pot, texture, opponents, in_position, skill;
+    if (!raw_equity.acquire(objs[0], "raw_equity", "d", 8) ||
+        !position.acquire(objs[1], "position", "il", 4) ||
+        !stack.acquire(objs[2], "stack", "d", 8) ||
+        !pot.acquire(objs[3], "pot", "d", 8) ||
+        !texture.acquire(objs[4], "board_texture", "il", 4) ||
+        !opponents.acquire(objs[5], "opponents", "il", 4) ||
+        !in_position.acquire(objs[6], "in_position", "?Bb", 1) ||
+        !skill.acquire(objs[7], "opponent_skill", "d", 8)) {
+        return nullptr;
+    }
+
+    Py_ssize_t n = raw_equity.size();
+    const BufferView* columns[] = {&raw_equity, &position, &stack, &pot, &texture,
+                                   &opponents, &in_position, &skill};
+    for (const BufferView* column : columns) {
+        if (column->size() != n) {
+            PyErr_SetString(PyExc_ValueError, "all input columns must have the same length");
+            return nullptr;
+        }
+    }
+
+    // 出力列: [eqr, position, stack, board, multiway, skill]
+    constexpr int OUTPUT_COLUMNS = 6;
+    OutputArray outputs[OUTPUT_COLUMNS];
+    int created = factors ? OUTPUT_COLUMNS : 1;
+    for (int c = 0; c < created; ++c) {
+        if (!outputs[c].create(c == 0 ? out_obj : nullptr, n, "d", 8)) return nullptr;
+    }
+    // バッチカーネルは入出力が重ならないことを前提にSIMD化している
+    for (const BufferView* column : columns) {
+        if (column->overlaps(outputs[0].data<double>(), n * 8)) {
+            PyErr_SetString(PyExc_ValueError, "out must not overlap an input column");
+            return nullptr;
+        }
+    }
+    // 係数列が不要な場合は一時領域に書き捨てる
+    std::vector<double> scratch(factors ? 0 : static_cast<size_t>(n) * (OUTPUT_COLUMNS - 1));
+    double* dst[OUTPUT_COLUMNS];
+    for (int c = 0; c < OUTPUT_COLUMNS; ++c) {
+        dst[c] = c < created ? outputs[c].data<double>() : scratch.data() + (c - 1) * n;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    calculate_eqr_batch(
+        static_cast<int>(n),
+        raw_equity.data<double>(), position.data<int32_t>(),
+        stack.data<double>(), pot.data<double>(),
+        texture.data<int32_t>(), opponents.data<int32_t>(),
+        in_position.data<uint8_t>(), skill.data<double>(),
+        dst[0], dst[1], dst[2], dst[3], dst[4], dst[5]);
+    Py_END_ALLOW_THREADS
+
+    if (!factors) return outputs[0].release();
+
+    PyObject* result = PyTuple_New(OUTPUT_COLUMNS);
+    if (result == nullptr) return nullptr;
+    for (int c = 0; c < OUTPUT_COLUMNS; ++c) {
+        PyTuple_SET_ITEM(result, c, outputs[c].release());
+    }
+    return result;
+}
+
+// ===== CFRソルバー =====
+
+// ソルバーは学習中に情報セットとゲーム状態を書き換えるため、GILを解放している間の
+// 同じオブジェクトへの呼び出しはlockで直列化する（lockはGILを手放してから取る）
+struct PyCFRSolver {
+    PyObject_HEAD
+    void* solver;
+    std::mutex lock;
+};
+
+// CFRSolver(game='kuhn'): 'kuhn'=クーン・ポーカー, 'leduc'=レデュック・ホールデム
+static PyObject* solver_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"game", nullptr};
+    const char* game = "kuhn";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|s", const_cast<char**>(keywords), &game)) {
+        return nullptr;
+    }
+    int game_id;
+    if (std::strcmp(game, "kuhn") == 0) {
+        game_id = 0;
+    } else if (std::strcmp(game, "leduc") == 0) {
+        game_id = 1;
+    } else {
+        PyErr_Format(PyExc_ValueError, "unknown game '%s' (expected 'kuhn' or 'leduc')", game);
+        return nullptr;
+    }
+
+    PyCFRSolver* self = reinterpret_cast<PyCFRSolver*>(type->tp_alloc(type, 0));
+    if (self == nullptr) return nullptr;
+    new (&self->lock) std::mutex();
+    self->solver = create_cfr_solver_game(game_id);
+    if (self->solver == nullptr) {
+        Py_DECREF(self);
+        PyErr_SetString(PyExc_RuntimeError, "failed to create CFR solver");
+        return nullptr;
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void solver_dealloc(PyCFRSolver* self) {
+    if (self->solver != nullptr) destroy_cfr_solver(self->solver);
+    self->lock.~mutex();
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+static PyObject* solver_train(PyCFRSolver* self, PyObject* args) {
+    int iterations;
+    if (!PyArg_ParseTuple(args, "i", &iterations)) return nullptr;
+    if (iterations < 0) {
+        PyErr_SetString(PyExc_ValueError, "iterations must be non-negative");
+        return nullptr;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    {
+        std::lock_guard<std::mutex> guard(self->lock);
+        cfr_train(self->solver, iterations);
+    }
+    Py_END_ALLOW_THREADS
+
+    Py_RETURN_NONE;
+}
+
+static PyObject* solver_exploitability(PyCFRSolver* self, PyObject*) {
+    double value;
+
+    Py_BEGIN_ALLOW_THREADS
+    {
+        std::lock_guard<std::mutex> guard(self->lock);
+        value = cfr_exploitability(self->solver);
+    }
+    Py_END_ALLOW_THREADS
+
+    return PyFloat_FromDouble(value);
+}
+
+static PyObject* solver_info_sets(PyCFRSolver* self, PyObject*) {
+    int count;
+
+    Py_BEGIN_ALLOW_THREADS
+    {
+        std::lock_guard<std::mutex> guard(self->lock);
+        count = cfr_info_set_count(self->solver);
+    }
+    Py_END_ALLOW_THREADS
+
+    return PyLong_FromLong(count);
+}
+
+static PyMethodDef solver_methods[] = {
+    {"train", as_cfunction(solver_train), METH_VARARGS,
+     "train(iterations): CFRイテレーションを実行（GIL解放）"},
+    {"exploitability", as_cfunction(solver_exploitability), METH_NOARGS,
+     "exploitability() -> float: 平均戦略の最適反応によるエクスプロイタビリティ（チップ/ゲーム、学習前は0）"},
+    {"info_sets", as_cfunction(solver_info_sets), METH_NOARGS,
+     "info_sets() -> int: 学習済みの情報セット数"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyTypeObject CFRSolverType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// ===== キャリブレーション済みEQRモデル =====
+
+struct PyEQRModel {
+    PyObject_HEAD
+    void* handle;
+};
+
+static PyObject* eqr_model_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"path", nullptr};
+    const char* path;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", const_cast<char**>(kwlist), &path)) {
+        return nullptr;
+    }
+
+    void* handle;
+    Py_BEGIN_ALLOW_THREADS
+    handle = eqr_model_open(path);
+    Py_END_ALLOW_THREADS
+    if (handle == nullptr) {
+        PyErr_Format(PyExc_OSError, "cannot load EQR model: %s", path);
+        return nullptr;
+    }
+
+    PyEQRModel* self = reinterpret_cast<PyEQRModel*>(type->tp_alloc(type, 0));
+    if (self == nullptr) {
+        eqr_model_close(handle);
+        return nullptr;
+    }
+    self->handle = handle;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void eqr_model_dealloc(PyEQRModel* self) {
+    eqr_model_close(self->handle);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+// reload() -> bool: ファイルが更新されていれば差し替える
+static PyObject* eqr_model_py_reload(PyEQRModel* self, PyObject*) {
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = eqr_model_reload(self->handle);
+    Py_END_ALLOW_THREADS
+    if (result < 0) {
+        PyErr_SetString(PyExc_OSError, "EQR model reload failed; keeping the current model");
+        return nullptr;
+    }
+    return PyBool_FromLong(result);
+}
+
+static PyObject* eqr_model_py_version(PyEQRModel* self, PyObject*) {
+    return PyLong_FromUnsignedLongLong(eqr_model_version(self->handle));
+}
+
+// eqr_batch(raw_equity f64, position i32, stack f64, pot f64, board_texture i32,
+//           opponents i32, in_position bool, street i32, opponent_skill f64, out=None)
+//   -> float64[N]
+static PyObject* eqr_model_py_eqr_batch(PyEQRModel* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"raw_equity", "position", "stack", "pot",
+                                   "board_texture", "opponents", "in_position",
+                                   "street", "opponent_skill", "out", nullptr};
+    PyObject* objs[9];
+    PyObject* out_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOOOOOO|O", const_cast<char**>(kwlist),
+                                     &objs[0], &objs[1], &objs[2], &objs[3], &objs[4],
+                                     &objs[5], &objs[6], &objs[7], &objs[8], &out_obj)) {
+        return nullptr;
+    }
+
+    BufferView raw_equity, position, stack, pot, texture, opponents, in_position, street, skill;
+    if (!raw_equity.acquire(objs[0], "raw_equity", "d", 8) ||
+        !position.acquire(objs[1], "position", "il", 4) ||
+        !stack.acquire(objs[2], "stack", "d", 8) ||
+        !pot.acquire(objs[3], "pot", "d", 8) ||
+        !texture.acquire(objs[4], "board_texture", "il", 4) ||
+        !opponents.acquire(objs[5], "opponents", "il", 4) ||
+        !in_position.acquire(objs[6], "in_position", "?Bb", 1) ||
+        !street.acquire(objs[7], "street", "il", 4) ||
+        !skill.acquire(objs[8], "opponent_skill", "d", 8)) {
+        return nullptr;
+    }
+
+    Py_ssize_t n = raw_equity.size();
+    const BufferView* columns[] = {&position, &stack, &pot, &texture, &opponents,
+                                   &in_position, &street, &skill};
+    for (const BufferView* column : columns) {
+        if (column->size() != n) {
+            PyErr_SetString(PyExc_ValueError, "all input columns must have the same length");
+            return nullptr;
+        }
+    }
+
+    OutputArray out;
+    if (!out.create(out_obj, n, "d", 8)) return nullptr;
+
+    Py_BEGIN_ALLOW_THREADS
+    eqr_model_calculate_batch(
+        self->handle, static_cast<int>(n),
+        raw_equity.data<double>(), position.data<int32_t>(),
+        stack.data<double>(), pot.data<double>(),
+        texture.data<int32_t>(), opponents.data<int32_t>(),
+        in_position.data<uint8_t>(), street.data<int32_t>(),
+        skill.data<double>(), out.data<double>());
+    Py_END_ALLOW_THREADS
+
+    return out.release();
+}
+
+static PyMethodDef eqr_model_methods[] = {
+    {"reload", as_cfunction(eqr_model_py_reload), METH_NOARGS,
+     "reload() -> bool: ファイルが更新されていれば新しいモデルに差し替える"},
+    {"version", as_cfunction(eqr_model_py_version), METH_NOARGS,
+     "version() -> int: 読み込み中モデルのバージョン"},
+    {"eqr_batch", as_cfunction(eqr_model_py_eqr_batch), METH_VARARGS | METH_KEYWORDS,
+     "eqr_batch(raw_equity, position, stack, pot, board_texture, opponents, "
+     "in_position, street, opponent_skill, out=None) -> float64[N]"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyTypeObject EQRModelType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// ===== HUD統計ストア =====
+
+struct PyHudStats {
+    PyObject_HEAD
+    void* handle;
+};
+
+static PyTypeObject HudStatsType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+static PyObject* wrap_hud_stats(PyTypeObject* type, void* handle) {
+    PyHudStats* self = reinterpret_cast<PyHudStats*>(type->tp_alloc(type, 0));
+    if (self == nullptr) {
+        hud_stats_destroy(handle);
+        return nullptr;
+    }
+    self->handle = handle;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+// HudStats(path=None): pathを指定すると保存済みファイルをmmapで開く
+static PyObject* hud_stats_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"path", nullptr};
+    const char* path = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|z", const_cast<char**>(kwlist), &path)) {
+        return nullptr;
+    }
+
+    void* handle;
+    Py_BEGIN_ALLOW_THREADS
+    handle = path != nullptr ? hud_stats_open(path) : hud_stats_create();
+    Py_END_ALLOW_THREADS
+    if (handle == nullptr) {
+        PyErr_Format(PyExc_OSError, "cannot open HUD stats: %s", path);
+        return nullptr;
+    }
+    return wrap_hud_stats(type, handle);
+}
+
+static void hud_stats_dealloc(PyHudStats* self) {
+    hud_stats_destroy(self->handle);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+static PyObject* summary_to_dict(const PokerHudSummary& s) {
+    const float* v = s.vpip_by_position;
+    return Py_BuildValue(
+        "{s:I,s:i,s:d,s:d,s:d,s:d,s:d,s:(ddd),s:(ddd),s:d,s:d,s:d,s:d,s:(dddddd)}",
+        "hands", s.hands,
+        "player_type", s.player_type,
+        "vpip", double(s.vpip),
+        "pfr", double(s.pfr),
+        "3bet", double(s.threeb),
+        "af", double(s.af),
+        "agg_freq", double(s.agg_freq),
+        "cbet", double(s.cbet[0]), double(s.cbet[1]), double(s.cbet[2]),
+        "fold_to_cbet", double(s.fold_to_cbet[0]), double(s.fold_to_cbet[1]),
+        double(s.fold_to_cbet[2]),
+        "wtsd", double(s.wtsd),
+        "wssd", double(s.wssd),
+        "avg_bet_size", double(s.avg_bet_size),
+        "fast_ratio", double(s.fast_ratio),
+        "vpip_by_position", double(v[0]), double(v[1]), double(v[2]), double(v[3]),
+        double(v[4]), double(v[5]));
+}
+
+// player_id(name) -> int: 未登録なら追加する
+static PyObject* hud_stats_py_player_id(PyHudStats* self, PyObject* args) {
+    const char* name;
+    if (!PyArg_ParseTuple(args, "s", &name)) return nullptr;
+    return PyLong_FromUnsignedLong(hud_stats_player_id(self->handle, name));
+}
+
+// find(name) -> int | None
+static PyObject* hud_stats_py_find(PyHudStats* self, PyObject* args) {
+    const char* name;
+    if (!PyArg_ParseTuple(args, "s", &name)) return nullptr;
+    int64_t id = hud_stats_find(self->handle, name);
+    if (id < 0) Py_RETURN_NONE;
+    return PyLong_FromLongLong(id);
+}
+
+static PyObject* hud_stats_py_player_count(PyHudStats* self, PyObject*) {
+    return PyLong_FromUnsignedLong(hud_stats_player_count(self->handle));
+}
+
+// record(player, kind, position, street, action=0, flag=False, value=0.0): イベント1件
+static PyObject* hud_stats_py_record(PyHudStats* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"player", "kind", "position", "street",
+                                   "action", "flag", "value", nullptr};
+    unsigned int player;
+    int kind, position, street, action = 0, flag = 0;
+    float value = 0.0f;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Iiii|ipf", const_cast<char**>(kwlist),
+                                     &player, &kind, &position, &street,
+                                     &action, &flag, &value)) {
+        return nullptr;
+    }
+    if (kind < 0 || kind > 5 || position < 0 || position > 5 || street < 0 || street > 3 ||
+        action < 0 || action > 4) {
+        PyErr_SetString(PyExc_ValueError, "kind/position/street/action out of range");
+        return nullptr;
+    }
+    PokerHudEvent e = {};
+    e.player = player;
+    e.kind = static_cast<uint8_t>(kind);
+    e.position = static_cast<uint8_t>(position);
+    e.street = static_cast<uint8_t>(street);
+    e.action = static_cast<uint8_t>(action);
+    e.flag = static_cast<uint8_t>(flag);
+    e.value = value;
+    hud_stats_apply(self->handle, &e, 1);
+    Py_RETURN_NONE;
+}
+
+// apply(events): PokerHudEvent(16バイト)を連続して詰めたバッファを一括適用する
+static PyObject* hud_stats_py_apply(PyHudStats* self, PyObject* args) {
+    PyObject* events_obj;
+    if (!PyArg_ParseTuple(args, "O", &events_obj)) return nullptr;
+
+    BufferView events;
+    if (!events.acquire(events_obj, "events", "Bb", 1)) return nullptr;
+    if (events.size() % static_cast<Py_ssize_t>(sizeof(PokerHudEvent)) != 0) {
+        PyErr_SetString(PyExc_ValueError, "events: length must be a multiple of 16 bytes");
+        return nullptr;
+    }
+    // 入力はbytes等でアラインが保証されないため、コピーしてから適用する
+    size_t n = static_cast<size_t>(events.size()) / sizeof(PokerHudEvent);
+    std::vector<PokerHudEvent> copy(n);
+    std::memcpy(copy.data(), events.data<uint8_t>(), n * sizeof(PokerHudEvent));
+    events.release();
+
+    Py_BEGIN_ALLOW_THREADS
+    hud_stats_apply(self->handle, copy.data(), static_cast<int>(n));
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+// summary(player) -> dict | None
+static PyObject* hud_stats_py_summary(PyHudStats* self, PyObject* args) {
+    unsigned int player;
+    if (!PyArg_ParseTuple(args, "I", &player)) return nullptr;
+    PokerHudSummary s;
+    if (hud_stats_summary(self->handle, player, &s) != 0) Py_RETURN_NONE;
+    return summary_to_dict(s);
+}
+
+// summaries(players uint32[N]) -> list[dict]: テーブル全席を1回で取得する
+static PyObject* hud_stats_py_summaries(PyHudStats* self, PyObject* args) {
+    PyObject* players_obj;
+    if (!PyArg_ParseTuple(args, "O", &players_obj)) return nullptr;
+
+    BufferView players;
+    if (!players.acquire(players_obj, "players", "IL", 4)) return nullptr;
+    Py_ssize_t n = players.size();
+    std::vector<PokerHudSummary> out(static_cast<size_t>(n));
+    const uint32_t* ids = players.data<uint32_t>();
+    Py_BEGIN_ALLOW_THREADS
+    hud_stats_summaries(self->handle, ids, static_cast<int>(n), out.data());
+    Py_END_ALLOW_THREADS
+
+    PyObject* list = PyList_New(n);
+    if (list == nullptr) return nullptr;
+    for (Py_ssize_t i = 0; i < n; ++i) {
+        PyObject* item = summary_to_dict(out[i]);
+        if (item == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+// aggregate(players=None, position_mask=0x3F, street_mask=0xF) -> list[int]: カウンタ合計(23)
+static PyObject* hud_stats_py_aggregate(PyHudStats* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"players", "position_mask", "street_mask", nullptr};
+    PyObject* players_obj = nullptr;
+    unsigned int position_mask = 0x3F, street_mask = 0xF;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OII", const_cast<char**>(kwlist),
+                                     &players_obj, &position_mask, &street_mask)) {
+        return nullptr;
+    }
+
+    BufferView players;
+    const uint32_t* ids = nullptr;
+    int n = 0;
+    if (players_obj != nullptr && players_obj != Py_None) {
+        if (!players.acquire(players_obj, "players", "IL", 4)) return nullptr;
+        ids = players.data<uint32_t>();
+        n = static_cast<int>(players.size());
+    }
+
+    constexpr int COUNTERS = 23;
+    uint64_t totals[COUNTERS];
+    Py_BEGIN_ALLOW_THREADS
+    hud_stats_aggregate(self->handle, ids, n, position_mask, street_mask, totals);
+    Py_END_ALLOW_THREADS
+
+    PyObject* list = PyList_New(COUNTERS);
+    if (list == nullptr) return nullptr;
+    for (int k = 0; k < COUNTERS; ++k) {
+        PyObject* item = PyLong_FromUnsignedLongLong(totals[k]);
+        if (item == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, k, item);
+    }
+    return list;
+}
+
+// snapshot() -> HudStats: 現時点の複製
+static PyObject* hud_stats_py_snapshot(PyHudStats* self, PyObject*) {
+    void* handle;
+    Py_BEGIN_ALLOW_THREADS
+    handle = hud_stats_snapshot(self->handle);
+    Py_END_ALLOW_THREADS
+    return wrap_hud_stats(Py_TYPE(self), handle);
+}
+
+static PyObject* hud_stats_py_save(PyHudStats* self, PyObject* args) {
+    const char* path;
+    if (!PyArg_ParseTuple(args, "s", &path)) return nullptr;
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = hud_stats_save(self->handle, path);
+    Py_END_ALLOW_THREADS
+    if (result != 0) {
+        PyErr_Format(PyExc_OSError, "cannot write HUD stats: %s", path);
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef hud_stats_methods[] = {
+    {"player_id", as_cfunction(hud_stats_py_player_id), METH_VARARGS,
+     "player_id(name) -> int: プレイヤー番号（未登録なら追加）"},
+    {"find", as_cfunction(hud_stats_py_find), METH_VARARGS,
+     "find(name) -> int | None"},
+    {"player_count", as_cfunction(hud_stats_py_player_count), METH_NOARGS,
+     "player_count() -> int"},
+    {"record", as_cfunction(hud_stats_py_record), METH_VARARGS | METH_KEYWORDS,
+     "record(player, kind, position, street, action=0, flag=False, value=0.0)"},
+    {"apply", as_cfunction(hud_stats_py_apply), METH_VARARGS,
+     "apply(events): 16バイトのイベントを詰めたバッファを一括適用"},
+    {"summary", as_cfunction(hud_stats_py_summary), METH_VARARGS,
+     "summary(player) -> dict | None"},
+    {"summaries", as_cfunction(hud_stats_py_summaries), METH_VARARGS,
+     "summaries(players uint32[N]) -> list[dict]"},
+    {"aggregate", as_cfunction(hud_stats_py_aggregate), METH_VARARGS | METH_KEYWORDS,
+     "aggregate(players=None, position_mask=0x3F, street_mask=0xF) -> list[int]"},
+    {"snapshot", as_cfunction(hud_stats_py_snapshot), METH_NOARGS,
+     "snapshot() -> HudStats: 現時点の複製"},
+    {"save", as_cfunction(hud_stats_py_save), METH_VARARGS,
+     "save(path): mmap可能なファイル形式で保存"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+// ===== ハンドストア =====
+
+struct PyHandStore {
+    PyObject_HEAD
+    void* handle;
+    void* query;   // step53の索引（初回の条件式検索で作る）
+    void* allin;   // step54の結果列（初回に開く）
+};
+
+static PyTypeObject HandStoreType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// 金額は通貨単位のfloatで受け渡し、ストアにはセントで持つ
+static int64_t to_cents(double amount) {
+    return static_cast<int64_t>(amount * 100.0 + (amount < 0.0 ? -0.5 : 0.5));
+}
+
+// HandStore(path, read_only=False, sync=True)
+static PyObject* hand_store_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"path", "read_only", "sync", nullptr};
+    const char* path;
+    int read_only = 0, sync = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|pp", const_cast<char**>(kwlist),
+                                     &path, &read_only, &sync)) {
+        return nullptr;
+    }
+
+    void* handle;
+    Py_BEGIN_ALLOW_THREADS
+    handle = hand_store_open(path, read_only, sync);
+    Py_END_ALLOW_THREADS
+    if (handle == nullptr) {
+        PyErr_Format(PyExc_OSError, "cannot open hand store: %s", path);
+        return nullptr;
+    }
+    PyHandStore* self = reinterpret_cast<PyHandStore*>(type->tp_alloc(type, 0));
+    if (self == nullptr) {
+        hand_store_close(handle);
+        return nullptr;
+    }
+    self->handle = handle;
+    self->query = nullptr;
+    self->allin = nullptr;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void hand_store_dealloc(PyHandStore* self) {
+    // 未書き込み分の書き込みを待つ（索引はストアより先に閉じる）
+    Py_BEGIN_ALLOW_THREADS
+    if (self->query != nullptr) hand_query_close(self->query);
+    if (self->allin != nullptr) allin_ev_close(self->allin);
+    hand_store_close(self->handle);
+    Py_END_ALLOW_THREADS
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+// session(name) -> int: 未登録なら追加する（読み取り専用で未登録ならKeyError）
+static PyObject* hand_store_py_session(PyHandStore* self, PyObject* args) {
+    const char* name;
+    if (!PyArg_ParseTuple(args, "s", &name)) return nullptr;
+    int64_t session = hand_store_session(self->handle, name);
+    if (session < 0) {
+        PyErr_Format(PyExc_KeyError, "session '%s' not found in read-only store", name);
+        return nullptr;
+    }
+    return PyLong_FromLongLong(session);
+}
+
+// append(hole, board=None, position=-1, pot=0.0, profit=0.0, hand_id=0, timestamp=0, session=0,
+//        won=None, showdown=False, equity=0.0, eqr=0.0, ev=0.0, opponents=0, actions=(),
+//        pot_type=0, villain=-1, flop_players=0, allin_street=-1, villain_cards=None,
+//        invested=None, rake=0.0, big_blind=0.0)
+//   -> int: ハンド番号（同じhand_idが既にあればその番号）
+//   actions: (street, action, amount, pot_before[, all_in, to_call, stack]) の列
+//   pot_type: 0=不明, 1=リンプ, 2=シングルレイズ, 3=3bet, 4=4bet以上。villain: 主な相手のポジション
+//   allin_street: リバー前にオールインになったストリート(0-2)。villain_cards: その相手が見せた2枚
+//   invested: ヒーローの投入額（省略時はactionsの合計）。big_blind: ステーク（0=不明）
+static PyObject* hand_store_py_append(PyHandStore* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"hole", "board", "position", "pot", "profit", "hand_id",
+                                   "timestamp", "session", "won", "showdown", "equity", "eqr",
+                                   "ev", "opponents", "actions", "pot_type", "villain",
+                                   "flop_players", "allin_street", "villain_cards", "invested",
+                                   "rake", "big_blind", nullptr};
+    PyObject* hole_obj;
+    PyObject* board_obj = nullptr;
+    PyObject* won_obj = Py_None;
+    PyObject* actions_obj = nullptr;
+    int position = -1, showdown = 0, opponents = 0;
+    int pot_type = 0, villain = -1, flop_players = 0, allin_street = -1;
+    PyObject* villain_cards_obj = nullptr;
+    PyObject* invested_obj = Py_None;
+    double rake = 0.0, big_blind = 0.0;
+    double pot = 0.0, profit = 0.0, equity = 0.0, eqr = 0.0, ev = 0.0;
+    unsigned long long hand_id = 0;
+    long long timestamp = 0;
+    unsigned int session = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OiddKLIOpdddiOiiiiOOdd", const_cast<char**>(kwlist),
+                                     &hole_obj, &board_obj, &position, &pot, &profit, &hand_id,
+                                     &timestamp, &session, &won_obj, &showdown, &equity, &eqr,
+                                     &ev, &opponents, &actions_obj, &pot_type, &villain,
+                                     &flop_players, &allin_street, &villain_cards_obj,
+                                     &invested_obj, &rake, &big_blind)) {
+        return nullptr;
+    }
+
+    PokerStoredHand hand = {};
+    BufferView hole;
+    if (!hole.acquire(hole_obj, "hole", "Bb", 1) ||
+        !check_cards(hole.data<uint8_t>(), hole.size())) {
+        return nullptr;
+    }
+    if (hole.size() != 0 && hole.size() != 2) {
+        PyErr_SetString(PyExc_ValueError, "hole: expected 0 or 2 cards");
+        return nullptr;
+    }
+    for (Py_ssize_t i = 0; i < hole.size(); ++i) hand.hole |= uint64_t(1) << hole.data<uint8_t>()[i];
+    BufferView board;
+    if (!parse_board(board, board_obj)) return nullptr;
+    if (board_obj != nullptr && board_obj != Py_None) {
+        hand.board_count = static_cast<uint8_t>(board.size());
+        std::memcpy(hand.board_cards, board.data<uint8_t>(), hand.board_count);
+    }
+    if (position < -1 || position > 5 || villain < -1 || villain > 5) {
+        PyErr_SetString(PyExc_ValueError, "position out of range");
+        return nullptr;
+    }
+    if (pot_type < 0 || pot_type > 4 || flop_players < 0 || flop_players > 10 ||
+        allin_street < -1 || allin_street > 2) {
+        PyErr_SetString(PyExc_ValueError, "pot_type/flop_players/allin_street out of range");
+        return nullptr;
+    }
+    hand.villain_cards[0] = hand.villain_cards[1] = 0xFF;
+    if (villain_cards_obj != nullptr && villain_cards_obj != Py_None) {
+        BufferView villain_cards;
+        if (!villain_cards.acquire(villain_cards_obj, "villain_cards", "Bb", 1) ||
+            !check_cards(villain_cards.data<uint8_t>(), villain_cards.size())) {
+            return nullptr;
+        }
+        if (villain_cards.size() != 2) {
+            PyErr_SetString(PyExc_ValueError, "villain_cards: expected 2 cards");
+            return nullptr;
+        }
+        hand.villain_cards[0] = villain_cards.data<uint8_t>()[0];
+        hand.villain_cards[1] = villain_cards.data<uint8_t>()[1];
+    }
+
+    hand.hand_id = hand_id;
+    hand.timestamp = timestamp;
+    hand.pot = to_cents(pot);
+    hand.profit = to_cents(profit);
+    hand.equity = static_cast<float>(equity);
+    hand.eqr = static_cast<float>(eqr);
+    hand.ev = static_cast<float>(ev);
+    hand.session = session;
+    hand.position = position < 0 ? 0xFF : static_cast<uint8_t>(position);
+    hand.opponents = static_cast<uint8_t>(opponents);
+    hand.pot_type = static_cast<uint8_t>(pot_type);
+    hand.villain = static_cast<uint8_t>(villain + 1);
+    hand.flop_players = static_cast<uint8_t>(flop_players);
+    hand.allin_street = static_cast<uint8_t>(allin_street + 1);
+    hand.rake = static_cast<int32_t>(to_cents(rake));
+    hand.big_blind = static_cast<int32_t>(std::clamp<int64_t>(to_cents(big_blind), 0, INT32_MAX));
+    int won = won_obj == Py_None ? profit > 0.0 : PyObject_IsTrue(won_obj);
+    if (won < 0) return nullptr;
+    hand.flags = static_cast<uint8_t>((won ? 1 : 0) | (showdown ? 2 : 0));
+
+    std::vector<PokerStoredAction> actions;
+    if (actions_obj != nullptr && actions_obj != Py_None) {
+        PyObject* seq = PySequence_Fast(actions_obj, "actions: expected a sequence of tuples");
+        if (seq == nullptr) return nullptr;
+        Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+        actions.resize(static_cast<size_t>(n));
+        for (Py_ssize_t i = 0; i < n; ++i) {
+            int street, action, all_in = 0;
+            double amount, pot_before, to_call = 0.0, stack = 0.0;
+            if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(seq, i), "iidd|pdd;actions: expected "
+                                  "(street, action, amount, pot_before[, all_in, to_call, stack])",
+                                  &street, &action, &amount, &pot_before, &all_in,
+                                  &to_call, &stack)) {
+                Py_DECREF(seq);
+                return nullptr;
+            }
+            if (street < 0 || street > 3 || action < 0 || action > 5) {
+                Py_DECREF(seq);
+                PyErr_SetString(PyExc_ValueError, "actions: street/action out of range");
+                return nullptr;
+            }
+            PokerStoredAction& a = actions[static_cast<size_t>(i)];
+            a.street = static_cast<uint8_t>(street);
+            a.action = static_cast<uint8_t>(action);
+            a.all_in = static_cast<uint8_t>(all_in);
+            a.amount = static_cast<int32_t>(to_cents(amount));
+            a.pot_before = static_cast<int32_t>(to_cents(pot_before));
+            a.to_call = static_cast<int32_t>(to_cents(to_call));
+            a.stack = static_cast<int32_t>(to_cents(stack));
+        }
+        Py_DECREF(seq);
+    }
+    if (invested_obj != Py_None) {
+        double v = PyFloat_AsDouble(invested_obj);
+        if (v == -1.0 && PyErr_Occurred()) return nullptr;
+        hand.invested = static_cast<int32_t>(to_cents(v));
+    } else {
+        for (const PokerStoredAction& a : actions) hand.invested += a.amount;
+    }
+
+    int64_t index = hand_store_append(self->handle, &hand, actions.data(),
+                                      static_cast<int>(actions.size()));
+    if (index < 0) {
+        PyErr_SetString(PyExc_OSError, "hand store append failed");
+        return nullptr;
+    }
+    return PyLong_FromLongLong(index);
+}
+
+// flush(): 追加済みの全ハンドが書き込まれるまで待つ
+static PyObject* hand_store_py_flush(PyHandStore* self, PyObject*) {
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = hand_store_flush(self->handle);
+    Py_END_ALLOW_THREADS
+    if (result != 0) {
+        PyErr_SetString(PyExc_OSError, "hand store write failed");
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+// refresh() -> int: 読み取り専用で開いた場合に他プロセスの追記を反映する
+static PyObject* hand_store_py_refresh(PyHandStore* self, PyObject*) {
+    int64_t count;
+    Py_BEGIN_ALLOW_THREADS
+    count = hand_store_refresh(self->handle);
+    Py_END_ALLOW_THREADS
+    if (count < 0) {
+        PyErr_SetString(PyExc_OSError, "hand store refresh failed");
+        return nullptr;
+    }
+    return PyLong_FromLongLong(count);
+}
+
+static PyObject* hand_store_py_count(PyHandStore* self, PyObject*) {
+    return PyLong_FromUnsignedLongLong(hand_store_count(self->handle));
+}
+
+// find(hand_id) -> int | None
+static PyObject* hand_store_py_find(PyHandStore* self, PyObject* args) {
+    unsigned long long hand_id;
+    if (!PyArg_ParseTuple(args, "K", &hand_id)) return nullptr;
+    int64_t index = hand_store_find(self->handle, hand_id);
+    if (index < 0) Py_RETURN_NONE;
+    return PyLong_FromLongLong(index);
+}
+
+// get(index) -> dict | None
+static PyObject* hand_store_py_get(PyHandStore* self, PyObject* args) {
+    unsigned long long index;
+    if (!PyArg_ParseTuple(args, "K", &index)) return nullptr;
+    PokerStoredHand h;
+    std::vector<PokerStoredAction> actions(64);
+    int n = hand_store_get(self->handle, index, &h, actions.data(), static_cast<int>(actions.size()));
+    if (n < 0) Py_RETURN_NONE;
+    if (n > static_cast<int>(actions.size())) {
+        actions.resize(static_cast<size_t>(n));
+        n = hand_store_get(self->handle, index, &h, actions.data(), n);
+    }
+
+    char hole[2];
+    int hole_count = 0;
+    for (int c = 0; c < DECK_SIZE && hole_count < 2; ++c) {
+        if ((h.hole >> c) & 1) hole[hole_count++] = static_cast<char>(c);
+    }
+    PyObject* action_list = PyList_New(n);
+    if (action_list == nullptr) return nullptr;
+    for (int k = 0; k < n; ++k) {
+        const PokerStoredAction& a = actions[static_cast<size_t>(k)];
+        PyObject* item = Py_BuildValue("(iiddNdd)", a.street, a.action, a.amount / 100.0,
+                                       a.pot_before / 100.0, PyBool_FromLong(a.all_in),
+                                       a.to_call / 100.0, a.stack / 100.0);
+        if (item == nullptr) {
+            Py_DECREF(action_list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(action_list, k, item);
+    }
+    const char* session = hand_store_session_name(self->handle, h.session);
+    // 不明(255)はNone
+    auto optional = [](uint8_t value, uint8_t limit) -> PyObject* {
+        if (value < limit) return PyLong_FromLong(value);
+        Py_RETURN_NONE;
+    };
+    PyObject* position = optional(h.position, 6);
+    PyObject* hole_class = optional(h.hole_class, 169);
+    PyObject* texture = optional(h.texture, 4);
+    PyObject* villain = optional(static_cast<uint8_t>(h.villain - 1), 6);
+    PyObject* allin_street = optional(static_cast<uint8_t>(h.allin_street - 1), 3);
+    bool villain_known = h.villain_cards[0] < DECK_SIZE && h.villain_cards[1] < DECK_SIZE;
+    return Py_BuildValue(
+        "{s:K,s:L,s:s,s:N,s:y#,s:y#,s:N,s:N,s:d,s:d,s:N,s:N,s:d,s:d,s:d,s:i,s:i,s:N,s:i,"
+        "s:N,s:y#,s:d,s:d,s:d,s:N}",
+        "hand_id", static_cast<unsigned long long>(h.hand_id),
+        "timestamp", static_cast<long long>(h.timestamp),
+        "session", session != nullptr ? session : "",
+        "position", position,
+        "hole", hole, static_cast<Py_ssize_t>(hole_count),
+        "board", reinterpret_cast<const char*>(h.board_cards), static_cast<Py_ssize_t>(h.board_count),
+        "hole_class", hole_class,
+        "texture", texture,
+        "pot", h.pot / 100.0,
+        "profit", h.profit / 100.0,
+        "won", PyBool_FromLong(h.flags & 1),
+        "showdown", PyBool_FromLong((h.flags >> 1) & 1),
+        "equity", double(h.equity),
+        "eqr", double(h.eqr),
+        "ev", double(h.ev),
+        "opponents", h.opponents,
+        "pot_type", h.pot_type,
+        "villain", villain,
+        "flop_players", h.flop_players,
+        "allin_street", allin_street,
+        "villain_cards", reinterpret_cast<const char*>(h.villain_cards),
+        static_cast<Py_ssize_t>(villain_known ? 2 : 0),
+        "invested", h.invested / 100.0,
+        "rake", h.rake / 100.0,
+        "big_blind", h.big_blind / 100.0,
+        "actions", action_list);
+}
+
+// 整数の列をビット集合へ（Noneなら0 = 指定なし）
+static bool mask_from_sequence(PyObject* obj, const char* name, int limit, uint64_t* words) {
+    if (obj == nullptr || obj == Py_None) return true;
+    PyObject* seq = PySequence_Fast(obj, name);
+    if (seq == nullptr) return false;
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i) {
+        long v = PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i));
+        if (v == -1 && PyErr_Occurred()) {
+            Py_DECREF(seq);
+            return false;
+        }
+        if (v < 0 || v >= limit) {
+            Py_DECREF(seq);
+            PyErr_Format(PyExc_ValueError, "%s: value %ld out of range", name, v);
+            return false;
+        }
+        words[v >> 6] |= uint64_t(1) << (v & 63);
+    }
+    Py_DECREF(seq);
+    return true;
+}
+
+// 検索条件（キーワード引数）: session, positions (6=不明), classes (0-168),
+// textures (4=フロップなし), won, showdown, min_pot, start, end
+static bool parse_hand_query(PyObject* args, PyObject* kwargs, PokerHandQuery& q) {
+    static const char* kwlist[] = {"session", "positions", "classes", "textures", "won",
+                                   "showdown", "min_pot", "start", "end", nullptr};
+    PyObject* session = Py_None;
+    PyObject* positions = nullptr;
+    PyObject* classes = nullptr;
+    PyObject* textures = nullptr;
+    PyObject* won = Py_None;
+    PyObject* showdown = Py_None;
+    PyObject* min_pot = Py_None;
+    long long start = 0, end = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$OOOOOOOLL", const_cast<char**>(kwlist),
+                                     &session, &positions, &classes, &textures, &won,
+                                     &showdown, &min_pot, &start, &end)) {
+        return false;
+    }
+
+    std::memset(&q, 0, sizeof(q));
+    q.session = -1;
+    q.won = -1;
+    q.showdown = -1;
+    if (session != Py_None) {
+        q.session = PyLong_AsLongLong(session);
+        if (q.session == -1 && PyErr_Occurred()) return false;
+    }
+    uint64_t position_mask = 0, texture_mask = 0;
+    if (!mask_from_sequence(positions, "positions", 7, &position_mask) ||
+        !mask_from_sequence(textures, "textures", 5, &texture_mask) ||
+        !mask_from_sequence(classes, "classes", 169, q.class_mask)) {
+        return false;
+    }
+    q.position_mask = static_cast<uint32_t>(position_mask);
+    q.texture_mask = static_cast<uint32_t>(texture_mask);
+    if (won != Py_None && (q.won = PyObject_IsTrue(won)) < 0) return false;
+    if (showdown != Py_None && (q.showdown = PyObject_IsTrue(showdown)) < 0) return false;
+    if (min_pot != Py_None) {
+        double v = PyFloat_AsDouble(min_pot);
+        if (v == -1.0 && PyErr_Occurred()) return false;
+        q.min_pot = to_cents(v);
+    }
+    q.start_time = start;
+    q.end_time = end;
+    return true;
+}
+
+// query(**filters) -> list[int]: 条件に合うハンド番号（追加順）
+static PyObject* hand_store_py_query(PyHandStore* self, PyObject* args, PyObject* kwargs) {
+    PokerHandQuery q;
+    if (!parse_hand_query(args, kwargs, q)) return nullptr;
+
+    std::vector<uint32_t> ids(4096);
+    int64_t total;
+    while (true) {
+        Py_BEGIN_ALLOW_THREADS
+        total = hand_store_query(self->handle, &q, ids.data(), static_cast<int64_t>(ids.size()));
+        Py_END_ALLOW_THREADS
+        if (total <= static_cast<int64_t>(ids.size())) break;
+        ids.resize(static_cast<size_t>(total));   // 件数が確定したので取り直す
+    }
+
+    PyObject* list = PyList_New(total);
+    if (list == nullptr) return nullptr;
+    for (int64_t i = 0; i < total; ++i) {
+        PyObject* item = PyLong_FromUnsignedLong(ids[static_cast<size_t>(i)]);
+        if (item == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+// position_stats(**filters) -> list[dict]: ポジション別（添字6=不明）の件数・勝ち数・収支・平均エクイティ
+static PyObject* hand_store_py_position_stats(PyHandStore* self, PyObject* args, PyObject* kwargs) {
+    PokerHandQuery q;
+    if (!parse_hand_query(args, kwargs, q)) return nullptr;
+
+    PokerPositionStats stats[7];
+    Py_BEGIN_ALLOW_THREADS
+    hand_store_position_stats(self->handle, &q, stats);
+    Py_END_ALLOW_THREADS
+
+    PyObject* list = PyList_New(7);
+    if (list == nullptr) return nullptr;
+    for (int p = 0; p < 7; ++p) {
+        const PokerPositionStats& s = stats[p];
+        PyObject* item = Py_BuildValue(
+            "{s:K,s:K,s:d,s:d}",
+            "hands", static_cast<unsigned long long>(s.hands),
+            "won", static_cast<unsigned long long>(s.won),
+            "profit", s.profit / 100.0,
+            "avg_equity", s.hands > 0 ? s.equity_sum / double(s.hands) : 0.0);
+        if (item == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, p, item);
+    }
+    return list;
+}
+
+// step53の索引（初回に作る。GILの下なので競合しない）
+static void* hand_store_query_handle(PyHandStore* self) {
+    if (self->query == nullptr) {
+        void* query;
+        Py_BEGIN_ALLOW_THREADS
+        query = hand_query_open(self->handle);
+        Py_END_ALLOW_THREADS
+        if (self->query == nullptr) {
+            self->query = query;
+        } else {
+            hand_query_close(query);   // 索引構築中に別スレッドが先に作った
+        }
+    }
+    return self->query;
+}
+
+// search(expression) -> list[int]: 条件式（step53）に合うハンド番号（追加順）
+static PyObject* hand_store_py_search(PyHandStore* self, PyObject* args) {
+    const char* expression;
+    if (!PyArg_ParseTuple(args, "s", &expression)) return nullptr;
+    void* query = hand_store_query_handle(self);
+
+    std::vector<uint32_t> ids(4096);
+    int64_t total;
+    while (true) {
+        Py_BEGIN_ALLOW_THREADS
+        total = hand_query_select(query, expression, ids.data(), static_cast<int64_t>(ids.size()));
+        Py_END_ALLOW_THREADS
+        if (total < 0) {
+            PyErr_SetString(PyExc_ValueError, hand_query_error());
+            return nullptr;
+        }
+        if (total <= static_cast<int64_t>(ids.size())) break;
+        ids.resize(static_cast<size_t>(total));   // 取り直しの間に増えた分は次のループで拾う
+    }
+
+    PyObject* list = PyList_New(total);
+    if (list == nullptr) return nullptr;
+    for (int64_t i = 0; i < total; ++i) {
+        PyObject* item = PyLong_FromUnsignedLong(ids[static_cast<size_t>(i)]);
+        if (item == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+// count_where(expression) -> int
+static PyObject* hand_store_py_count_where(PyHandStore* self, PyObject* args) {
+    const char* expression;
+    if (!PyArg_ParseTuple(args, "s", &expression)) return nullptr;
+    void* query = hand_store_query_handle(self);
+    int64_t total;
+    Py_BEGIN_ALLOW_THREADS
+    total = hand_query_select(query, expression, nullptr, 0);
+    Py_END_ALLOW_THREADS
+    if (total < 0) {
+        PyErr_SetString(PyExc_ValueError, hand_query_error());
+        return nullptr;
+    }
+    return PyLong_FromLongLong(total);
+}
+
+// analyze(expression="", group_by="position") -> list[dict]
+//   group_by: none / position / villain / pot / class / texture / made（hand_query_aggregateの順）
+//   各グループの件数・勝ち数・ショーダウン数・収支・平均エクイティ。最後の要素は「不明」
+static PyObject* hand_store_py_analyze(PyHandStore* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"expression", "group_by", nullptr};
+    static const char* groups[] = {"none", "position", "villain", "pot", "class", "texture", "made"};
+    const char* expression = "";
+    const char* group_name = "position";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ss", const_cast<char**>(kwlist),
+                                     &expression, &group_name)) {
+        return nullptr;
+    }
+    int group_by = -1;
+    for (int g = 0; g < 7; ++g) {
+        if (std::strcmp(group_name, groups[g]) == 0) group_by = g;
+    }
+    if (group_by < 0) {
+        PyErr_Format(PyExc_ValueError, "unknown group_by: %s", group_name);
+        return nullptr;
+    }
+    void* query = hand_store_query_handle(self);
+
+    std::vector<PokerQueryGroup> out(static_cast<size_t>(hand_query_group_size(group_by)));
+    int n;
+    Py_BEGIN_ALLOW_THREADS
+    n = hand_query_aggregate(query, expression, group_by, out.data());
+    Py_END_ALLOW_THREADS
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, hand_query_error());
+        return nullptr;
+    }
+
+    PyObject* list = PyList_New(n);
+    if (list == nullptr) return nullptr;
+    for (int g = 0; g < n; ++g) {
+        const PokerQueryGroup& s = out[static_cast<size_t>(g)];
+        PyObject* item = Py_BuildValue(
+            "{s:K,s:K,s:K,s:d,s:d}",
+            "hands", static_cast<unsigned long long>(s.hands),
+            "won", static_cast<unsigned long long>(s.won),
+            "showdown", static_cast<unsigned long long>(s.showdown),
+            "profit", s.profit / 100.0,
+            "avg_equity", s.hands > 0 ? s.equity_sum / double(s.hands) : 0.0);
+        if (item == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, g, item);
+    }
+    return list;
+}
+
+// step54の結果列（初回に開く。別プロセスが書き込み中なら読み取り専用で開く）
+static void* hand_store_allin_handle(PyHandStore* self) {
+    if (self->allin == nullptr) {
+        void* allin;
+        std::string error;
+        Py_BEGIN_ALLOW_THREADS
+        allin = allin_ev_open(self->handle, 0);
+        if (allin == nullptr) {
+            error = allin_ev_error();
+            allin = allin_ev_open(self->handle, 1);
+        }
+        Py_END_ALLOW_THREADS
+        if (allin == nullptr) {
+            PyErr_SetString(PyExc_OSError, error.c_str());
+            return nullptr;
+        }
+        if (self->allin == nullptr) {
+            self->allin = allin;
+        } else {
+            allin_ev_close(allin);
+        }
+    }
+    return self->allin;
+}
+
+// allin_ev(threads=0) -> int: 未処理のハンドのオールインEVを計算して結果列に追記する（今回処理した件数）
+static PyObject* hand_store_py_allin_ev(PyHandStore* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"threads", nullptr};
+    int threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i", const_cast<char**>(kwlist), &threads)) {
+        return nullptr;
+    }
+    void* allin = hand_store_allin_handle(self);
+    if (allin == nullptr) return nullptr;
+    int64_t processed;
+    Py_BEGIN_ALLOW_THREADS
+    processed = allin_ev_update(allin, threads);
+    Py_END_ALLOW_THREADS
+    if (processed < 0) {
+        PyErr_SetString(PyExc_OSError, allin_ev_error());
+        return nullptr;
+    }
+    return PyLong_FromLongLong(processed);
+}
+
+static PyObject* street_list(const float* values) {
+    return Py_BuildValue("[dddd]", double(values[0]), double(values[1]), double(values[2]),
+                         double(values[3]));
+}
+
+template <class T>
+static PyObject* street_cents(const T* values) {
+    return Py_BuildValue("[dddd]", values[0] / 100.0, values[1] / 100.0, values[2] / 100.0,
+                         values[3] / 100.0);
+}
+
+// allin_result(index) -> dict | None: 未処理ならNone
+static PyObject* hand_store_py_allin_result(PyHandStore* self, PyObject* args) {
+    unsigned long long index;
+    if (!PyArg_ParseTuple(args, "K", &index)) return nullptr;
+    void* allin = hand_store_allin_handle(self);
+    if (allin == nullptr) return nullptr;
+    PokerAllInResult r;
+    if (allin_ev_get(allin, index, &r) != 0) Py_RETURN_NONE;
+    static const char* statuses[] = {"none", "computed", "skipped"};
+    PyObject* street;
+    if (r.street < 3) {
+        street = PyLong_FromLong(r.street);
+    } else {
+        street = Py_None;
+        Py_INCREF(street);
+    }
+    return Py_BuildValue(
+        "{s:K,s:s,s:N,s:d,s:d,s:d,s:N,s:N,s:N}",
+        "hand_id", static_cast<unsigned long long>(r.hand_id),
+        "status", statuses[r.status < 3 ? r.status : 0],
+        "street", street,
+        "equity", double(r.equity),
+        "ev_profit", r.ev_profit / 100.0,
+        "luck", r.luck / 100.0,
+        "street_equity", street_list(r.street_equity),
+        "street_luck", street_cents(r.street_luck),
+        "ev_loss", street_cents(r.ev_loss));
+}
+
+// allin_summary(**filters) -> dict: 処理済みのハンドの実収支・EV調整収支・運（queryと同じ条件）
+static PyObject* hand_store_py_allin_summary(PyHandStore* self, PyObject* args, PyObject* kwargs) {
+    PokerHandQuery q;
+    if (!parse_hand_query(args, kwargs, q)) return nullptr;
+    void* allin = hand_store_allin_handle(self);
+    if (allin == nullptr) return nullptr;
+    PokerAllInSummary s;
+    Py_BEGIN_ALLOW_THREADS
+    allin_ev_summary(allin, &q, &s);
+    Py_END_ALLOW_THREADS
+    return Py_BuildValue(
+        "{s:K,s:K,s:K,s:d,s:d,s:d,s:d,s:N,s:N}",
+        "hands", static_cast<unsigned long long>(s.hands),
+        "allin_hands", static_cast<unsigned long long>(s.allin_hands),
+        "skipped", static_cast<unsigned long long>(s.skipped),
+        "profit", s.profit / 100.0,
+        "ev_profit", s.ev_profit / 100.0,
+        "luck", s.luck / 100.0,
+        "avg_allin_equity", s.allin_hands > 0 ? s.allin_equity_sum / double(s.allin_hands) : 0.0,
+        "street_luck", street_cents(s.street_luck),
+        "ev_loss", street_cents(s.ev_loss));
+}
+
+static const char* AUDIT_STREETS[] = {"preflop", "flop", "turn", "river"};
+static const char* AUDIT_ACTIONS[] = {"fold", "check", "call", "bet", "raise"};
+
+// audit(threads=0, top=20, model=None, **filters) -> dict: ヒーローの判断をEV最大のアクションと比べる
+//   leaks: ストリート×実際のアクション別の件数・ミス・EV損失、worst: 損失の大きい順の判断
+static PyObject* hand_store_py_audit(PyHandStore* self, PyObject* args, PyObject* kwargs) {
+    int threads = 0;
+    long long top = 20;
+    void* model = nullptr;
+    PokerHandQuery q;
+    // threads/top/modelを取り除いた残りがqueryと同じ条件
+    PyObject* filters = kwargs != nullptr ? PyDict_Copy(kwargs) : PyDict_New();
+    if (filters == nullptr) return nullptr;
+    bool ok = true;
+    PyObject* value;
+    if (ok && (value = PyDict_GetItemString(filters, "threads")) != nullptr) {
+        threads = static_cast<int>(PyLong_AsLong(value));
+        ok = !PyErr_Occurred() && PyDict_DelItemString(filters, "threads") == 0;
+    }
+    if (ok && (value = PyDict_GetItemString(filters, "top")) != nullptr) {
+        top = PyLong_AsLongLong(value);
+        ok = !PyErr_Occurred() && PyDict_DelItemString(filters, "top") == 0;
+    }
+    if (ok && (value = PyDict_GetItemString(filters, "model")) != nullptr) {
+        if (value != Py_None) {
+            if (!PyObject_TypeCheck(value, &EQRModelType)) {
+                PyErr_SetString(PyExc_TypeError, "model: expected EQRModel");
+                ok = false;
+            } else {
+                model = reinterpret_cast<PyEQRModel*>(value)->handle;
+            }
+        }
+        ok = ok && PyDict_DelItemString(filters, "model") == 0;
+    }
+    ok = ok && parse_hand_query(args, filters, q);
+    Py_DECREF(filters);
+    if (!ok) return nullptr;
+    if (top < 0) {
+        PyErr_SetString(PyExc_ValueError, "top must be >= 0");
+        return nullptr;
+    }
+
+    std::vector<PokerAuditDecision> worst(static_cast<size_t>(top));
+    PokerAuditSummary s;
+    int64_t written;
+    Py_BEGIN_ALLOW_THREADS
+    written = decision_audit(self->handle, model, &q, threads, worst.data(), top, &s);
+    Py_END_ALLOW_THREADS
+
+    PyObject* leaks = PyList_New(0);
+    if (leaks == nullptr) return nullptr;
+    for (int st = 0; st < 4; ++st) {
+        for (int a = 0; a < 5; ++a) {
+            const PokerAuditCell& c = s.cells[st][a];
+            if (c.decisions == 0) continue;
+            PyObject* item = Py_BuildValue(
+                "{s:s,s:s,s:K,s:K,s:d,s:{s:K,s:K,s:K,s:K,s:K}}",
+                "street", AUDIT_STREETS[st],
+                "action", AUDIT_ACTIONS[a],
+                "decisions", static_cast<unsigned long long>(c.decisions),
+                "mistakes", static_cast<unsigned long long>(c.mistakes),
+                "ev_loss", c.ev_loss / 100.0,
+                "best",
+                "fold", static_cast<unsigned long long>(c.recommended[0]),
+                "check", static_cast<unsigned long long>(c.recommended[1]),
+                "call", static_cast<unsigned long long>(c.recommended[2]),
+                "bet", static_cast<unsigned long long>(c.recommended[3]),
+                "raise", static_cast<unsigned long long>(c.recommended[4]));
+            if (item == nullptr || PyList_Append(leaks, item) != 0) {
+                Py_XDECREF(item);
+                Py_DECREF(leaks);
+                return nullptr;
+            }
+            Py_DECREF(item);
+        }
+    }
+
+    PyObject* worst_list = PyList_New(written);
+    if (worst_list == nullptr) {
+        Py_DECREF(leaks);
+        return nullptr;
+    }
+    for (int64_t i = 0; i < written; ++i) {
+        const PokerAuditDecision& d = worst[static_cast<size_t>(i)];
+        PyObject* item = Py_BuildValue(
+            "{s:K,s:k,s:i,s:s,s:s,s:s,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d}",
+            "hand_id", static_cast<unsigned long long>(d.hand_id),
+            "index", static_cast<unsigned long>(d.hand_index),
+            "action_index", static_cast<int>(d.action_index),
+            "street", AUDIT_STREETS[d.street < 4 ? d.street : 0],
+            "action", AUDIT_ACTIONS[d.action < 5 ? d.action : 0],
+            "best_action", AUDIT_ACTIONS[d.best_action < 5 ? d.best_action : 0],
+            "equity", double(d.equity),
+            "realized", double(d.realized),
+            "pot", d.pot / 100.0,
+            "to_call", d.to_call / 100.0,
+            "amount", d.amount / 100.0,
+            "best_amount", d.best_amount / 100.0,
+            "ev_actual", d.ev_actual / 100.0,
+            "ev_best", d.ev_best / 100.0,
+            "ev_loss", d.ev_loss / 100.0);
+        if (item == nullptr) {
+            Py_DECREF(leaks);
+            Py_DECREF(worst_list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(worst_list, i, item);
+    }
+    return Py_BuildValue(
+        "{s:K,s:K,s:K,s:d,s:K,s:N,s:N}",
+        "hands", static_cast<unsigned long long>(s.hands),
+        "decisions", static_cast<unsigned long long>(s.decisions),
+        "mistakes", static_cast<unsigned long long>(s.mistakes),
+        "ev_loss", s.ev_loss / 100.0,
+        "groups", static_cast<unsigned long long>(s.groups),
+        "leaks", leaks,
+        "worst", worst_list);
+}
+
+static PyMethodDef hand_store_methods[] = {
+    {"session", as_cfunction(hand_store_py_session), METH_VARARGS,
+     "session(name) -> int: セッション番号（未登録なら追加。読み取り専用ではKeyError）"},
+    {"append", as_cfunction(hand_store_py_append), METH_VARARGS | METH_KEYWORDS,
+     "append(hole, board=None, position=-1, pot=0.0, profit=0.0, hand_id=0, timestamp=0, "
+     "session=0, won=None, showdown=False, equity=0.0, eqr=0.0, ev=0.0, opponents=0, "
+     "actions=(), pot_type=0, villain=-1, flop_players=0, allin_street=-1, villain_cards=None, "
+     "invested=None, rake=0.0, big_blind=0.0) -> int"},
+    {"flush", as_cfunction(hand_store_py_flush), METH_NOARGS,
+     "flush(): 追加済みの全ハンドの書き込みを待つ"},
+    {"refresh", as_cfunction(hand_store_py_refresh), METH_NOARGS,
+     "refresh() -> int: 他プロセスの追記を反映（読み取り専用）"},
+    {"count", as_cfunction(hand_store_py_count), METH_NOARGS,
+     "count() -> int: 検索可能なハンド数"},
+    {"find", as_cfunction(hand_store_py_find), METH_VARARGS,
+     "find(hand_id) -> int | None"},
+    {"get", as_cfunction(hand_store_py_get), METH_VARARGS,
+     "get(index) -> dict | None"},
+    {"query", as_cfunction(hand_store_py_query), METH_VARARGS | METH_KEYWORDS,
+     "query(session=None, positions=None, classes=None, textures=None, won=None, "
+     "showdown=None, min_pot=None, start=0, end=0) -> list[int]"},
+    {"position_stats", as_cfunction(hand_store_py_position_stats), METH_VARARGS | METH_KEYWORDS,
+     "position_stats(**filters) -> list[dict]: ポジション別集計（添字6=不明）"},
+    {"search", as_cfunction(hand_store_py_search), METH_VARARGS,
+     "search(expression) -> list[int]: 条件式に合うハンド番号 "
+     "(例: 'position=BTN & pot=3bet & (made=pair | draw=flush,oesd)')"},
+    {"count_where", as_cfunction(hand_store_py_count_where), METH_VARARGS,
+     "count_where(expression) -> int"},
+    {"analyze", as_cfunction(hand_store_py_analyze), METH_VARARGS | METH_KEYWORDS,
+     "analyze(expression='', group_by='position') -> list[dict]: 条件式に合うハンドのグループ別集計"},
+    {"allin_ev", as_cfunction(hand_store_py_allin_ev), METH_VARARGS | METH_KEYWORDS,
+     "allin_ev(threads=0) -> int: 未処理のハンドのオールインEVを計算（path.allinに追記）"},
+    {"allin_result", as_cfunction(hand_store_py_allin_result), METH_VARARGS,
+     "allin_result(index) -> dict | None"},
+    {"allin_summary", as_cfunction(hand_store_py_allin_summary), METH_VARARGS | METH_KEYWORDS,
+     "allin_summary(**filters) -> dict: 実収支・オールイン調整収支・運・ストリート別の運とEV損失"},
+    {"audit", as_cfunction(hand_store_py_audit), METH_VARARGS | METH_KEYWORDS,
+     "audit(threads=0, top=20, model=None, **filters) -> dict: 判断ごとのEV損失とリーク集計"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+// ===== 集計キューブ =====
+
+struct PyAggregateCube {
+    PyObject_HEAD
+    void* handle;
+};
+
+static PyTypeObject AggregateCubeType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// AggregateCube(path=None, utc_offset=0): pathを指定すると保存済みのキューブを開く
+static PyObject* aggregate_cube_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"path", "utc_offset", nullptr};
+    const char* path = nullptr;
+    int utc_offset = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|zi", const_cast<char**>(kwlist),
+                                     &path, &utc_offset)) {
+        return nullptr;
+    }
+    void* handle;
+    if (path != nullptr) {
+        Py_BEGIN_ALLOW_THREADS
+        handle = aggregate_cube_open(path);
+        Py_END_ALLOW_THREADS
+        if (handle == nullptr) {
+            PyErr_Format(PyExc_OSError, "cannot open aggregate cube: %s", aggregate_cube_error());
+            return nullptr;
+        }
+    } else {
+        handle = aggregate_cube_create(utc_offset);
+    }
+    PyAggregateCube* self = reinterpret_cast<PyAggregateCube*>(type->tp_alloc(type, 0));
+    if (self == nullptr) {
+        aggregate_cube_close(handle);
+        return nullptr;
+    }
+    self->handle = handle;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void aggregate_cube_dealloc(PyAggregateCube* self) {
+    aggregate_cube_close(self->handle);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+// add(profit, timestamp=0, session=0, position=-1, hole_class=-1, big_blind=0.0, won=None)
+static PyObject* aggregate_cube_py_add(PyAggregateCube* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"profit", "timestamp", "session", "position", "hole_class",
+                                   "big_blind", "won", nullptr};
+    double profit, big_blind = 0.0;
+    long long timestamp = 0;
+    unsigned int session = 0;
+    int position = -1, hole_class = -1;
+    PyObject* won_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "d|LIiidO", const_cast<char**>(kwlist),
+                                     &profit, &timestamp, &session, &position, &hole_class,
+                                     &big_blind, &won_obj)) {
+        return nullptr;
+    }
+    if (position < -1 || position > 5 || hole_class < -1 || hole_class > 168) {
+        PyErr_SetString(PyExc_ValueError, "position/hole_class out of range");
+        return nullptr;
+    }
+    int won = won_obj == Py_None ? profit > 0.0 : PyObject_IsTrue(won_obj);
+    if (won < 0) return nullptr;
+    PokerCubeFact fact = {};
+    fact.timestamp = timestamp;
+    fact.profit = to_cents(profit);
+    fact.session = session;
+    fact.big_blind = static_cast<int32_t>(std::clamp<int64_t>(to_cents(big_blind), 0, INT32_MAX));
+    fact.position = position < 0 ? 0xFF : static_cast<uint8_t>(position);
+    fact.hole_class = hole_class < 0 ? 0xFF : static_cast<uint8_t>(hole_class);
+    fact.won = static_cast<uint8_t>(won);
+    aggregate_cube_add(self->handle, &fact, 1);
+    Py_RETURN_NONE;
+}
+
+// sync(store) -> int: ハンドストアの未取り込み分を足す（今回取り込んだ件数）
+static PyObject* aggregate_cube_py_sync(PyAggregateCube* self, PyObject* args) {
+    PyObject* store_obj;
+    if (!PyArg_ParseTuple(args, "O!", &HandStoreType, &store_obj)) return nullptr;
+    int64_t added;
+    Py_BEGIN_ALLOW_THREADS
+    added = aggregate_cube_sync(self->handle, reinterpret_cast<PyHandStore*>(store_obj)->handle);
+    Py_END_ALLOW_THREADS
+    if (added < 0) {
+        PyErr_SetString(PyExc_ValueError, aggregate_cube_error());
+        return nullptr;
+    }
+    return PyLong_FromLongLong(added);
+}
+
+static PyObject* aggregate_cube_py_save(PyAggregateCube* self, PyObject* args) {
+    const char* path;
+    if (!PyArg_ParseTuple(args, "s", &path)) return nullptr;
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = aggregate_cube_save(self->handle, path);
+    Py_END_ALLOW_THREADS
+    if (result != 0) {
+        PyErr_SetString(PyExc_OSError, aggregate_cube_error());
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* aggregate_cube_py_count(PyAggregateCube* self, PyObject*) {
+    return PyLong_FromUnsignedLongLong(aggregate_cube_count(self->handle));
+}
+
+// 絞り込み（キーワード引数）: session, position (6=不明), hole_class (169=不明), big_blind, start, end
+static bool parse_cube_query(PyObject* args, PyObject* kwargs, PokerCubeQuery& q) {
+    static const char* kwlist[] = {"session", "position", "hole_class", "big_blind",
+                                   "start", "end", nullptr};
+    PyObject* session = Py_None;
+    PyObject* position = Py_None;
+    PyObject* hole_class = Py_None;
+    PyObject* big_blind = Py_None;
+    long long start = 0, end = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$OOOOLL", const_cast<char**>(kwlist),
+                                     &session, &position, &hole_class, &big_blind,
+                                     &start, &end)) {
+        return false;
+    }
+    auto integer = [](PyObject* obj, int64_t& out) {
+        if (obj == Py_None) return true;
+        out = PyLong_AsLongLong(obj);
+        return !(out == -1 && PyErr_Occurred());
+    };
+    int64_t pos = -1, cls = -1;
+    q.session = -1;
+    q.big_blind = -1;
+    if (!integer(session, q.session) || !integer(position, pos) || !integer(hole_class, cls)) {
+        return false;
+    }
+    if (pos < -1 || pos > 6 || cls < -1 || cls > 169) {
+        PyErr_SetString(PyExc_ValueError, "position/hole_class out of range");
+        return false;
+    }
+    if (big_blind != Py_None) {
+        double v = PyFloat_AsDouble(big_blind);
+        if (v == -1.0 && PyErr_Occurred()) return false;
+        q.big_blind = to_cents(v);
+    }
+    q.position = static_cast<int32_t>(pos);
+    q.hole_class = static_cast<int32_t>(cls);
+    q.start_time = start;
+    q.end_time = end;
+    return true;
+}
+
+// 件数・勝率・収支の合計/平均/分散（母分散）/最小/最大
+static PyObject* cube_cell_dict(const PokerCubeCell& c) {
+    double n = double(c.count);
+    double mean = c.count > 0 ? c.sum / n : 0.0;
+    double variance = c.count > 0 ? std::max(0.0, c.sum_sq / n - mean * mean) : 0.0;
+    return Py_BuildValue(
+        "{s:K,s:K,s:d,s:d,s:d,s:d,s:d,s:d,s:d}",
+        "hands", static_cast<unsigned long long>(c.count),
+        "won", static_cast<unsigned long long>(c.won),
+        "win_rate", c.count > 0 ? c.won / n : 0.0,
+        "profit", c.sum / 100.0,
+        "mean", mean / 100.0,
+        "variance", variance / 10000.0,
+        "std_dev", std::sqrt(variance) / 100.0,
+        "min", c.min / 100.0,
+        "max", c.max / 100.0);
+}
+
+// rollup(**filters) -> dict
+static PyObject* aggregate_cube_py_rollup(PyAggregateCube* self, PyObject* args, PyObject* kwargs) {
+    PokerCubeQuery q;
+    if (!parse_cube_query(args, kwargs, q)) return nullptr;
+    PokerCubeCell cell;
+    aggregate_cube_rollup(self->handle, &q, &cell);
+    return cube_cell_dict(cell);
+}
+
+static const char* CUBE_DIMENSIONS[] = {"session", "position", "stake", "day", "class"};
+
+// group(by, **filters) -> list[dict]: byの値ごとの集計（'key'にその値、stakeはビッグブラインド）
+static PyObject* aggregate_cube_py_group(PyAggregateCube* self, PyObject* args, PyObject* kwargs) {
+    if (PyTuple_GET_SIZE(args) != 1 || !PyUnicode_Check(PyTuple_GET_ITEM(args, 0))) {
+        PyErr_SetString(PyExc_TypeError, "group(by, **filters): by must be a string");
+        return nullptr;
+    }
+    const char* by = PyUnicode_AsUTF8(PyTuple_GET_ITEM(args, 0));
+    if (by == nullptr) return nullptr;
+    int dimension = -1;
+    for (int d = 0; d < 5; ++d) {
+        if (std::strcmp(by, CUBE_DIMENSIONS[d]) == 0) dimension = d;
+    }
+    if (dimension < 0) {
+        PyErr_Format(PyExc_ValueError, "unknown dimension: %s", by);
+        return nullptr;
+    }
+    PyObject* empty = PyTuple_New(0);
+    if (empty == nullptr) return nullptr;
+    PokerCubeQuery q;
+    bool ok = parse_cube_query(empty, kwargs, q);
+    Py_DECREF(empty);
+    if (!ok) return nullptr;
+
+    std::vector<int64_t> keys(256);
+    std::vector<PokerCubeCell> cells(keys.size());
+    int64_t total;
+    while (true) {
+        total = aggregate_cube_group(self->handle, &q, dimension, keys.data(), cells.data(),
+                                     static_cast<int64_t>(keys.size()));
+        if (total <= static_cast<int64_t>(keys.size())) break;
+        keys.resize(static_cast<size_t>(total));
+        cells.resize(keys.size());
+    }
+
+    PyObject* list = PyList_New(total);
+    if (list == nullptr) return nullptr;
+    for (int64_t i = 0; i < total; ++i) {
+        PyObject* item = cube_cell_dict(cells[static_cast<size_t>(i)]);
+        PyObject* key = dimension == 2 ? PyFloat_FromDouble(keys[static_cast<size_t>(i)] / 100.0)
+                                       : PyLong_FromLongLong(keys[static_cast<size_t>(i)]);
+        if (item == nullptr || key == nullptr || PyDict_SetItemString(item, "key", key) != 0) {
+            Py_XDECREF(item);
+            Py_XDECREF(key);
+            Py_DECREF(list);
+            return nullptr;
+        }
+        Py_DECREF(key);
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+static PyMethodDef aggregate_cube_methods[] = {
+    {"add", as_cfunction(aggregate_cube_py_add), METH_VARARGS | METH_KEYWORDS,
+     "add(profit, timestamp=0, session=0, position=-1, hole_class=-1, big_blind=0.0, won=None)"},
+    {"sync", as_cfunction(aggregate_cube_py_sync), METH_VARARGS,
+     "sync(store) -> int: HandStoreの未取り込み分を足す"},
+    {"save", as_cfunction(aggregate_cube_py_save), METH_VARARGS,
+     "save(path): 最も細かいセルだけを保存"},
+    {"count", as_cfunction(aggregate_cube_py_count), METH_NOARGS,
+     "count() -> int: 取り込んだハンド数"},
+    {"rollup", as_cfunction(aggregate_cube_py_rollup), METH_VARARGS | METH_KEYWORDS,
+     "rollup(session=None, position=None, hole_class=None, big_blind=None, start=0, end=0) -> dict"},
+    {"group", as_cfunction(aggregate_cube_py_group), METH_VARARGS | METH_KEYWORDS,
+     "group(by, **filters) -> list[dict]: by = 'session', 'position', 'stake', 'day', 'class'"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+// ===== 収支の逐次集計 =====
+
+struct PyPerformanceStream {
+    PyObject_HEAD
+    void* handle;
+};
+
+static PyTypeObject PerformanceStreamType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// PerformanceStream(window=100, trend_window=100, alpha=0.05)
+static PyObject* performance_stream_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"window", "trend_window", "alpha", nullptr};
+    int window = 100, trend_window = 100;
+    double alpha = 0.05;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|iid", const_cast<char**>(kwlist),
+                                     &window, &trend_window, &alpha)) {
+        return nullptr;
+    }
+    if (window < 1 || trend_window < 1 || !(alpha > 0.0 && alpha <= 1.0)) {
+        PyErr_SetString(PyExc_ValueError, "window/trend_window must be >= 1 and 0 < alpha <= 1");
+        return nullptr;
+    }
+    PyPerformanceStream* self = reinterpret_cast<PyPerformanceStream*>(type->tp_alloc(type, 0));
+    if (self == nullptr) return nullptr;
+    self->handle = performance_stream_create(static_cast<uint32_t>(window),
+                                             static_cast<uint32_t>(trend_window), alpha);
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void performance_stream_dealloc(PyPerformanceStream* self) {
+    performance_stream_destroy(self->handle);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+// push(profit, won=None): wonを省略するとprofit > 0を勝ちとする
+static PyObject* performance_stream_py_push(PyPerformanceStream* self, PyObject* args,
+                                            PyObject* kwargs) {
+    static const char* kwlist[] = {"profit", "won", nullptr};
+    double profit;
+    PyObject* won_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "d|O", const_cast<char**>(kwlist),
+                                     &profit, &won_obj)) {
+        return nullptr;
+    }
+    uint8_t won;
+    if (won_obj == Py_None) {
+        won = profit > 0.0;
+    } else {
+        int truth = PyObject_IsTrue(won_obj);
+        if (truth < 0) return nullptr;
+        won = static_cast<uint8_t>(truth);
+    }
+    performance_stream_push(self->handle, &profit, &won, 1);
+    Py_RETURN_NONE;
+}
+
+// extend(profits f64[N], won=None bool[N]): 過去の配列をまとめて追加する
+static PyObject* performance_stream_py_extend(PyPerformanceStream* self, PyObject* args,
+                                              PyObject* kwargs) {
+    static const char* kwlist[] = {"profits", "won", nullptr};
+    PyObject* profits_obj;
+    PyObject* won_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(kwlist),
+                                     &profits_obj, &won_obj)) {
+        return nullptr;
+    }
+    BufferView profits, won;
+    if (!profits.acquire(profits_obj, "profits", "d", 8)) return nullptr;
+    bool has_won = won_obj != nullptr && won_obj != Py_None;
+    if (has_won) {
+        if (!won.acquire(won_obj, "won", "?Bb", 1)) return nullptr;
+        if (won.size() != profits.size()) {
+            PyErr_SetString(PyExc_ValueError, "profits and won must have the same length");
+            return nullptr;
+        }
+    }
+    Py_BEGIN_ALLOW_THREADS
+    performance_stream_push(self->handle, profits.data<double>(),
+                            has_won ? won.data<uint8_t>() : nullptr, profits.size());
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+static PyObject* performance_stream_py_count(PyPerformanceStream* self, PyObject*) {
+    return PyLong_FromUnsignedLongLong(performance_stream_count(self->handle));
+}
+
+// state() -> dict: 全体・移動窓・EWMA・トレンド・連勝連敗（全てO(1)で保持している値）
+static PyObject* performance_stream_py_state(PyPerformanceStream* self, PyObject*) {
+    PokerPerformanceState s;
+    performance_stream_state(self->handle, &s);
+    return Py_BuildValue(
+        "{s:K,s:d,s:d,s:d,s:d,s:d,s:(dd),s:I,s:d,s:d,s:(dd),s:d,s:d,"
+        "s:I,s:d,s:d,s:d,s:d,s:d,s:d,s:L,s:K,s:K}",
+        "hands", static_cast<unsigned long long>(s.hands),
+        "total", s.total,
+        "mean", s.mean,
+        "std_dev", s.std_dev,
+        "min", s.min,
+        "max", s.max,
+        "mean_band", s.mean_low, s.mean_high,
+        "rolling_count", s.rolling_count,
+        "rolling_mean", s.rolling_mean,
+        "rolling_std", s.rolling_std,
+        "rolling_band", s.rolling_low, s.rolling_high,
+        "ewma", s.ewma,
+        "ewma_std", s.ewma_std,
+        "trend_count", s.trend_count,
+        "slope", s.slope,
+        "intercept", s.intercept,
+        "r_squared", s.r_squared,
+        "p_value", s.p_value,
+        "trend_mean", s.trend_mean,
+        "trend_std", s.trend_std,
+        "streak", static_cast<long long>(s.streak),
+        "max_win_streak", static_cast<unsigned long long>(s.max_win_streak),
+        "max_lose_streak", static_cast<unsigned long long>(s.max_lose_streak));
+}
+
+// rolling(window=0, out=None) -> float64[N]: 全履歴の移動平均（window=0は作成時の窓）
+static PyObject* performance_stream_py_rolling(PyPerformanceStream* self, PyObject* args,
+                                               PyObject* kwargs) {
+    static const char* kwlist[] = {"window", "out", nullptr};
+    int window = 0;
+    PyObject* out_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|iO", const_cast<char**>(kwlist),
+                                     &window, &out_obj)) {
+        return nullptr;
+    }
+    if (window < 0) {
+        PyErr_SetString(PyExc_ValueError, "window must be >= 0");
+        return nullptr;
+    }
+    OutputArray out;
+    Py_ssize_t n = static_cast<Py_ssize_t>(performance_stream_count(self->handle));
+    if (!out.create(out_obj, n, "d", 8)) return nullptr;
+    Py_BEGIN_ALLOW_THREADS
+    performance_stream_rolling(self->handle, static_cast<uint32_t>(window), out.data<double>(), n);
+    Py_END_ALLOW_THREADS
+    return out.release();
+}
+
+// percentiles(q) -> list[float]: q は0-100の列
+static PyObject* performance_stream_py_percentiles(PyPerformanceStream* self, PyObject* args) {
+    PyObject* q_obj;
+    if (!PyArg_ParseTuple(args, "O", &q_obj)) return nullptr;
+    PyObject* seq = PySequence_Fast(q_obj, "percentiles: expected a sequence of numbers");
+    if (seq == nullptr) return nullptr;
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    std::vector<double> q(static_cast<size_t>(n)), out(q.size());
+    for (Py_ssize_t i = 0; i < n; ++i) {
+        q[static_cast<size_t>(i)] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, i));
+        if (q[static_cast<size_t>(i)] == -1.0 && PyErr_Occurred()) {
+            Py_DECREF(seq);
+            return nullptr;
+        }
+    }
+    Py_DECREF(seq);
+    Py_BEGIN_ALLOW_THREADS
+    performance_stream_percentiles(self->handle, q.data(), static_cast<int>(n), out.data());
+    Py_END_ALLOW_THREADS
+    PyObject* list = PyList_New(n);
+    if (list == nullptr) return nullptr;
+    for (Py_ssize_t i = 0; i < n; ++i) {
+        PyObject* item = PyFloat_FromDouble(out[static_cast<size_t>(i)]);
+        if (item == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+static PyMethodDef performance_stream_methods[] = {
+    {"push", as_cfunction(performance_stream_py_push), METH_VARARGS | METH_KEYWORDS,
+     "push(profit, won=None): 1ハンド追加（O(1)）"},
+    {"extend", as_cfunction(performance_stream_py_extend), METH_VARARGS | METH_KEYWORDS,
+     "extend(profits f64[N], won=None): 過去の配列をまとめて追加"},
+    {"count", as_cfunction(performance_stream_py_count), METH_NOARGS,
+     "count() -> int"},
+    {"state", as_cfunction(performance_stream_py_state), METH_NOARGS,
+     "state() -> dict: 全体・移動窓・EWMA・トレンド・連勝連敗"},
+    {"rolling", as_cfunction(performance_stream_py_rolling), METH_VARARGS | METH_KEYWORDS,
+     "rolling(window=0, out=None) -> float64[N]: 全履歴の移動平均"},
+    {"percentiles", as_cfunction(performance_stream_py_percentiles), METH_VARARGS,
+     "percentiles(q) -> list[float]"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+// ===== カード認識 =====
+
+struct PyCardRecognizer {
+    PyObject_HEAD
+    void* handle;
+};
+
+static PyTypeObject CardRecognizerType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// uint8の画像（H×W のグレー、H×W×3 のBGR、H×W×4 のBGRA。C連続）
+static bool acquire_image(PyObject* obj, BufferView& buffer, PokerImageView& image) {
+    if (!buffer.acquire(obj, "image", "B", 1)) return false;
+    int channels = buffer.ndim() == 2 ? 1 : buffer.ndim() == 3 ? static_cast<int>(buffer.shape(2)) : 0;
+    if (channels != 1 && channels != 3 && channels != 4) {
+        PyErr_SetString(PyExc_ValueError, "image: expected HxW, HxWx3 (BGR) or HxWx4 (BGRA) uint8 array");
+        return false;
+    }
+    if (buffer.shape(0) <= 0 || buffer.shape(1) <= 0 ||
+        buffer.shape(0) > INT32_MAX / 4 || buffer.shape(1) > INT32_MAX / 4) {
+        PyErr_SetString(PyExc_ValueError, "image: invalid size");
+        return false;
+    }
+    image.pixels = buffer.data<const uint8_t>();
+    image.height = static_cast<int32_t>(buffer.shape(0));
+    image.width = static_cast<int32_t>(buffer.shape(1));
+    image.channels = channels;
+    image.stride = image.width * channels;
+    return true;
+}
+
+// (x, y, width, height)（cv2.boundingRectと同じ順）
+static bool parse_box(PyObject* obj, PokerImageBox& box) {
+    PyObject* tuple = PySequence_Tuple(obj);
+    if (tuple == nullptr) return false;
+    int ok = PyArg_ParseTuple(tuple, "iiii", &box.x, &box.y, &box.width, &box.height);
+    Py_DECREF(tuple);
+    return ok != 0;
+}
+
+// 画像からはみ出す矩形はValueError
+static bool parse_image_box(PyObject* obj, const PokerImageView& image, PokerImageBox& box) {
+    if (!parse_box(obj, box)) return false;
+    if (box.x < 0 || box.y < 0 || box.width <= 0 || box.height <= 0 ||
+        box.x > image.width - box.width || box.y > image.height - box.height) {
+        PyErr_Format(PyExc_ValueError, "box (%d, %d, %d, %d) is outside the %dx%d image",
+                     box.x, box.y, box.width, box.height, image.width, image.height);
+        return false;
+    }
+    return true;
+}
+
+static bool parse_layout_box(PyObject* obj, const char* name, float* out) {
+    if (obj == Py_None) return true;
+    PyObject* seq = PySequence_Fast(obj, name);
+    if (seq == nullptr) return false;
+    bool ok = PySequence_Fast_GET_SIZE(seq) == 4;
+    for (Py_ssize_t i = 0; ok && i < 4; ++i) {
+        double v = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, i));
+        ok = !(v == -1.0 && PyErr_Occurred());
+        out[i] = static_cast<float>(v);
+    }
+    Py_DECREF(seq);
+    if (!ok && !PyErr_Occurred()) {
+        PyErr_Format(PyExc_ValueError, "%s: expected (x0, y0, x1, y1) as fractions of the card", name);
+    }
+    return ok;
+}
+
+// CardRecognizer(path=None, rank_box=None, suit_box=None)
+//   pathを指定すると保存済みのテンプレートを開く。rank_box / suit_box はカードに対する比率
+static PyObject* card_recognizer_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"path", "rank_box", "suit_box", nullptr};
+    const char* path = nullptr;
+    PyObject* rank_obj = Py_None;
+    PyObject* suit_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|zOO", const_cast<char**>(kwlist),
+                                     &path, &rank_obj, &suit_obj)) {
+        return nullptr;
+    }
+    void* handle;
+    if (path != nullptr) {
+        Py_BEGIN_ALLOW_THREADS
+        handle = card_recognizer_open(path);
+        Py_END_ALLOW_THREADS
+        if (handle == nullptr) {
+            PyErr_Format(PyExc_OSError, "cannot open card templates: %s", card_recognizer_error());
+            return nullptr;
+        }
+    } else {
+        PokerCardLayout layout = {};   // 0のままの領域は既定の位置
+        if (!parse_layout_box(rank_obj, "rank_box", layout.rank_box) ||
+            !parse_layout_box(suit_obj, "suit_box", layout.suit_box)) {
+            return nullptr;
+        }
+        handle = card_recognizer_create(&layout);
+        if (handle == nullptr) {
+            PyErr_SetString(PyExc_ValueError, card_recognizer_error());
+            return nullptr;
+        }
+    }
+    PyCardRecognizer* self = reinterpret_cast<PyCardRecognizer*>(type->tp_alloc(type, 0));
+    if (self == nullptr) {
+        card_recognizer_close(handle);
+        return nullptr;
+    }
+    self->handle = handle;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void card_recognizer_dealloc(PyCardRecognizer* self) {
+    card_recognizer_close(self->handle);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+// learn(image, card, box=None): cardは0-51か 'As' 形式
+static PyObject* card_recognizer_py_learn(PyCardRecognizer* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"image", "card", "box", nullptr};
+    PyObject* image_obj;
+    PyObject* card_obj;
+    PyObject* box_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", const_cast<char**>(kwlist),
+                                     &image_obj, &card_obj, &box_obj)) {
+        return nullptr;
+    }
+    int card;
+    if (PyUnicode_Check(card_obj)) {
+        const char* text = PyUnicode_AsUTF8(card_obj);
+        if (text == nullptr) return nullptr;
+        uint8_t parsed;
+        if (parse_cards_string(text, &parsed, 1) != 1) {
+            PyErr_Format(PyExc_ValueError, "invalid card: %s", text);
+            return nullptr;
+        }
+        card = parsed;
+    } else {
+        card = static_cast<int>(PyLong_AsLong(card_obj));
+        if (card == -1 && PyErr_Occurred()) return nullptr;
+    }
+
+    BufferView buffer;
+    PokerImageView image;
+    if (!acquire_image(image_obj, buffer, image)) return nullptr;
+    PokerImageBox box = {0, 0, image.width, image.height};
+    if (box_obj != Py_None && !parse_image_box(box_obj, image, box)) return nullptr;
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = card_recognizer_learn(self->handle, &image, &box, card);
+    Py_END_ALLOW_THREADS
+    if (result != 0) {
+        PyErr_SetString(PyExc_ValueError, card_recognizer_error());
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+// recognize(image, boxes=None, method='ncc') -> list[(card | None, confidence)]
+//   boxes: 1フレーム内のカードの (x, y, width, height) の列（Noneなら画像全体を1枚のカードとする）
+static PyObject* card_recognizer_py_recognize(PyCardRecognizer* self, PyObject* args,
+                                              PyObject* kwargs) {
+    static const char* kwlist[] = {"image", "boxes", "method", nullptr};
+    PyObject* image_obj;
+    PyObject* boxes_obj = Py_None;
+    const char* method_name = "ncc";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Os", const_cast<char**>(kwlist),
+                                     &image_obj, &boxes_obj, &method_name)) {
+        return nullptr;
+    }
+    int method;
+    if (std::strcmp(method_name, "ncc") == 0) {
+        method = 0;   // 正規化相互相関
+    } else if (std::strcmp(method_name, "hamming") == 0) {
+        method = 1;   // ハッシュのハミング距離
+    } else {
+        PyErr_Format(PyExc_ValueError, "unknown method '%s' (expected 'ncc' or 'hamming')", method_name);
+        return nullptr;
+    }
+
+    BufferView buffer;
+    PokerImageView image;
+    if (!acquire_image(image_obj, buffer, image)) return nullptr;
+    std::vector<PokerImageBox> boxes;
+    if (boxes_obj == Py_None) {
+        boxes.push_back({0, 0, image.width, image.height});
+    } else {
+        PyObject* seq = PySequence_Fast(boxes_obj, "boxes: expected a sequence of (x, y, width, height)");
+        if (seq == nullptr) return nullptr;
+        Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+        boxes.resize(static_cast<size_t>(n));
+        for (Py_ssize_t i = 0; i < n; ++i) {
+            if (!parse_image_box(PySequence_Fast_GET_ITEM(seq, i), image, boxes[static_cast<size_t>(i)])) {
+                Py_DECREF(seq);
+                return nullptr;
+            }
+        }
+        Py_DECREF(seq);
+    }
+
+    std::vector<PokerCardMatch> matches(boxes.size());
+    Py_BEGIN_ALLOW_THREADS
+    card_recognizer_match(self->handle, &image, boxes.data(), static_cast<int64_t>(boxes.size()),
+                          method, matches.data());
+    Py_END_ALLOW_THREADS
+    buffer.release();
+
+    PyObject* list = PyList_New(static_cast<Py_ssize_t>(matches.size()));
+    if (list == nullptr) return nullptr;
+    for (size_t i = 0; i < matches.size(); ++i) {
+        const PokerCardMatch& m = matches[i];
+        PyObject* item = m.card >= 0 ? Py_BuildValue("(id)", m.card, double(m.confidence))
+                                     : Py_BuildValue("(Od)", Py_None, 0.0);
+        if (item == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), item);
+    }
+    return list;
+}
+
+static PyObject* card_recognizer_py_save(PyCardRecognizer* self, PyObject* args) {
+    const char* path;
+    if (!PyArg_ParseTuple(args, "s", &path)) return nullptr;
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = card_recognizer_save(self->handle, path);
+    Py_END_ALLOW_THREADS
+    if (result != 0) {
+        PyErr_SetString(PyExc_OSError, card_recognizer_error());
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+// samples() -> {'ranks': [13], 'suits': [4]}: 学習済みのサンプル数
+static PyObject* card_recognizer_py_samples(PyCardRecognizer* self, PyObject*) {
+    uint32_t ranks[13], suits[4];
+    card_recognizer_samples(self->handle, ranks, suits);
+    return Py_BuildValue("{s:[IIIIIIIIIIIII],s:[IIII]}",
+                         "ranks", ranks[0], ranks[1], ranks[2], ranks[3], ranks[4], ranks[5], ranks[6],
+                         ranks[7], ranks[8], ranks[9], ranks[10], ranks[11], ranks[12],
+                         "suits", suits[0], suits[1], suits[2], suits[3]);
+}
+
+static PyMethodDef card_recognizer_methods[] = {
+    {"learn", as_cfunction(card_recognizer_py_learn), METH_VARARGS | METH_KEYWORDS,
+     "learn(image, card, box=None): ラベル付きのカード画像をテンプレートに加える"},
+    {"recognize", as_cfunction(card_recognizer_py_recognize), METH_VARARGS | METH_KEYWORDS,
+     "recognize(image, boxes=None, method='ncc') -> list[(card | None, confidence)]"},
+    {"save", as_cfunction(card_recognizer_py_save), METH_VARARGS,
+     "save(path)"},
+    {"samples", as_cfunction(card_recognizer_py_samples), METH_NOARGS,
+     "samples() -> dict: ランク・スートごとの学習済みサンプル数"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+// ===== フレームの変化検出 =====
+
+struct PyFrameGate {
+    PyObject_HEAD
+    void* handle;
+    std::mutex lock;          // 領域の数の読み取りとupdateを、add_region・clearと排他にする
+};
+
+static PyTypeObject FrameGateType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// FrameGate(hash_threshold=1, cell_threshold=4)
+static PyObject* frame_gate_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"hash_threshold", "cell_threshold", nullptr};
+    int hash_threshold = 1, cell_threshold = 4;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ii", const_cast<char**>(kwlist),
+                                     &hash_threshold, &cell_threshold)) {
+        return nullptr;
+    }
+    PyFrameGate* self = reinterpret_cast<PyFrameGate*>(type->tp_alloc(type, 0));
+    if (self == nullptr) return nullptr;
+    new (&self->lock) std::mutex();
+    self->handle = frame_gate_create(hash_threshold, cell_threshold);
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void frame_gate_dealloc(PyFrameGate* self) {
+    frame_gate_destroy(self->handle);
+    self->lock.~mutex();
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+// add_region(box, tile=32) -> int: boxはフレーム上の (x, y, width, height)
+static PyObject* frame_gate_py_add_region(PyFrameGate* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"box", "tile", nullptr};
+    PyObject* box_obj;
+    int tile = 32;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", const_cast<char**>(kwlist),
+                                     &box_obj, &tile)) {
+        return nullptr;
+    }
+    PokerImageBox box;
+    if (!parse_box(box_obj, box)) return nullptr;
+    int index;
+    Py_BEGIN_ALLOW_THREADS
+    {
+        std::lock_guard<std::mutex> guard(self->lock);
+        index = frame_gate_add_region(self->handle, &box, tile);
+    }
+    Py_END_ALLOW_THREADS
+    if (index < 0) {
+        PyErr_SetString(PyExc_ValueError, "box must have a positive width and height");
+        return nullptr;
+    }
+    return PyLong_FromLong(index);
+}
+
+static PyObject* frame_gate_py_clear(PyFrameGate* self, PyObject*) {
+    Py_BEGIN_ALLOW_THREADS
+    {
+        std::lock_guard<std::mutex> guard(self->lock);
+        frame_gate_clear(self->handle);
+    }
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+static PyObject* frame_gate_py_reset(PyFrameGate* self, PyObject*) {
+    frame_gate_reset(self->handle);
+    Py_RETURN_NONE;
+}
+
+static PyObject* frame_gate_py_count(PyFrameGate* self, PyObject*) {
+    return PyLong_FromLong(frame_gate_region_count(self->handle));
+}
+
+// update(frame) -> list[int]: 前のフレームから変化した領域の番号
+static PyObject* frame_gate_py_update(PyFrameGate* self, PyObject* args) {
+    PyObject* frame_obj;
+    if (!PyArg_ParseTuple(args, "O", &frame_obj)) return nullptr;
+    BufferView buffer;
+    PokerImageView frame;
+    if (!acquire_image(frame_obj, buffer, frame)) return nullptr;
+    // 領域の数で確保してから更新するまでの間に領域が増えないよう、同じロックの中で行う
+    std::vector<int32_t> changed;
+    Py_BEGIN_ALLOW_THREADS
+    {
+        std::lock_guard<std::mutex> guard(self->lock);
+        changed.resize(static_cast<size_t>(frame_gate_region_count(self->handle)));
+        frame_gate_update(self->handle, &frame, changed.data());
+    }
+    Py_END_ALLOW_THREADS
+    buffer.release();
+
+    PyObject* list = PyList_New(0);
+    if (list == nullptr) return nullptr;
+    for (size_t i = 0; i < changed.size(); ++i) {
+        if (changed[i] == 0) continue;
+        PyObject* item = PyLong_FromSize_t(i);
+        if (item == nullptr || PyList_Append(list, item) != 0) {
+            Py_XDECREF(item);
+            Py_DECREF(list);
+            return nullptr;
+        }
+        Py_DECREF(item);
+    }
+    return list;
+}
+
+static PyMethodDef frame_gate_methods[] = {
+    {"add_region", as_cfunction(frame_gate_py_add_region), METH_VARARGS | METH_KEYWORDS,
+     "add_region(box, tile=32) -> int: 注目領域を追加（戻り値は領域の番号）"},
+    {"clear", as_cfunction(frame_gate_py_clear), METH_NOARGS,
+     "clear(): 全ての領域を削除"},
+    {"reset", as_cfunction(frame_gate_py_reset), METH_NOARGS,
+     "reset(): 次のupdateで全ての領域を変化ありとする"},
+    {"count", as_cfunction(frame_gate_py_count), METH_NOARGS,
+     "count() -> int: 領域の数"},
+    {"update", as_cfunction(frame_gate_py_update), METH_VARARGS,
+     "update(frame) -> list[int]: 変化した領域の番号"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+// ===== 複数テーブルのキャプチャパイプライン =====
+
+struct PyCapturePipeline {
+    PyObject_HEAD
+    void* handle;
+};
+
+static PyTypeObject CapturePipelineType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// next_jobが返す依頼。バッファプロトコルで (height, width[, channels]) のuint8画像として読める
+struct PyCaptureJob {
+    PyObject_HEAD
+    PyCapturePipeline* pipeline;
+    PokerCaptureJob job;
+    PokerImageView image;
+    Py_ssize_t shape[3];
+    Py_ssize_t strides[3];
+    int exports;
+    bool completed;
+    bool released;
+};
+
+static PyTypeObject CaptureJobType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// CapturePipeline(redetect_interval=2.0, layout_threshold=0.6)
+static PyObject* capture_pipeline_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"redetect_interval", "layout_threshold", nullptr};
+    double redetect_interval = 2.0, layout_threshold = 0.6;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|dd", const_cast<char**>(kwlist),
+                                     &redetect_interval, &layout_threshold)) {
+        return nullptr;
+    }
+    PyCapturePipeline* self = reinterpret_cast<PyCapturePipeline*>(type->tp_alloc(type, 0));
+    if (self == nullptr) return nullptr;
+    self->handle = capture_pipeline_create(static_cast<int>(redetect_interval * 1000.0), layout_threshold);
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void capture_pipeline_dealloc(PyCapturePipeline* self) {
+    capture_pipeline_destroy(self->handle);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+// set_tables([(table_box, [region_box, ...]), ...]) -> int: 新しい世代
+static PyObject* capture_pipeline_py_set_tables(PyCapturePipeline* self, PyObject* args) {
+    PyObject* tables_obj;
+    if (!PyArg_ParseTuple(args, "O", &tables_obj)) return nullptr;
+    PyObject* tables = PySequence_Fast(tables_obj, "tables must be a sequence of (box, regions)");
+    if (tables == nullptr) return nullptr;
+    std::vector<PokerImageBox> boxes, regions;
+    std::vector<int32_t> region_counts;
+    bool ok = true;
+    for (Py_ssize_t i = 0; ok && i < PySequence_Fast_GET_SIZE(tables); ++i) {
+        PyObject* box_obj;
+        PyObject* regions_obj;
+        PyObject* item = PySequence_Tuple(PySequence_Fast_GET_ITEM(tables, i));
+        ok = item != nullptr && PyArg_ParseTuple(item, "OO", &box_obj, &regions_obj);
+        PokerImageBox box;
+        ok = ok && parse_box(box_obj, box);
+        PyObject* table_regions = ok ? PySequence_Fast(regions_obj, "regions must be a sequence of boxes") : nullptr;
+        ok = table_regions != nullptr;
+        if (ok) {
+            boxes.push_back(box);
+            region_counts.push_back(static_cast<int32_t>(PySequence_Fast_GET_SIZE(table_regions)));
+            for (Py_ssize_t r = 0; ok && r < PySequence_Fast_GET_SIZE(table_regions); ++r) {
+                PokerImageBox region;
+                ok = parse_box(PySequence_Fast_GET_ITEM(table_regions, r), region);
+                regions.push_back(region);
+            }
+        }
+        Py_XDECREF(table_regions);
+        Py_XDECREF(item);
+    }
+    Py_DECREF(tables);
+    if (!ok) return nullptr;
+    int generation;
+    Py_BEGIN_ALLOW_THREADS
+    generation = capture_pipeline_set_tables(self->handle, boxes.data(), static_cast<int>(boxes.size()),
+                                             regions.data(), region_counts.data());
+    Py_END_ALLOW_THREADS
+    if (generation < 0) {
+        PyErr_SetString(PyExc_ValueError, "at most 64 tables with 48 regions each");
+        return nullptr;
+    }
+    return PyLong_FromLong(generation);
+}
+
+// submit(frame) -> int: 抽出・再検出の依頼数（0なら変化なし）
+static PyObject* capture_pipeline_py_submit(PyCapturePipeline* self, PyObject* args) {
+    PyObject* frame_obj;
+    if (!PyArg_ParseTuple(args, "O", &frame_obj)) return nullptr;
+    BufferView buffer;
+    PokerImageView frame;
+    if (!acquire_image(frame_obj, buffer, frame)) return nullptr;
+    int queued;
+    Py_BEGIN_ALLOW_THREADS
+    queued = capture_pipeline_submit(self->handle, &frame);
+    Py_END_ALLOW_THREADS
+    buffer.release();
+    return PyLong_FromLong(queued);
+}
+
+// next_job(timeout=0.2) -> CaptureJob | None（時間切れ・停止）
+static PyObject* capture_pipeline_py_next_job(PyCapturePipeline* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"timeout", nullptr};
+    double timeout = 0.2;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|d", const_cast<char**>(kwlist), &timeout)) {
+        return nullptr;
+    }
+    PokerCaptureJob job;
+    int got;
+    Py_BEGIN_ALLOW_THREADS
+    got = capture_pipeline_next_job(self->handle, static_cast<int>(timeout * 1000.0), &job);
+    Py_END_ALLOW_THREADS
+    if (got != 1) Py_RETURN_NONE;
+
+    PyCaptureJob* result = PyObject_New(PyCaptureJob, &CaptureJobType);
+    if (result == nullptr) {
+        capture_pipeline_complete(self->handle, &job, -1, 0);
+        capture_pipeline_release(self->handle, job.buffer);
+        return nullptr;
+    }
+    Py_INCREF(self);
+    result->pipeline = self;
+    result->job = job;
+    capture_pipeline_buffer(self->handle, job.buffer, &result->image);
+    result->exports = 0;
+    result->completed = false;
+    result->released = false;
+    return reinterpret_cast<PyObject*>(result);
+}
+
+// next_analysis(timeout=0.2) -> dict | None: ヒーローの手番のテーブルが先
+static PyObject* capture_pipeline_py_next_analysis(PyCapturePipeline* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"timeout", nullptr};
+    double timeout = 0.2;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|d", const_cast<char**>(kwlist), &timeout)) {
+        return nullptr;
+    }
+    PokerCaptureAnalysis analysis;
+    int got;
+    Py_BEGIN_ALLOW_THREADS
+    got = capture_pipeline_next_analysis(self->handle, static_cast<int>(timeout * 1000.0), &analysis);
+    Py_END_ALLOW_THREADS
+    if (got != 1) Py_RETURN_NONE;
+    return Py_BuildValue("{s:i,s:I,s:O,s:K,s:d}",
+                         "table", analysis.table, "generation", analysis.generation,
+                         "hero_to_act", analysis.hero_to_act ? Py_True : Py_False,
+                         "sequence", static_cast<unsigned long long>(analysis.sequence),
+                         "latency_ms", analysis.latency_ms);
+}
+
+static PyObject* capture_pipeline_py_stop(PyCapturePipeline* self, PyObject*) {
+    capture_pipeline_stop(self->handle);
+    Py_RETURN_NONE;
+}
+
+static PyObject* capture_pipeline_py_stats(PyCapturePipeline* self, PyObject*) {
+    PokerCaptureStats s;
+    capture_pipeline_stats(self->handle, &s);
+    return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:d,s:d,s:d,s:d,s:I,s:I,s:K}",
+                         "frames", static_cast<unsigned long long>(s.frames),
+                         "unchanged", static_cast<unsigned long long>(s.unchanged),
+                         "dropped", static_cast<unsigned long long>(s.dropped),
+                         "superseded", static_cast<unsigned long long>(s.superseded),
+                         "extract_jobs", static_cast<unsigned long long>(s.extract_jobs),
+                         "layout_jobs", static_cast<unsigned long long>(s.layout_jobs),
+                         "analyses", static_cast<unsigned long long>(s.analyses),
+                         "urgent_analyses", static_cast<unsigned long long>(s.urgent_analyses),
+                         "mean_latency_ms", s.mean_latency_ms, "max_latency_ms", s.max_latency_ms,
+                         "urgent_mean_latency_ms", s.urgent_mean_latency_ms,
+                         "urgent_max_latency_ms", s.urgent_max_latency_ms,
+                         "tables", s.tables, "buffers_in_use", s.buffers_in_use,
+                         "buffer_bytes", static_cast<unsigned long long>(s.buffer_bytes));
+}
+
+static PyMethodDef capture_pipeline_methods[] = {
+    {"set_tables", as_cfunction(capture_pipeline_py_set_tables), METH_VARARGS,
+     "set_tables([(table_box, [region_box, ...]), ...]) -> int: テーブル構成を置き換える（戻り値は世代）"},
+    {"submit", as_cfunction(capture_pipeline_py_submit), METH_VARARGS,
+     "submit(frame) -> int: フレームを取り込む（戻り値は依頼数）"},
+    {"next_job", as_cfunction(capture_pipeline_py_next_job), METH_VARARGS | METH_KEYWORDS,
+     "next_job(timeout=0.2) -> CaptureJob | None"},
+    {"next_analysis", as_cfunction(capture_pipeline_py_next_analysis), METH_VARARGS | METH_KEYWORDS,
+     "next_analysis(timeout=0.2) -> dict | None"},
+    {"stop", as_cfunction(capture_pipeline_py_stop), METH_NOARGS,
+     "stop(): 待っているワーカーを全て起こす"},
+    {"stats", as_cfunction(capture_pipeline_py_stats), METH_NOARGS,
+     "stats() -> dict"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static void capture_job_finish(PyCaptureJob* self, int hero_to_act, int changed) {
+    if (self->completed) return;
+    self->completed = true;
+    capture_pipeline_complete(self->pipeline->handle, &self->job, hero_to_act, changed);
+}
+
+static void capture_job_dealloc(PyCaptureJob* self) {
+    capture_job_finish(self, -1, 0);
+    if (!self->released) capture_pipeline_release(self->pipeline->handle, self->job.buffer);
+    Py_DECREF(self->pipeline);
+    PyObject_Del(self);
+}
+
+static int capture_job_getbuffer(PyCaptureJob* self, Py_buffer* view, int flags) {
+    if (self->released) {
+        PyErr_SetString(PyExc_BufferError, "job buffer already released");
+        return -1;
+    }
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "job buffer is read-only");
+        return -1;
+    }
+    const PokerImageView& image = self->image;
+    self->shape[0] = image.height;
+    self->shape[1] = image.width;
+    self->shape[2] = image.channels;
+    self->strides[0] = image.stride;
+    self->strides[1] = image.channels;
+    self->strides[2] = 1;
+    view->buf = const_cast<uint8_t*>(image.pixels);
+    view->obj = reinterpret_cast<PyObject*>(self);
+    Py_INCREF(self);
+    view->len = static_cast<Py_ssize_t>(image.stride) * image.height;
+    view->readonly = 1;
+    view->itemsize = 1;
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>("B") : nullptr;
+    view->ndim = image.channels == 1 ? 2 : 3;
+    view->shape = (flags & PyBUF_ND) ? self->shape : nullptr;
+    view->strides = (flags & PyBUF_STRIDES) ? self->strides : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+    ++self->exports;
+    return 0;
+}
+
+static void capture_job_releasebuffer(PyCaptureJob* self, Py_buffer*) {
+    --self->exports;
+}
+
+static PyBufferProcs capture_job_buffer_procs = {
+    reinterpret_cast<getbufferproc>(capture_job_getbuffer),
+    reinterpret_cast<releasebufferproc>(capture_job_releasebuffer),
+};
+
+// complete(hero_to_act=None, changed=False): 抽出の完了（changedなら分析待ちにする）
+static PyObject* capture_job_py_complete(PyCaptureJob* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"hero_to_act", "changed", nullptr};
+    PyObject* hero_obj = Py_None;
+    int changed = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|Op", const_cast<char**>(kwlist), &hero_obj, &changed)) {
+        return nullptr;
+    }
+    int hero_to_act = -1;
+    if (hero_obj != Py_None) {
+        hero_to_act = PyObject_IsTrue(hero_obj);
+        if (hero_to_act < 0) return nullptr;
+    }
+    if (self->completed) {
+        PyErr_SetString(PyExc_RuntimeError, "job already completed");
+        return nullptr;
+    }
+    capture_job_finish(self, hero_to_act, changed);
+    Py_RETURN_NONE;
+}
+
+// release(): 画像のバッファを早めに返す（以後バッファとしては読めない）
+static PyObject* capture_job_py_release(PyCaptureJob* self, PyObject*) {
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "job buffer is still exported");
+        return nullptr;
+    }
+    if (!self->released) {
+        self->released = true;
+        capture_pipeline_release(self->pipeline->handle, self->job.buffer);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* capture_job_get_kind(PyCaptureJob* self, void*) {
+    return PyUnicode_FromString(self->job.kind == 1 ? "layout" : "extract");
+}
+
+static PyObject* capture_job_get_table(PyCaptureJob* self, void*) {
+    return PyLong_FromLong(self->job.table);
+}
+
+static PyObject* capture_job_get_generation(PyCaptureJob* self, void*) {
+    return PyLong_FromUnsignedLong(self->job.generation);
+}
+
+static PyObject* capture_job_get_sequence(PyCaptureJob* self, void*) {
+    return PyLong_FromUnsignedLongLong(self->job.sequence);
+}
+
+static PyObject* capture_job_get_box(PyCaptureJob* self, void*) {
+    const PokerImageBox& box = self->job.box;
+    return Py_BuildValue("(iiii)", box.x, box.y, box.width, box.height);
+}
+
+// 変化した領域の番号（set_tablesで渡した順）
+static PyObject* capture_job_get_regions(PyCaptureJob* self, void*) {
+    PyObject* list = PyList_New(0);
+    if (list == nullptr) return nullptr;
+    for (int r = 0; r < 64; ++r) {
+        if (!(self->job.regions >> r & 1)) continue;
+        PyObject* item = PyLong_FromLong(r);
+        if (item == nullptr || PyList_Append(list, item) != 0) {
+            Py_XDECREF(item);
+            Py_DECREF(list);
+            return nullptr;
+        }
+        Py_DECREF(item);
+    }
+    return list;
+}
+
+static PyMethodDef capture_job_methods[] = {
+    {"complete", as_cfunction(capture_job_py_complete), METH_VARARGS | METH_KEYWORDS,
+     "complete(hero_to_act=None, changed=False): 抽出の完了"},
+    {"release", as_cfunction(capture_job_py_release), METH_NOARGS,
+     "release(): 画像のバッファを返す"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyGetSetDef capture_job_getset[] = {
+    {const_cast<char*>("kind"), reinterpret_cast<getter>(capture_job_get_kind), nullptr,
+     const_cast<char*>("'extract' | 'layout'"), nullptr},
+    {const_cast<char*>("table"), reinterpret_cast<getter>(capture_job_get_table), nullptr,
+     const_cast<char*>("テーブル番号（再検出は-1）"), nullptr},
+    {const_cast<char*>("generation"), reinterpret_cast<getter>(capture_job_get_generation), nullptr,
+     const_cast<char*>("set_tablesの世代"), nullptr},
+    {const_cast<char*>("sequence"), reinterpret_cast<getter>(capture_job_get_sequence), nullptr,
+     const_cast<char*>("フレームの通し番号"), nullptr},
+    {const_cast<char*>("box"), reinterpret_cast<getter>(capture_job_get_box), nullptr,
+     const_cast<char*>("画像のフレーム上の位置 (x, y, width, height)"), nullptr},
+    {const_cast<char*>("regions"), reinterpret_cast<getter>(capture_job_get_regions), nullptr,
+     const_cast<char*>("変化した領域の番号"), nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}
+};
+
+// ===== 金額の認識 =====
+
+struct PyAmountRecognizer {
+    PyObject_HEAD
+    void* handle;
+};
+
+static PyTypeObject AmountRecognizerType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+// AmountRecognizer(path=None): pathを指定すると保存済みのテンプレートを開く
+static PyObject* amount_recognizer_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"path", nullptr};
+    const char* path = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|z", const_cast<char**>(kwlist), &path)) {
+        return nullptr;
+    }
+    void* handle;
+    if (path != nullptr) {
+        Py_BEGIN_ALLOW_THREADS
+        handle = amount_recognizer_open(path);
+        Py_END_ALLOW_THREADS
+        if (handle == nullptr) {
+            PyErr_Format(PyExc_OSError, "cannot open amount templates: %s", amount_recognizer_error());
+            return nullptr;
+        }
+    } else {
+        handle = amount_recognizer_create();
+    }
+    PyAmountRecognizer* self = reinterpret_cast<PyAmountRecognizer*>(type->tp_alloc(type, 0));
+    if (self == nullptr) {
+        amount_recognizer_close(handle);
+        return nullptr;
+    }
+    self->handle = handle;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void amount_recognizer_dealloc(PyAmountRecognizer* self) {
+    amount_recognizer_close(self->handle);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+// learn(image, text, box=None): textは画面の表記どおり（'$1,250.50'、'12.5K' など）
+static PyObject* amount_recognizer_py_learn(PyAmountRecognizer* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"image", "text", "box", nullptr};
+    PyObject* image_obj;
+    const char* text;
+    PyObject* box_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Os|O", const_cast<char**>(kwlist),
+                                     &image_obj, &text, &box_obj)) {
+        return nullptr;
+    }
+    BufferView buffer;
+    PokerImageView image;
+    if (!acquire_image(image_obj, buffer, image)) return nullptr;
+    PokerImageBox box = {0, 0, image.width, image.height};
+    if (box_obj != Py_None && !parse_image_box(box_obj, image, box)) return nullptr;
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = amount_recognizer_learn(self->handle, &image, &box, text);
+    Py_END_ALLOW_THREADS
+    if (result != 0) {
+        PyErr_SetString(PyExc_ValueError, amount_recognizer_error());
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+// read(image, boxes=None) -> list[(amount | None, confidence, text)]
+//   boxes: 1フレーム内の金額の (x, y, width, height) の列（Noneなら画像全体を1つの金額とする）
+static PyObject* amount_recognizer_py_read(PyAmountRecognizer* self, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"image", "boxes", nullptr};
+    PyObject* image_obj;
+    PyObject* boxes_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(kwlist),
+                                     &image_obj, &boxes_obj)) {
+        return nullptr;
+    }
+    BufferView buffer;
+    PokerImageView image;
+    if (!acquire_image(image_obj, buffer, image)) return nullptr;
+    std::vector<PokerImageBox> boxes;
+    if (boxes_obj == Py_None) {
+        boxes.push_back({0, 0, image.width, image.height});
+    } else {
+        PyObject* seq = PySequence_Fast(boxes_obj, "boxes: expected a sequence of (x, y, width, height)");
+        if (seq == nullptr) return nullptr;
+        Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+        boxes.resize(static_cast<size_t>(n));
+        for (Py_ssize_t i = 0; i < n; ++i) {
+            if (!parse_image_box(PySequence_Fast_GET_ITEM(seq, i), image, boxes[static_cast<size_t>(i)])) {
+                Py_DECREF(seq);
+                return nullptr;
+            }
+        }
+        Py_DECREF(seq);
+    }
+
+    std::vector<PokerAmountMatch> matches(boxes.size());
+    Py_BEGIN_ALLOW_THREADS
+    amount_recognizer_read(self->handle, &image, boxes.data(), static_cast<int64_t>(boxes.size()),
+                           matches.data());
+    Py_END_ALLOW_THREADS
+    buffer.release();
+
+    PyObject* list = PyList_New(static_cast<Py_ssize_t>(matches.size()));
+    if (list == nullptr) return nullptr;
+    for (size_t i = 0; i < matches.size(); ++i) {
+        const PokerAmountMatch& m = matches[i];
+        PyObject* item = m.valid ? Py_BuildValue("(dds)", m.value, double(m.confidence), m.text)
+                                 : Py_BuildValue("(Ods)", Py_None, 0.0, m.text);
+        if (item == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), item);
+    }
+    return list;
+}
+
+static PyObject* amount_recognizer_py_save(PyAmountRecognizer* self, PyObject* args) {
+    const char* path;
+    if (!PyArg_ParseTuple(args, "s", &path)) return nullptr;
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = amount_recognizer_save(self->handle, path);
+    Py_END_ALLOW_THREADS
+    if (result != 0) {
+        PyErr_SetString(PyExc_OSError, amount_recognizer_error());
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+// samples() -> dict: 文字ごとの学習済みサンプル数
+static PyObject* amount_recognizer_py_samples(PyAmountRecognizer* self, PyObject*) {
+    static const char chars[] = "0123456789$KM";
+    uint32_t counts[sizeof(chars) - 1];
+    amount_recognizer_samples(self->handle, counts);
+    PyObject* dict = PyDict_New();
+    if (dict == nullptr) return nullptr;
+    for (size_t i = 0; i < sizeof(chars) - 1; ++i) {
+        char key[2] = {chars[i], '\0'};
+        PyObject* value = PyLong_FromUnsignedLong(counts[i]);
+        if (value == nullptr || PyDict_SetItemString(dict, key, value) != 0) {
+            Py_XDECREF(value);
+            Py_DECREF(dict);
+            return nullptr;
+        }
+        Py_DECREF(value);
+    }
+    return dict;
+}
+
+static PyMethodDef amount_recognizer_methods[] = {
+    {"learn", as_cfunction(amount_recognizer_py_learn), METH_VARARGS | METH_KEYWORDS,
+     "learn(image, text, box=None): ラベル付きの金額の画像をテンプレートに加える"},
+    {"read", as_cfunction(amount_recognizer_py_read), METH_VARARGS | METH_KEYWORDS,
+     "read(image, boxes=None) -> list[(amount | None, confidence, text)]"},
+    {"save", as_cfunction(amount_recognizer_py_save), METH_VARARGS,
+     "save(path)"},
+    {"samples", as_cfunction(amount_recognizer_py_samples), METH_NOARGS,
+     "samples() -> dict: 文字ごとの学習済みサンプル数"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+// ===== ハンド履歴の取り込み =====
+
+// import_hand_histories(paths, stats=None, history=None, threads=0, store=None) -> dict
+//   stats: HudStats、history: step33の履歴DBのパス、store: HandStore
+static PyObject* py_import_hand_histories(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"paths", "stats", "history", "threads", "store", nullptr};
+    PyObject* paths_obj;
+    PyObject* stats_obj = nullptr;
+    const char* history = nullptr;
+    int threads = 0;
+    PyObject* store_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OziO", const_cast<char**>(kwlist),
+                                     &paths_obj, &stats_obj, &history, &threads, &store_obj)) {
+        return nullptr;
+    }
+
+    void* stats_handle = nullptr;
+    if (stats_obj != nullptr && stats_obj != Py_None) {
+        if (!PyObject_TypeCheck(stats_obj, &HudStatsType)) {
+            PyErr_SetString(PyExc_TypeError, "stats: expected HudStats");
+            return nullptr;
+        }
+        stats_handle = reinterpret_cast<PyHudStats*>(stats_obj)->handle;
+    }
+    void* store_handle = nullptr;
+    if (store_obj != nullptr && store_obj != Py_None) {
+        if (!PyObject_TypeCheck(store_obj, &HandStoreType)) {
+            PyErr_SetString(PyExc_TypeError, "store: expected HandStore");
+            return nullptr;
+        }
+        store_handle = reinterpret_cast<PyHandStore*>(store_obj)->handle;
+    }
+
+    PyObject* seq = PySequence_Fast(paths_obj, "paths: expected a sequence of str");
+    if (seq == nullptr) return nullptr;
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    std::vector<const char*> paths(n);
+    for (Py_ssize_t i = 0; i < n; ++i) {
+        paths[i] = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+        if (paths[i] == nullptr) {
+            Py_DECREF(seq);
+            return nullptr;
+        }
+    }
+
+    // stats/storeオブジェクトは呼び出し側が参照を保持している
+    PokerImportResult result = {};
+    int64_t hands;
+    Py_BEGIN_ALLOW_THREADS
+    hands = hh_import(paths.data(), static_cast<int>(n), stats_handle, history, store_handle,
+                      threads, &result);
+    Py_END_ALLOW_THREADS
+    Py_DECREF(seq);
+    if (hands < 0) {
+        PyErr_SetString(PyExc_OSError, "hand history import failed");
+        return nullptr;
+    }
+
+    return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:d}",
+                         "files", static_cast<unsigned long long>(result.files),
+                         "bytes", static_cast<unsigned long long>(result.bytes),
+                         "hands", static_cast<unsigned long long>(result.hands),
+                         "errors", static_cast<unsigned long long>(result.errors),
+                         "history_rows", static_cast<unsigned long long>(result.history_rows),
+                         "store_rows", static_cast<unsigned long long>(result.store_rows),
+                         "seconds", result.seconds);
+}
+
+// write_builtin_eqr_model(path, model_version=1): 現行定数を焼き込んだモデルを書き出す
+static PyObject* py_write_builtin_eqr_model(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"path", "model_version", nullptr};
+    const char* path;
+    unsigned long long model_version = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|K", const_cast<char**>(kwlist),
+                                     &path, &model_version)) {
+        return nullptr;
+    }
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = eqr_model_write_builtin(path, model_version);
+    Py_END_ALLOW_THREADS
+    if (result != 0) {
+        PyErr_Format(PyExc_OSError, "cannot write EQR model: %s", path);
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+// ===== カード・レンジ文字列 =====
+
+constexpr Py_ssize_t COMBO_COUNT = 1326;
+
+// parse_cards(text) -> bytes: "AsKd7c" をカードID列へ
+static PyObject* py_parse_cards(PyObject*, PyObject* args) {
+    const char* text;
+    if (!PyArg_ParseTuple(args, "s", &text)) return nullptr;
+    uint8_t cards[DECK_SIZE];
+    int count = parse_cards_string(text, cards, DECK_SIZE);
+    if (count < 0) {
+        PyErr_Format(PyExc_ValueError, "invalid card string: %s", text);
+        return nullptr;
+    }
+    return PyBytes_FromStringAndSize(reinterpret_cast<const char*>(cards), count);
+}
+
+// parse_range(text, out=None) -> float32[1326]: コンボ番号順の重み
+static PyObject* py_parse_range(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"text", "out", nullptr};
+    const char* text;
+    PyObject* out_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|O", const_cast<char**>(kwlist),
+                                     &text, &out_obj)) {
+        return nullptr;
+    }
+
+    OutputArray out;
+    if (!out.create(out_obj, COMBO_COUNT, "f", 4)) return nullptr;
+    if (parse_range_string(text, out.data<float>()) < 0) {
+        PyErr_Format(PyExc_ValueError, "invalid range '%s': %s", text, range_parse_error());
+        return nullptr;
+    }
+    return out.release();
+}
+
+// parse_ranges(texts, out=None) -> float32[N*1326]: 不正なレンジは全て0の行になる
+static PyObject* py_parse_ranges(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"texts", "out", nullptr};
+    PyObject* texts_obj;
+    PyObject* out_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(kwlist),
+                                     &texts_obj, &out_obj)) {
+        return nullptr;
+    }
+
+    PyObject* seq = PySequence_Fast(texts_obj, "texts: expected a sequence of str");
+    if (seq == nullptr) return nullptr;
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    std::vector<const char*> texts(n);
+    for (Py_ssize_t i = 0; i < n; ++i) {
+        texts[i] = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+        if (texts[i] == nullptr) {
+            Py_DECREF(seq);
+            return nullptr;
+        }
+    }
+
+    OutputArray out;
+    if (!out.create(out_obj, n * COMBO_COUNT, "f", 4)) {
+        Py_DECREF(seq);
+        return nullptr;
+    }
+    float* dst = out.data<float>();
+
+    // UTF-8バッファはseqが保持する文字列オブジェクトが所有する
+    Py_BEGIN_ALLOW_THREADS
+    parse_range_batch(static_cast<int>(n), texts.data(), dst, nullptr);
+    Py_END_ALLOW_THREADS
+
+    Py_DECREF(seq);
+    return out.release();
+}
+
+// range_remove_cards(weights, dead): デッドカードを含むコンボの重みをその場で0にする
+static PyObject* py_range_remove_cards(PyObject*, PyObject* args) {
+    PyObject* weights_obj;
+    PyObject* dead_obj;
+    if (!PyArg_ParseTuple(args, "OO", &weights_obj, &dead_obj)) return nullptr;
+
+    BufferView weights, dead;
+    if (!weights.acquire(weights_obj, "weights", "f", 4, true)) return nullptr;
+    if (!dead.acquire(dead_obj, "dead", "Bb", 1)) return nullptr;
+    if (weights.size() != COMBO_COUNT) {
+        PyErr_SetString(PyExc_ValueError, "weights: expected 1326 elements");
+        return nullptr;
+    }
+    if (!check_cards(dead.data<uint8_t>(), dead.size())) return nullptr;
+
+    range_remove_cards(weights.data<float>(), dead.data<uint8_t>(),
+                       static_cast<int>(dead.size()));
+    Py_RETURN_NONE;
+}
+
+// range_classes(weights, out=None, frequencies=False) -> float32[169]
+static PyObject* py_range_classes(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"weights", "out", "frequencies", nullptr};
+    PyObject* weights_obj;
+    PyObject* out_obj = nullptr;
+    int frequencies = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Op", const_cast<char**>(kwlist),
+                                     &weights_obj, &out_obj, &frequencies)) {
+        return nullptr;
+    }
+
+    BufferView weights;
+    if (!weights.acquire(weights_obj, "weights", "f", 4)) return nullptr;
+    if (weights.size() != COMBO_COUNT) {
+        PyErr_SetString(PyExc_ValueError, "weights: expected 1326 elements");
+        return nullptr;
+    }
+    OutputArray out;
+    if (!out.create(out_obj, 169, "f", 4)) return nullptr;
+
+    range_to_classes(weights.data<float>(), out.data<float>(), frequencies);
+    return out.release();
+}
+
+// ===== ボード特徴量 =====
+
+// board_features(board) -> dict
+static PyObject* py_board_features(PyObject*, PyObject* args) {
+    PyObject* board_obj;
+    if (!PyArg_ParseTuple(args, "O", &board_obj)) return nullptr;
+
+    BufferView board;
+    if (!board.acquire(board_obj, "board", "Bb", 1)) return nullptr;
+    if (board.size() > 5) {
+        PyErr_SetString(PyExc_ValueError, "board: at most 5 cards");
+        return nullptr;
+    }
+    if (!check_cards(board.data<uint8_t>(), board.size())) return nullptr;
+
+    PokerBoardFeatures f;
+    int32_t iso_index;
+    Py_BEGIN_ALLOW_THREADS   // 初回はテーブル構築が走る
+    iso_index = board_features_c(board.data<uint8_t>(), static_cast<int>(board.size()), &f);
+    Py_END_ALLOW_THREADS
+
+    return Py_BuildValue(
+        "{s:i,s:O,s:O,s:i,s:i,s:i,s:i,s:i,s:i,s:d,s:d,s:K,s:i}",
+        "card_count", f.card_count,
+        "paired", f.paired ? Py_True : Py_False,
+        "trips", f.trips ? Py_True : Py_False,
+        "high_cards", f.high_cards,
+        "max_suit", f.max_suit,
+        "flush_class", f.flush_class,
+        "straight_class", f.straight_class,
+        "texture", f.texture,
+        "eqr_texture", f.eqr_texture,
+        "connectivity", static_cast<double>(f.connectivity),
+        "eqr_factor", static_cast<double>(f.eqr_factor),
+        "danger_cards", static_cast<unsigned long long>(f.danger_cards),
+        "iso_index", iso_index);
+}
+
+// board_textures(boards[N*k] uint8, cards_per_board, out=None) -> int32[N]: EQR用テクスチャ(0-2)
+static PyObject* py_board_textures(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"boards", "cards_per_board", "out", nullptr};
+    PyObject* boards_obj;
+    int per_board;
+    PyObject* out_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|O", const_cast<char**>(kwlist),
+                                     &boards_obj, &per_board, &out_obj)) {
+        return nullptr;
+    }
+
+    BufferView boards;
+    if (!boards.acquire(boards_obj, "boards", "Bb", 1)) return nullptr;
+    if (per_board < 3 || per_board > 5 || boards.size() % per_board != 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "boards: length must be a multiple of cards_per_board (3-5)");
+        return nullptr;
+    }
+    if (!check_cards(boards.data<uint8_t>(), boards.size())) return nullptr;
+
+    Py_ssize_t n = boards.size() / per_board;
+    OutputArray out;
+    if (!out.create(out_obj, n, "i", 4)) return nullptr;
+
+    const uint8_t* src = boards.data<uint8_t>();
+    int32_t* dst = out.data<int32_t>();
+    Py_BEGIN_ALLOW_THREADS
+    board_texture_batch(static_cast<int>(n), src, per_board, dst);
+    Py_END_ALLOW_THREADS
+
+    return out.release();
+}
+
+// ===== アウツ =====
+
+// outs(hero, board, villain=None) -> dict
+//   outs/clean_outs/dirty_outs/nut_outs: カードマスク(bit = カードID)
+//   counts: 改善後の役ごとのアウツ数[9], category/next_street_outs: bytes[52]
+//   villain_better: {カードID: 改善後に上回る相手コンボの割合}（アウツのみ）
+static PyObject* py_outs(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"hero", "board", "villain", nullptr};
+    PyObject* hero_obj;
+    PyObject* board_obj;
+    PyObject* villain_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", const_cast<char**>(kwlist),
+                                     &hero_obj, &board_obj, &villain_obj)) {
+        return nullptr;
+    }
+
+    BufferView hero, board, villain;
+    if (!hero.acquire(hero_obj, "hero", "Bb", 1)) return nullptr;
+    if (!board.acquire(board_obj, "board", "Bb", 1)) return nullptr;
+    if (hero.size() != 2 || board.size() < 3 || board.size() > 4) {
+        PyErr_SetString(PyExc_ValueError, "expected 2 hero cards and a 3-4 card board");
+        return nullptr;
+    }
+    if (!check_cards(hero.data<uint8_t>(), 2) ||
+        !check_cards(board.data<uint8_t>(), board.size())) {
+        return nullptr;
+    }
+    const float* villain_weights = nullptr;
+    if (villain_obj != nullptr && villain_obj != Py_None) {
+        if (!villain.acquire(villain_obj, "villain", "f", 4)) return nullptr;
+        if (villain.size() != COMBO_COUNT) {
+            PyErr_SetString(PyExc_ValueError, "villain: expected 1326 elements");
+            return nullptr;
+        }
+        villain_weights = villain.data<float>();
+    }
+
+    PokerOutsReport report;
+    int n;
+    Py_BEGIN_ALLOW_THREADS
+    n = outs_analyze(hero.data<uint8_t>()[0], hero.data<uint8_t>()[1], board.data<uint8_t>(),
+                     static_cast<int>(board.size()), villain_weights, &report);
+    Py_END_ALLOW_THREADS
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "duplicate cards in hero/board");
+        return nullptr;
+    }
+
+    PyObject* better = PyDict_New();
+    if (better == nullptr) return nullptr;
+    for (int c = 0; c < DECK_SIZE; ++c) {
+        if (!((report.outs >> c) & 1)) continue;
+        PyObject* key = PyLong_FromLong(c);
+        PyObject* value = PyFloat_FromDouble(report.villain_better[c]);
+        int rc = (key && value) ? PyDict_SetItem(better, key, value) : -1;
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        if (rc != 0) {
+            Py_DECREF(better);
+            return nullptr;
+        }
+    }
+
+    const int* k = report.counts;
+    return Py_BuildValue(
+        "{s:K,s:K,s:K,s:K,s:[iiiiiiiii],s:y#,s:y#,s:N}",
+        "outs", static_cast<unsigned long long>(report.outs),
+        "clean_outs", static_cast<unsigned long long>(report.clean_outs),
+        "dirty_outs", static_cast<unsigned long long>(report.outs & ~report.clean_outs),
+        "nut_outs", static_cast<unsigned long long>(report.nut_outs),
+        "counts", k[0], k[1], k[2], k[3], k[4], k[5], k[6], k[7], k[8],
+        "category", reinterpret_cast<const char*>(report.category), Py_ssize_t(DECK_SIZE),
+        "next_street_outs", reinterpret_cast<const char*>(report.next_street_outs),
+        Py_ssize_t(DECK_SIZE),
+        "villain_better", better);
+}
+
+// outs_range(weights, board, out=None) -> (uint64[1326] アウツのマスク, 役ごとの平均アウツ数[9])
+static PyObject* py_outs_range(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"weights", "board", "out", nullptr};
+    PyObject* weights_obj;
+    PyObject* board_obj;
+    PyObject* out_obj = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", const_cast<char**>(kwlist),
+                                     &weights_obj, &board_obj, &out_obj)) {
+        return nullptr;
+    }
+
+    BufferView weights, board;
+    if (!weights.acquire(weights_obj, "weights", "f", 4)) return nullptr;
+    if (!board.acquire(board_obj, "board", "Bb", 1)) return nullptr;
+    if (weights.size() != COMBO_COUNT) {
+        PyErr_SetString(PyExc_ValueError, "weights: expected 1326 elements");
+        return nullptr;
+    }
+    if (board.size() < 3 || board.size() > 4) {
+        PyErr_SetString(PyExc_ValueError, "board: expected 3-4 cards");
+        return nullptr;
+    }
+    if (!check_cards(board.data<uint8_t>(), board.size())) return nullptr;
+
+    OutputArray out;
+    if (!out.create(out_obj, COMBO_COUNT, "Q", 8)) return nullptr;
+
+    double counts[9];
+    int rc;
+    const float* w = weights.data<float>();
+    const uint8_t* cards = board.data<uint8_t>();
+    uint64_t* masks = out.data<uint64_t>();
+    Py_BEGIN_ALLOW_THREADS
+    rc = outs_analyze_range(w, cards, static_cast<int>(board.size()), masks, counts);
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        PyErr_SetString(PyExc_ValueError, "board: duplicate cards");
+        return nullptr;
+    }
+
+    return Py_BuildValue("(N[ddddddddd])", out.release(),
+                         counts[0], counts[1], counts[2], counts[3], counts[4],
+                         counts[5], counts[6], counts[7], counts[8]);
+}
+
+// ===== モジュール定義 =====
+
+static PyMethodDef module_methods[] = {
+    {"evaluate", as_cfunction(py_evaluate),
+     METH_VARARGS | METH_KEYWORDS,
+     "evaluate(cards, out=None) -> uint32[N]: 7枚ハンドをN件まとめて評価"},
+    {"equity", as_cfunction(py_equity),
+     METH_VARARGS | METH_KEYWORDS,
+     "equity(hero, board=None, opponents=1, iterations=100000) -> float"},
+    {"equity_batch", as_cfunction(py_equity_batch),
+     METH_VARARGS | METH_KEYWORDS,
+     "equity_batch(hands, board=None, opponents=1, iterations=50000, out=None) -> float32[N]"},
+    {"eqr_batch", as_cfunction(py_eqr_batch),
+     METH_VARARGS | METH_KEYWORDS,
+     "eqr_batch(raw_equity, position, stack, pot, board_texture, opponents, "
+     "in_position, opponent_skill, out=None, factors=False) -> float64[N] | tuple"},
+    {"write_builtin_eqr_model", as_cfunction(py_write_builtin_eqr_model),
+     METH_VARARGS | METH_KEYWORDS,
+     "write_builtin_eqr_model(path, model_version=1): 現行定数のEQRモデルを書き出す"},
+    {"parse_cards", as_cfunction(py_parse_cards), METH_VARARGS,
+     "parse_cards(text) -> bytes: カード文字列 ('AsKd7c') をカードID列へ"},
+    {"parse_range", as_cfunction(py_parse_range),
+     METH_VARARGS | METH_KEYWORDS,
+     "parse_range(text, out=None) -> float32[1326]: レンジ文字列をコンボ重みへ展開"},
+    {"parse_ranges", as_cfunction(py_parse_ranges),
+     METH_VARARGS | METH_KEYWORDS,
+     "parse_ranges(texts, out=None) -> float32[N*1326]: 複数のレンジをまとめて展開"},
+    {"range_remove_cards", as_cfunction(py_range_remove_cards), METH_VARARGS,
+     "range_remove_cards(weights, dead): デッドカードを含むコンボを除去（その場で更新）"},
+    {"range_classes", as_cfunction(py_range_classes),
+     METH_VARARGS | METH_KEYWORDS,
+     "range_classes(weights, out=None, frequencies=False) -> float32[169]: 13x13クラスへ集計"},
+    {"board_features", as_cfunction(py_board_features), METH_VARARGS,
+     "board_features(board) -> dict: ボード特徴量（同型ボードの事前計算テーブルを参照）"},
+    {"board_textures", as_cfunction(py_board_textures),
+     METH_VARARGS | METH_KEYWORDS,
+     "board_textures(boards, cards_per_board, out=None) -> int32[N]: EQR用テクスチャ(0-2)"},
+    {"import_hand_histories", as_cfunction(py_import_hand_histories),
+     METH_VARARGS | METH_KEYWORDS,
+     "import_hand_histories(paths, stats=None, history=None, threads=0, store=None) -> dict: "
+     "PokerStars形式のハンド履歴を並列に取り込む"},
+    {"outs", as_cfunction(py_outs), METH_VARARGS | METH_KEYWORDS,
+     "outs(hero, board, villain=None) -> dict: アウツと改善カテゴリ、相手レンジに対するダーティ判定"},
+    {"outs_range", as_cfunction(py_outs_range), METH_VARARGS | METH_KEYWORDS,
+     "outs_range(weights, board, out=None) -> (uint64[1326], list[9]): レンジ全体のアウツ"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyModuleDef engine_module = {
+    PyModuleDef_HEAD_INIT,
+    "poker_engine",
+    "Poker engine native extension (zero-copy buffer protocol, GIL released)",
+    -1,
+    module_methods
+};
+
+static bool add_type(PyObject* module, PyTypeObject* type, const char* name) {
+    if (PyType_Ready(type) < 0) return false;
+    Py_INCREF(type);
+    if (PyModule_AddObject(module, name, reinterpret_cast<PyObject*>(type)) < 0) {
+        Py_DECREF(type);
+        return false;
+    }
+    return true;
+}
+
+} // namespace PyEngine
+
+extern "C" PyMODINIT_FUNC PyInit_poker_engine() {
+    using namespace PyEngine;
+
+    CFRSolverType.tp_name = "poker_engine.CFRSolver";
+    CFRSolverType.tp_basicsize = sizeof(PyCFRSolver);
+    CFRSolverType.tp_flags = Py_TPFLAGS_DEFAULT;
+    CFRSolverType.tp_doc = "CFRソルバー（train/exploitabilityはGILを解放し、同じソルバーへの呼び出しは直列化）";
+    CFRSolverType.tp_new = solver_new;
+    CFRSolverType.tp_dealloc = reinterpret_cast<destructor>(solver_dealloc);
+    CFRSolverType.tp_methods = solver_methods;
+
+    EQRModelType.tp_name = "poker_engine.EQRModel";
+    EQRModelType.tp_basicsize = sizeof(PyEQRModel);
+    EQRModelType.tp_flags = Py_TPFLAGS_DEFAULT;
+    EQRModelType.tp_doc = "EQRModel(path): mmapしたキャリブレーション済みEQRモデル（ホットリロード可）";
+    EQRModelType.tp_new = eqr_model_new;
+    EQRModelType.tp_dealloc = reinterpret_cast<destructor>(eqr_model_dealloc);
+    EQRModelType.tp_methods = eqr_model_methods;
+
+    HudStatsType.tp_name = "poker_engine.HudStats";
+    HudStatsType.tp_basicsize = sizeof(PyHudStats);
+    HudStatsType.tp_flags = Py_TPFLAGS_DEFAULT;
+    HudStatsType.tp_doc = "HudStats(path=None): 列指向のHUD統計ストア（pathはmmapで開く）";
+    HudStatsType.tp_new = hud_stats_new;
+    HudStatsType.tp_dealloc = reinterpret_cast<destructor>(hud_stats_dealloc);
+    HudStatsType.tp_methods = hud_stats_methods;
+
+    HandStoreType.tp_name = "poker_engine.HandStore";
+    HandStoreType.tp_basicsize = sizeof(PyHandStore);
+    HandStoreType.tp_flags = Py_TPFLAGS_DEFAULT;
+    HandStoreType.tp_doc = "HandStore(path, read_only=False, sync=True): 追記型ハンドストア（step52）";
+    HandStoreType.tp_new = hand_store_new;
+    HandStoreType.tp_dealloc = reinterpret_cast<destructor>(hand_store_dealloc);
+    HandStoreType.tp_methods = hand_store_methods;
+
+    AggregateCubeType.tp_name = "poker_engine.AggregateCube";
+    AggregateCubeType.tp_basicsize = sizeof(PyAggregateCube);
+    AggregateCubeType.tp_flags = Py_TPFLAGS_DEFAULT;
+    AggregateCubeType.tp_doc = "AggregateCube(path=None, utc_offset=0): 増分更新の集計キューブ（step56）";
+    AggregateCubeType.tp_new = aggregate_cube_new;
+    AggregateCubeType.tp_dealloc = reinterpret_cast<destructor>(aggregate_cube_dealloc);
+    AggregateCubeType.tp_methods = aggregate_cube_methods;
+
+    PerformanceStreamType.tp_name = "poker_engine.PerformanceStream";
+    PerformanceStreamType.tp_basicsize = sizeof(PyPerformanceStream);
+    PerformanceStreamType.tp_flags = Py_TPFLAGS_DEFAULT;
+    PerformanceStreamType.tp_doc =
+        "PerformanceStream(window=100, trend_window=100, alpha=0.05): 収支の逐次集計（step57）";
+    PerformanceStreamType.tp_new = performance_stream_new;
+    PerformanceStreamType.tp_dealloc = reinterpret_cast<destructor>(performance_stream_dealloc);
+    PerformanceStreamType.tp_methods = performance_stream_methods;
+
+    CardRecognizerType.tp_name = "poker_engine.CardRecognizer";
+    CardRecognizerType.tp_basicsize = sizeof(PyCardRecognizer);
+    CardRecognizerType.tp_flags = Py_TPFLAGS_DEFAULT;
+    CardRecognizerType.tp_doc =
+        "CardRecognizer(path=None, rank_box=None, suit_box=None): スキンごとのカード認識（step58）";
+    CardRecognizerType.tp_new = card_recognizer_new;
+    CardRecognizerType.tp_dealloc = reinterpret_cast<destructor>(card_recognizer_dealloc);
+    CardRecognizerType.tp_methods = card_recognizer_methods;
+
+    FrameGateType.tp_name = "poker_engine.FrameGate";
+    FrameGateType.tp_basicsize = sizeof(PyFrameGate);
+    FrameGateType.tp_flags = Py_TPFLAGS_DEFAULT;
+    FrameGateType.tp_doc = "FrameGate(hash_threshold=1, cell_threshold=4): キャプチャフレームの変化検出（step59）";
+    FrameGateType.tp_new = frame_gate_new;
+    FrameGateType.tp_dealloc = reinterpret_cast<destructor>(frame_gate_dealloc);
+    FrameGateType.tp_methods = frame_gate_methods;
+
+    CapturePipelineType.tp_name = "poker_engine.CapturePipeline";
+    CapturePipelineType.tp_basicsize = sizeof(PyCapturePipeline);
+    CapturePipelineType.tp_flags = Py_TPFLAGS_DEFAULT;
+    CapturePipelineType.tp_doc =
+        "CapturePipeline(redetect_interval=2.0, layout_threshold=0.6): 複数テーブルのキャプチャパイプライン（step60）";
+    CapturePipelineType.tp_new = capture_pipeline_new;
+    CapturePipelineType.tp_dealloc = reinterpret_cast<destructor>(capture_pipeline_dealloc);
+    CapturePipelineType.tp_methods = capture_pipeline_methods;
+
+    CaptureJobType.tp_name = "poker_engine.CaptureJob";
+    CaptureJobType.tp_basicsize = sizeof(PyCaptureJob);
+    CaptureJobType.tp_flags = Py_TPFLAGS_DEFAULT;
+    CaptureJobType.tp_doc = "CapturePipeline.next_jobが返す抽出・再検出の依頼（バッファプロトコルで画像を読める）";
+    CaptureJobType.tp_dealloc = reinterpret_cast<destructor>(capture_job_dealloc);
+    CaptureJobType.tp_methods = capture_job_methods;
+    CaptureJobType.tp_getset = capture_job_getset;
+    CaptureJobType.tp_as_buffer = &capture_job_buffer_procs;
+
+    AmountRecognizerType.tp_name = "poker_engine.AmountRecognizer";
+    AmountRecognizerType.tp_basicsize = sizeof(PyAmountRecognizer);
+    AmountRecognizerType.tp_flags = Py_TPFLAGS_DEFAULT;
+    AmountRecognizerType.tp_doc = "AmountRecognizer(path=None): スキンごとの金額の認識（step61）";
+    AmountRecognizerType.tp_new = amount_recognizer_new;
+    AmountRecognizerType.tp_dealloc = reinterpret_cast<destructor>(amount_recognizer_dealloc);
+    AmountRecognizerType.tp_methods = amount_recognizer_methods;
+
+    PyObject* module = PyModule_Create(&engine_module);
+    if (module == nullptr) return nullptr;
+
+    if (!add_type(module, &CFRSolverType, "CFRSolver") ||
+        !add_type(module, &EQRModelType, "EQRModel") ||
+        !add_type(module, &HudStatsType, "HudStats") ||
+        !add_type(module, &HandStoreType, "HandStore") ||
+        !add_type(module, &AggregateCubeType, "AggregateCube") ||
+        !add_type(module, &PerformanceStreamType, "PerformanceStream") ||
+        !add_type(module, &CardRecognizerType, "CardRecognizer") ||
+        !add_type(module, &FrameGateType, "FrameGate") ||
+        !add_type(module, &CapturePipelineType, "CapturePipeline") ||
+        !add_type(module, &CaptureJobType, "CaptureJob") ||
+        !add_type(module, &AmountRecognizerType, "AmountRecognizer")) {
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
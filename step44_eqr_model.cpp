@@ -0,0 +1,476 @@
+// step44_eqr_model.cpp
+// キャリブレーション済みEQRモデル（データ駆動）
+// ポジション × SPR × テクスチャ × ポジション有利 × 相手人数 × ストリート × スキル の
+// 密な多次元グリッドに実現係数を持ち、多重線形補間で参照する。
+// モデルはバージョン付きバイナリファイルからmmapで読み込み、エンジンを止めずに差し替えられる。
+#ifndef POKER_STEP44_EQR_MODEL_CPP
+#define POKER_STEP44_EQR_MODEL_CPP
+
+#include "step9_eqr_complete.cpp"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace EQRModel {
+
+// グリッドの軸（ファイル内の並び順 = 値配列の次元順）
+enum Axis : int {
+    AXIS_POSITION = 0,   // 0-8 (UTG..BB)
+    AXIS_SPR,            // Stack-to-Pot Ratio
+    AXIS_TEXTURE,        // 0=dry, 1=semi-wet, 2=wet
+    AXIS_IN_POSITION,    // 0=OOP, 1=IP
+    AXIS_OPPONENTS,      // 相手人数
+    AXIS_STREET,         // 0=preflop .. 3=river
+    AXIS_SKILL,          // 0.0 (weak) - 1.0 (strong)
+    AXIS_COUNT
+};
+
+constexpr char FILE_MAGIC[8] = {'P', 'K', 'E', 'Q', 'R', 'M', 'D', 'L'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+// ファイルレイアウト:
+//   FileHeader
+//   double coordinates[sum(axis_sizes)]   各軸のグリッド座標（昇順）
+//   double values[prod(axis_sizes)]       実現係数（row-major、最後の軸が最内）
+struct FileHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t axis_count;
+    uint64_t model_version;   // キャリブレーションの世代番号
+    uint64_t checksum;        // ペイロード（座標+値）のFNV-1a
+    uint32_t axis_sizes[AXIS_COUNT];
+    uint32_t reserved;
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout must stay stable");
+
+inline uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 1469598103934665603ULL) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 軸上の位置を求める: grid[lo] <= x < grid[lo+1] と補間率 t (範囲外は端にクランプしてt=0)
+inline void locate(const double* grid, int n, double x, int& lo, double& t) {
+    t = 0.0;
+    if (!(x > grid[0])) {
+        lo = 0;
+    } else if (x >= grid[n - 1]) {
+        lo = n - 1;
+    } else {
+        // 軸は数点〜十数点なので線形探索
+        lo = 0;
+        while (grid[lo + 1] <= x) ++lo;
+        t = (x - grid[lo]) / (grid[lo + 1] - grid[lo]);
+    }
+}
+
+// 読み込み済みモデル（不変）。mmapした領域を直接参照する
+class Model {
+private:
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    const FileHeader* header = nullptr;
+    const double* axis_coords[AXIS_COUNT] = {};
+    const double* values = nullptr;
+    size_t strides[AXIS_COUNT] = {};
+
+    Model() = default;
+
+public:
+    ~Model() {
+        if (mapping != nullptr) munmap(mapping, mapping_size);
+    }
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+
+    // ファイルをmmapして検証する。失敗時はnullptrを返しerrorに理由を入れる
+    static std::shared_ptr<const Model> open(const std::string& path, std::string& error) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = "cannot open " + path;
+            return nullptr;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+            ::close(fd);
+            error = "file too small: " + path;
+            return nullptr;
+        }
+
+        std::shared_ptr<Model> model(new Model());
+        model->mapping_size = static_cast<size_t>(st.st_size);
+        model->mapping = mmap(nullptr, model->mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (model->mapping == MAP_FAILED) {
+            model->mapping = nullptr;
+            error = "mmap failed: " + path;
+            return nullptr;
+        }
+        if (!model->validate(error)) return nullptr;
+        return model;
+    }
+
+    uint64_t version() const { return header->model_version; }
+    int axis_size(int axis) const { return static_cast<int>(header->axis_sizes[axis]); }
+    const double* coordinates(int axis) const { return axis_coords[axis]; }
+
+    // 多重線形補間で実現係数を求める（範囲外は端の値にクランプ）
+    double factor(const double point[AXIS_COUNT]) const {
+        size_t base = 0;
+        int active = 0;
+        double weights[AXIS_COUNT];
+        size_t active_strides[AXIS_COUNT];
+
+        for (int a = 0; a < AXIS_COUNT; ++a) {
+            int lo;
+            double t;
+            locate(axis_coords[a], axis_size(a), point[a], lo, t);
+            base += lo * strides[a];
+            if (t > 0.0) {
+                weights[active] = t;
+                active_strides[active] = strides[a];
+                ++active;
+            }
+        }
+
+        // 補間が必要な軸の頂点だけを走査する（離散軸は重み1の1点）
+        double result = 0.0;
+        for (int corner = 0; corner < (1 << active); ++corner) {
+            double w = 1.0;
+            size_t offset = base;
+            for (int k = 0; k < active; ++k) {
+                if (corner & (1 << k)) {
+                    w *= weights[k];
+                    offset += active_strides[k];
+                } else {
+                    w *= 1.0 - weights[k];
+                }
+            }
+            result += w * values[offset];
+        }
+        return result;
+    }
+
+private:
+    bool validate(std::string& error) {
+        header = static_cast<const FileHeader*>(mapping);
+        if (std::memcmp(header->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            error = "bad magic";
+            return false;
+        }
+        if (header->format_version != FORMAT_VERSION || header->axis_count != AXIS_COUNT) {
+            error = "unsupported format version";
+            return false;
+        }
+
+        size_t coord_count = 0;
+        size_t value_count = 1;
+        for (int a = AXIS_COUNT - 1; a >= 0; --a) {
+            uint32_t n = header->axis_sizes[a];
+            if (n == 0 || n > 4096) {
+                error = "invalid axis size";
+                return false;
+            }
+            strides[a] = value_count;
+            coord_count += n;
+            value_count *= n;
+            if (value_count > (size_t(1) << 28)) {
+                error = "grid too large";
+                return false;
+            }
+        }
+
+        size_t payload = (coord_count + value_count) * sizeof(double);
+        if (mapping_size != sizeof(FileHeader) + payload) {
+            error = "file size does not match header";
+            return false;
+        }
+        const char* body = static_cast<const char*>(mapping) + sizeof(FileHeader);
+        if (fnv1a(body, payload) != header->checksum) {
+            error = "checksum mismatch";
+            return false;
+        }
+
+        const double* coords = reinterpret_cast<const double*>(body);
+        for (int a = 0; a < AXIS_COUNT; ++a) {
+            axis_coords[a] = coords;
+            for (uint32_t i = 1; i < header->axis_sizes[a]; ++i) {
+                if (!(coords[i] > coords[i - 1])) {
+                    error = "axis coordinates must be strictly increasing";
+                    return false;
+                }
+            }
+            coords += header->axis_sizes[a];
+        }
+        values = coords;
+        return true;
+    }
+};
+
+// モデルファイルの書き出し。一時ファイルに書いてからrenameするため、
+// 稼働中のリーダーが書きかけのファイルを読むことはない
+class ModelWriter {
+public:
+    std::vector<double> axes[AXIS_COUNT];
+    std::vector<double> values;
+    uint64_t model_version = 1;
+
+    size_t value_count() const {
+        size_t n = 1;
+        for (const auto& axis : axes) n *= axis.size();
+        return n;
+    }
+
+    // 軸座標を設定し、値配列を初期化する
+    void set_axes(const std::vector<double> (&new_axes)[AXIS_COUNT], double initial = 1.0) {
+        for (int a = 0; a < AXIS_COUNT; ++a) axes[a] = new_axes[a];
+        values.assign(value_count(), initial);
+    }
+
+    size_t index(const int (&idx)[AXIS_COUNT]) const {
+        size_t offset = 0;
+        for (int a = 0; a < AXIS_COUNT; ++a) {
+            offset = offset * axes[a].size() + static_cast<size_t>(idx[a]);
+        }
+        return offset;
+    }
+
+    bool write(const std::string& path, std::string& error) const {
+        if (values.size() != value_count() || values.empty()) {
+            error = "values do not match axis sizes";
+            return false;
+        }
+
+        std::vector<double> payload;
+        for (const auto& axis : axes) payload.insert(payload.end(), axis.begin(), axis.end());
+        payload.insert(payload.end(), values.begin(), values.end());
+
+        FileHeader header = {};
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.format_version = FORMAT_VERSION;
+        header.axis_count = AXIS_COUNT;
+        header.model_version = model_version;
+        header.checksum = fnv1a(payload.data(), payload.size() * sizeof(double));
+        for (int a = 0; a < AXIS_COUNT; ++a) {
+            header.axis_sizes[a] = static_cast<uint32_t>(axes[a].size());
+        }
+
+        std::string tmp = path + ".tmp";
+        FILE* fp = std::fopen(tmp.c_str(), "wb");
+        if (fp == nullptr) {
+            error = "cannot create " + tmp;
+            return false;
+        }
+        bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                  std::fwrite(payload.data(), sizeof(double), payload.size(), fp) == payload.size();
+        ok = (std::fflush(fp) == 0) && ok;
+        ok = (fsync(fileno(fp)) == 0) && ok;
+        ok = (std::fclose(fp) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            error = "failed to write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    // 現行のハードコード定数(step9)をグリッドに焼き込んだ初期モデル
+    static ModelWriter from_builtin_factors(uint64_t model_version = 1) {
+        using namespace EQRCalculator;
+
+        ModelWriter writer;
+        writer.model_version = model_version;
+        // SPRはstep9と同じ階段関数にするため、各ブラケットの境界の直前（1つ小さいdouble）と
+        // 境界の両方に点を置く（間に他のdoubleが無いので補間しても段差がそのまま残る）
+        std::vector<double> spr_grid = {0.0};
+        for (double boundary : StackDepthAdjustment::BRACKETS) {
+            spr_grid.push_back(std::nextafter(boundary, 0.0));
+            spr_grid.push_back(boundary);
+        }
+        std::vector<double> grid[AXIS_COUNT] = {
+            {0, 1, 2, 3, 4, 5, 6, 7, 8},
+            spr_grid,
+            {0, 1, 2},
+            {0, 1},
+            {1, 2, 3, 4, 5, 6, 7, 8, 9},
+            {0, 1, 2, 3},
+            {0.0, 1.0},
+        };
+        writer.set_axes(grid);
+
+        const int spr_points = static_cast<int>(spr_grid.size());
+        int idx[AXIS_COUNT];
+        for (idx[0] = 0; idx[0] < 9; ++idx[0])
+        for (idx[1] = 0; idx[1] < spr_points; ++idx[1])
+        for (idx[2] = 0; idx[2] < 3; ++idx[2])
+        for (idx[3] = 0; idx[3] < 2; ++idx[3])
+        for (idx[4] = 0; idx[4] < 9; ++idx[4])
+        for (idx[5] = 0; idx[5] < 4; ++idx[5])
+        for (idx[6] = 0; idx[6] < 2; ++idx[6]) {
+            writer.values[writer.index(idx)] =
+                PositionFactors::get_factor(idx[0]) *
+                StackDepthAdjustment::calculate(spr_grid[idx[1]]) *
+                BoardTextureAdjustment::calculate(idx[2], idx[3] != 0) *
+                MultiwayAdjustment::calculate(static_cast<int>(grid[AXIS_OPPONENTS][idx[4]])) *
+                StreetAdjustment::FACTORS[idx[5]] *
+                SkillAdjustment::calculate(grid[AXIS_SKILL][idx[6]]);
+        }
+        return writer;
+    }
+};
+
+// モデルのホットリロード管理
+// 参照側は現在のモデルをshared_ptrで取得するだけなので、差し替え中も古いモデルで
+// 計算を続けられ、最後の参照が外れた時点でmunmapされる
+class ModelStore {
+private:
+    std::string path;
+    std::shared_ptr<const Model> current;
+    std::mutex reload_mutex;
+    // 読み込み済みファイルの識別子（変更検出用）
+    dev_t loaded_dev = 0;
+    ino_t loaded_ino = 0;
+    off_t loaded_size = 0;
+    struct timespec loaded_mtime = {};
+    std::string last_error;
+
+public:
+    explicit ModelStore(std::string model_path) : path(std::move(model_path)) {}
+
+    std::shared_ptr<const Model> get() const {
+        return std::atomic_load(&current);
+    }
+
+    const std::string& error() const { return last_error; }
+
+    // ファイルが更新されていれば読み直す
+    // 戻り値: 1=差し替えた, 0=変更なし, -1=失敗（現行モデルを維持）
+    int reload_if_changed() {
+        std::lock_guard<std::mutex> lock(reload_mutex);
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+            last_error = "cannot stat " + path;
+            return -1;
+        }
+        if (current && st.st_dev == loaded_dev && st.st_ino == loaded_ino &&
+            st.st_size == loaded_size &&
+            st.st_mtim.tv_sec == loaded_mtime.tv_sec &&
+            st.st_mtim.tv_nsec == loaded_mtime.tv_nsec) {
+            return 0;
+        }
+
+        auto model = Model::open(path, last_error);
+        if (!model) return -1;
+
+        std::atomic_store(&current, model);
+        loaded_dev = st.st_dev;
+        loaded_ino = st.st_ino;
+        loaded_size = st.st_size;
+        loaded_mtime = st.st_mtim;
+        return 1;
+    }
+};
+
+// キャリブレーション済みモデルによるEQR
+class CalibratedEQR {
+public:
+    static double calculate(const Model& model, double raw_equity, int position,
+                            double stack, double pot, int board_texture, int opponents,
+                            bool in_position, int street, double opponent_skill) {
+        double point[AXIS_COUNT];
+        point[AXIS_POSITION] = position;
+        point[AXIS_SPR] = pot > 0 ? stack / pot : 100.0;
+        point[AXIS_TEXTURE] = board_texture;
+        point[AXIS_IN_POSITION] = in_position ? 1.0 : 0.0;
+        point[AXIS_OPPONENTS] = opponents;
+        point[AXIS_STREET] = street;
+        point[AXIS_SKILL] = opponent_skill;
+
+        double eqr = raw_equity * model.factor(point);
+        return std::min(1.0, std::max(0.0, eqr));
+    }
+};
+
+} // namespace EQRModel
+
+extern "C" {
+    using namespace EQRModel;
+
+    // モデルファイルを開く（失敗時はnullptr）
+    void* eqr_model_open(const char* path) {
+        auto* store = new ModelStore(path);
+        if (store->reload_if_changed() != 1) {
+            std::fprintf(stderr, "eqr_model_open: %s\n", store->error().c_str());
+            delete store;
+            return nullptr;
+        }
+        return store;
+    }
+
+    void eqr_model_close(void* handle) {
+        delete static_cast<ModelStore*>(handle);
+    }
+
+    // 1=差し替えた, 0=変更なし, -1=失敗（現行モデルを維持）
+    int eqr_model_reload(void* handle) {
+        return static_cast<ModelStore*>(handle)->reload_if_changed();
+    }
+
+    uint64_t eqr_model_version(void* handle) {
+        return static_cast<ModelStore*>(handle)->get()->version();
+    }
+
+    double eqr_model_calculate(
+        void* handle,
+        double raw_equity, int position, double stack, double pot,
+        int board_texture, int opponents, bool in_position,
+        int street, double opponent_skill
+    ) {
+        auto model = static_cast<ModelStore*>(handle)->get();
+        return CalibratedEQR::calculate(*model, raw_equity, position, stack, pot,
+                                        board_texture, opponents, in_position,
+                                        street, opponent_skill);
+    }
+
+    // バッチ版: 呼び出し中は同じモデル世代を使う
+    void eqr_model_calculate_batch(
+        void* handle, int count,
+        const double* raw_equity, const int32_t* position,
+        const double* stack, const double* pot,
+        const int32_t* board_texture, const int32_t* opponents,
+        const uint8_t* in_position, const int32_t* street,
+        const double* opponent_skill, double* out_eqr
+    ) {
+        auto model = static_cast<ModelStore*>(handle)->get();
+        for (int i = 0; i < count; ++i) {
+            out_eqr[i] = CalibratedEQR::calculate(
+                *model, raw_equity[i], position[i], stack[i], pot[i],
+                board_texture[i], opponents[i], in_position[i] != 0,
+                street[i], opponent_skill[i]);
+        }
+    }
+
+    // 現行のハードコード定数を焼き込んだモデルファイルを書き出す
+    int eqr_model_write_builtin(const char* path, uint64_t model_version) {
+        std::string error;
+        if (!ModelWriter::from_builtin_factors(model_version).write(path, error)) {
+            std::fprintf(stderr, "eqr_model_write_builtin: %s\n", error.c_str());
+            return -1;
+        }
+        return 0;
+    }
+}
+
+#endif // POKER_STEP44_EQR_MODEL_CPP
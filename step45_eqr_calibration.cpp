@@ -0,0 +1,483 @@
+// step45_eqr_calibration.cpp
+// EQRモデル(step44)のキャリブレーション・パイプライン
+// ソルバー出力（CSV）またはハンド履歴DB(step33)から「生エクイティに対して実際に回収した取り分」を
+// サンプルとして読み出し、多重線形補間の重みでグリッド頂点へ配分して実現係数を推定する。
+// 読み込みはストリーミング（有界キューでバッチ受け渡し）、集計はスレッドごとの
+// アキュムレータで行い最後にマージする。サンプルの少ないセルは事前モデルへ縮約する。
+#ifndef POKER_STEP45_EQR_CALIBRATION_CPP
+#define POKER_STEP45_EQR_CALIBRATION_CPP
+
+#include "step44_eqr_model.cpp"
+#include "step46_range_parser.cpp"
+#include "step48_board_features.cpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <thread>
+#ifdef POKER_ENGINE_HAS_SQLITE
+#include <sqlite3.h>
+#endif
+
+namespace EQRCalibration {
+
+using namespace EQRModel;
+using BoardFeatureEngine::BoardFeatureTable;
+
+// 1サンプル: グリッド上の点・生エクイティ・実現した取り分（ポットに対する割合）・重み
+struct Sample {
+    double point[AXIS_COUNT];
+    double raw_equity;
+    double realized;
+    double weight;
+};
+
+using SampleBatch = std::vector<Sample>;
+
+// 読み込みスレッドと集計スレッドの間の有界キュー
+// 容量を超えるとpushがブロックするため、入力全体をメモリに載せない
+class BatchQueue {
+private:
+    std::deque<SampleBatch> batches;
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit BatchQueue(size_t max_batches) : capacity(std::max<size_t>(1, max_batches)) {}
+
+    void push(SampleBatch&& batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [&] { return batches.size() < capacity; });
+        batches.push_back(std::move(batch));
+        not_empty.notify_one();
+    }
+
+    // キューが閉じられて空になったらfalse
+    bool pop(SampleBatch& batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [&] { return !batches.empty() || closed; });
+        if (batches.empty()) return false;
+        batch = std::move(batches.front());
+        batches.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+    }
+};
+
+// グリッド頂点ごとの加重和
+//   realized_sum = Σ w·realized,  equity_sum = Σ w·raw_equity,  weight_sum = Σ w
+class GridAccumulator {
+private:
+    const std::vector<double>* axes;
+    size_t strides[AXIS_COUNT];
+
+public:
+    std::vector<double> realized_sum;
+    std::vector<double> equity_sum;
+    std::vector<double> weight_sum;
+    uint64_t samples = 0;
+
+    explicit GridAccumulator(const ModelWriter& layout) : axes(layout.axes) {
+        size_t n = 1;
+        for (int a = AXIS_COUNT - 1; a >= 0; --a) {
+            strides[a] = n;
+            n *= axes[a].size();
+        }
+        realized_sum.assign(n, 0.0);
+        equity_sum.assign(n, 0.0);
+        weight_sum.assign(n, 0.0);
+    }
+
+    // Model::factorの補間と同じ重みでサンプルを頂点へ配分する
+    void add(const Sample& s) {
+        size_t base = 0;
+        int active = 0;
+        double weights[AXIS_COUNT];
+        size_t active_strides[AXIS_COUNT];
+        for (int a = 0; a < AXIS_COUNT; ++a) {
+            int lo;
+            double t;
+            locate(axes[a].data(), static_cast<int>(axes[a].size()), s.point[a], lo, t);
+            base += lo * strides[a];
+            if (t > 0.0) {
+                weights[active] = t;
+                active_strides[active] = strides[a];
+                ++active;
+            }
+        }
+
+        for (int corner = 0; corner < (1 << active); ++corner) {
+            double w = s.weight;
+            size_t offset = base;
+            for (int k = 0; k < active; ++k) {
+                if (corner & (1 << k)) {
+                    w *= weights[k];
+                    offset += active_strides[k];
+                } else {
+                    w *= 1.0 - weights[k];
+                }
+            }
+            realized_sum[offset] += w * s.realized;
+            equity_sum[offset] += w * s.raw_equity;
+            weight_sum[offset] += w;
+        }
+        ++samples;
+    }
+
+    void merge(const GridAccumulator& other) {
+        for (size_t i = 0; i < realized_sum.size(); ++i) {
+            realized_sum[i] += other.realized_sum[i];
+            equity_sum[i] += other.equity_sum[i];
+            weight_sum[i] += other.weight_sum[i];
+        }
+        samples += other.samples;
+    }
+};
+
+// 事前モデルへの縮約つきで係数を推定する
+// 事前係数 f0 を「生エクイティ1・実現 f0」の擬似観測 prior_strength 件として加える:
+//   factor = (Σw·realized + K·f0) / (Σw·raw + K)
+inline void estimate_factors(const GridAccumulator& acc, double prior_strength,
+                             ModelWriter& model) {
+    for (size_t i = 0; i < model.values.size(); ++i) {
+        double prior = model.values[i];
+        double numerator = acc.realized_sum[i] + prior_strength * prior;
+        double denominator = acc.equity_sum[i] + prior_strength;
+        if (denominator > 0.0) model.values[i] = numerator / denominator;
+    }
+}
+
+// 既存のモデルファイルをグリッドごと読み込み、事前モデルとして使う
+inline bool load_prior(const std::string& path, ModelWriter& writer, std::string& error) {
+    auto model = Model::open(path, error);
+    if (!model) return false;
+
+    std::vector<double> grid[AXIS_COUNT];
+    for (int a = 0; a < AXIS_COUNT; ++a) {
+        const double* coords = model->coordinates(a);
+        grid[a].assign(coords, coords + model->axis_size(a));
+    }
+    writer.set_axes(grid);
+    writer.model_version = model->version();
+
+    // 格子点上の補間値 = 格納値
+    int idx[AXIS_COUNT] = {};
+    double point[AXIS_COUNT];
+    for (size_t i = 0; i < writer.values.size(); ++i) {
+        for (int a = 0; a < AXIS_COUNT; ++a) point[a] = grid[a][idx[a]];
+        writer.values[i] = model->factor(point);
+        for (int a = AXIS_COUNT - 1; a >= 0; --a) {
+            if (++idx[a] < static_cast<int>(grid[a].size())) break;
+            idx[a] = 0;
+        }
+    }
+    return true;
+}
+
+// ===== ソルバー出力（CSV） =====
+// 列: position,spr,texture,in_position,opponents,street,skill,equity,realized[,weight]
+// realized はルートでの期待値をポットで割った取り分（EV/pot）。数字で始まらない行は見出しとして読み飛ばす
+class SolverCsvSource {
+private:
+    std::string path;
+
+public:
+    explicit SolverCsvSource(std::string csv_path) : path(std::move(csv_path)) {}
+
+    bool run(BatchQueue& queue, size_t batch_size, std::string& error) {
+        FILE* fp = std::fopen(path.c_str(), "r");
+        if (fp == nullptr) {
+            error = "cannot open " + path;
+            return false;
+        }
+
+        SampleBatch batch;
+        batch.reserve(batch_size);
+        char line[512];
+        while (std::fgets(line, sizeof(line), fp) != nullptr) {
+            Sample s;
+            if (!parse_line(line, s)) continue;
+            batch.push_back(s);
+            if (batch.size() == batch_size) {
+                queue.push(std::move(batch));
+                batch = SampleBatch();
+                batch.reserve(batch_size);
+            }
+        }
+        std::fclose(fp);
+        if (!batch.empty()) queue.push(std::move(batch));
+        return true;
+    }
+
+private:
+    static bool parse_line(const char* line, Sample& s) {
+        double fields[10];
+        int n = 0;
+        const char* p = line;
+        while (n < 10) {
+            char* end;
+            double v = std::strtod(p, &end);
+            if (end == p) break;
+            fields[n++] = v;
+            p = end;
+            while (*p == ' ' || *p == '\t') ++p;
+            if (*p != ',') break;
+            ++p;
+        }
+        if (n < 9) return false;
+        for (int a = 0; a < AXIS_COUNT; ++a) s.point[a] = fields[a];
+        s.raw_equity = fields[7];
+        s.realized = fields[8];
+        s.weight = n >= 10 ? fields[9] : 1.0;
+        return s.raw_equity > 0.0 && s.weight > 0.0;
+    }
+};
+
+// ===== ハンド履歴DB（step33 HandHistoryManagerのSQLite） =====
+// 実現値 = won (0/1)、生エクイティ = equity列。
+// step33はスタックを記録しないためSPRは既定値、スキルも中央値で固定する
+struct HandHistoryOptions {
+    double default_spr = 13.0;
+    double default_skill = 0.5;
+};
+
+class HandHistorySource {
+private:
+    std::string path;
+    HandHistoryOptions options;
+
+public:
+    HandHistorySource(std::string db_path, HandHistoryOptions opts)
+        : path(std::move(db_path)), options(opts) {}
+
+    // "UTG".."BB" -> 0-8、不明なら-1
+    static int position_index(const char* name) {
+        static const char* const NAMES[9] = {
+            "UTG", "UTG+1", "UTG+2", "MP", "HJ", "CO", "BTN", "SB", "BB"
+        };
+        for (int i = 0; i < 9; ++i) {
+            if (std::strcmp(name, NAMES[i]) == 0) return i;
+        }
+        return -1;
+    }
+
+    // JSON配列 ["As","Kd",...] をカードマスクへ。戻り値は枚数（不正なら-1）
+    static int parse_board(const char* json, CardMask& board) {
+        board = 0;
+        int count = 0;
+        for (const char* p = json; *p != '\0'; ++p) {
+            if (*p != '"') continue;
+            int card = p[1] != '\0' ? RangeParser::parse_card(std::string_view(p + 1, 2)) : -1;
+            if (card < 0 || p[3] != '"' || count >= 5) return -1;
+            board = add_card(board, static_cast<Card>(card));
+            ++count;
+            p += 3;
+        }
+        return count;
+    }
+
+    // JSON配列の要素数（空なら0）
+    static int count_json_items(const char* json) {
+        int depth = 0;
+        int items = 0;
+        bool in_string = false;
+        bool has_item = false;
+        for (const char* p = json; *p != '\0'; ++p) {
+            char c = *p;
+            if (in_string) {
+                if (c == '\\' && p[1] != '\0') ++p;
+                else if (c == '"') in_string = false;
+                continue;
+            }
+            if (c == '"') {
+                in_string = true;
+                if (depth == 1) has_item = true;
+            } else if (c == '[' || c == '{') {
+                if (depth == 1) has_item = true;
+                ++depth;
+            } else if (c == ']' || c == '}') {
+                --depth;
+            } else if (c == ',' && depth == 1) {
+                ++items;
+            } else if (depth == 1 && c != ' ' && c != '\n' && c != '\t') {
+                has_item = true;
+            }
+        }
+        return has_item ? items + 1 : 0;
+    }
+
+#ifdef POKER_ENGINE_HAS_SQLITE
+    bool run(BatchQueue& queue, size_t batch_size, std::string& error) {
+        sqlite3* db = nullptr;
+        if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+            error = "cannot open " + path + ": " + sqlite3_errmsg(db);
+            sqlite3_close(db);
+            return false;
+        }
+
+        sqlite3_stmt* stmt = nullptr;
+        const char* sql =
+            "SELECT position, board, won, equity, opponents FROM hands "
+            "WHERE equity IS NOT NULL AND equity > 0";
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+            error = std::string("query failed: ") + sqlite3_errmsg(db);
+            sqlite3_close(db);
+            return false;
+        }
+
+        SampleBatch batch;
+        batch.reserve(batch_size);
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            Sample s;
+            if (!row_to_sample(stmt, s)) continue;
+            batch.push_back(s);
+            if (batch.size() == batch_size) {
+                queue.push(std::move(batch));
+                batch = SampleBatch();
+                batch.reserve(batch_size);
+            }
+        }
+        if (rc != SQLITE_DONE) error = std::string("read failed: ") + sqlite3_errmsg(db);
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+        if (!batch.empty()) queue.push(std::move(batch));
+        return rc == SQLITE_DONE;
+    }
+
+private:
+    static const char* text_column(sqlite3_stmt* stmt, int column) {
+        const unsigned char* text = sqlite3_column_text(stmt, column);
+        return text != nullptr ? reinterpret_cast<const char*>(text) : "";
+    }
+
+    bool row_to_sample(sqlite3_stmt* stmt, Sample& s) const {
+        int position = position_index(text_column(stmt, 0));
+        if (position < 0) return false;
+
+        CardMask board;
+        int board_count = parse_board(text_column(stmt, 1), board);
+        if (board_count < 0 || board_count == 1 || board_count == 2) return false;
+
+        // 0/3/4/5枚 -> preflop/flop/turn/river
+        int street = board_count == 0 ? 0 : board_count - 2;
+        int opponents = std::max(1, count_json_items(text_column(stmt, 4)));
+        // BTN/COはポストフロップで概ねポジションを持つ
+        bool in_position = position == 5 || position == 6;
+
+        s.point[AXIS_POSITION] = position;
+        s.point[AXIS_SPR] = options.default_spr;
+        s.point[AXIS_TEXTURE] = board_count == 0
+            ? 0 : BoardFeatureTable::instance().lookup(board).eqr_texture;
+        s.point[AXIS_IN_POSITION] = in_position ? 1.0 : 0.0;
+        s.point[AXIS_OPPONENTS] = opponents;
+        s.point[AXIS_STREET] = street;
+        s.point[AXIS_SKILL] = options.default_skill;
+        s.raw_equity = sqlite3_column_double(stmt, 3);
+        s.realized = sqlite3_column_int(stmt, 2) != 0 ? 1.0 : 0.0;
+        s.weight = 1.0;
+        return s.raw_equity > 0.0;
+    }
+#else
+    bool run(BatchQueue&, size_t, std::string& error) {
+        error = "built without SQLite support";
+        return false;
+    }
+#endif
+};
+
+struct CalibrationOptions {
+    int threads = 0;                // 0 = hardware_concurrency
+    size_t batch_size = 4096;
+    size_t queue_batches = 16;
+    double prior_strength = 20.0;   // 事前モデルの擬似観測数（生エクイティ換算）
+};
+
+// 入力を流し込みながら並列に集計し、推定した係数をmodelへ書き込む
+// modelには事前モデル（軸と初期値）を入れておく。戻り値は使用したサンプル数（失敗時-1）
+template <typename Source>
+int64_t calibrate(Source& source, const CalibrationOptions& options,
+                  ModelWriter& model, std::string& error) {
+    int threads = options.threads > 0
+        ? options.threads
+        : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    BatchQueue queue(options.queue_batches);
+    std::vector<GridAccumulator> accumulators(threads, GridAccumulator(model));
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&queue, &acc = accumulators[t]] {
+            SampleBatch batch;
+            while (queue.pop(batch)) {
+                for (const Sample& s : batch) acc.add(s);
+            }
+        });
+    }
+
+    bool ok = source.run(queue, std::max<size_t>(1, options.batch_size), error);
+    queue.close();
+    for (auto& worker : workers) worker.join();
+    if (!ok) return -1;
+
+    for (int t = 1; t < threads; ++t) accumulators[0].merge(accumulators[t]);
+    estimate_factors(accumulators[0], options.prior_strength, model);
+    return static_cast<int64_t>(accumulators[0].samples);
+}
+
+} // namespace EQRCalibration
+
+extern "C" {
+    using namespace EQRCalibration;
+
+    // キャリブレーションを実行してモデルファイルを書き出す
+    // source_kind: 0=ソルバーCSV, 1=ハンド履歴DB(SQLite)
+    // prior_path: 事前モデル（NULLなら組み込み係数）。model_version=0なら事前モデルの世代+1
+    // 戻り値: 使用したサンプル数（失敗時-1）
+    int64_t eqr_calibrate(int source_kind, const char* input_path, const char* output_path,
+                          const char* prior_path, double prior_strength, int threads,
+                          double default_spr, uint64_t model_version) {
+        std::string error;
+        ModelWriter model = ModelWriter::from_builtin_factors();
+        if (prior_path != nullptr && !load_prior(prior_path, model, error)) {
+            std::fprintf(stderr, "eqr_calibrate: %s\n", error.c_str());
+            return -1;
+        }
+        model.model_version = model_version != 0 ? model_version : model.model_version + 1;
+
+        CalibrationOptions options;
+        options.threads = threads;
+        options.prior_strength = prior_strength;
+
+        int64_t used;
+        if (source_kind == 0) {
+            SolverCsvSource source(input_path);
+            used = calibrate(source, options, model, error);
+        } else if (source_kind == 1) {
+            HandHistoryOptions hh;
+            hh.default_spr = default_spr;
+            HandHistorySource source(input_path, hh);
+            used = calibrate(source, options, model, error);
+        } else {
+            error = "unknown source kind";
+            used = -1;
+        }
+
+        if (used < 0 || !model.write(output_path, error)) {
+            std::fprintf(stderr, "eqr_calibrate: %s\n", error.c_str());
+            return -1;
+        }
+        return used;
+    }
+}
+
+#endif // POKER_STEP45_EQR_CALIBRATION_CPP
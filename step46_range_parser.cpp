@@ -0,0 +1,390 @@
+// step46_range_parser.cpp
+// カード・ボード・レンジ文字列のパーサー
+// レンジ表記 ("22+, A2s+, KTo+, AKs:0.5, AsKh") を1326コンボの重みベクトルへ直接展開する。
+// 同じ文字列は繰り返し問い合わせられるため、解析結果は文字列をキーにキャッシュする。
+#ifndef POKER_STEP46_RANGE_PARSER_CPP
+#define POKER_STEP46_RANGE_PARSER_CPP
+
+#include "step1_card_system_advanced.cpp"
+#include <cctype>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace RangeParser {
+
+using namespace PokerCore;
+
+// ===== コンボ（2枚のホールカード）の番号付け =====
+// コンボ番号 = 2枚集合のcolex順位 (low + high*(high-1)/2)。0..1325 の密な添字
+constexpr int COMBO_COUNT = 1326;
+
+struct ComboCards {
+    Card low;
+    Card high;
+};
+
+constexpr std::array<ComboCards, COMBO_COUNT> make_combo_table() {
+    std::array<ComboCards, COMBO_COUNT> table = {};
+    int index = 0;
+    for (int high = 1; high < DECK_SIZE; ++high) {
+        for (int low = 0; low < high; ++low) {
+            table[index++] = {static_cast<Card>(low), static_cast<Card>(high)};
+        }
+    }
+    return table;
+}
+constexpr std::array<ComboCards, COMBO_COUNT> COMBO_CARDS = make_combo_table();
+
+inline int combo_index(Card a, Card b) {
+    Card low = std::min(a, b);
+    Card high = std::max(a, b);
+    return low + high * (high - 1) / 2;
+}
+
+using WeightVector = std::array<float, COMBO_COUNT>;
+
+// ===== カード・ボード =====
+inline int parse_rank(char c) {
+    switch (c) {
+        case 'T': case 't': return RANK_T;
+        case 'J': case 'j': return RANK_J;
+        case 'Q': case 'q': return RANK_Q;
+        case 'K': case 'k': return RANK_K;
+        case 'A': case 'a': return RANK_A;
+        default: return (c >= '2' && c <= '9') ? c - '2' : -1;
+    }
+}
+
+inline int parse_suit(char c) {
+    switch (c) {
+        case 's': case 'S': return SUIT_SPADES;
+        case 'h': case 'H': return SUIT_HEARTS;
+        case 'd': case 'D': return SUIT_DIAMONDS;
+        case 'c': case 'C': return SUIT_CLUBS;
+        default: return -1;
+    }
+}
+
+// "As" -> 0-51、不正なら-1
+inline int parse_card(std::string_view text) {
+    if (text.size() != 2) return -1;
+    int rank = parse_rank(text[0]);
+    int suit = parse_suit(text[1]);
+    if (rank < 0 || suit < 0) return -1;
+    return make_card(static_cast<Rank>(rank), static_cast<Suit>(suit));
+}
+
+// "AsKd7c" / "As Kd 7c" / "As,Kd,7c" -> カード列。戻り値は枚数（不正・重複・超過なら-1）
+inline int parse_cards(std::string_view text, Card* out, int max_cards, CardMask* mask = nullptr) {
+    CardMask seen = 0;
+    int count = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (c == ' ' || c == ',' || c == '\t') {
+            ++i;
+            continue;
+        }
+        if (i + 1 >= text.size() || count >= max_cards) return -1;
+        int card = parse_card(text.substr(i, 2));
+        if (card < 0 || has_card(seen, static_cast<Card>(card))) return -1;
+        seen = add_card(seen, static_cast<Card>(card));
+        out[count++] = static_cast<Card>(card);
+        i += 2;
+    }
+    if (mask != nullptr) *mask = seen;
+    return count;
+}
+
+// ===== レンジ =====
+// 構文（カンマ区切り、各項目に ":重み" を付けられる。後の項目が前の項目を上書きする）:
+//   AA, AKs, AKo, AK          ハンドクラス（suit指定なしは両方）
+//   22+, A2s+, KTo+           ペアは上方向、非ペアはキッカーをハイカードの1つ下まで
+//   AA-77, AKs-ATs, AKo-AJo   区間
+//   AXs, KXo, QX              Xは他の全ランク
+//   AsKh                      特定のコンボ
+class Parser {
+private:
+    std::string_view text;
+    size_t pos = 0;
+    std::string error;
+
+public:
+    explicit Parser(std::string_view range_text) : text(range_text) {}
+
+    const std::string& error_message() const { return error; }
+
+    bool parse(WeightVector& weights) {
+        weights.fill(0.0f);
+        while (true) {
+            skip_spaces();
+            if (pos >= text.size()) return true;
+
+            size_t start = pos;
+            while (pos < text.size() && text[pos] != ',' && text[pos] != ':' &&
+                   text[pos] != ' ' && text[pos] != '\t') {
+                ++pos;
+            }
+            std::string_view token = text.substr(start, pos - start);
+
+            float weight = 1.0f;
+            skip_spaces();
+            if (pos < text.size() && text[pos] == ':') {
+                ++pos;
+                skip_spaces();
+                if (!parse_weight(weight)) return false;
+                skip_spaces();
+            }
+            if (!apply_token(token, weight, weights)) return false;
+
+            if (pos < text.size()) {
+                if (text[pos] != ',') return fail("expected ','");
+                ++pos;
+            }
+        }
+    }
+
+private:
+    bool fail(const char* message) {
+        error = std::string(message) + " at position " + std::to_string(pos);
+        return false;
+    }
+
+    void skip_spaces() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+    }
+
+    bool parse_weight(float& weight) {
+        std::string number;
+        while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) ||
+                                     text[pos] == '.')) {
+            number += text[pos++];
+        }
+        char* end = nullptr;
+        double value = number.empty() ? -1.0 : std::strtod(number.c_str(), &end);
+        if (number.empty() || *end != '\0' || value < 0.0 || value > 1.0) {
+            return fail("weight must be a number in [0, 1]");
+        }
+        weight = static_cast<float>(value);
+        return true;
+    }
+
+    // ハンドクラス1つ分の全コンボに重みを設定する
+    // suited: 1=スーテッド, 0=オフスート, -1=両方
+    static void set_class(int high, int low, int suited, float weight, WeightVector& weights) {
+        for (int s1 = 0; s1 < SUIT_COUNT; ++s1) {
+            for (int s2 = 0; s2 < SUIT_COUNT; ++s2) {
+                if (high == low && s2 <= s1) continue;
+                if (high != low && suited == 1 && s1 != s2) continue;
+                if (high != low && suited == 0 && s1 == s2) continue;
+                Card a = make_card(static_cast<Rank>(high), static_cast<Suit>(s1));
+                Card b = make_card(static_cast<Rank>(low), static_cast<Suit>(s2));
+                weights[combo_index(a, b)] = weight;
+            }
+        }
+    }
+
+    struct HandClass {
+        int high;
+        int low;      // -1 = X
+        int suited;   // 1=s, 0=o, -1=指定なし
+    };
+
+    static bool parse_class(std::string_view token, HandClass& hc) {
+        if (token.size() < 2 || token.size() > 3) return false;
+        hc.high = parse_rank(token[0]);
+        hc.low = (token[1] == 'X' || token[1] == 'x') ? -1 : parse_rank(token[1]);
+        hc.suited = -1;
+        if (hc.high < 0 || (hc.low < 0 && token[1] != 'X' && token[1] != 'x')) return false;
+        if (token.size() == 3) {
+            if (token[2] == 's') hc.suited = 1;
+            else if (token[2] == 'o') hc.suited = 0;
+            else return false;
+        }
+        if (hc.low > hc.high) std::swap(hc.high, hc.low);
+        // ペアにs/oは付けられない
+        return !(hc.high == hc.low && hc.suited != -1);
+    }
+
+    bool apply_token(std::string_view token, float weight, WeightVector& weights) {
+        if (token.empty()) return fail("empty range item");
+
+        // 特定のコンボ (AsKh)
+        if (token.size() == 4 && parse_suit(token[1]) >= 0 && parse_suit(token[3]) >= 0) {
+            int a = parse_card(token.substr(0, 2));
+            int b = parse_card(token.substr(2, 2));
+            if (a < 0 || b < 0 || a == b) return fail("invalid combo");
+            weights[combo_index(static_cast<Card>(a), static_cast<Card>(b))] = weight;
+            return true;
+        }
+
+        // 区間 (AA-77, AKs-ATs)
+        size_t dash = token.find('-');
+        if (dash != std::string_view::npos) {
+            HandClass from, to;
+            if (!parse_class(token.substr(0, dash), from) ||
+                !parse_class(token.substr(dash + 1), to) || from.low < 0 || to.low < 0) {
+                return fail("invalid range interval");
+            }
+            bool pairs = from.high == from.low && to.high == to.low;
+            if (pairs) {
+                for (int r = std::min(from.high, to.high); r <= std::max(from.high, to.high); ++r) {
+                    set_class(r, r, -1, weight, weights);
+                }
+                return true;
+            }
+            if (from.high != to.high || from.suited != to.suited ||
+                from.high == from.low || to.high == to.low) {
+                return fail("interval ends must share the high card and suitedness");
+            }
+            for (int r = std::min(from.low, to.low); r <= std::max(from.low, to.low); ++r) {
+                set_class(from.high, r, from.suited, weight, weights);
+            }
+            return true;
+        }
+
+        bool plus = token.back() == '+';
+        HandClass hc;
+        if (!parse_class(plus ? token.substr(0, token.size() - 1) : token, hc)) {
+            return fail("invalid hand class");
+        }
+
+        if (hc.low < 0) {
+            // AXs: ハイカード以外の全ランク
+            for (int r = 0; r < RANK_COUNT; ++r) {
+                if (r != hc.high) set_class(std::max(hc.high, r), std::min(hc.high, r),
+                                            hc.suited, weight, weights);
+            }
+        } else if (!plus) {
+            set_class(hc.high, hc.low, hc.suited, weight, weights);
+        } else if (hc.high == hc.low) {
+            for (int r = hc.high; r < RANK_COUNT; ++r) set_class(r, r, -1, weight, weights);
+        } else {
+            for (int r = hc.low; r < hc.high; ++r) set_class(hc.high, r, hc.suited, weight, weights);
+        }
+        return true;
+    }
+};
+
+// 解析済みレンジのキャッシュ（LRU）
+class RangeCache {
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const WeightVector>>;
+    std::list<Entry> entries;   // 先頭が最近使ったもの
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+    std::mutex mutex;
+    size_t capacity;
+
+public:
+    explicit RangeCache(size_t max_entries) : capacity(std::max<size_t>(1, max_entries)) {}
+
+    // 失敗時はnullptrを返しerrorに理由を入れる
+    std::shared_ptr<const WeightVector> get(std::string_view text, std::string& error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(text);
+            if (it != index.end()) {
+                entries.splice(entries.begin(), entries, it->second);
+                return it->second->second;
+            }
+        }
+
+        // 解析はロックの外で行う
+        auto weights = std::make_shared<WeightVector>();
+        Parser parser(text);
+        if (!parser.parse(*weights)) {
+            error = parser.error_message();
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(text);
+        if (it != index.end()) return it->second->second;
+        entries.emplace_front(std::string(text), weights);
+        index.emplace(entries.front().first, entries.begin());
+        if (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        return weights;
+    }
+
+    static RangeCache& instance() {
+        static RangeCache cache(1024);
+        return cache;
+    }
+};
+
+// 直近のエラーメッセージ（C ABI用、スレッドごと）
+inline std::string& last_error() {
+    thread_local std::string message;
+    return message;
+}
+
+inline int count_combos(const WeightVector& weights) {
+    int n = 0;
+    for (float w : weights) n += w > 0.0f;
+    return n;
+}
+
+} // namespace RangeParser
+
+extern "C" {
+    using namespace RangeParser;
+
+    // "As" -> 0-51（不正なら-1）
+    int parse_card_string(const char* text) {
+        return parse_card(text);
+    }
+
+    // ボード/カード列の文字列を解析する。戻り値は枚数（不正なら-1）
+    int parse_cards_string(const char* text, uint8_t* out, int max_cards) {
+        return parse_cards(text, out, max_cards);
+    }
+
+    // レンジ文字列を1326コンボの重みへ展開する（キャッシュ付き）
+    // 戻り値は重みが正のコンボ数（構文エラーなら-1、理由は range_parse_error）
+    int parse_range_string(const char* text, float* out_weights) {
+        auto weights = RangeCache::instance().get(text, last_error());
+        if (!weights) return -1;
+        std::copy(weights->begin(), weights->end(), out_weights);
+        return count_combos(*weights);
+    }
+
+    // バッチ版: out_weightsは count*1326。out_combos[i]は各レンジのコンボ数（エラーなら-1）
+    // 戻り値はエラーになったレンジの数
+    int parse_range_batch(int count, const char* const* texts,
+                          float* out_weights, int32_t* out_combos) {
+        int failures = 0;
+        for (int i = 0; i < count; ++i) {
+            float* dst = out_weights + static_cast<size_t>(i) * COMBO_COUNT;
+            int combos = parse_range_string(texts[i], dst);
+            if (combos < 0) {
+                std::fill(dst, dst + COMBO_COUNT, 0.0f);
+                ++failures;
+            }
+            if (out_combos != nullptr) out_combos[i] = combos;
+        }
+        return failures;
+    }
+
+    const char* range_parse_error(void) {
+        return last_error().c_str();
+    }
+
+    int combo_index_c(uint8_t card1, uint8_t card2) {
+        return combo_index(card1, card2);
+    }
+
+    void combo_cards_c(int index, uint8_t* out) {
+        out[0] = COMBO_CARDS[index].low;
+        out[1] = COMBO_CARDS[index].high;
+    }
+}
+
+#endif // POKER_STEP46_RANGE_PARSER_CPP
@@ -0,0 +1,236 @@
+// step47_range.cpp
+// 1326コンボのレンジ型
+// 重みをコンボ番号順(step46)の連続したfloat配列で持ち、集合演算・カード除去・
+// 169クラス集計・コンボ数カウントを全て配列演算として行う（自動ベクトル化される）。
+// エクイティ・ソルバー・相手モデルが同じ表現を共有するための共通型。
+#ifndef POKER_STEP47_RANGE_CPP
+#define POKER_STEP47_RANGE_CPP
+
+#include "step46_range_parser.cpp"
+
+namespace RangeEngine {
+
+using namespace PokerCore;
+using RangeParser::COMBO_COUNT;
+using RangeParser::COMBO_CARDS;
+using RangeParser::WeightVector;
+
+constexpr int CLASS_COUNT = 169;
+
+// ===== 事前計算テーブル =====
+
+// カードごとに、そのカードを含む51コンボの番号
+using CardComboTable = std::array<std::array<uint16_t, DECK_SIZE - 1>, DECK_SIZE>;
+
+constexpr CardComboTable make_card_combo_table() {
+    CardComboTable table = {};
+    std::array<int, DECK_SIZE> filled = {};
+    for (int i = 0; i < COMBO_COUNT; ++i) {
+        int low = COMBO_CARDS[i].low;
+        int high = COMBO_CARDS[i].high;
+        table[low][filled[low]++] = static_cast<uint16_t>(i);
+        table[high][filled[high]++] = static_cast<uint16_t>(i);
+    }
+    return table;
+}
+constexpr CardComboTable CARD_COMBOS = make_card_combo_table();
+
+// 13x13グリッドのクラス番号: 行=高い方のランク(A..2)。スーテッドは対角より上、オフスートは下
+//   class = (12 - row_rank) * 13 + (12 - col_rank)
+constexpr int class_index(int rank1, int rank2, bool suited) {
+    int high = rank1 > rank2 ? rank1 : rank2;
+    int low = rank1 > rank2 ? rank2 : rank1;
+    return suited ? (12 - high) * 13 + (12 - low) : (12 - low) * 13 + (12 - high);
+}
+
+constexpr std::array<uint8_t, COMBO_COUNT> make_combo_class_table() {
+    std::array<uint8_t, COMBO_COUNT> table = {};
+    for (int i = 0; i < COMBO_COUNT; ++i) {
+        int low = COMBO_CARDS[i].low;
+        int high = COMBO_CARDS[i].high;
+        bool suited = low / RANK_COUNT == high / RANK_COUNT;
+        table[i] = static_cast<uint8_t>(class_index(low % RANK_COUNT, high % RANK_COUNT, suited));
+    }
+    return table;
+}
+constexpr std::array<uint8_t, COMBO_COUNT> COMBO_CLASS = make_combo_class_table();
+
+// クラスごとのコンボ数 (ペア6, スーテッド4, オフスート12)
+constexpr int class_combo_count(int cls) {
+    int row = cls / 13;
+    int col = cls % 13;
+    return row == col ? 6 : (col > row ? 4 : 12);
+}
+
+// "AKs" 等のクラス名
+inline std::string class_name(int cls) {
+    static const char RANKS[] = "AKQJT98765432";
+    int row = cls / 13;
+    int col = cls % 13;
+    std::string name;
+    name += RANKS[std::min(row, col)];
+    name += RANKS[std::max(row, col)];
+    if (row != col) name += col > row ? 's' : 'o';
+    return name;
+}
+
+// ===== 配列カーネル（1326要素、出力は入力と重なってよい） =====
+
+POKER_HOT_KERNEL
+static void union_kernel(const float* a, const float* b, float* out) {
+    for (int i = 0; i < COMBO_COUNT; ++i) out[i] = std::max(a[i], b[i]);
+}
+
+POKER_HOT_KERNEL
+static void intersect_kernel(const float* a, const float* b, float* out) {
+    for (int i = 0; i < COMBO_COUNT; ++i) out[i] = std::min(a[i], b[i]);
+}
+
+POKER_HOT_KERNEL
+static void scale_kernel(float* w, float factor) {
+    for (int i = 0; i < COMBO_COUNT; ++i) w[i] *= factor;
+}
+
+POKER_HOT_KERNEL
+static double sum_kernel(const float* w) {
+    // 8本の部分和で並べて足し、順序に依存する丸め誤差を抑える
+    double lanes[8] = {};
+    int i = 0;
+    for (; i + 8 <= COMBO_COUNT; i += 8) {
+        for (int k = 0; k < 8; ++k) lanes[k] += w[i + k];
+    }
+    double total = 0.0;
+    for (; i < COMBO_COUNT; ++i) total += w[i];
+    for (double lane : lanes) total += lane;
+    return total;
+}
+
+POKER_HOT_KERNEL
+static int nonzero_kernel(const float* w) {
+    int n = 0;
+    for (int i = 0; i < COMBO_COUNT; ++i) n += w[i] > 0.0f;
+    return n;
+}
+
+// デッドカードを含むコンボの重みを0にする（カード1枚あたり51要素）
+inline void remove_cards(float* w, CardMask dead) {
+    while (dead != 0) {
+        const auto& combos = CARD_COMBOS[__builtin_ctzll(dead)];
+        for (uint16_t combo : combos) w[combo] = 0.0f;
+        dead &= dead - 1;
+    }
+}
+
+// 169クラスへ集計する（frequencies=trueなら各クラスの平均重み = 頻度）
+inline void aggregate_classes(const float* w, float* out, bool frequencies) {
+    std::fill(out, out + CLASS_COUNT, 0.0f);
+    for (int i = 0; i < COMBO_COUNT; ++i) out[COMBO_CLASS[i]] += w[i];
+    if (frequencies) {
+        for (int c = 0; c < CLASS_COUNT; ++c) out[c] /= class_combo_count(c);
+    }
+}
+
+// ===== レンジ型 =====
+class Range {
+private:
+    alignas(64) WeightVector weights;
+
+public:
+    Range() { weights.fill(0.0f); }
+
+    // レンジ文字列から生成（step46のキャッシュを使う）
+    static bool parse(std::string_view text, Range& out, std::string& error) {
+        auto parsed = RangeParser::RangeCache::instance().get(text, error);
+        if (!parsed) return false;
+        out.weights = *parsed;
+        return true;
+    }
+
+    static Range full() {
+        Range r;
+        r.weights.fill(1.0f);
+        return r;
+    }
+
+    float* data() { return weights.data(); }
+    const float* data() const { return weights.data(); }
+    float weight(Card a, Card b) const { return weights[RangeParser::combo_index(a, b)]; }
+    void set_weight(Card a, Card b, float w) { weights[RangeParser::combo_index(a, b)] = w; }
+
+    Range& unite(const Range& other) {
+        union_kernel(data(), other.data(), data());
+        return *this;
+    }
+
+    Range& intersect(const Range& other) {
+        intersect_kernel(data(), other.data(), data());
+        return *this;
+    }
+
+    Range& scale(float factor) {
+        scale_kernel(data(), factor);
+        return *this;
+    }
+
+    // 重みの合計が1になるよう正規化する。戻り値は正規化前の合計
+    double normalize() {
+        double total = sum_kernel(data());
+        if (total > 0.0) scale_kernel(data(), static_cast<float>(1.0 / total));
+        return total;
+    }
+
+    Range& remove(CardMask dead) {
+        remove_cards(data(), dead);
+        return *this;
+    }
+
+    // 重み付きコンボ数
+    double combos() const { return sum_kernel(data()); }
+    int nonzero_combos() const { return nonzero_kernel(data()); }
+
+    void classes(float* out, bool frequencies = false) const {
+        aggregate_classes(data(), out, frequencies);
+    }
+};
+
+} // namespace RangeEngine
+
+extern "C" {
+    using namespace RangeEngine;
+
+    // 重みベクトル(1326 float)への直接操作。outは入力と同じ配列でもよい
+    void range_union(const float* a, const float* b, float* out) {
+        union_kernel(a, b, out);
+    }
+
+    void range_intersect(const float* a, const float* b, float* out) {
+        intersect_kernel(a, b, out);
+    }
+
+    void range_scale(float* weights, float factor) {
+        scale_kernel(weights, factor);
+    }
+
+    double range_normalize(float* weights) {
+        double total = sum_kernel(weights);
+        if (total > 0.0) scale_kernel(weights, static_cast<float>(1.0 / total));
+        return total;
+    }
+
+    void range_remove_cards(float* weights, const uint8_t* dead, int dead_count) {
+        CardMask mask = 0;
+        for (int i = 0; i < dead_count; ++i) mask = add_card(mask, dead[i]);
+        remove_cards(weights, mask);
+    }
+
+    // 169クラス集計 (13x13グリッド、行=高ランクA..2、スーテッドは右上)
+    void range_to_classes(const float* weights, float* out, int frequencies) {
+        aggregate_classes(weights, out, frequencies != 0);
+    }
+
+    double range_combo_count(const float* weights) {
+        return sum_kernel(weights);
+    }
+}
+
+#endif // POKER_STEP47_RANGE_CPP
@@ -0,0 +1,258 @@
+// step48_board_features.cpp
+// ボード特徴量テーブル（フロップ/ターン/リバーの全ボード）
+// スートの入れ替えで同型になるボードは同じ特徴量を持つため、正規形（スート・レーンを降順に
+// 並べたもの）ごとに一度だけ計算してテーブルに格納する。参照は
+//   正規化 → colex順位 → 正規ボード番号 → 特徴量
+// の配列参照のみ。テーブルはストリートごとに最初の参照時に構築する
+// （正規ボード数 1,755 / 16,432 / 134,459、添字表はC(52,k)要素）。
+// 分類規則はstep16 BoardTextureAnalyzerに合わせている。
+#ifndef POKER_STEP48_BOARD_FEATURES_CPP
+#define POKER_STEP48_BOARD_FEATURES_CPP
+
+#include "poker_engine.h"
+#include "step1_card_system_advanced.cpp"
+#include <mutex>
+#include <vector>
+
+namespace BoardFeatureEngine {
+
+using namespace PokerCore;
+
+// 特徴量ベクトル（C ABIと共通のレイアウト）
+using BoardFeatures = PokerBoardFeatures;
+
+enum TextureClass : uint8_t {
+    TEXTURE_DRY = 0, TEXTURE_SEMI_WET, TEXTURE_WET, TEXTURE_ULTRA_WET
+};
+
+enum FlushClass : uint8_t {
+    FLUSH_RAINBOW = 0,    // 同スート2枚以上なし
+    FLUSH_DRAW,           // 同スート2枚
+    FLUSH_POSSIBLE        // 同スート3枚以上
+};
+
+enum StraightClass : uint8_t {
+    STRAIGHT_NONE = 0,
+    STRAIGHT_GUTSHOT,     // 隣接ランクのギャップが3のみ
+    STRAIGHT_DRAW,        // ギャップ2以下の隣接ランクあり
+    STRAIGHT_POSSIBLE     // 5ランク幅に3種以上のランク（ストレート完成の可能性）
+};
+
+// ===== スートの正規化 =====
+// 4つのスート・レーンを値の降順に並べる。perm[j] = 正規形のレーンjの元のスート
+inline SuitMajorMask canonicalize(SuitMajorMask mask, uint8_t perm[SUIT_COUNT]) {
+    uint16_t lanes[SUIT_COUNT];
+    for (int s = 0; s < SUIT_COUNT; ++s) {
+        lanes[s] = suit_ranks(mask, s);
+        perm[s] = static_cast<uint8_t>(s);
+    }
+    // 4要素の挿入ソート
+    for (int i = 1; i < SUIT_COUNT; ++i) {
+        for (int j = i; j > 0 && lanes[j] > lanes[j - 1]; --j) {
+            std::swap(lanes[j], lanes[j - 1]);
+            std::swap(perm[j], perm[j - 1]);
+        }
+    }
+    SuitMajorMask canonical = 0;
+    for (int s = 0; s < SUIT_COUNT; ++s) {
+        canonical |= SuitMajorMask(lanes[s]) << (16 * s);
+    }
+    return canonical;
+}
+
+// 正規形のスートで表したマスクを元のスートへ戻す
+inline SuitMajorMask uncanonicalize(SuitMajorMask mask, const uint8_t perm[SUIT_COUNT]) {
+    SuitMajorMask result = 0;
+    for (int j = 0; j < SUIT_COUNT; ++j) {
+        result |= SuitMajorMask(suit_ranks(mask, j)) << (16 * perm[j]);
+    }
+    return result;
+}
+
+// ===== 特徴量の計算（正規ボード1つにつき1回） =====
+
+// ランク集合(bit r = ランクr、A=12)のいずれかの5ランク幅に3種以上あるか（A-5を含む）
+inline bool straight_possible(uint16_t ranks) {
+    // Aをローとしても扱うため、bit0にAを複製して14bitにする
+    uint32_t extended = (uint32_t(ranks) << 1) | ((ranks >> RANK_A) & 1);
+    for (int low = 0; low <= 9; ++low) {
+        if (__builtin_popcount((extended >> low) & 0x1F) >= 3) return true;
+    }
+    return false;
+}
+
+inline BoardFeatures compute_features(SuitMajorMask board) {
+    BoardFeatures f = {};
+    int count = __builtin_popcountll(board);
+    f.card_count = static_cast<uint8_t>(count);
+    f.eqr_factor = 1.0f;
+    if (count < 3) return f;
+
+    uint16_t ranks = rank_set(board);
+    int unique_ranks = __builtin_popcount(ranks);
+
+    // ランクごとの枚数
+    int max_of_rank = 0;
+    int min_rank = RANK_COUNT;
+    int max_rank = -1;
+    for (int r = 0; r < RANK_COUNT; ++r) {
+        int n = 0;
+        for (int s = 0; s < SUIT_COUNT; ++s) n += (suit_ranks(board, s) >> r) & 1;
+        if (n == 0) continue;
+        max_of_rank = std::max(max_of_rank, n);
+        min_rank = std::min(min_rank, r);
+        max_rank = std::max(max_rank, r);
+        if (r >= RANK_T) f.high_cards += static_cast<uint8_t>(n);
+    }
+    f.paired = unique_ranks < count;
+    f.trips = max_of_rank >= 3;
+
+    f.max_suit = static_cast<uint8_t>(max_suit_count(board));
+    f.flush_class = f.max_suit >= 3 ? FLUSH_POSSIBLE : (f.max_suit == 2 ? FLUSH_DRAW : FLUSH_RAINBOW);
+
+    // コネクティビティ = 1 / 平均ギャップ（ソート済みランク、重複含む）
+    double avg_gap = double(max_rank - min_rank) / (count - 1);
+    f.connectivity = avg_gap > 0.0 ? static_cast<float>(std::min(1.0, 1.0 / avg_gap)) : 1.0f;
+
+    // 隣接する異なるランク間のギャップ
+    int min_gap = RANK_COUNT;
+    for (int r = min_rank, prev = -1; r <= max_rank; ++r) {
+        if (!((ranks >> r) & 1)) continue;
+        if (prev >= 0) min_gap = std::min(min_gap, r - prev);
+        prev = r;
+    }
+    if (straight_possible(ranks)) {
+        f.straight_class = STRAIGHT_POSSIBLE;
+    } else if (min_gap <= 2) {
+        f.straight_class = STRAIGHT_DRAW;
+    } else if (min_gap == 3) {
+        f.straight_class = STRAIGHT_GUTSHOT;
+    }
+
+    // テクスチャ分類 (step16 _classify_texture)
+    int score = 0;
+    if (f.connectivity > 0.7f) score += 2;
+    else if (f.connectivity > 0.5f) score += 1;
+    if (f.max_suit >= 2) score += 1;
+    if (min_gap <= 3) score += 1;
+    if (f.paired) score -= 1;
+    f.texture = score >= 3 ? TEXTURE_ULTRA_WET
+              : score >= 2 ? TEXTURE_WET
+              : score >= 1 ? TEXTURE_SEMI_WET : TEXTURE_DRY;
+    // EQR(step9/step44)の3段階: ULTRA_WETはWETと同じ
+    f.eqr_texture = std::min<uint8_t>(f.texture, TEXTURE_WET);
+
+    // EQR係数 (step16 _calculate_eqr_factor)
+    static constexpr float TEXTURE_EQR[4] = {1.05f, 1.00f, 0.95f, 0.90f};
+    f.eqr_factor = TEXTURE_EQR[f.texture] * (f.paired ? 1.02f : 1.0f);
+
+    // 次のストリートの危険カード（リバーでは無し）
+    // フラッシュ: フロップは同スート2枚以上、ターンは3枚以上のスートの残りカード
+    // ストレート: 加えると新たに5ランク幅へ3種以上が揃うランク
+    if (count < 5) {
+        int flush_threshold = count == 3 ? 2 : 3;
+        SuitMajorMask danger = 0;
+        for (int s = 0; s < SUIT_COUNT; ++s) {
+            if (__builtin_popcount(suit_ranks(board, s)) >= flush_threshold) {
+                danger |= SuitMajorMask(0x1FFF) << (16 * s);
+            }
+        }
+        for (int r = 0; r < RANK_COUNT; ++r) {
+            uint16_t with = ranks | uint16_t(1u << r);
+            if (with != ranks && straight_possible(with) && !straight_possible(ranks)) {
+                danger |= 0x0001000100010001ULL << r;   // 全スートのランクr
+            }
+        }
+        f.danger_cards = from_suit_major(danger & ~board);
+    }
+    return f;
+}
+
+// ===== テーブル =====
+class BoardFeatureTable {
+private:
+    struct Street {
+        std::once_flag built;
+        std::vector<uint32_t> index;         // colex順位 -> 正規ボード番号（正規形のみ有効）
+        std::vector<BoardFeatures> features; // 正規ボード番号 -> 特徴量（正規スートで表現）
+    };
+    Street streets[3];   // 3, 4, 5枚
+
+    Street& street(int count) {
+        Street& st = streets[count - 3];
+        std::call_once(st.built, [&] { build(st, count); });
+        return st;
+    }
+
+    static void build(Street& st, int count) {
+        uint64_t total = binomial(DECK_SIZE, count);
+        st.index.assign(total, UINT32_MAX);
+        uint8_t perm[SUIT_COUNT];
+        for (uint64_t r = 0; r < total; ++r) {
+            SuitMajorMask board = to_suit_major(colex_unrank(r, count));
+            if (canonicalize(board, perm) != board) continue;
+            st.index[r] = static_cast<uint32_t>(st.features.size());
+            st.features.push_back(compute_features(board));
+        }
+    }
+
+public:
+    static BoardFeatureTable& instance() {
+        static BoardFeatureTable table;
+        return table;
+    }
+
+    // 正規ボード数（ストリート別）
+    size_t canonical_count(int count) {
+        return street(count).features.size();
+    }
+
+    // ボード(CardMask)の特徴量。iso_indexには正規ボード番号を返す（3-5枚以外は-1）
+    BoardFeatures lookup(CardMask board, int32_t* iso_index = nullptr) {
+        int count = count_cards(board);
+        if (count < 3 || count > 5) {
+            if (iso_index != nullptr) *iso_index = -1;
+            return compute_features(to_suit_major(board));
+        }
+
+        uint8_t perm[SUIT_COUNT];
+        SuitMajorMask canonical = canonicalize(to_suit_major(board), perm);
+        Street& st = street(count);
+        uint32_t idx = st.index[colex_rank(from_suit_major(canonical))];
+        if (iso_index != nullptr) *iso_index = static_cast<int32_t>(idx);
+
+        BoardFeatures f = st.features[idx];
+        f.danger_cards = from_suit_major(uncanonicalize(to_suit_major(f.danger_cards), perm));
+        return f;
+    }
+};
+
+} // namespace BoardFeatureEngine
+
+extern "C" {
+    using namespace BoardFeatureEngine;
+
+    // ボードの特徴量を求める。戻り値は正規ボード番号（3-5枚以外は-1）
+    int32_t board_features_c(const uint8_t* board, int count, PokerBoardFeatures* out) {
+        CardMask mask = 0;
+        for (int i = 0; i < count; ++i) mask = add_card(mask, board[i]);
+        int32_t iso_index;
+        *out = BoardFeatureTable::instance().lookup(mask, &iso_index);
+        return iso_index;
+    }
+
+    // 複数ボード（各cards_per_board枚、連続配置）のEQR用テクスチャ(0-2)
+    void board_texture_batch(int count, const uint8_t* boards, int cards_per_board,
+                             int32_t* out_texture) {
+        auto& table = BoardFeatureTable::instance();
+        for (int i = 0; i < count; ++i) {
+            CardMask mask = 0;
+            for (int k = 0; k < cards_per_board; ++k) {
+                mask = add_card(mask, boards[i * cards_per_board + k]);
+            }
+            out_texture[i] = table.lookup(mask).eqr_texture;
+        }
+    }
+}
+
+#endif // POKER_STEP48_BOARD_FEATURES_CPP
@@ -0,0 +1,214 @@
+// step49_outs.cpp
+// アウツとドロー分類
+// ヒーロー+ボードのマスクから次のカードを全て列挙し、カードごとに
+//   ・役の改善カテゴリ（ホールカードが関与する改善のみ）
+//   ・相手レンジのうちヒーローを上回るコンボの割合（ダーティアウツ判定）
+//   ・ナッツになるか
+//   ・次のストリートで残るアウツ数（フロップのみ、ドローの継続）
+// を求める。役カテゴリはスート・レーンのビット演算、比較は評価テーブルで行う。
+#ifndef POKER_STEP49_OUTS_CPP
+#define POKER_STEP49_OUTS_CPP
+
+#include "poker_engine.h"
+#include "step2_3_perfect_evaluator.cpp"
+#include "step46_range_parser.cpp"
+
+namespace OutsEngine {
+
+using namespace PokerCore;
+using PokerEval::HandEvaluator;
+using RangeParser::COMBO_COUNT;
+using RangeParser::COMBO_CARDS;
+
+// 改善カテゴリ = 改善後の役（0 = アウツではない）
+enum OutCategory : uint8_t {
+    OUT_NONE = 0,
+    OUT_PAIR,
+    OUT_TWO_PAIR,
+    OUT_TRIPS,
+    OUT_STRAIGHT,
+    OUT_FLUSH,
+    OUT_FULL_HOUSE,
+    OUT_QUADS,
+    OUT_STRAIGHT_FLUSH,
+    OUT_CATEGORY_COUNT
+};
+
+// 結果（C ABIと共通のレイアウト）
+using OutsReport = PokerOutsReport;
+
+// 任意枚数（0-7枚）の役カテゴリ（step2_3の役定数と同じ番号）
+inline int hand_category(SuitMajorMask hand) {
+    uint64_t l0 = suit_ranks(hand, 0), l1 = suit_ranks(hand, 1);
+    uint64_t l2 = suit_ranks(hand, 2), l3 = suit_ranks(hand, 3);
+    uint16_t any = static_cast<uint16_t>(l0 | l1 | l2 | l3);
+    uint16_t two = static_cast<uint16_t>((l0 & l1) | (l0 & l2) | (l0 & l3) |
+                                         (l1 & l2) | (l1 & l3) | (l2 & l3));
+    uint16_t three = static_cast<uint16_t>((l0 & l1 & l2) | (l0 & l1 & l3) |
+                                           (l0 & l2 & l3) | (l1 & l2 & l3));
+    uint16_t four = static_cast<uint16_t>(l0 & l1 & l2 & l3);
+
+    auto has_straight = [](uint16_t ranks) {
+        uint32_t r = (uint32_t(ranks) << 1) | ((ranks >> RANK_A) & 1);   // A-5用にAを複製
+        return (r & (r >> 1) & (r >> 2) & (r >> 3) & (r >> 4)) != 0;
+    };
+
+    int flush_suit = -1;
+    for (int s = 0; s < SUIT_COUNT; ++s) {
+        if (__builtin_popcount(suit_ranks(hand, s)) >= 5) flush_suit = s;
+    }
+    if (flush_suit >= 0 && has_straight(suit_ranks(hand, flush_suit))) {
+        return PokerEval::RANK_STRAIGHT_FLUSH;
+    }
+    if (four) return PokerEval::RANK_FOUR_OF_KIND;
+    if (three && __builtin_popcount(two) >= 2) return PokerEval::RANK_FULL_HOUSE;
+    if (flush_suit >= 0) return PokerEval::RANK_FLUSH;
+    if (has_straight(any)) return PokerEval::RANK_STRAIGHT;
+    if (three) return PokerEval::RANK_THREE_OF_KIND;
+    if (__builtin_popcount(two) >= 2) return PokerEval::RANK_TWO_PAIR;
+    if (two) return PokerEval::RANK_ONE_PAIR;
+    return PokerEval::RANK_HIGH_CARD;
+}
+
+// カードcがアウツなら改善後のカテゴリ、そうでなければOUT_NONE
+// 改善はヒーローの役カテゴリが上がり、かつボードだけの役を上回る場合に限る
+inline int out_category(SuitMajorMask hero_board, SuitMajorMask board, int current, Card c) {
+    SuitMajorMask bit = suit_major_bit(c);
+    int after = hand_category(hero_board | bit);
+    if (after <= current || after <= hand_category(board | bit)) return OUT_NONE;
+    return after;
+}
+
+// ヒーローのアウツのマスク（ダーティ判定なし）
+inline CardMask outs_mask(SuitMajorMask hero_board, SuitMajorMask board, CardMask live,
+                          int* counts = nullptr) {
+    int current = hand_category(hero_board);
+    CardMask outs = 0;
+    for (CardMask rest = live; rest != 0; rest &= rest - 1) {
+        Card c = static_cast<Card>(__builtin_ctzll(rest));
+        int category = out_category(hero_board, board, current, c);
+        if (category != OUT_NONE) {
+            outs = add_card(outs, c);
+            if (counts != nullptr) ++counts[category];
+        }
+    }
+    return outs;
+}
+
+// 単一ハンドの分析。villain_weightsはコンボ番号順の1326重み（nullptrなら全コンボ均等）
+// boardは3枚か4枚
+inline bool analyze(Card h1, Card h2, CardMask board_cards, const float* villain_weights,
+                    OutsReport& report) {
+    report = OutsReport{};
+    int board_count = count_cards(board_cards);
+    CardMask hero_cards = card_to_mask(h1) | card_to_mask(h2);
+    if ((board_count != 3 && board_count != 4) || h1 == h2 || (hero_cards & board_cards)) {
+        return false;
+    }
+
+    SuitMajorMask board = to_suit_major(board_cards);
+    SuitMajorMask hero_board = board | to_suit_major(hero_cards);
+    CardMask dead = hero_cards | board_cards;
+    CardMask live = ~dead & ((1ULL << DECK_SIZE) - 1);
+    int current = hand_category(hero_board);
+
+    for (CardMask rest = live; rest != 0; rest &= rest - 1) {
+        Card c = static_cast<Card>(__builtin_ctzll(rest));
+        int category = out_category(hero_board, board, current, c);
+        report.category[c] = static_cast<uint8_t>(category);
+
+        // フロップ: このカードの後にターン→リバーで残るアウツ数
+        SuitMajorMask next_hero = hero_board | suit_major_bit(c);
+        if (board_count == 3) {
+            report.next_street_outs[c] = static_cast<uint8_t>(count_cards(
+                outs_mask(next_hero, board | suit_major_bit(c), remove_card(live, c))));
+        }
+        if (category == OUT_NONE) continue;
+
+        report.outs = add_card(report.outs, c);
+        ++report.counts[category];
+
+        // 相手コンボとの比較（ヒーローの改善後の役を上回る割合）
+        uint32_t hero_value = HandEvaluator::evaluate_mask(next_hero);
+        SuitMajorMask next_board = board | suit_major_bit(c);
+        CardMask blocked = dead | card_to_mask(c);
+        double total = 0.0;
+        double better = 0.0;
+        bool nut = true;
+        for (int i = 0; i < COMBO_COUNT; ++i) {
+            Card a = COMBO_CARDS[i].low;
+            Card b = COMBO_CARDS[i].high;
+            if (has_card(blocked, a) || has_card(blocked, b)) continue;
+            uint32_t value = HandEvaluator::evaluate_mask(
+                next_board | suit_major_bit(a) | suit_major_bit(b));
+            bool beats = value > hero_value;
+            nut = nut && !beats;
+            float w = villain_weights != nullptr ? villain_weights[i] : 1.0f;
+            total += w;
+            if (beats) better += w;
+        }
+        report.villain_better[c] = total > 0.0 ? static_cast<float>(better / total) : 0.0f;
+        if (better == 0.0) report.clean_outs = add_card(report.clean_outs, c);
+        if (nut) report.nut_outs = add_card(report.nut_outs, c);
+    }
+    return true;
+}
+
+// レンジ全体のアウツ（ダーティ判定なし）。out_masks[コンボ番号]にアウツのマスク、
+// category_countsにカテゴリ別アウツ数のレンジ重み付き平均を返す
+inline bool analyze_range(const float* hero_weights, CardMask board_cards,
+                          uint64_t* out_masks, double* category_counts) {
+    int board_count = count_cards(board_cards);
+    if (board_count != 3 && board_count != 4) return false;
+
+    SuitMajorMask board = to_suit_major(board_cards);
+    CardMask all_live = ~board_cards & ((1ULL << DECK_SIZE) - 1);
+    double total_weight = 0.0;
+    std::fill(category_counts, category_counts + OUT_CATEGORY_COUNT, 0.0);
+
+    for (int i = 0; i < COMBO_COUNT; ++i) {
+        out_masks[i] = 0;
+        CardMask hero_cards = card_to_mask(COMBO_CARDS[i].low) | card_to_mask(COMBO_CARDS[i].high);
+        float w = hero_weights[i];
+        if (w <= 0.0f || (hero_cards & board_cards)) continue;
+
+        int counts[OUT_CATEGORY_COUNT] = {};
+        out_masks[i] = outs_mask(board | to_suit_major(hero_cards), board,
+                                 all_live & ~hero_cards, counts);
+        for (int k = 0; k < OUT_CATEGORY_COUNT; ++k) category_counts[k] += w * counts[k];
+        total_weight += w;
+    }
+    if (total_weight > 0.0) {
+        for (int k = 0; k < OUT_CATEGORY_COUNT; ++k) category_counts[k] /= total_weight;
+    }
+    return true;
+}
+
+} // namespace OutsEngine
+
+extern "C" {
+    using namespace OutsEngine;
+
+    // 戻り値はアウツ枚数（入力が不正なら-1）
+    int outs_analyze(uint8_t h1, uint8_t h2, const uint8_t* board, int board_count,
+                     const float* villain_weights, PokerOutsReport* out) {
+        CardMask board_cards = 0;
+        for (int i = 0; i < board_count; ++i) board_cards = add_card(board_cards, board[i]);
+        if (count_cards(board_cards) != board_count ||
+            !analyze(h1, h2, board_cards, villain_weights, *out)) {
+            return -1;
+        }
+        return count_cards(out->outs);
+    }
+
+    // out_masks: 1326要素、out_category_counts: 9要素。戻り値 0=成功, -1=不正なボード
+    int outs_analyze_range(const float* hero_weights, const uint8_t* board, int board_count,
+                           uint64_t* out_masks, double* out_category_counts) {
+        CardMask board_cards = 0;
+        for (int i = 0; i < board_count; ++i) board_cards = add_card(board_cards, board[i]);
+        if (count_cards(board_cards) != board_count) return -1;
+        return analyze_range(hero_weights, board_cards, out_masks, out_category_counts) ? 0 : -1;
+    }
+}
+
+#endif // POKER_STEP49_OUTS_CPP
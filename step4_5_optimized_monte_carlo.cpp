@@ -1,4 +1,10 @@
 // step4_5_optimized_monte_carlo.cpp
+#ifndef POKER_STEP4_5_OPTIMIZED_MONTE_CARLO_CPP
+#define POKER_STEP4_5_OPTIMIZED_MONTE_CARLO_CPP
+
+#include "step2_3_perfect_evaluator.cpp"
+#include <algorithm>
+#include <atomic>
 #include <immintrin.h>
 #include <random>
 #include <thread>
@@ -14,7 +20,7 @@ private:
     uint64_t state;
     
 public:
-    explicit FastRNG(uint64_t seed) : state(seed) {}
+    explicit FastRNG(uint64_t seed) : state(xorshift_seed(seed)) {}
     
     uint64_t next() {
         state ^= state << 13;
@@ -28,7 +34,7 @@ public:
     }
     
     int next_int(int max) {
-        return next32() % max;
+        return static_cast<int>(uniform_below(*this, static_cast<uint32_t>(max)));
     }
 };
 
@@ -47,33 +53,47 @@ public:
         const Card* board, int board_count,
         int opponents,
         int iterations,
-        uint64_t seed = 0
+        uint64_t seed = 0,
+        int threads = 0     // 0 = hardware_concurrency
     ) {
         if (seed == 0) {
             std::random_device rd;
             seed = rd();
         }
         
-        // マルチスレッド処理
-        int num_threads = std::thread::hardware_concurrency();
-        int iters_per_thread = iterations / num_threads;
+        // マルチスレッド処理（スレッド数は試行回数以下にし、余りは先頭のスレッドに1回ずつ配る）
+        int num_threads = threads > 0 ? threads
+                                      : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        num_threads = std::max(1, std::min(num_threads, iterations));
+        const int iters_per_thread = iterations / num_threads;
+        const int remainder = iterations % num_threads;
+        
+        // 1スレッドなら呼び出し元のスレッドでそのまま回す
+        if (num_threads == 1) {
+            Result final = run_simulation(hero_card1, hero_card2, board, board_count,
+                                          opponents, iterations, seed);
+            final.equity = final.iterations > 0
+                ? static_cast<float>(final.wins + final.ties * 0.5f) / final.iterations
+                : 0.0f;
+            return final;
+        }
         
-        std::vector<std::thread> threads;
+        std::vector<std::thread> workers;
         std::vector<Result> results(num_threads);
         
         for (int t = 0; t < num_threads; ++t) {
-            threads.emplace_back([&, t]() {
+            workers.emplace_back([&, t]() {
                 results[t] = run_simulation(
                     hero_card1, hero_card2,
                     board, board_count,
                     opponents,
-                    iters_per_thread,
+                    iters_per_thread + (t < remainder ? 1 : 0),
                     seed + t
                 );
             });
         }
         
-        for (auto& thread : threads) {
+        for (auto& thread : workers) {
             thread.join();
         }
         
@@ -86,11 +106,14 @@ public:
             final.iterations += r.iterations;
         }
         
-        final.equity = static_cast<float>(final.wins + final.ties * 0.5f) / final.iterations;
+        final.equity = final.iterations > 0
+            ? static_cast<float>(final.wins + final.ties * 0.5f) / final.iterations
+            : 0.0f;
         return final;
     }
     
 private:
+    POKER_HOT_KERNEL
     static Result run_simulation(
         Card hero_card1, Card hero_card2,
         const Card* board, int board_count,
@@ -102,62 +125,37 @@ private:
         FastRNG rng(seed);
         
         // 使用済みカードのマスク
-        CardMask dead_cards = card_to_mask(hero_card1) | card_to_mask(hero_card2);
+        const CardMask hero_cards = card_to_mask(hero_card1) | card_to_mask(hero_card2);
+        CardMask board_cards = 0;
         for (int i = 0; i < board_count; ++i) {
-            dead_cards |= card_to_mask(board[i]);
+            board_cards |= card_to_mask(board[i]);
         }
         
-        // 利用可能なデッキを作成
-        std::array<Card, DECK_SIZE> deck;
-        int deck_size = 0;
-        for (int c = 0; c < DECK_SIZE; ++c) {
-            if (!has_card(dead_cards, c)) {
-                deck[deck_size++] = c;
-            }
-        }
-        
-        Card full_board[5];
-        Card hero_hand[7];
-        Card opp_hand[7];
-        
-        // ヒーローのハンド前半
-        hero_hand[0] = hero_card1;
-        hero_hand[1] = hero_card2;
+        // 残りのカード（ライブカード）
+        const CardMask live_cards = ~(hero_cards | board_cards) & ((1ULL << DECK_SIZE) - 1);
         
         for (int iter = 0; iter < iterations; ++iter) {
-            // デッキをシャッフル（Fisher-Yates）
-            for (int i = deck_size - 1; i > 0; --i) {
-                int j = rng.next_int(i + 1);
-                std::swap(deck[i], deck[j]);
-            }
+            // デッキ全体はシャッフルせず、必要なカードだけをマスクのまま非復元で引く
+            CardMask live = live_cards;
             
             // ボードを完成させる
-            int deck_pos = 0;
-            for (int i = 0; i < board_count; ++i) {
-                full_board[i] = board[i];
-            }
-            for (int i = board_count; i < 5; ++i) {
-                full_board[i] = deck[deck_pos++];
-            }
+            const CardMask runout = sample_cards(live, 5 - board_count, rng);
+            live ^= runout;
+            const CardMask full_board = board_cards | runout;
             
             // ヒーローのハンドを評価
-            for (int i = 0; i < 5; ++i) {
-                hero_hand[i + 2] = full_board[i];
-            }
-            uint32_t hero_score = evaluate_7cards_perfect(hero_hand);
+            uint32_t hero_score = HandEvaluator::evaluate_mask(to_suit_major(hero_cards | full_board));
             
             // 相手のハンドを評価
             bool won = true;
             bool tied = false;
             
             for (int opp = 0; opp < opponents; ++opp) {
-                opp_hand[0] = deck[deck_pos++];
-                opp_hand[1] = deck[deck_pos++];
-                for (int i = 0; i < 5; ++i) {
-                    opp_hand[i + 2] = full_board[i];
-                }
+                // 相手のホールカードは必要になった時点で引く（負けが確定したら以降は引かない）
+                const CardMask hole = sample_cards(live, 2, rng);
+                live ^= hole;
                 
-                uint32_t opp_score = evaluate_7cards_perfect(opp_hand);
+                uint32_t opp_score = HandEvaluator::evaluate_mask(to_suit_major(hole | full_board));
                 
                 if (opp_score > hero_score) {
                     won = false;
@@ -194,4 +192,44 @@ extern "C" {
         );
         return result.equity;
     }
+    
+    // hands[count*2]のそれぞれのエクイティ。ハンドをthreads本（0 = hardware_concurrency）の
+    // ワーカーに分け、各ハンドは1スレッドで計算する（ハンドごとにスレッドを作り直さない）
+    void calculate_equity_batch(
+        const uint8_t* hands, int count,
+        const uint8_t* board, int board_count,
+        int opponents, int iterations, int threads, float* out
+    ) {
+        if (count <= 0) return;
+        int num_threads = threads > 0 ? threads
+                                      : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        num_threads = std::min(num_threads, count);
+        
+        std::atomic<int> next{0};
+        auto worker = [&] {
+            for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                out[i] = EquityCalculator::calculate_equity(
+                    hands[i * 2], hands[i * 2 + 1], board, board_count, opponents, iterations, 0, 1
+                ).equity;
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int t = 1; t < num_threads; ++t) workers.emplace_back(worker);
+        worker();
+        for (auto& thread : workers) thread.join();
+    }
+    
+    // threads: 使うスレッド数（0 = hardware_concurrency）
+    float calculate_equity_threads(
+        uint8_t h1, uint8_t h2,
+        const uint8_t* board, int board_count,
+        int opponents, int iterations, int threads
+    ) {
+        auto result = EquityCalculator::calculate_equity(
+            h1, h2, board, board_count, opponents, iterations, 0, threads
+        );
+        return result.equity;
+    }
 }
+
+#endif // POKER_STEP4_5_OPTIMIZED_MONTE_CARLO_CPP
@@ -0,0 +1,618 @@
+// step50_hud_stats.cpp
+// HUD用プレイヤー統計ストア（列指向）
+// プレイヤー × ポジション × ストリートの固定長レコード(24セル)ごとに整数カウンタを持ち、
+// カウンタごとに1本の連続配列（列）に並べる。
+//   列[counter][player * CELLS + position * STREET_COUNT + street]
+// ・アクションイベントでカウンタを加算するだけなので更新はO(1)
+// ・比率はHUD参照時にセルを合計して求める（1プレイヤーあたり23列×24セル）
+// ・全プレイヤーの集計は列を先頭から走査するだけなので自動ベクトル化される
+// ・ファイルは列をそのまま並べた形式で、mmapしてそのまま参照できる
+//   （書き込みが来た時点でメモリへコピーする）
+// イベントの意味はstep13 AdvancedHUDTrackerの各record_*メソッドに合わせている。
+#ifndef POKER_STEP50_HUD_STATS_CPP
+#define POKER_STEP50_HUD_STATS_CPP
+
+#include "poker_engine.h"
+#include "step1_card_system_advanced.cpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace HUDStats {
+
+// ポジション (step13: UTG, MP, CO, BTN, SB, BB)
+constexpr int POSITION_COUNT = 6;
+// ストリート 0=preflop .. 3=river
+constexpr int STREET_COUNT = 4;
+constexpr int CELLS = POSITION_COUNT * STREET_COUNT;
+
+enum Counter : int {
+    C_HANDS = 0,        // プリフロップのアクション回数 (step13 hands_played)
+    C_VPIP,
+    C_PFR,
+    C_THREEB,
+    C_THREEB_OPP,
+    C_BETS,
+    C_RAISES,
+    C_CALLS,
+    C_CHECKS,
+    C_FOLDS,
+    C_BET_SIZE_SUM,     // ベット額/ポット の合計 (1/100単位)
+    C_BET_SIZED,        // サイズが記録されたベット数
+    C_RAISE_SIZE_SUM,
+    C_RAISE_SIZED,
+    C_CBET_OPP,
+    C_CBET_MADE,
+    C_FACED_CBET,
+    C_FOLDED_TO_CBET,
+    C_SHOWDOWNS,
+    C_SHOWDOWNS_WON,
+    C_TIMED,            // 時間が記録されたアクション数
+    C_FAST,             // 2秒未満
+    C_SLOW,             // 10秒超
+    COUNTER_COUNT
+};
+
+enum EventKind : uint8_t {
+    EVENT_PREFLOP = 0,   // action, flag=レイズに直面
+    EVENT_POSTFLOP,      // action, value=ベット額/ポット
+    EVENT_CBET,          // flag=CBetした
+    EVENT_FACED_CBET,    // flag=フォールドした
+    EVENT_SHOWDOWN,      // flag=勝った
+    EVENT_TIMING         // value=秒
+};
+
+enum Action : uint8_t {
+    ACTION_FOLD = 0, ACTION_CHECK, ACTION_CALL, ACTION_BET, ACTION_RAISE
+};
+
+// step13 PlayerType の並び
+enum PlayerType : int32_t {
+    TYPE_UNKNOWN = 0, TYPE_TAG, TYPE_LAG, TYPE_ROCK, TYPE_FISH, TYPE_MANIAC, TYPE_NIT
+};
+
+// C ABIと共通のレイアウト
+using Event = PokerHudEvent;
+using Summary = PokerHudSummary;
+
+constexpr uint32_t ALL_POSITIONS = (1u << POSITION_COUNT) - 1;
+constexpr uint32_t ALL_STREETS = (1u << STREET_COUNT) - 1;
+
+inline int cell_index(int position, int street) {
+    return position * STREET_COUNT + street;
+}
+
+// ===== ファイル形式 =====
+//   FileHeader
+//   uint32_t columns[COUNTER_COUNT][player_count * CELLS]
+//   名前表: (uint32_t 長さ, バイト列) × player_count
+constexpr char FILE_MAGIC[8] = {'P', 'K', 'H', 'U', 'D', 'S', 'T', 'S'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t counter_count;
+    uint32_t cells;
+    uint32_t reserved;
+    uint64_t player_count;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint64_t padding[2];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout must stay stable");
+
+// ===== 集計カーネル =====
+
+// 1列のプレイヤーplayers人分をセルごとに合計する（acc[CELLS]に加算）
+POKER_HOT_KERNEL
+static void accumulate_cells(const uint32_t* column, size_t players, uint64_t* acc) {
+    uint64_t local[CELLS] = {};
+    for (size_t p = 0; p < players; ++p) {
+        const uint32_t* record = column + p * CELLS;
+        for (int c = 0; c < CELLS; ++c) local[c] += record[c];
+    }
+    for (int c = 0; c < CELLS; ++c) acc[c] += local[c];
+}
+
+// 1レコード(24セル)のうちマスクされたセルの合計
+inline uint64_t masked_sum(const uint32_t* record, const uint32_t* cell_mask) {
+    uint64_t total = 0;
+    for (int c = 0; c < CELLS; ++c) total += record[c] & cell_mask[c];
+    return total;
+}
+
+// ポジション・ストリートのビットマスクをセル単位のマスク(0 / 0xFFFFFFFF)に展開
+inline void expand_mask(uint32_t position_mask, uint32_t street_mask, uint32_t* cell_mask) {
+    for (int pos = 0; pos < POSITION_COUNT; ++pos) {
+        for (int st = 0; st < STREET_COUNT; ++st) {
+            bool on = ((position_mask >> pos) & 1) && ((street_mask >> st) & 1);
+            cell_mask[cell_index(pos, st)] = on ? 0xFFFFFFFFu : 0u;
+        }
+    }
+}
+
+inline float ratio(uint64_t num, uint64_t den) {
+    return den > 0 ? static_cast<float>(double(num) / double(den)) : 0.0f;
+}
+
+// プレイヤー1人分のカウンタ合計からHUDの比率を求める (step13 get_player_summary)
+inline Summary summarize(const uint32_t* const* columns, uint32_t player) {
+    Summary s = {};
+    uint32_t all[CELLS];
+    expand_mask(ALL_POSITIONS, ALL_STREETS, all);
+    uint64_t t[COUNTER_COUNT];
+    for (int k = 0; k < COUNTER_COUNT; ++k) {
+        t[k] = masked_sum(columns[k] + size_t(player) * CELLS, all);
+    }
+
+    s.hands = static_cast<uint32_t>(t[C_HANDS]);
+    s.vpip = ratio(t[C_VPIP], t[C_HANDS]);
+    s.pfr = ratio(t[C_PFR], t[C_HANDS]);
+    s.threeb = ratio(t[C_THREEB], t[C_THREEB_OPP]);
+
+    uint64_t aggressive = t[C_BETS] + t[C_RAISES];
+    s.af = t[C_CALLS] > 0 ? static_cast<float>(double(aggressive) / t[C_CALLS])
+                          : static_cast<float>(aggressive);
+    s.agg_freq = ratio(aggressive, aggressive + t[C_CALLS] + t[C_FOLDS]);
+
+    for (int st = 1; st < STREET_COUNT; ++st) {
+        uint64_t opp = 0, made = 0, faced = 0, folded = 0;
+        for (int pos = 0; pos < POSITION_COUNT; ++pos) {
+            size_t cell = size_t(player) * CELLS + cell_index(pos, st);
+            opp += columns[C_CBET_OPP][cell];
+            made += columns[C_CBET_MADE][cell];
+            faced += columns[C_FACED_CBET][cell];
+            folded += columns[C_FOLDED_TO_CBET][cell];
+        }
+        s.cbet[st - 1] = ratio(made, opp);
+        s.fold_to_cbet[st - 1] = ratio(folded, faced);
+    }
+    for (int pos = 0; pos < POSITION_COUNT; ++pos) {
+        size_t cell = size_t(player) * CELLS + cell_index(pos, 0);
+        s.vpip_by_position[pos] = ratio(columns[C_VPIP][cell], columns[C_HANDS][cell]);
+    }
+
+    s.wtsd = ratio(t[C_SHOWDOWNS], t[C_VPIP]);
+    s.wssd = ratio(t[C_SHOWDOWNS_WON], t[C_SHOWDOWNS]);
+    s.avg_bet_size = ratio(t[C_BET_SIZE_SUM], t[C_BET_SIZED] * 100);
+    s.fast_ratio = ratio(t[C_FAST], t[C_TIMED]);
+
+    // プレイヤータイプ (step13 classify_player_type)
+    s.player_type = TYPE_UNKNOWN;
+    if (s.hands >= 30) {
+        float vpip = s.vpip;
+        float pf_ratio = vpip > 0.0f ? s.pfr / vpip : 0.0f;
+        float af = s.af;
+        if (vpip < 0.15f) s.player_type = TYPE_NIT;
+        else if (vpip < 0.20f && pf_ratio > 0.7f && af > 2.5f) s.player_type = TYPE_TAG;
+        else if (vpip > 0.35f && af > 3.5f) s.player_type = TYPE_MANIAC;
+        else if (vpip > 0.35f && af < 1.5f) s.player_type = TYPE_FISH;
+        else if (vpip > 0.28f && pf_ratio > 0.65f && af > 2.0f) s.player_type = TYPE_LAG;
+        else if (vpip < 0.25f && af < 1.5f) s.player_type = TYPE_ROCK;
+    }
+    return s;
+}
+
+// ===== ストア =====
+class StatsStore {
+private:
+    mutable std::shared_mutex mutex;
+    std::vector<uint32_t> columns[COUNTER_COUNT];
+    // 名前の実体はdequeに置き（追加しても移動しない）、索引はそれを指すstring_view
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, uint32_t> ids;
+
+    // mmapしたファイル（書き込みが来るまではこちらを直接参照する）
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    const uint32_t* mapped_columns[COUNTER_COUNT] = {};
+
+    uint32_t player_count() const { return static_cast<uint32_t>(names.size()); }
+
+    const uint32_t* column(int k) const {
+        return mapping != nullptr ? mapped_columns[k] : columns[k].data();
+    }
+
+    void column_pointers(const uint32_t** out) const {
+        for (int k = 0; k < COUNTER_COUNT; ++k) out[k] = column(k);
+    }
+
+    // mmap参照からメモリ上の列へ切り替える（排他ロック中に呼ぶ）
+    void materialize() {
+        if (mapping == nullptr) return;
+        size_t n = size_t(player_count()) * CELLS;
+        for (int k = 0; k < COUNTER_COUNT; ++k) {
+            columns[k].assign(mapped_columns[k], mapped_columns[k] + n);
+        }
+        unmap();
+    }
+
+    void unmap() {
+        if (mapping != nullptr) munmap(mapping, mapping_size);
+        mapping = nullptr;
+        mapping_size = 0;
+    }
+
+    uint32_t add_player(std::string_view name) {
+        materialize();
+        uint32_t id = player_count();
+        names.emplace_back(name);
+        ids.emplace(names.back(), id);
+        for (auto& col : columns) col.resize(size_t(id + 1) * CELLS, 0);
+        return id;
+    }
+
+    void apply_locked(const Event& e) {
+        if (e.player >= player_count() || e.position >= POSITION_COUNT ||
+            e.street >= STREET_COUNT) {
+            return;
+        }
+        size_t base = size_t(e.player) * CELLS;
+        auto bump = [&](int counter, int street, uint32_t amount = 1) {
+            columns[counter][base + cell_index(e.position, street)] += amount;
+        };
+
+        switch (e.kind) {
+        case EVENT_PREFLOP:
+            bump(C_HANDS, 0);
+            if (e.action == ACTION_CALL || e.action == ACTION_BET || e.action == ACTION_RAISE) {
+                bump(C_VPIP, 0);
+            }
+            if (e.action == ACTION_BET || e.action == ACTION_RAISE) bump(C_PFR, 0);
+            if (e.flag) {
+                bump(C_THREEB_OPP, 0);
+                if (e.action == ACTION_RAISE) bump(C_THREEB, 0);
+            }
+            break;
+        case EVENT_POSTFLOP:
+            switch (e.action) {
+            case ACTION_BET:
+                bump(C_BETS, e.street);
+                if (e.value > 0.0f) {
+                    bump(C_BET_SIZE_SUM, e.street, static_cast<uint32_t>(std::lround(e.value * 100.0f)));
+                    bump(C_BET_SIZED, e.street);
+                }
+                break;
+            case ACTION_RAISE:
+                bump(C_RAISES, e.street);
+                if (e.value > 0.0f) {
+                    bump(C_RAISE_SIZE_SUM, e.street, static_cast<uint32_t>(std::lround(e.value * 100.0f)));
+                    bump(C_RAISE_SIZED, e.street);
+                }
+                break;
+            case ACTION_CALL: bump(C_CALLS, e.street); break;
+            case ACTION_CHECK: bump(C_CHECKS, e.street); break;
+            case ACTION_FOLD: bump(C_FOLDS, e.street); break;
+            }
+            break;
+        case EVENT_CBET:
+            bump(C_CBET_OPP, e.street);
+            if (e.flag) bump(C_CBET_MADE, e.street);
+            break;
+        case EVENT_FACED_CBET:
+            bump(C_FACED_CBET, e.street);
+            if (e.flag) bump(C_FOLDED_TO_CBET, e.street);
+            break;
+        case EVENT_SHOWDOWN:
+            bump(C_SHOWDOWNS, e.street);
+            if (e.flag) bump(C_SHOWDOWNS_WON, e.street);
+            break;
+        case EVENT_TIMING:
+            bump(C_TIMED, e.street);
+            if (e.value < 2.0f) bump(C_FAST, e.street);
+            else if (e.value > 10.0f) bump(C_SLOW, e.street);
+            break;
+        }
+    }
+
+public:
+    StatsStore() = default;
+    ~StatsStore() { unmap(); }
+    StatsStore(const StatsStore&) = delete;
+    StatsStore& operator=(const StatsStore&) = delete;
+
+    // プレイヤー番号（未登録なら追加する）
+    uint32_t player_id(std::string_view name) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = ids.find(name);
+            if (it != ids.end()) return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(name);
+        return it != ids.end() ? it->second : add_player(name);
+    }
+
+    // 複数の名前をまとめて番号へ（取り込み用。ロックは1回）
+    void player_ids(const std::string_view* batch, size_t count, uint32_t* out) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (size_t i = 0; i < count; ++i) {
+            auto it = ids.find(batch[i]);
+            out[i] = it != ids.end() ? it->second : add_player(batch[i]);
+        }
+    }
+
+    // 登録済みプレイヤーの番号（無ければ-1）
+    int64_t find(std::string_view name) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(name);
+        return it != ids.end() ? int64_t(it->second) : -1;
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return names.size();
+    }
+
+    void apply(const Event* events, size_t count) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        materialize();
+        for (size_t i = 0; i < count; ++i) apply_locked(events[i]);
+    }
+
+    bool summary(uint32_t player, Summary& out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        if (player >= player_count()) return false;
+        const uint32_t* cols[COUNTER_COUNT];
+        column_pointers(cols);
+        out = summarize(cols, player);
+        return true;
+    }
+
+    // 複数プレイヤーのサマリー（テーブルの全席を1回のロックで更新する）
+    // 未登録の番号はhands=0のサマリーになる
+    void summaries(const uint32_t* players, size_t count, Summary* out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        const uint32_t* cols[COUNTER_COUNT];
+        column_pointers(cols);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = players[i] < player_count() ? summarize(cols, players[i]) : Summary{};
+        }
+    }
+
+    // プレイヤー集合（nullptrなら全員）のカウンタ合計をポジション・ストリートで絞って求める
+    void aggregate(const uint32_t* players, size_t count, uint32_t position_mask,
+                   uint32_t street_mask, uint64_t* out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        uint32_t cell_mask[CELLS];
+        expand_mask(position_mask, street_mask, cell_mask);
+        for (int k = 0; k < COUNTER_COUNT; ++k) {
+            const uint32_t* col = column(k);
+            uint64_t acc[CELLS] = {};
+            if (players == nullptr) {
+                accumulate_cells(col, player_count(), acc);
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    if (players[i] < player_count()) {
+                        accumulate_cells(col + size_t(players[i]) * CELLS, 1, acc);
+                    }
+                }
+            }
+            uint64_t total = 0;
+            for (int c = 0; c < CELLS; ++c) total += cell_mask[c] ? acc[c] : 0;
+            out[k] = total;
+        }
+    }
+
+    // 現時点の内容を複製した独立したストア（以後の更新の影響を受けない）
+    std::unique_ptr<StatsStore> snapshot() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto copy = std::make_unique<StatsStore>();
+        size_t n = size_t(player_count()) * CELLS;
+        for (int k = 0; k < COUNTER_COUNT; ++k) {
+            const uint32_t* col = column(k);
+            copy->columns[k].assign(col, col + n);
+        }
+        copy->names = names;
+        for (uint32_t i = 0; i < player_count(); ++i) copy->ids.emplace(copy->names[i], i);
+        return copy;
+    }
+
+    // ファイルへ保存（一時ファイルに書いてからrename）
+    bool save(const std::string& path, std::string& error) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        size_t n = size_t(player_count()) * CELLS;
+
+        std::string name_table;
+        for (const auto& name : names) {
+            uint32_t len = static_cast<uint32_t>(name.size());
+            name_table.append(reinterpret_cast<const char*>(&len), sizeof(len));
+            name_table += name;
+        }
+
+        FileHeader header = {};
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.format_version = FORMAT_VERSION;
+        header.counter_count = COUNTER_COUNT;
+        header.cells = CELLS;
+        header.player_count = player_count();
+        header.names_offset = sizeof(FileHeader) + n * COUNTER_COUNT * sizeof(uint32_t);
+        header.names_size = name_table.size();
+
+        std::string tmp = path + ".tmp";
+        FILE* fp = std::fopen(tmp.c_str(), "wb");
+        if (fp == nullptr) {
+            error = "cannot create " + tmp;
+            return false;
+        }
+        bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1;
+        for (int k = 0; k < COUNTER_COUNT && ok; ++k) {
+            ok = std::fwrite(column(k), sizeof(uint32_t), n, fp) == n;
+        }
+        ok = ok && std::fwrite(name_table.data(), 1, name_table.size(), fp) == name_table.size();
+        ok = (std::fflush(fp) == 0) && ok;
+        ok = (fsync(fileno(fp)) == 0) && ok;
+        ok = (std::fclose(fp) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            error = "failed to write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    // ファイルをmmapして開く。列はファイルを直接参照し、最初の更新時にメモリへコピーする
+    // （巨大なファイルでも開くコストは名前表の読み込みのみ。チェックサムは持たない）
+    static std::unique_ptr<StatsStore> open(const std::string& path, std::string& error) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = "cannot open " + path;
+            return nullptr;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+            ::close(fd);
+            error = "file too small: " + path;
+            return nullptr;
+        }
+
+        auto store = std::make_unique<StatsStore>();
+        store->mapping_size = static_cast<size_t>(st.st_size);
+        store->mapping = mmap(nullptr, store->mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (store->mapping == MAP_FAILED) {
+            store->mapping = nullptr;
+            error = "mmap failed: " + path;
+            return nullptr;
+        }
+        if (!store->validate(error)) return nullptr;
+        return store;
+    }
+
+private:
+    bool validate(std::string& error) {
+        const auto* header = static_cast<const FileHeader*>(mapping);
+        if (std::memcmp(header->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            error = "bad magic";
+            return false;
+        }
+        if (header->format_version != FORMAT_VERSION || header->counter_count != COUNTER_COUNT ||
+            header->cells != CELLS) {
+            error = "unsupported format version";
+            return false;
+        }
+        uint64_t players = header->player_count;
+        if (players > (uint64_t(1) << 32) / CELLS) {
+            error = "too many players";
+            return false;
+        }
+        size_t n = size_t(players) * CELLS;
+        if (header->names_offset != sizeof(FileHeader) + n * COUNTER_COUNT * sizeof(uint32_t) ||
+            header->names_offset + header->names_size != mapping_size) {
+            error = "file size does not match header";
+            return false;
+        }
+
+        const char* base = static_cast<const char*>(mapping);
+        for (int k = 0; k < COUNTER_COUNT; ++k) {
+            mapped_columns[k] = reinterpret_cast<const uint32_t*>(
+                base + sizeof(FileHeader) + k * n * sizeof(uint32_t));
+        }
+
+        const char* p = base + header->names_offset;
+        const char* end = p + header->names_size;
+        for (uint64_t i = 0; i < players; ++i) {
+            uint32_t len;
+            if (end - p < static_cast<ptrdiff_t>(sizeof(len))) {
+                error = "truncated name table";
+                return false;
+            }
+            std::memcpy(&len, p, sizeof(len));
+            p += sizeof(len);
+            if (static_cast<uint64_t>(end - p) < len) {
+                error = "truncated name table";
+                return false;
+            }
+            names.emplace_back(p, len);
+            ids.emplace(names.back(), static_cast<uint32_t>(i));
+            p += len;
+        }
+        return true;
+    }
+};
+
+} // namespace HUDStats
+
+extern "C" {
+    using namespace HUDStats;
+
+    void* hud_stats_create() {
+        return new StatsStore();
+    }
+
+    // 保存済みファイルをmmapで開く（失敗時はnullptr）
+    void* hud_stats_open(const char* path) {
+        std::string error;
+        auto store = StatsStore::open(path, error);
+        if (!store) {
+            std::fprintf(stderr, "hud_stats_open: %s\n", error.c_str());
+            return nullptr;
+        }
+        return store.release();
+    }
+
+    void hud_stats_destroy(void* handle) {
+        delete static_cast<StatsStore*>(handle);
+    }
+
+    int hud_stats_save(void* handle, const char* path) {
+        std::string error;
+        if (!static_cast<StatsStore*>(handle)->save(path, error)) {
+            std::fprintf(stderr, "hud_stats_save: %s\n", error.c_str());
+            return -1;
+        }
+        return 0;
+    }
+
+    // 現時点の複製（別ハンドル、hud_stats_destroyで解放）
+    void* hud_stats_snapshot(void* handle) {
+        return static_cast<StatsStore*>(handle)->snapshot().release();
+    }
+
+    uint32_t hud_stats_player_id(void* handle, const char* name) {
+        return static_cast<StatsStore*>(handle)->player_id(name);
+    }
+
+    int64_t hud_stats_find(void* handle, const char* name) {
+        return static_cast<StatsStore*>(handle)->find(name);
+    }
+
+    uint32_t hud_stats_player_count(void* handle) {
+        return static_cast<uint32_t>(static_cast<StatsStore*>(handle)->size());
+    }
+
+    void hud_stats_apply(void* handle, const PokerHudEvent* events, int count) {
+        static_cast<StatsStore*>(handle)->apply(events, static_cast<size_t>(count));
+    }
+
+    // 0=成功, -1=未登録のプレイヤー
+    int hud_stats_summary(void* handle, uint32_t player, PokerHudSummary* out) {
+        return static_cast<StatsStore*>(handle)->summary(player, *out) ? 0 : -1;
+    }
+
+    void hud_stats_summaries(void* handle, const uint32_t* players, int count,
+                             PokerHudSummary* out) {
+        static_cast<StatsStore*>(handle)->summaries(players, static_cast<size_t>(count), out);
+    }
+
+    // out: COUNTER_COUNT(23)要素。playersがNULLなら全プレイヤー
+    void hud_stats_aggregate(void* handle, const uint32_t* players, int count,
+                             uint32_t position_mask, uint32_t street_mask, uint64_t* out) {
+        static_cast<StatsStore*>(handle)->aggregate(players, static_cast<size_t>(count),
+                                                    position_mask, street_mask, out);
+    }
+}
+
+#endif // POKER_STEP50_HUD_STATS_CPP
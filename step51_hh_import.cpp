@@ -0,0 +1,1200 @@
+// step51_hh_import.cpp
+// ハンド履歴テキスト（PokerStars形式）の一括取り込み
+// ファイルをmmapし、固定サイズのウィンドウ単位で
+//   ハンド境界で分割 → スレッドごとにstring_viewのままパース → 正規化した固定長レコード
+// を作り、メインスレッドがウィンドウ順に出力先（step50統計ストア、step33履歴DB）へ流す。
+// 次のウィンドウのパースは出力と並行して進める。
+// パース中は文字列を一切コピーしない（名前はmmap領域を指すstring_view）。
+#ifndef POKER_STEP51_HH_IMPORT_CPP
+#define POKER_STEP51_HH_IMPORT_CPP
+
+#include "poker_engine.h"
+#include "step46_range_parser.cpp"
+#include "step50_hud_stats.cpp"
+#include "step52_hand_store.cpp"
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <future>
+#include <thread>
+#ifdef POKER_ENGINE_HAS_SQLITE
+#include <sqlite3.h>
+#endif
+
+namespace HandHistoryImport {
+
+using namespace PokerCore;
+using HUDStats::StatsStore;
+
+constexpr int MAX_SEATS = 10;
+constexpr uint8_t NO_SEAT = 0xFF;
+constexpr uint8_t NO_CARD = 0xFF;
+// アクション種別は HUDStats::Action (fold..raise) の続きにブラインド・アンテを置く
+constexpr uint8_t ACTION_POST = 5;
+
+// ===== 正規化レコード（金額は全てセント単位） =====
+
+struct SeatRecord {
+    uint32_t player;      // 統計ストアのプレイヤー番号（出力時に設定）
+    uint8_t seat;         // 座席番号(1-10)
+    uint8_t position;     // 0-5 (UTG, MP, CO, BTN, SB, BB)
+    uint8_t cards[2];     // 判明したホールカード（不明はNO_CARD）
+    int64_t stack;        // 開始スタック
+    int64_t invested;     // 投入額（返却されたベットを除く）
+    int64_t net;          // 収支（回収額 - 投入額）
+};
+static_assert(sizeof(SeatRecord) == 32, "SeatRecord layout must stay stable");
+
+struct ActionRecord {
+    uint8_t seat_index;   // HandRecord::seats の添字
+    uint8_t street;       // 0=preflop .. 3=river
+    uint8_t action;       // HUDStats::Action / ACTION_POST
+    uint8_t all_in;
+    uint32_t to_call;     // このアクションの直前にコールに必要だった額
+    int64_t amount;       // このアクションで追加した額
+    int64_t pot_before;
+};
+static_assert(sizeof(ActionRecord) == 24, "ActionRecord layout must stay stable");
+
+struct HandRecord {
+    uint64_t hand_id;
+    int64_t timestamp;    // UNIX秒（履歴に書かれた時刻をそのままUTCとして扱う）
+    int64_t small_blind;
+    int64_t big_blind;
+    int64_t pot;
+    int64_t rake;
+    uint32_t action_begin;   // チャンクのアクション配列内の開始位置
+    uint16_t action_count;
+    uint8_t seat_count;
+    uint8_t button;          // seatsの添字
+    uint8_t hero;            // seatsの添字（ヒーロー不在はNO_SEAT）
+    uint8_t board_count;
+    uint8_t board[5];
+    uint8_t showdown;
+    SeatRecord seats[MAX_SEATS];
+};
+static_assert(sizeof(HandRecord) == 64 + MAX_SEATS * sizeof(SeatRecord),
+              "HandRecord layout must stay stable");
+
+// 1ハンドのパース結果（名前はmmap領域を指す）
+struct ParsedHand {
+    HandRecord record;
+    std::string_view names[MAX_SEATS];
+};
+
+// スレッド1本分のパース結果
+struct ParsedChunk {
+    std::vector<ParsedHand> hands;
+    std::vector<ActionRecord> actions;
+    size_t errors = 0;
+};
+
+// ===== テキスト処理 =====
+
+inline bool starts_with(std::string_view s, std::string_view prefix) {
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+class LineReader {
+private:
+    std::string_view text;
+    size_t pos = 0;
+
+public:
+    explicit LineReader(std::string_view t) : text(t) {}
+
+    bool next(std::string_view& line) {
+        if (pos >= text.size()) return false;
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+        line = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        return true;
+    }
+};
+
+// "$1,234.56" / "€0.05" / "1500" -> セント。posは数値の直後へ進む（失敗時-1）
+inline int64_t parse_amount(std::string_view s, size_t& pos) {
+    while (pos < s.size() && (s[pos] == '$' || s[pos] == ' ' ||
+                              static_cast<unsigned char>(s[pos]) >= 0x80)) {
+        ++pos;   // 通貨記号（€ £ はUTF-8の複数バイト）
+    }
+    if (pos >= s.size() || !(s[pos] >= '0' && s[pos] <= '9')) return -1;
+    int64_t whole = 0;
+    while (pos < s.size() && ((s[pos] >= '0' && s[pos] <= '9') || s[pos] == ',')) {
+        if (s[pos] != ',') whole = whole * 10 + (s[pos] - '0');
+        ++pos;
+    }
+    int64_t cents = 0;
+    if (pos + 1 < s.size() && s[pos] == '.' && s[pos + 1] >= '0' && s[pos + 1] <= '9') {
+        ++pos;
+        int digits = 0;
+        while (pos < s.size() && s[pos] >= '0' && s[pos] <= '9') {
+            if (digits < 2) cents = cents * 10 + (s[pos] - '0');
+            ++digits;
+            ++pos;
+        }
+        if (digits == 1) cents *= 10;
+    }
+    return whole * 100 + cents;
+}
+
+inline int64_t parse_amount_at(std::string_view s, size_t pos) {
+    return parse_amount(s, pos);
+}
+
+inline uint64_t parse_uint(std::string_view s, size_t& pos) {
+    uint64_t v = 0;
+    while (pos < s.size() && s[pos] >= '0' && s[pos] <= '9') v = v * 10 + (s[pos++] - '0');
+    return v;
+}
+
+// 1970-01-01からの日数（proleptic Gregorian）
+inline int64_t days_from_civil(int64_t y, int64_t m, int64_t d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// "2020/01/31 9:05:07" 形式の最初の日時（無ければ0）
+inline int64_t parse_datetime(std::string_view s) {
+    for (size_t i = 0; i + 10 <= s.size(); ++i) {
+        if (!(s[i] >= '0' && s[i] <= '9') || s[i + 4] != '/' || s[i + 7] != '/') continue;
+        size_t p = i;
+        uint64_t y = parse_uint(s, p);
+        if (p != i + 4) continue;
+        ++p;
+        uint64_t mo = parse_uint(s, p);
+        if (p >= s.size() || s[p] != '/') continue;
+        ++p;
+        uint64_t d = parse_uint(s, p);
+        uint64_t hh = 0, mm = 0, ss = 0;
+        if (p < s.size() && s[p] == ' ') {
+            ++p;
+            hh = parse_uint(s, p);
+            if (p < s.size() && s[p] == ':') { ++p; mm = parse_uint(s, p); }
+            if (p < s.size() && s[p] == ':') { ++p; ss = parse_uint(s, p); }
+        }
+        return days_from_civil(int64_t(y), int64_t(mo), int64_t(d)) * 86400 +
+               int64_t(hh) * 3600 + int64_t(mm) * 60 + int64_t(ss);
+    }
+    return 0;
+}
+
+// "[Ah Kd]" の中身を読む。戻り値は枚数
+inline int parse_bracket_cards(std::string_view s, size_t open, Card* out, int max_cards) {
+    size_t close = s.find(']', open);
+    if (open == std::string_view::npos || close == std::string_view::npos) return -1;
+    return RangeParser::parse_cards(s.substr(open + 1, close - open - 1), out, max_cards);
+}
+
+// ハンドの先頭行か
+inline bool is_hand_header(std::string_view line) {
+    return starts_with(line, "PokerStars ") && line.find("Hand #") != std::string_view::npos;
+}
+
+// from以降で最初のハンド先頭（行頭の "PokerStars "）。無ければtext.size()
+inline size_t find_hand_start(std::string_view text, size_t from) {
+    if (from == 0 && starts_with(text, "PokerStars ")) return 0;
+    if (from == 0 && starts_with(text, "\xEF\xBB\xBFPokerStars ")) return 3;   // UTF-8 BOM
+    size_t pos = from == 0 ? 0 : from - 1;
+    while (true) {
+        pos = text.find("\nPokerStars ", pos);
+        if (pos == std::string_view::npos) return text.size();
+        size_t line_end = text.find('\n', pos + 1);
+        std::string_view line = text.substr(pos + 1, line_end == std::string_view::npos
+                                                         ? std::string_view::npos
+                                                         : line_end - pos - 1);
+        if (is_hand_header(line)) return pos + 1;
+        pos += 1;
+    }
+}
+
+// ===== ハンドのパース =====
+
+class HandParser {
+private:
+    ParsedHand& out;
+    std::vector<ActionRecord>& actions;
+    HandRecord& rec;
+    int street = 0;
+    int64_t pot = 0;
+    int64_t street_commit[MAX_SEATS] = {};
+    int64_t invested[MAX_SEATS] = {};
+    int64_t collected[MAX_SEATS] = {};
+    int button_seat = -1;
+    bool summary = false;
+
+public:
+    HandParser(ParsedHand& hand, std::vector<ActionRecord>& action_buffer)
+        : out(hand), actions(action_buffer), rec(hand.record) {}
+
+    // ハンドの先頭行から開始する
+    bool begin(std::string_view header) {
+        rec = HandRecord{};
+        rec.hero = NO_SEAT;
+        rec.action_begin = static_cast<uint32_t>(actions.size());
+        return parse_header(header);
+    }
+
+    // 先頭行以降の1行
+    void line(std::string_view line) {
+        if (line.empty()) return;
+        if (summary) {
+            if (starts_with(line, "Total pot ")) parse_total(line);
+            return;
+        }
+        if (starts_with(line, "*** ")) {
+            summary = parse_marker(line);
+        } else if (starts_with(line, "Seat ") && street == 0 && actions.size() == rec.action_begin) {
+            parse_seat(line);
+        } else if (starts_with(line, "Table '")) {
+            size_t p = line.find("Seat #");
+            if (p != std::string_view::npos) {
+                p += 6;
+                button_seat = static_cast<int>(parse_uint(line, p));
+            }
+        } else {
+            parse_action(line);
+        }
+    }
+
+    // ハンドの終わり（次の先頭行かテキストの終端）
+    bool finish() {
+        if (rec.seat_count < 2) return false;
+        rec.action_count = static_cast<uint16_t>(actions.size() - rec.action_begin);
+        if (rec.pot == 0) rec.pot = pot;
+        for (int i = 0; i < rec.seat_count; ++i) {
+            rec.seats[i].invested = invested[i];
+            rec.seats[i].net = collected[i] - invested[i];
+        }
+        assign_positions();
+        return true;
+    }
+
+private:
+    bool parse_header(std::string_view line) {
+        if (!is_hand_header(line)) return false;
+        size_t p = line.find("Hand #") + 6;
+        rec.hand_id = parse_uint(line, p);
+        if (rec.hand_id == 0) return false;
+
+        // ブラインド: 最初の "(SB/BB" 形式の括弧
+        for (size_t open = line.find('('); open != std::string_view::npos;
+             open = line.find('(', open + 1)) {
+            size_t q = open + 1;
+            int64_t sb = parse_amount(line, q);
+            if (sb < 0 || q >= line.size() || line[q] != '/') continue;
+            ++q;
+            int64_t bb = parse_amount(line, q);
+            if (bb < 0) continue;
+            rec.small_blind = sb;
+            rec.big_blind = bb;
+            break;
+        }
+
+        size_t dash = line.find(" - ", p);
+        rec.timestamp = dash != std::string_view::npos ? parse_datetime(line.substr(dash)) : 0;
+        return true;
+    }
+
+    // "Seat 3: name ($10.00 in chips)"
+    void parse_seat(std::string_view line) {
+        if (rec.seat_count >= MAX_SEATS) return;
+        size_t p = 5;
+        uint64_t seat = parse_uint(line, p);
+        if (p + 2 > line.size() || line[p] != ':' || seat == 0 || seat > MAX_SEATS) return;
+        size_t chips = line.find(" in chips");
+        if (chips == std::string_view::npos) return;
+        size_t open = line.rfind(" (", chips);
+        if (open == std::string_view::npos || open < p + 2) return;
+
+        int i = rec.seat_count++;
+        out.names[i] = line.substr(p + 2, open - p - 2);
+        SeatRecord& s = rec.seats[i];
+        s.seat = static_cast<uint8_t>(seat);
+        s.cards[0] = s.cards[1] = NO_CARD;
+        s.stack = std::max<int64_t>(0, parse_amount_at(line, open + 2));
+    }
+
+    // "*** FLOP *** [..]" 等。SUMMARYに入ったらtrue
+    bool parse_marker(std::string_view line) {
+        int next_street = -1;
+        if (starts_with(line, "*** FLOP ***")) next_street = 1;
+        else if (starts_with(line, "*** TURN ***")) next_street = 2;
+        else if (starts_with(line, "*** RIVER ***")) next_street = 3;
+        else if (starts_with(line, "*** SHOW DOWN ***")) rec.showdown = 1;
+        else if (starts_with(line, "*** SUMMARY ***")) return true;
+
+        if (next_street > 0) {
+            street = next_street;
+            std::fill(street_commit, street_commit + MAX_SEATS, 0);
+            // 新しいカードは最後の括弧（フロップは3枚）
+            Card cards[3];
+            int n = parse_bracket_cards(line, line.rfind('['), cards, 3);
+            for (int k = 0; k < n && rec.board_count < 5; ++k) {
+                rec.board[rec.board_count++] = cards[k];
+            }
+        }
+        return false;
+    }
+
+    void parse_total(std::string_view line) {
+        rec.pot = std::max<int64_t>(0, parse_amount_at(line, 10));
+        size_t rake = line.find("Rake ");
+        if (rake != std::string_view::npos) {
+            rec.rake = std::max<int64_t>(0, parse_amount_at(line, rake + 5));
+        }
+    }
+
+    // 行頭が「名前 + suffix」ならその座席の添字
+    int match_seat(std::string_view line, std::string_view suffix, size_t& rest) const {
+        for (int i = 0; i < rec.seat_count; ++i) {
+            std::string_view name = out.names[i];
+            if (line.size() > name.size() + suffix.size() &&
+                line.compare(0, name.size(), name) == 0 &&
+                line.compare(name.size(), suffix.size(), suffix) == 0) {
+                rest = name.size() + suffix.size();
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // このストリートの最大の投入額との差
+    int64_t facing(int seat) const {
+        int64_t top = 0;
+        for (int i = 0; i < rec.seat_count; ++i) top = std::max(top, street_commit[i]);
+        return std::max<int64_t>(0, top - street_commit[seat]);
+    }
+
+    void add_action(int seat, uint8_t action, int64_t amount, bool all_in, int64_t to_call) {
+        ActionRecord a = {};
+        a.seat_index = static_cast<uint8_t>(seat);
+        a.street = static_cast<uint8_t>(street);
+        a.action = action;
+        a.all_in = all_in ? 1 : 0;
+        a.to_call = static_cast<uint32_t>(std::min<int64_t>(to_call, UINT32_MAX));
+        a.amount = amount;
+        a.pot_before = pot;
+        actions.push_back(a);
+        pot += amount;
+        invested[seat] += amount;
+    }
+
+    void parse_action(std::string_view line) {
+        size_t rest;
+        if (starts_with(line, "Dealt to ")) {
+            int seat = match_seat(line.substr(9), " [", rest);
+            if (seat < 0) return;
+            rec.hero = static_cast<uint8_t>(seat);
+            set_cards(seat, line, 9 + rest - 1);
+            return;
+        }
+        if (starts_with(line, "Uncalled bet (")) {
+            int64_t amount = parse_amount_at(line, 14);
+            size_t to = line.find(") returned to ");
+            if (amount <= 0 || to == std::string_view::npos) return;
+            std::string_view name = line.substr(to + 14);
+            for (int i = 0; i < rec.seat_count; ++i) {
+                if (out.names[i] == name) {
+                    invested[i] -= amount;
+                    street_commit[i] -= amount;
+                    pot -= amount;
+                    break;
+                }
+            }
+            return;
+        }
+
+        int seat = match_seat(line, ": ", rest);
+        if (seat < 0) {
+            // "name collected $X from pot"
+            seat = match_seat(line, " collected ", rest);
+            if (seat >= 0) collected[seat] += std::max<int64_t>(0, parse_amount_at(line, rest));
+            return;
+        }
+
+        std::string_view verb = line.substr(rest);
+        bool all_in = verb.find("all-in") != std::string_view::npos;
+        int64_t to_call = facing(seat);
+        if (starts_with(verb, "folds")) {
+            add_action(seat, HUDStats::ACTION_FOLD, 0, false, to_call);
+        } else if (starts_with(verb, "checks")) {
+            add_action(seat, HUDStats::ACTION_CHECK, 0, false, to_call);
+        } else if (starts_with(verb, "calls ")) {
+            int64_t amount = std::max<int64_t>(0, parse_amount_at(verb, 6));
+            street_commit[seat] += amount;
+            add_action(seat, HUDStats::ACTION_CALL, amount, all_in, to_call);
+        } else if (starts_with(verb, "bets ")) {
+            int64_t amount = std::max<int64_t>(0, parse_amount_at(verb, 5));
+            street_commit[seat] += amount;
+            add_action(seat, HUDStats::ACTION_BET, amount, all_in, to_call);
+        } else if (starts_with(verb, "raises ")) {
+            // "raises $X to $Y": Yはこのストリートの合計
+            size_t to = verb.find(" to ");
+            if (to == std::string_view::npos) return;
+            int64_t total = std::max<int64_t>(0, parse_amount_at(verb, to + 4));
+            int64_t amount = std::max<int64_t>(0, total - street_commit[seat]);
+            street_commit[seat] = total;
+            add_action(seat, HUDStats::ACTION_RAISE, amount, all_in, to_call);
+        } else if (starts_with(verb, "posts ")) {
+            size_t p = verb.rfind(' ');
+            int64_t amount = std::max<int64_t>(0, parse_amount_at(verb, p + 1));
+            // アンテはストリートの合計（raises ... to の基準）に含めない
+            if (verb.find("ante") == std::string_view::npos) street_commit[seat] += amount;
+            add_action(seat, ACTION_POST, amount, false, to_call);
+        } else if (starts_with(verb, "shows [")) {
+            set_cards(seat, verb, 6);
+        }
+    }
+
+    void set_cards(int seat, std::string_view line, size_t open) {
+        Card cards[2];
+        if (parse_bracket_cards(line, open, cards, 2) == 2) {
+            rec.seats[seat].cards[0] = cards[0];
+            rec.seats[seat].cards[1] = cards[1];
+        }
+    }
+
+    // ボタンからの相対位置でstep13のポジション名に割り当てる
+    void assign_positions() {
+        int n = rec.seat_count;
+        // 空席がボタンのときは直前の座席（全ての座席より小さい番号なら一周して最後の座席）
+        int b = n > 0 ? n - 1 : 0;
+        for (int i = 0; i < n; ++i) {
+            if (rec.seats[i].seat <= button_seat) b = i;
+        }
+        rec.button = static_cast<uint8_t>(b);
+        enum { UTG = 0, MP, CO, BTN, SB, BB };
+        for (int i = 0; i < n; ++i) {
+            int k = (i - b + n) % n;
+            int pos;
+            if (n == 2) pos = k == 0 ? SB : BB;
+            else if (k == 0) pos = BTN;
+            else if (k == 1) pos = SB;
+            else if (k == 2) pos = BB;
+            else {
+                int from_button = n - k;   // 1 = ボタンの右隣
+                pos = from_button == 1 ? CO : (from_button == 2 ? MP : UTG);
+            }
+            rec.seats[i].position = static_cast<uint8_t>(pos);
+        }
+    }
+};
+
+// テキスト範囲（ハンド境界で始まる）を1回の行走査でパースする
+inline void parse_hands(std::string_view text, ParsedChunk& chunk) {
+    // 1ハンドはおよそ800バイト
+    chunk.hands.reserve(chunk.hands.size() + text.size() / 700 + 1);
+    chunk.actions.reserve(chunk.actions.size() + text.size() / 60 + 1);
+
+    std::optional<HandParser> parser;
+    size_t action_mark = 0;
+    auto finish = [&] {
+        if (!parser) return;
+        if (!parser->finish()) {
+            chunk.hands.pop_back();
+            chunk.actions.resize(action_mark);
+            ++chunk.errors;
+        }
+        parser.reset();
+    };
+
+    LineReader reader(text);
+    std::string_view line;
+    while (reader.next(line)) {
+        if (line.size() > 11 && line[0] == 'P' && is_hand_header(line)) {
+            finish();
+            chunk.hands.emplace_back();
+            action_mark = chunk.actions.size();
+            parser.emplace(chunk.hands.back(), chunk.actions);
+            if (!parser->begin(line)) {
+                parser.reset();
+                chunk.hands.pop_back();
+                ++chunk.errors;
+            }
+        } else if (parser) {
+            parser->line(line);
+        }
+    }
+    finish();
+}
+
+// ===== 出力先 =====
+
+// 統計ストアへのイベント化（step13 AdvancedHUDTrackerと同じ意味のイベントを作る）
+//   プリフロップ: 1人1イベント。アクションはレイズ > コール > 最初の判断 の順で代表させ、
+//                 最初の判断時点でレイズに直面していればflag
+//   ポストフロップ: 各アクション（value = 額/ポット）
+//   CBet: 前のストリートの最後のアグレッサーが、誰もベットしていない状態で最初に行動した機会
+//   ショーダウン: ショーダウンまでフォールドしなかったプレイヤー（回収があれば勝ち）
+class StatsSink {
+private:
+    StatsStore& store;
+    std::vector<PokerHudEvent> events;
+    std::vector<std::string_view> names;
+    std::vector<uint32_t> ids;
+
+    void push(const SeatRecord& seat, uint8_t kind, int street, uint8_t action,
+              bool flag, float value) {
+        PokerHudEvent e = {};
+        e.player = seat.player;
+        e.kind = kind;
+        e.position = seat.position;
+        e.street = static_cast<uint8_t>(street);
+        e.action = action;
+        e.flag = flag ? 1 : 0;
+        e.value = value;
+        events.push_back(e);
+    }
+
+public:
+    explicit StatsSink(StatsStore& s) : store(s) {}
+
+    void write(ParsedChunk& chunk) {
+        // チャンク内の全座席の名前を1回のロックで番号へ変換する
+        names.clear();
+        for (const ParsedHand& hand : chunk.hands) {
+            names.insert(names.end(), hand.names, hand.names + hand.record.seat_count);
+        }
+        ids.resize(names.size());
+        store.player_ids(names.data(), names.size(), ids.data());
+
+        events.clear();
+        size_t next = 0;
+        for (ParsedHand& hand : chunk.hands) {
+            HandRecord& rec = hand.record;
+            for (int i = 0; i < rec.seat_count; ++i) rec.seats[i].player = ids[next++];
+            hand_events(rec, chunk.actions.data() + rec.action_begin);
+        }
+        store.apply(events.data(), events.size());
+    }
+
+private:
+    void hand_events(const HandRecord& rec, const ActionRecord* acts) {
+        int n = rec.seat_count;
+        bool decided[MAX_SEATS] = {}, facing[MAX_SEATS] = {}, raised[MAX_SEATS] = {};
+        bool called[MAX_SEATS] = {}, folded[MAX_SEATS] = {};
+        uint8_t first[MAX_SEATS] = {};
+        int aggressor = -1;
+        int raises = 0;
+
+        for (int k = 0; k < rec.action_count; ++k) {
+            const ActionRecord& a = acts[k];
+            if (a.street != 0 || a.action == ACTION_POST) continue;
+            int s = a.seat_index;
+            if (!decided[s]) {
+                decided[s] = true;
+                facing[s] = raises > 0;
+                first[s] = a.action;
+            }
+            if (a.action == HUDStats::ACTION_RAISE || a.action == HUDStats::ACTION_BET) {
+                raised[s] = true;
+                aggressor = s;
+                ++raises;
+            } else if (a.action == HUDStats::ACTION_CALL) {
+                called[s] = true;
+            } else if (a.action == HUDStats::ACTION_FOLD) {
+                folded[s] = true;
+            }
+        }
+        for (int s = 0; s < n; ++s) {
+            if (!decided[s]) continue;
+            uint8_t action = raised[s] ? HUDStats::ACTION_RAISE
+                           : called[s] ? HUDStats::ACTION_CALL : first[s];
+            push(rec.seats[s], HUDStats::EVENT_PREFLOP, 0, action, facing[s], 0.0f);
+        }
+
+        // ベットの無いストリートの後はCBetを追わない（アクションとフォールドは全ストリート記録する）
+        bool tracking = aggressor >= 0;
+        for (int street = 1; street < 4; ++street) {
+            bool bet_seen = false;
+            bool cbet_checked = false;
+            bool cbet_made = false;
+            bool responded[MAX_SEATS] = {};
+            int next_aggressor = -1;
+            for (int k = 0; k < rec.action_count; ++k) {
+                const ActionRecord& a = acts[k];
+                if (a.street != street) continue;
+                int s = a.seat_index;
+                bool aggressive = a.action == HUDStats::ACTION_BET || a.action == HUDStats::ACTION_RAISE;
+                float size = a.pot_before > 0 ? float(double(a.amount) / double(a.pot_before)) : 0.0f;
+                push(rec.seats[s], HUDStats::EVENT_POSTFLOP, street, a.action, false, size);
+                if (a.action == HUDStats::ACTION_FOLD) folded[s] = true;
+
+                if (tracking && s == aggressor && !cbet_checked) {
+                    cbet_checked = true;
+                    if (!bet_seen) {
+                        cbet_made = a.action == HUDStats::ACTION_BET;
+                        push(rec.seats[s], HUDStats::EVENT_CBET, street, 0, cbet_made, 0.0f);
+                    }
+                } else if (cbet_made && s != aggressor && !responded[s]) {
+                    responded[s] = true;
+                    push(rec.seats[s], HUDStats::EVENT_FACED_CBET, street, 0,
+                         a.action == HUDStats::ACTION_FOLD, 0.0f);
+                }
+                if (aggressive) {
+                    bet_seen = true;
+                    next_aggressor = s;
+                    if (s != aggressor) cbet_made = false;   // レイズ後の応答はCBetへの対応ではない
+                }
+            }
+            aggressor = next_aggressor;
+            if (aggressor < 0) tracking = false;
+        }
+
+        if (rec.showdown) {
+            int last_street = rec.board_count >= 3 ? rec.board_count - 2 : 0;
+            for (int s = 0; s < n; ++s) {
+                if (!decided[s] || folded[s]) continue;
+                push(rec.seats[s], HUDStats::EVENT_SHOWDOWN, last_street, 0,
+                     rec.seats[s].net > 0, 0.0f);
+            }
+        }
+    }
+};
+
+inline std::string card_name(Card c) {
+    static const char RANKS[] = "23456789TJQKA";
+    static const char SUITS[] = "shdc";
+    return std::string{RANKS[c % RANK_COUNT], SUITS[c / RANK_COUNT]};
+}
+
+// step33の履歴DBへの書き込み（ヒーローが参加したハンドのみ）
+class HistorySink {
+#ifdef POKER_ENGINE_HAS_SQLITE
+private:
+    sqlite3* db = nullptr;
+    sqlite3_stmt* insert_hand = nullptr;
+    sqlite3_stmt* insert_action = nullptr;
+    std::string session_id;
+    uint64_t rows = 0;
+
+public:
+    ~HistorySink() {
+        sqlite3_finalize(insert_hand);
+        sqlite3_finalize(insert_action);
+        sqlite3_close(db);
+    }
+
+    bool open(const std::string& path, const std::string& session, std::string& error) {
+        session_id = session;
+        if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) {
+            error = "cannot open " + path + ": " + sqlite3_errmsg(db);
+            return false;
+        }
+        // step33 HandHistory._init_database と同じスキーマ
+        const char* schema =
+            "CREATE TABLE IF NOT EXISTS hands ("
+            " hand_id TEXT PRIMARY KEY, timestamp TEXT, session_id TEXT, position TEXT,"
+            " hole_cards TEXT, board TEXT, pot_size REAL, won BOOLEAN, profit_loss REAL,"
+            " action_preflop TEXT, action_flop TEXT, action_turn TEXT, action_river TEXT,"
+            " showdown BOOLEAN, hand_strength TEXT, equity REAL, eqr REAL, ev REAL,"
+            " gto_action TEXT, actual_action TEXT, opponents TEXT, notes TEXT);"
+            "CREATE TABLE IF NOT EXISTS actions ("
+            " action_id INTEGER PRIMARY KEY AUTOINCREMENT, hand_id TEXT, street TEXT,"
+            " action_type TEXT, amount REAL, pot_before REAL, pot_after REAL, timestamp TEXT,"
+            " FOREIGN KEY (hand_id) REFERENCES hands (hand_id));";
+        if (sqlite3_exec(db, schema, nullptr, nullptr, nullptr) != SQLITE_OK ||
+            sqlite3_prepare_v2(db,
+                "INSERT OR IGNORE INTO hands VALUES "
+                "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, '', 0, 0, 0, '', '', ?, '')",
+                -1, &insert_hand, nullptr) != SQLITE_OK ||
+            sqlite3_prepare_v2(db,
+                "INSERT INTO actions (hand_id, street, action_type, amount, pot_before,"
+                " pot_after, timestamp) VALUES (?, ?, ?, ?, ?, ?, ?)",
+                -1, &insert_action, nullptr) != SQLITE_OK) {
+            error = std::string("cannot prepare history statements: ") + sqlite3_errmsg(db);
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t written() const { return rows; }
+
+    bool write(const ParsedChunk& chunk, std::string& error) {
+        static const char* const POSITIONS[] = {"UTG", "MP", "CO", "BTN", "SB", "BB"};
+        static const char* const STREETS[] = {"preflop", "flop", "turn", "river"};
+        static const char* const ACTIONS[] = {"fold", "check", "call", "bet", "raise", "post"};
+
+        sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+        for (const ParsedHand& hand : chunk.hands) {
+            const HandRecord& rec = hand.record;
+            if (rec.hero == NO_SEAT) continue;
+            const SeatRecord& hero = rec.seats[rec.hero];
+
+            std::string id = std::to_string(rec.hand_id);
+            char when[32];
+            int64_t days = rec.timestamp / 86400;
+            int64_t secs = rec.timestamp % 86400;
+            civil_string(days, secs, when);
+
+            std::string hole = "[";
+            if (hero.cards[0] != NO_CARD) {
+                hole += "\"" + card_name(hero.cards[0]) + "\", \"" + card_name(hero.cards[1]) + "\"";
+            }
+            hole += "]";
+            std::string board = "[";
+            for (int k = 0; k < rec.board_count; ++k) {
+                if (k > 0) board += ", ";
+                board += "\"" + card_name(rec.board[k]) + "\"";
+            }
+            board += "]";
+            std::string opponents = "[";
+            for (int i = 0; i < rec.seat_count; ++i) {
+                if (i == rec.hero) continue;
+                if (opponents.size() > 1) opponents += ", ";
+                opponents += "\"" + json_escape(hand.names[i]) + "\"";
+            }
+            opponents += "]";
+
+            std::string street_actions[4];
+            const ActionRecord* acts = chunk.actions.data() + rec.action_begin;
+            for (int k = 0; k < rec.action_count; ++k) {
+                const ActionRecord& a = acts[k];
+                if (a.seat_index != rec.hero || a.action == ACTION_POST) continue;
+                std::string& text = street_actions[a.street];
+                if (!text.empty()) text += ", ";
+                text += ACTIONS[a.action];
+                if (a.amount > 0) text += " " + money_string(a.amount);
+            }
+
+            sqlite3_reset(insert_hand);
+            bind_text(insert_hand, 1, id);
+            bind_text(insert_hand, 2, when);
+            bind_text(insert_hand, 3, session_id);
+            bind_text(insert_hand, 4, POSITIONS[hero.position]);
+            bind_text(insert_hand, 5, hole);
+            bind_text(insert_hand, 6, board);
+            sqlite3_bind_double(insert_hand, 7, rec.pot / 100.0);
+            sqlite3_bind_int(insert_hand, 8, hero.net > 0);
+            sqlite3_bind_double(insert_hand, 9, hero.net / 100.0);
+            for (int st = 0; st < 4; ++st) bind_text(insert_hand, 10 + st, street_actions[st]);
+            sqlite3_bind_int(insert_hand, 14, rec.showdown);
+            bind_text(insert_hand, 15, opponents);
+            if (sqlite3_step(insert_hand) != SQLITE_DONE) {
+                error = std::string("insert failed: ") + sqlite3_errmsg(db);
+                sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+                return false;
+            }
+            if (sqlite3_changes(db) == 0) continue;   // 取り込み済み
+            ++rows;
+
+            for (int k = 0; k < rec.action_count; ++k) {
+                const ActionRecord& a = acts[k];
+                if (a.seat_index != rec.hero) continue;
+                sqlite3_reset(insert_action);
+                bind_text(insert_action, 1, id);
+                bind_text(insert_action, 2, STREETS[a.street]);
+                bind_text(insert_action, 3, ACTIONS[a.action]);
+                sqlite3_bind_double(insert_action, 4, a.amount / 100.0);
+                sqlite3_bind_double(insert_action, 5, a.pot_before / 100.0);
+                sqlite3_bind_double(insert_action, 6, (a.pot_before + a.amount) / 100.0);
+                bind_text(insert_action, 7, when);
+                if (sqlite3_step(insert_action) != SQLITE_DONE) {
+                    error = std::string("insert failed: ") + sqlite3_errmsg(db);
+                    sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+                    return false;
+                }
+            }
+        }
+        if (sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            error = std::string("commit failed: ") + sqlite3_errmsg(db);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static void bind_text(sqlite3_stmt* stmt, int index, const std::string& text) {
+        sqlite3_bind_text(stmt, index, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+    }
+
+    static void civil_string(int64_t days, int64_t secs, char* out) {
+        // days_from_civilの逆変換
+        days += 719468;
+        int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        int64_t doe = days - era * 146097;
+        int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int64_t mp = (5 * doy + 2) / 153;
+        int64_t d = doy - (153 * mp + 2) / 5 + 1;
+        int64_t m = mp < 10 ? mp + 3 : mp - 9;
+        int64_t y = yoe + era * 400 + (m <= 2);
+        std::snprintf(out, 32, "%04lld-%02lld-%02lldT%02lld:%02lld:%02lld",
+                      static_cast<long long>(y), static_cast<long long>(m),
+                      static_cast<long long>(d), static_cast<long long>(secs / 3600),
+                      static_cast<long long>(secs / 60 % 60), static_cast<long long>(secs % 60));
+    }
+
+    static std::string money_string(int64_t cents) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%lld.%02lld", static_cast<long long>(cents / 100),
+                      static_cast<long long>(cents % 100));
+        return buf;
+    }
+
+    static std::string json_escape(std::string_view s) {
+        std::string out;
+        out.reserve(s.size());
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+#else
+public:
+    bool open(const std::string&, const std::string&, std::string& error) {
+        error = "built without SQLite support";
+        return false;
+    }
+    uint64_t written() const { return 0; }
+    bool write(const ParsedChunk&, std::string&) { return true; }
+#endif
+};
+
+// step52のハンドストアへの追加（ヒーローが参加したハンドのみ。取り込み済みのhand_idは飛ばす）
+class StoreSink {
+private:
+    HandStore::Store& store;
+    uint32_t session;
+    uint64_t rows = 0;
+    std::vector<PokerStoredAction> actions;
+
+public:
+    // 書き込み可能なストアのみ（hh_importで確認する）
+    StoreSink(HandStore::Store& s, std::string_view session_name)
+        : store(s), session(static_cast<uint32_t>(s.session(session_name))) {}
+
+    uint64_t written() const { return rows; }
+
+    bool write(const ParsedChunk& chunk, std::string& error) {
+        for (const ParsedHand& hand : chunk.hands) {
+            const HandRecord& rec = hand.record;
+            if (rec.hero == NO_SEAT) continue;
+            const SeatRecord& hero = rec.seats[rec.hero];
+
+            PokerStoredHand out = {};
+            out.hand_id = rec.hand_id;
+            out.timestamp = rec.timestamp;
+            if (hero.cards[0] != NO_CARD) {
+                out.hole = card_to_mask(hero.cards[0]) | card_to_mask(hero.cards[1]);
+            }
+            out.pot = rec.pot;
+            out.profit = hero.net;
+            out.session = session;
+            out.position = hero.position;
+            out.flags = static_cast<uint8_t>((hero.net > 0 ? HandStore::FLAG_WON : 0) |
+                                             (rec.showdown ? HandStore::FLAG_SHOWDOWN : 0));
+            out.opponents = static_cast<uint8_t>(rec.seat_count - 1);
+            out.board_count = rec.board_count;
+            std::memcpy(out.board_cards, rec.board, sizeof(out.board_cards));
+
+            // プリフロップのレイズ回数・フォールド・最後のレイザーからポットの種類と主な相手を決める
+            const ActionRecord* acts = chunk.actions.data() + rec.action_begin;
+            int raises = 0;
+            int last_raiser = -1;
+            bool folded[MAX_SEATS] = {};
+            for (int k = 0; k < rec.action_count; ++k) {
+                const ActionRecord& a = acts[k];
+                if (a.street != 0) break;
+                if (a.action == HUDStats::ACTION_RAISE || a.action == HUDStats::ACTION_BET) {
+                    ++raises;
+                    last_raiser = a.seat_index;
+                } else if (a.action == HUDStats::ACTION_FOLD) {
+                    folded[a.seat_index] = true;
+                }
+            }
+            out.pot_type = static_cast<uint8_t>(std::min(raises, 3) + HandStore::POT_LIMPED);
+            int remaining = 0;
+            int opponent = -1;
+            for (int i = 0; i < rec.seat_count; ++i) {
+                if (folded[i]) continue;
+                ++remaining;
+                if (i != rec.hero) opponent = i;
+            }
+            if (rec.board_count >= 3) out.flop_players = static_cast<uint8_t>(remaining);
+            // ヘッズアップならその相手、そうでなければヒーロー以外の最後のレイザー
+            if (remaining != 2 || folded[rec.hero]) {
+                opponent = last_raiser != rec.hero ? last_raiser : -1;
+            }
+            if (opponent >= 0) out.villain = static_cast<uint8_t>(rec.seats[opponent].position + 1);
+
+            out.big_blind = static_cast<int32_t>(std::clamp<int64_t>(rec.big_blind, 0, INT32_MAX));
+            out.invested = static_cast<int32_t>(hero.invested);
+            out.rake = static_cast<int32_t>(rec.rake);
+
+            // リバー前のオールイン: 誰かがオールインし、最後のアクションの後はボードが配られるだけ
+            // （ショーダウンまで残った相手が1人でカードを見せていれば、その2枚も残す）
+            out.villain_cards[0] = out.villain_cards[1] = NO_CARD;
+            if (rec.action_count > 0 && rec.showdown && rec.board_count == 5) {
+                bool any_all_in = false;
+                bool live[MAX_SEATS];
+                std::fill(live, live + MAX_SEATS, true);
+                for (int k = 0; k < rec.action_count; ++k) {
+                    any_all_in |= acts[k].all_in != 0;
+                    if (acts[k].action == HUDStats::ACTION_FOLD) live[acts[k].seat_index] = false;
+                }
+                int last_street = acts[rec.action_count - 1].street;
+                if (any_all_in && live[rec.hero] && last_street < 3) {
+                    out.allin_street = static_cast<uint8_t>(last_street + 1);
+                    int live_count = 0;
+                    int live_opponent = -1;
+                    for (int i = 0; i < rec.seat_count; ++i) {
+                        if (!live[i] || i == rec.hero) continue;
+                        ++live_count;
+                        live_opponent = i;
+                    }
+                    if (live_count == 1 && rec.seats[live_opponent].cards[0] != NO_CARD) {
+                        out.villain_cards[0] = rec.seats[live_opponent].cards[0];
+                        out.villain_cards[1] = rec.seats[live_opponent].cards[1];
+                    }
+                }
+            }
+
+            // ヒーローのアクションごとに、その直前の有効スタック
+            // （ヒーローの残りと、降りていない相手の最大の残りの小さい方）を再現する
+            actions.clear();
+            int64_t put[MAX_SEATS] = {};
+            bool out_of_hand[MAX_SEATS] = {};
+            for (int k = 0; k < rec.action_count; ++k) {
+                const ActionRecord& a = acts[k];
+                if (a.seat_index == rec.hero) {
+                    int64_t villain_left = 0;
+                    for (int i = 0; i < rec.seat_count; ++i) {
+                        if (i == rec.hero || out_of_hand[i]) continue;
+                        villain_left = std::max(villain_left, rec.seats[i].stack - put[i]);
+                    }
+                    PokerStoredAction sa = {};
+                    sa.street = a.street;
+                    sa.action = a.action;
+                    sa.all_in = a.all_in;
+                    sa.amount = static_cast<int32_t>(a.amount);
+                    sa.pot_before = static_cast<int32_t>(a.pot_before);
+                    sa.to_call = static_cast<int32_t>(std::min<uint32_t>(a.to_call, INT32_MAX));
+                    int64_t effective = std::min(hero.stack - put[rec.hero], villain_left);
+                    sa.stack = static_cast<int32_t>(std::clamp<int64_t>(effective, 0, INT32_MAX));
+                    actions.push_back(sa);
+                }
+                put[a.seat_index] += a.amount;
+                if (a.action == HUDStats::ACTION_FOLD) out_of_hand[a.seat_index] = true;
+            }
+
+            uint64_t index;
+            if (store.append(out, actions.data(), actions.size(), index, error)) {
+                ++rows;
+            } else if (!error.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// ===== 取り込み =====
+
+class MappedFile {
+private:
+    void* mapping = nullptr;
+    size_t length = 0;
+
+public:
+    ~MappedFile() {
+        if (mapping != nullptr) munmap(mapping, length);
+    }
+
+    bool open(const std::string& path, std::string& error) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = "cannot open " + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            error = "cannot stat " + path;
+            return false;
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                mapping = nullptr;
+                ::close(fd);
+                error = "mmap failed: " + path;
+                return false;
+            }
+            madvise(mapping, length, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    std::string_view text() const {
+        return std::string_view(static_cast<const char*>(mapping), length);
+    }
+};
+
+struct ImportOptions {
+    int threads = 0;                      // 0 = hardware_concurrency
+    size_t window_bytes = size_t(64) << 20;
+};
+
+struct ImportStats {
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+    uint64_t hands = 0;
+    uint64_t errors = 0;
+};
+
+// 出力先はチャンクごとにファイル内の順序どおり呼ばれる（メインスレッド）
+using ChunkSink = std::function<bool(ParsedChunk&, std::string&)>;
+
+class Importer {
+private:
+    ImportOptions options;
+    int threads;
+
+    // ウィンドウ（ハンド境界で始まり終わる範囲）をスレッド数に分けてパースする
+    std::vector<ParsedChunk> parse_window(std::string_view window) const {
+        size_t parts = static_cast<size_t>(threads);
+        std::vector<size_t> bounds{0};
+        for (size_t k = 1; k < parts; ++k) {
+            size_t start = find_hand_start(window, std::max(bounds.back(), window.size() * k / parts));
+            if (start >= window.size()) break;
+            if (start > bounds.back()) bounds.push_back(start);
+        }
+        bounds.push_back(window.size());
+
+        std::vector<ParsedChunk> chunks(bounds.size() - 1);
+        std::vector<std::thread> workers;
+        for (size_t k = 1; k < chunks.size(); ++k) {
+            workers.emplace_back([&, k] {
+                parse_hands(window.substr(bounds[k], bounds[k + 1] - bounds[k]), chunks[k]);
+            });
+        }
+        parse_hands(window.substr(0, bounds[1]), chunks[0]);
+        for (auto& w : workers) w.join();
+        return chunks;
+    }
+
+public:
+    explicit Importer(const ImportOptions& opts) : options(opts) {
+        threads = options.threads > 0
+            ? options.threads
+            : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    bool import_file(const std::string& path, const ChunkSink& sink, ImportStats& stats,
+                     std::string& error) {
+        MappedFile file;
+        if (!file.open(path, error)) return false;
+        std::string_view text = file.text();
+
+        // ウィンドウ境界をハンドの先頭に合わせる
+        auto window_end = [&](size_t begin) {
+            if (text.size() - begin <= options.window_bytes) return text.size();
+            return find_hand_start(text, begin + options.window_bytes);
+        };
+
+        size_t begin = find_hand_start(text, 0);
+        size_t end = window_end(begin);
+        auto pending = std::async(std::launch::async, [this, window = text.substr(begin, end - begin)] {
+            return parse_window(window);
+        });
+        bool ok = true;
+        while (true) {
+            std::vector<ParsedChunk> chunks = pending.get();
+            begin = end;
+            bool more = begin < text.size();
+            if (more) {
+                end = window_end(begin);
+                pending = std::async(std::launch::async,
+                                     [this, window = text.substr(begin, end - begin)] {
+                    return parse_window(window);
+                });
+            }
+            // 出力中に次のウィンドウのパースが進む
+            for (ParsedChunk& chunk : chunks) {
+                stats.hands += chunk.hands.size();
+                stats.errors += chunk.errors;
+                if (ok && !sink(chunk, error)) ok = false;
+            }
+            if (!more || !ok) break;   // 未取得のパースはfutureの破棄時に待つ
+        }
+        ++stats.files;
+        stats.bytes += text.size();
+        return ok;
+    }
+};
+
+} // namespace HandHistoryImport
+
+extern "C" {
+    using namespace HandHistoryImport;
+
+    // ハンド履歴ファイルを取り込む。stats_handle(step50)、history_path(step33 DB)、
+    // store_handle(step52)は省略可(NULL)。戻り値は取り込んだハンド数（失敗時-1）
+    int64_t hh_import(const char* const* paths, int path_count, void* stats_handle,
+                      const char* history_path, void* store_handle, int threads,
+                      PokerImportResult* out) {
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+
+        std::unique_ptr<StatsSink> stats;
+        if (stats_handle != nullptr) stats.reset(new StatsSink(*static_cast<StatsStore*>(stats_handle)));
+        std::unique_ptr<HistorySink> history;
+        if (history_path != nullptr && history_path[0] != '\0') {
+            history.reset(new HistorySink());
+            if (!history->open(history_path, "import", error)) {
+                std::fprintf(stderr, "hh_import: %s\n", error.c_str());
+                return -1;
+            }
+        }
+        std::unique_ptr<StoreSink> store;
+        if (store_handle != nullptr) {
+            if (static_cast<HandStore::Store*>(store_handle)->is_read_only()) {
+                std::fprintf(stderr, "hh_import: hand store is read-only\n");
+                return -1;
+            }
+            store.reset(new StoreSink(*static_cast<HandStore::Store*>(store_handle), "import"));
+        }
+
+        ImportOptions options;
+        options.threads = threads;
+        Importer importer(options);
+        ImportStats totals;
+        ChunkSink sink = [&](ParsedChunk& chunk, std::string& err) {
+            if (stats) stats->write(chunk);
+            return (!history || history->write(chunk, err)) && (!store || store->write(chunk, err));
+        };
+
+        bool ok = true;
+        for (int i = 0; i < path_count && ok; ++i) {
+            ok = importer.import_file(paths[i], sink, totals, error);
+        }
+        // ハンドストアは書き込みが非同期なので、全件が書かれるまで待つ
+        if (ok && store) ok = static_cast<HandStore::Store*>(store_handle)->flush(error);
+        if (!ok) std::fprintf(stderr, "hh_import: %s\n", error.c_str());
+
+        if (out != nullptr) {
+            out->files = totals.files;
+            out->bytes = totals.bytes;
+            out->hands = totals.hands;
+            out->errors = totals.errors;
+            out->history_rows = history ? history->written() : 0;
+            out->store_rows = store ? store->written() : 0;
+            out->seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+        return ok ? static_cast<int64_t>(totals.hands) : -1;
+    }
+}
+
+#endif // POKER_STEP51_HH_IMPORT_CPP
@@ -0,0 +1,777 @@
+// step52_hand_store.cpp
+// 追記型ハンドストア（step33 HandHistoryのSQLite記録を置き換える）
+// ヒーロー視点のハンドを固定長バイナリレコードとして3つのログファイルに追記する。
+//   path.hands     PokerStoredHand (104バイト) の配列
+//   path.actions   PokerStoredAction (20バイト) の配列（ハンドはoffset/countで参照）
+//   path.sessions  セッション名表 (uint32_t 長さ, バイト列)
+// ・追加はメモリ上のバッファに積むだけで、書き込みスレッドが数ms単位でまとめて書く
+//   （セッション → アクション → ハンドの順に書くので、途中で落ちても末尾を捨てれば整合する）
+// ・ファイルはmmapして参照し、検索は配列を直接走査する
+// ・二次索引（セッション / ポジション / 169クラス / フロップのテクスチャ / hand_id）は
+//   開くときに走査で作り直し、以降は書き込みごとに追記する（昇順のハンド番号列）
+#ifndef POKER_STEP52_HAND_STORE_CPP
+#define POKER_STEP52_HAND_STORE_CPP
+
+#include "poker_engine.h"
+#include "step47_range.cpp"
+#include "step48_board_features.cpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace HandStore {
+
+using namespace PokerCore;
+
+using StoredHand = PokerStoredHand;
+using StoredAction = PokerStoredAction;
+using HandQuery = PokerHandQuery;
+using PositionStats = PokerPositionStats;
+
+static_assert(sizeof(StoredHand) == 104, "StoredHand layout must stay stable");
+static_assert(sizeof(StoredAction) == 20, "StoredAction layout must stay stable");
+
+constexpr int POSITION_COUNT = 6;
+constexpr uint8_t UNKNOWN = 0xFF;
+constexpr int TEXTURE_COUNT = 4;
+constexpr int CLASS_COUNT = RangeEngine::CLASS_COUNT;
+constexpr uint8_t FLAG_WON = 1;
+constexpr uint8_t FLAG_SHOWDOWN = 2;
+// ポットの種類（プリフロップのレイズ回数）
+enum PotType : uint8_t {
+    POT_UNKNOWN = 0, POT_LIMPED, POT_SINGLE_RAISED, POT_3BET, POT_4BET
+};
+// ストアが採番するhand_id（取り込んだハンドのサイトIDと重ならない）
+constexpr uint64_t LOCAL_ID_BIT = uint64_t(1) << 63;
+
+// グループコミットの間隔と、待たずに書き始める件数
+constexpr auto COMMIT_INTERVAL = std::chrono::milliseconds(5);
+constexpr size_t COMMIT_BATCH = 4096;
+
+// ===== ファイル形式 =====
+struct LogHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t record_size;
+    uint64_t reserved[2];
+};
+static_assert(sizeof(LogHeader) == 32, "LogHeader layout must stay stable");
+
+// 形式の履歴（古い版のストアは開けないので取り込み直す）
+//   1: ハンド88バイト / アクション12バイト
+//   2: ハンド104バイト（オールインEV用の項目を追加） / アクション12バイト
+//   3: ハンド104バイト / アクション20バイト（監査用の項目を追加）
+constexpr uint32_t FORMAT_VERSION = 3;
+constexpr char HANDS_MAGIC[8] = {'P', 'K', 'H', 'S', 'H', 'A', 'N', 'D'};
+constexpr char ACTIONS_MAGIC[8] = {'P', 'K', 'H', 'S', 'A', 'C', 'T', 'N'};
+constexpr char SESSIONS_MAGIC[8] = {'P', 'K', 'H', 'S', 'S', 'E', 'S', 'S'};
+
+// 追記されるファイル1本。mmapは余裕を持って確保し、ファイルが伸びても張り直さずに済ませる
+class LogFile {
+private:
+    int fd = -1;
+    void* mapping = nullptr;
+    size_t mapped = 0;
+
+public:
+    ~LogFile() {
+        if (mapping != nullptr) munmap(mapping, mapped);
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool open(const std::string& path, bool read_only, const char* magic, uint32_t record_size,
+              std::string& error) {
+        fd = ::open(path.c_str(), read_only ? O_RDONLY | O_CLOEXEC
+                                            : O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            error = "cannot open " + path;
+            return false;
+        }
+        LogHeader header = {};
+        if (size() < sizeof(LogHeader)) {
+            // 新規（ヘッダ書き込み中に落ちたファイルも作り直す）
+            if (read_only) {
+                error = "not a hand store: " + path;
+                return false;
+            }
+            std::memcpy(header.magic, magic, sizeof(header.magic));
+            header.format_version = FORMAT_VERSION;
+            header.record_size = record_size;
+            if (ftruncate(fd, 0) != 0 || !append(&header, sizeof(header))) {
+                error = "cannot initialize " + path;
+                return false;
+            }
+        } else if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+                   std::memcmp(header.magic, magic, sizeof(header.magic)) != 0) {
+            error = "bad magic: " + path;
+            return false;
+        } else if (header.format_version != FORMAT_VERSION || header.record_size != record_size) {
+            error = "unsupported format version: " + path;
+            return false;
+        }
+        return true;
+    }
+
+    int descriptor() const { return fd; }
+
+    size_t size() const {
+        struct stat st;
+        return fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    }
+
+    // ヘッダ以降のlengthバイトを参照できるようにする
+    bool map(size_t length) {
+        size_t needed = sizeof(LogHeader) + length;
+        if (needed <= mapped) return true;
+        size_t capacity = std::max<size_t>(needed * 2, size_t(1) << 20);
+        void* m = mmap(nullptr, capacity, PROT_READ, MAP_SHARED, fd, 0);
+        if (m == MAP_FAILED) return false;
+        if (mapping != nullptr) munmap(mapping, mapped);
+        mapping = m;
+        mapped = capacity;
+        return true;
+    }
+
+    template <class T>
+    const T* records() const {
+        return reinterpret_cast<const T*>(static_cast<const char*>(mapping) + sizeof(LogHeader));
+    }
+
+    bool append(const void* data, size_t length) {
+        const char* p = static_cast<const char*>(data);
+        while (length > 0) {
+            ssize_t written = ::write(fd, p, length);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            p += written;
+            length -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool truncate(size_t length) {
+        return ftruncate(fd, static_cast<off_t>(sizeof(LogHeader) + length)) == 0;
+    }
+};
+
+// ===== 分類 =====
+
+// ホールカード2枚の169クラス（2枚でなければUNKNOWN）
+inline uint8_t hole_class(CardMask hole) {
+    if (count_cards(hole) != 2) return UNKNOWN;
+    Card low = static_cast<Card>(__builtin_ctzll(hole));
+    Card high = static_cast<Card>(63 - __builtin_clzll(hole));
+    return RangeEngine::COMBO_CLASS[RangeParser::combo_index(low, high)];
+}
+
+// フロップ（最初の3枚）のテクスチャ（フロップが無ければUNKNOWN）
+inline uint8_t flop_texture(const uint8_t* board_cards, int board_count) {
+    if (board_count < 3) return UNKNOWN;
+    CardMask flop = card_to_mask(board_cards[0]) | card_to_mask(board_cards[1]) |
+                    card_to_mask(board_cards[2]);
+    return BoardFeatureEngine::BoardFeatureTable::instance().lookup(flop).texture;
+}
+
+// 索引なしで判定する条件（索引で絞った後にも全条件をもう一度見る）
+inline bool matches(const StoredHand& h, const HandQuery& q) {
+    if (q.session >= 0 && h.session != static_cast<uint64_t>(q.session)) return false;
+    if (q.position_mask != 0) {
+        int bit = h.position < POSITION_COUNT ? h.position : POSITION_COUNT;
+        if (!((q.position_mask >> bit) & 1)) return false;
+    }
+    if (q.texture_mask != 0) {
+        int bit = h.texture < TEXTURE_COUNT ? h.texture : TEXTURE_COUNT;
+        if (!((q.texture_mask >> bit) & 1)) return false;
+    }
+    if ((q.class_mask[0] | q.class_mask[1] | q.class_mask[2]) != 0) {
+        if (h.hole_class >= CLASS_COUNT ||
+            !((q.class_mask[h.hole_class >> 6] >> (h.hole_class & 63)) & 1)) {
+            return false;
+        }
+    }
+    if (h.pot < q.min_pot) return false;
+    if (q.start_time != 0 && h.timestamp < q.start_time) return false;
+    if (q.end_time != 0 && h.timestamp >= q.end_time) return false;
+    if (q.won >= 0 && ((h.flags & FLAG_WON) != 0) != (q.won != 0)) return false;
+    if (q.showdown >= 0 && ((h.flags & FLAG_SHOWDOWN) != 0) != (q.showdown != 0)) return false;
+    return true;
+}
+
+inline void accumulate(const StoredHand& h, PositionStats* out) {
+    PositionStats& s = out[h.position < POSITION_COUNT ? h.position : POSITION_COUNT];
+    ++s.hands;
+    s.won += h.flags & FLAG_WON;
+    s.profit += h.profit;
+    s.equity_sum += h.equity;
+}
+
+// 全件走査のポジション別集計（索引で絞れない条件の場合）
+POKER_HOT_KERNEL
+static void scan_position_stats(const StoredHand* hands, size_t count, const HandQuery& q,
+                                PositionStats* out) {
+    for (size_t i = 0; i < count; ++i) {
+        if (matches(hands[i], q)) accumulate(hands[i], out);
+    }
+}
+
+// ===== ストア =====
+class Store {
+private:
+    std::string base_path;
+    bool read_only = false;
+    bool sync = true;
+    LogFile hands_file, actions_file, sessions_file;
+
+    // 追加側の状態（append_mutex）
+    mutable std::mutex append_mutex;
+    std::condition_variable wake_writer;
+    std::condition_variable committed_cv;
+    std::deque<std::string> session_names;
+    std::unordered_map<std::string_view, uint32_t> session_ids;
+    std::unordered_map<uint64_t, uint32_t> by_id;
+    std::vector<StoredHand> pending_hands;
+    std::vector<StoredAction> pending_actions;
+    std::string pending_sessions;
+    uint64_t next_index = 0;
+    uint64_t next_action = 0;
+    size_t sessions_bytes = 0;     // 読み込み済み（書き込み済み）のセッション表のバイト数
+    bool stopping = false;
+    bool flush_requested = false;
+    std::string write_error;
+    std::thread writer;
+
+    // 検索側の状態（index_mutex）
+    mutable std::shared_mutex index_mutex;
+    std::atomic<uint64_t> committed{0};
+    uint64_t committed_actions = 0;
+    std::vector<std::vector<uint32_t>> by_session;
+    std::vector<uint32_t> by_position[POSITION_COUNT + 1];
+    std::vector<uint32_t> by_class[CLASS_COUNT + 1];
+    std::vector<uint32_t> by_texture[TEXTURE_COUNT + 1];
+
+    void index_hand(uint32_t index, const StoredHand& h) {
+        if (h.session >= by_session.size()) by_session.resize(h.session + 1);
+        by_session[h.session].push_back(index);
+        by_position[h.position < POSITION_COUNT ? h.position : POSITION_COUNT].push_back(index);
+        by_class[h.hole_class < CLASS_COUNT ? h.hole_class : CLASS_COUNT].push_back(index);
+        by_texture[h.texture < TEXTURE_COUNT ? h.texture : TEXTURE_COUNT].push_back(index);
+    }
+
+    // 登録済みのセッション名に追加する（append_mutex中）
+    uint32_t add_session(std::string_view name) {
+        uint32_t id = static_cast<uint32_t>(session_names.size());
+        session_names.emplace_back(name);
+        session_ids.emplace(session_names.back(), id);
+        return id;
+    }
+
+    // セッション表の未読部分を読む（完全なエントリのみ）
+    bool load_sessions(std::string& error) {
+        size_t total = sessions_file.size() - sizeof(LogHeader);
+        if (total <= sessions_bytes) return true;
+        std::string buffer(total - sessions_bytes, '\0');
+        ssize_t got = pread(sessions_file.descriptor(), buffer.data(), buffer.size(),
+                            static_cast<off_t>(sizeof(LogHeader) + sessions_bytes));
+        if (got != static_cast<ssize_t>(buffer.size())) {
+            error = "cannot read session table";
+            return false;
+        }
+        size_t pos = 0;
+        while (buffer.size() - pos >= sizeof(uint32_t)) {
+            uint32_t len;
+            std::memcpy(&len, buffer.data() + pos, sizeof(len));
+            if (buffer.size() - pos - sizeof(len) < len) break;
+            add_session(std::string_view(buffer).substr(pos + sizeof(len), len));
+            pos += sizeof(len) + len;
+        }
+        sessions_bytes += pos;
+        return true;
+    }
+
+    // ファイルに書かれたハンドを検索対象に加える（開く時と読み取り専用のrefresh）。
+    // アクションやセッションが揃っていない末尾のハンドは書き込み途中とみなして含めない
+    bool scan_files(std::string& error) {
+        std::lock_guard<std::mutex> append_lock(append_mutex);
+        std::unique_lock<std::shared_mutex> lock(index_mutex);
+        if (!load_sessions(error)) return false;
+        uint64_t action_count = (actions_file.size() - sizeof(LogHeader)) / sizeof(StoredAction);
+        uint64_t hand_count = (hands_file.size() - sizeof(LogHeader)) / sizeof(StoredHand);
+        if (!hands_file.map(hand_count * sizeof(StoredHand)) ||
+            !actions_file.map(action_count * sizeof(StoredAction))) {
+            error = "mmap failed";
+            return false;
+        }
+
+        const StoredHand* hands = hands_file.records<StoredHand>();
+        uint64_t n = committed.load();
+        uint64_t actions_end = committed_actions;
+        for (; n < hand_count; ++n) {
+            const StoredHand& h = hands[n];
+            if (h.action_offset + h.action_count > action_count ||
+                h.session >= session_names.size()) {
+                break;
+            }
+            by_id.emplace(h.hand_id, static_cast<uint32_t>(n));
+            index_hand(static_cast<uint32_t>(n), h);
+            actions_end = std::max<uint64_t>(actions_end, h.action_offset + h.action_count);
+        }
+        committed_actions = actions_end;
+        committed.store(n);
+        next_index = n;
+        next_action = actions_end;
+
+        // 書き込み側は中途半端な末尾を切り詰めてから追記を始める
+        if (!read_only &&
+            (!hands_file.truncate(n * sizeof(StoredHand)) ||
+             !actions_file.truncate(actions_end * sizeof(StoredAction)) ||
+             !sessions_file.truncate(sessions_bytes))) {
+            error = "cannot truncate torn tail";
+            return false;
+        }
+        return true;
+    }
+
+    // 書き込みスレッド: 溜まった追加分をまとめて書き、検索対象に加える
+    void writer_loop() {
+        std::vector<StoredHand> hands;
+        std::vector<StoredAction> actions;
+        std::string sessions;
+        std::unique_lock<std::mutex> lock(append_mutex);
+        while (true) {
+            wake_writer.wait_for(lock, COMMIT_INTERVAL, [&] {
+                return stopping || flush_requested || pending_hands.size() >= COMMIT_BATCH;
+            });
+            flush_requested = false;
+            if (pending_hands.empty() && pending_sessions.empty()) {
+                if (stopping) break;
+                continue;
+            }
+            hands.swap(pending_hands);
+            actions.swap(pending_actions);
+            sessions.swap(pending_sessions);
+            lock.unlock();
+
+            bool ok = sessions_file.append(sessions.data(), sessions.size()) &&
+                      actions_file.append(actions.data(), actions.size() * sizeof(StoredAction));
+            if (ok && sync) {
+                ok = fdatasync(sessions_file.descriptor()) == 0 &&
+                     fdatasync(actions_file.descriptor()) == 0;
+            }
+            ok = ok && hands_file.append(hands.data(), hands.size() * sizeof(StoredHand));
+            if (ok && sync) ok = fdatasync(hands_file.descriptor()) == 0;
+
+            if (ok) {
+                std::unique_lock<std::shared_mutex> index_lock(index_mutex);
+                uint64_t first = committed.load();
+                ok = hands_file.map((first + hands.size()) * sizeof(StoredHand)) &&
+                     actions_file.map((committed_actions + actions.size()) * sizeof(StoredAction));
+                if (ok) {
+                    for (size_t i = 0; i < hands.size(); ++i) {
+                        index_hand(static_cast<uint32_t>(first + i), hands[i]);
+                    }
+                    committed_actions += actions.size();
+                    committed.store(first + hands.size());
+                }
+            }
+
+            lock.lock();
+            if (ok) {
+                sessions_bytes += sessions.size();
+            } else if (write_error.empty()) {
+                write_error = "hand store write failed";
+            }
+            hands.clear();
+            actions.clear();
+            sessions.clear();
+            committed_cv.notify_all();
+        }
+    }
+
+    // 索引で候補を絞る。最も候補の少ない索引（の和集合）を選ぶ。索引が使えなければfalse
+    bool candidates(const HandQuery& q, std::vector<uint32_t>& out) const {
+        std::vector<const std::vector<uint32_t>*> best;
+        size_t best_size = SIZE_MAX;
+        auto consider = [&](std::vector<const std::vector<uint32_t>*>& lists) {
+            size_t total = 0;
+            for (const auto* list : lists) total += list->size();
+            if (total < best_size) {
+                best_size = total;
+                best.swap(lists);
+            }
+        };
+
+        std::vector<const std::vector<uint32_t>*> lists;
+        if (q.session >= 0) {
+            static const std::vector<uint32_t> empty;
+            lists.push_back(static_cast<uint64_t>(q.session) < by_session.size()
+                            ? &by_session[q.session] : &empty);
+            consider(lists);
+        }
+        if (q.position_mask != 0) {
+            lists.clear();
+            for (int p = 0; p <= POSITION_COUNT; ++p) {
+                if ((q.position_mask >> p) & 1) lists.push_back(&by_position[p]);
+            }
+            consider(lists);
+        }
+        if (q.texture_mask != 0) {
+            lists.clear();
+            for (int t = 0; t <= TEXTURE_COUNT; ++t) {
+                if ((q.texture_mask >> t) & 1) lists.push_back(&by_texture[t]);
+            }
+            consider(lists);
+        }
+        if ((q.class_mask[0] | q.class_mask[1] | q.class_mask[2]) != 0) {
+            lists.clear();
+            for (int c = 0; c < CLASS_COUNT; ++c) {
+                if ((q.class_mask[c >> 6] >> (c & 63)) & 1) lists.push_back(&by_class[c]);
+            }
+            consider(lists);
+        }
+        if (best_size == SIZE_MAX) return false;
+
+        out.clear();
+        out.reserve(best_size);
+        for (const auto* list : best) out.insert(out.end(), list->begin(), list->end());
+        if (best.size() > 1) std::sort(out.begin(), out.end());
+        return true;
+    }
+
+public:
+    ~Store() {
+        if (writer.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(append_mutex);
+                stopping = true;
+            }
+            wake_writer.notify_all();
+            writer.join();
+        }
+    }
+
+    static std::unique_ptr<Store> open(const std::string& path, bool read_only, bool sync,
+                                       std::string& error) {
+        auto store = std::make_unique<Store>();
+        store->base_path = path;
+        store->read_only = read_only;
+        store->sync = sync;
+        if (!store->sessions_file.open(path + ".sessions", read_only, SESSIONS_MAGIC, 1, error) ||
+            !store->actions_file.open(path + ".actions", read_only, ACTIONS_MAGIC,
+                                      sizeof(StoredAction), error) ||
+            !store->hands_file.open(path + ".hands", read_only, HANDS_MAGIC,
+                                    sizeof(StoredHand), error)) {
+            return nullptr;
+        }
+        if (!read_only && flock(store->hands_file.descriptor(), LOCK_EX | LOCK_NB) != 0) {
+            error = "hand store is open for writing elsewhere: " + path;
+            return nullptr;
+        }
+        if (!store->scan_files(error)) return nullptr;
+        if (!read_only) {
+            // セッション0は既定（名前なし）
+            if (store->session_names.empty()) store->session(std::string_view());
+            store->writer = std::thread([s = store.get()] { s->writer_loop(); });
+        }
+        return store;
+    }
+
+    bool is_read_only() const { return read_only; }
+
+    // 開いたときのパス（拡張子なし。派生ファイルはこれに拡張子を付ける）
+    const std::string& path() const { return base_path; }
+
+    // 未登録なら追加する。読み取り専用では番号を作らず-1を返す
+    // （作った番号は書き込まれず、refreshで読む書き込み側のセッションの番号がずれるため）
+    int64_t session(std::string_view name) {
+        std::lock_guard<std::mutex> lock(append_mutex);
+        auto it = session_ids.find(name);
+        if (it != session_ids.end()) return it->second;
+        if (read_only) return -1;
+        uint32_t len = static_cast<uint32_t>(name.size());
+        pending_sessions.append(reinterpret_cast<const char*>(&len), sizeof(len));
+        pending_sessions.append(name);
+        return add_session(name);
+    }
+
+    // 登録済みのセッション名（dequeの要素なので以後も有効）
+    const std::string* session_name(uint32_t id) const {
+        std::lock_guard<std::mutex> lock(append_mutex);
+        return id < session_names.size() ? &session_names[id] : nullptr;
+    }
+
+    // 追加（書き込みは非同期）。indexにハンド番号を返す。同じhand_idが既にあればfalse
+    bool append(const StoredHand& hand, const StoredAction* actions, size_t action_count,
+                uint64_t& index, std::string& error) {
+        if (read_only) {
+            error = "hand store is read-only";
+            return false;
+        }
+        if (action_count > UINT16_MAX || hand.board_count > 5 ||
+            (hand.position >= POSITION_COUNT && hand.position != UNKNOWN) ||
+            hand.pot_type > POT_4BET || hand.villain > POSITION_COUNT || hand.allin_street > 3) {
+            error = "invalid hand record";
+            return false;
+        }
+        CardMask board = 0;
+        for (int k = 0; k < hand.board_count; ++k) {
+            if (hand.board_cards[k] >= DECK_SIZE) {
+                error = "invalid board card";
+                return false;
+            }
+            board = add_card(board, hand.board_cards[k]);
+        }
+        for (size_t k = 0; k < action_count; ++k) {
+            if (actions[k].street > 3 || actions[k].action > 5) {
+                error = "invalid action record";
+                return false;
+            }
+        }
+
+        StoredHand rec = hand;
+        rec.hole &= (CardMask(1) << DECK_SIZE) - 1;
+        rec.board = board;
+        rec.hole_class = hole_class(rec.hole);
+        rec.texture = flop_texture(rec.board_cards, rec.board_count);
+        rec.action_count = static_cast<uint16_t>(action_count);
+        if (rec.board_count < 3) rec.flop_players = 0;
+        std::memset(rec.reserved, 0, sizeof(rec.reserved));
+        if (rec.timestamp == 0) rec.timestamp = static_cast<int64_t>(std::time(nullptr));
+
+        std::lock_guard<std::mutex> lock(append_mutex);
+        if (!write_error.empty()) {
+            error = write_error;
+            return false;
+        }
+        if (rec.session >= session_names.size()) {
+            error = "unknown session";
+            return false;
+        }
+        if (rec.hand_id != 0) {
+            auto it = by_id.find(rec.hand_id);
+            if (it != by_id.end()) {
+                index = it->second;
+                return false;
+            }
+        } else {
+            rec.hand_id = LOCAL_ID_BIT | next_index;
+        }
+        if (next_index >= UINT32_MAX) {
+            error = "hand store is full";
+            return false;
+        }
+        index = next_index++;
+        rec.action_offset = next_action;
+        next_action += action_count;
+        by_id.emplace(rec.hand_id, static_cast<uint32_t>(index));
+        pending_hands.push_back(rec);
+        pending_actions.insert(pending_actions.end(), actions, actions + action_count);
+        if (pending_hands.size() >= COMMIT_BATCH) wake_writer.notify_one();
+        return true;
+    }
+
+    // ここまでに追加した全ハンドの書き込みを待つ
+    bool flush(std::string& error) {
+        std::unique_lock<std::mutex> lock(append_mutex);
+        if (read_only) return true;
+        uint64_t target = next_index;
+        flush_requested = true;
+        wake_writer.notify_one();
+        committed_cv.wait(lock, [&] {
+            return committed.load() >= target || !write_error.empty();
+        });
+        if (!write_error.empty()) {
+            error = write_error;
+            return false;
+        }
+        return true;
+    }
+
+    // 読み取り専用: 他プロセスが追記した分を取り込む
+    bool refresh(std::string& error) {
+        return !read_only || scan_files(error);
+    }
+
+    uint64_t size() const { return committed.load(); }
+
+    // 検索可能な全レコードを共有ロック中に参照する: f(records, count)
+    template <class F>
+    void read(F&& f) const {
+        std::shared_lock<std::shared_mutex> lock(index_mutex);
+        f(hands_file.records<StoredHand>(), committed.load());
+    }
+
+    int64_t find_session(std::string_view name) const {
+        std::lock_guard<std::mutex> lock(append_mutex);
+        auto it = session_ids.find(name);
+        return it != session_ids.end() ? it->second : -1;
+    }
+
+    int64_t find(uint64_t hand_id) const {
+        std::lock_guard<std::mutex> lock(append_mutex);
+        auto it = by_id.find(hand_id);
+        if (it == by_id.end() || it->second >= committed.load()) return -1;
+        return it->second;
+    }
+
+    // アクション数を返す（範囲外は-1）。actionsにはcapacity件まで書く
+    int get(uint64_t index, StoredHand& out, StoredAction* actions, size_t capacity) const {
+        std::shared_lock<std::shared_mutex> lock(index_mutex);
+        if (index >= committed.load()) return -1;
+        out = hands_file.records<StoredHand>()[index];
+        size_t n = std::min<size_t>(out.action_count, capacity);
+        if (n > 0) {
+            std::memcpy(actions, actions_file.records<StoredAction>() + out.action_offset,
+                        n * sizeof(StoredAction));
+        }
+        return out.action_count;
+    }
+
+    // 条件に合うハンド番号（昇順）。outにはcapacity件まで、戻り値は総数
+    uint64_t query(const HandQuery& q, uint32_t* out, size_t capacity) const {
+        std::shared_lock<std::shared_mutex> lock(index_mutex);
+        const StoredHand* hands = hands_file.records<StoredHand>();
+        uint64_t count = committed.load();
+        uint64_t total = 0;
+        auto emit = [&](uint32_t index) {
+            if (total < capacity) out[total] = index;
+            ++total;
+        };
+        std::vector<uint32_t> ids;
+        if (candidates(q, ids)) {
+            for (uint32_t index : ids) {
+                if (index < count && matches(hands[index], q)) emit(index);
+            }
+        } else {
+            for (uint64_t i = 0; i < count; ++i) {
+                if (matches(hands[i], q)) emit(static_cast<uint32_t>(i));
+            }
+        }
+        return total;
+    }
+
+    // ポジション別の件数・勝ち数・収支・平均エクイティ用の合計（out[7]）
+    void position_stats(const HandQuery& q, PositionStats* out) const {
+        std::fill(out, out + POSITION_COUNT + 1, PositionStats{});
+        std::shared_lock<std::shared_mutex> lock(index_mutex);
+        const StoredHand* hands = hands_file.records<StoredHand>();
+        uint64_t count = committed.load();
+        std::vector<uint32_t> ids;
+        if (!candidates(q, ids)) {
+            scan_position_stats(hands, count, q, out);
+            return;
+        }
+        for (uint32_t index : ids) {
+            if (index < count && matches(hands[index], q)) accumulate(hands[index], out);
+        }
+    }
+};
+
+} // namespace HandStore
+
+extern "C" {
+    using namespace HandStore;
+
+    void* hand_store_open(const char* path, int read_only, int sync) {
+        std::string error;
+        auto store = Store::open(path, read_only != 0, sync != 0, error);
+        if (!store) {
+            std::fprintf(stderr, "hand_store_open: %s\n", error.c_str());
+            return nullptr;
+        }
+        return store.release();
+    }
+
+    void hand_store_close(void* handle) {
+        delete static_cast<Store*>(handle);
+    }
+
+    int64_t hand_store_session(void* handle, const char* name) {
+        return static_cast<Store*>(handle)->session(name);
+    }
+
+    const char* hand_store_session_name(void* handle, uint32_t session) {
+        const std::string* name = static_cast<Store*>(handle)->session_name(session);
+        return name != nullptr ? name->c_str() : nullptr;
+    }
+
+    int64_t hand_store_append(void* handle, const PokerStoredHand* hand,
+                              const PokerStoredAction* actions, int action_count) {
+        std::string error;
+        uint64_t index = 0;
+        Store* store = static_cast<Store*>(handle);
+        if (action_count < 0 ||
+            (!store->append(*hand, actions, static_cast<size_t>(action_count), index, error) &&
+             !error.empty())) {
+            std::fprintf(stderr, "hand_store_append: %s\n",
+                         error.empty() ? "invalid action count" : error.c_str());
+            return -1;
+        }
+        return static_cast<int64_t>(index);
+    }
+
+    int hand_store_flush(void* handle) {
+        std::string error;
+        if (!static_cast<Store*>(handle)->flush(error)) {
+            std::fprintf(stderr, "hand_store_flush: %s\n", error.c_str());
+            return -1;
+        }
+        return 0;
+    }
+
+    int64_t hand_store_refresh(void* handle) {
+        std::string error;
+        Store* store = static_cast<Store*>(handle);
+        if (!store->refresh(error)) {
+            std::fprintf(stderr, "hand_store_refresh: %s\n", error.c_str());
+            return -1;
+        }
+        return static_cast<int64_t>(store->size());
+    }
+
+    uint64_t hand_store_count(void* handle) {
+        return static_cast<Store*>(handle)->size();
+    }
+
+    int64_t hand_store_find(void* handle, uint64_t hand_id) {
+        return static_cast<Store*>(handle)->find(hand_id);
+    }
+
+    int hand_store_get(void* handle, uint64_t index, PokerStoredHand* out,
+                       PokerStoredAction* actions, int capacity) {
+        return static_cast<Store*>(handle)->get(index, *out, actions,
+                                                static_cast<size_t>(std::max(capacity, 0)));
+    }
+
+    int64_t hand_store_query(void* handle, const PokerHandQuery* query, uint32_t* out,
+                             int64_t capacity) {
+        return static_cast<int64_t>(static_cast<Store*>(handle)->query(
+            *query, out, static_cast<size_t>(std::max<int64_t>(capacity, 0))));
+    }
+
+    void hand_store_position_stats(void* handle, const PokerHandQuery* query,
+                                   PokerPositionStats* out) {
+        static_cast<Store*>(handle)->position_stats(*query, out);
+    }
+}
+
+#endif // POKER_STEP52_HAND_STORE_CPP
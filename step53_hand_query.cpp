@@ -0,0 +1,846 @@
+// step53_hand_query.cpp
+// ハンドストア(step52)のビットマップ索引と条件式による検索
+// ハンドごとの属性（ポジション、相手のポジション、ポットの種類、169クラス、フロップの特徴、
+// フロップでのヒーローの役・ドロー、結果、フロップの人数、セッション）を値ごとの
+// 圧縮ビットマップ（roaring形式: 上位16ビットごとのコンテナを配列かビット列で持つ）にする。
+// 条件式
+//   position=BTN & villain=BB & pot=srp & flop=monotone & draw=flush
+//   (hole="QQ+, AKs" | made=set) & !result=won & pot_size>=20
+// はビットマップの積・和・差として評価する（数値の比較だけはレコードを走査する）。
+// 索引はストアの追加に合わせて差分だけ追記する（ハンド番号は昇順なので末尾への追加のみ）。
+#ifndef POKER_STEP53_HAND_QUERY_CPP
+#define POKER_STEP53_HAND_QUERY_CPP
+
+#include "poker_engine.h"
+#include "step46_range_parser.cpp"
+#include "step48_board_features.cpp"
+#include "step49_outs.cpp"
+#include "step52_hand_store.cpp"
+#include <algorithm>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace HandQueryEngine {
+
+using namespace PokerCore;
+using HandStore::StoredHand;
+using HandStore::Store;
+using QueryGroup = PokerQueryGroup;
+
+// ===== 圧縮ビットマップ =====
+
+constexpr uint32_t ARRAY_LIMIT = 4096;          // これを超えるコンテナはビット列にする
+constexpr size_t CONTAINER_WORDS = 65536 / 64;
+
+POKER_HOT_KERNEL
+static uint32_t words_and(const uint64_t* a, const uint64_t* b, uint64_t* out) {
+    uint32_t card = 0;
+    for (size_t i = 0; i < CONTAINER_WORDS; ++i) {
+        out[i] = a[i] & b[i];
+        card += static_cast<uint32_t>(__builtin_popcountll(out[i]));
+    }
+    return card;
+}
+
+POKER_HOT_KERNEL
+static uint32_t words_or(const uint64_t* a, const uint64_t* b, uint64_t* out) {
+    uint32_t card = 0;
+    for (size_t i = 0; i < CONTAINER_WORDS; ++i) {
+        out[i] = a[i] | b[i];
+        card += static_cast<uint32_t>(__builtin_popcountll(out[i]));
+    }
+    return card;
+}
+
+POKER_HOT_KERNEL
+static uint32_t words_andnot(const uint64_t* a, const uint64_t* b, uint64_t* out) {
+    uint32_t card = 0;
+    for (size_t i = 0; i < CONTAINER_WORDS; ++i) {
+        out[i] = a[i] & ~b[i];
+        card += static_cast<uint32_t>(__builtin_popcountll(out[i]));
+    }
+    return card;
+}
+
+// 上位16ビットが同じ値の集合。cardinality <= ARRAY_LIMIT なら昇順配列、超えればビット列
+struct Container {
+    uint16_t key = 0;
+    uint32_t cardinality = 0;
+    std::vector<uint16_t> values;
+    std::vector<uint64_t> words;
+
+    bool is_bitmap() const { return !words.empty(); }
+
+    bool contains(uint16_t low) const {
+        if (is_bitmap()) return (words[low >> 6] >> (low & 63)) & 1;
+        return std::binary_search(values.begin(), values.end(), low);
+    }
+
+    void to_bitmap() {
+        words.assign(CONTAINER_WORDS, 0);
+        for (uint16_t v : values) words[v >> 6] |= uint64_t(1) << (v & 63);
+        values.clear();
+        values.shrink_to_fit();
+    }
+
+    // 要素数が少なくなったビット列を配列に戻す
+    void normalize() {
+        if (!is_bitmap() || cardinality > ARRAY_LIMIT) return;
+        values.clear();
+        values.reserve(cardinality);
+        for (size_t i = 0; i < CONTAINER_WORDS; ++i) {
+            for (uint64_t w = words[i]; w != 0; w &= w - 1) {
+                values.push_back(static_cast<uint16_t>(i * 64 + __builtin_ctzll(w)));
+            }
+        }
+        words.clear();
+        words.shrink_to_fit();
+    }
+
+    size_t bytes() const {
+        return sizeof(Container) + values.capacity() * sizeof(uint16_t) +
+               words.capacity() * sizeof(uint64_t);
+    }
+};
+
+class Bitmap {
+private:
+    std::vector<Container> containers;   // keyの昇順
+
+    enum class Op { AND, OR, ANDNOT };
+
+    // 2つのコンテナの演算（aかbはビット列かもしれない）
+    static Container combine(const Container& a, const Container& b, Op op) {
+        Container out;
+        out.key = a.key;
+        if (a.is_bitmap() && b.is_bitmap()) {
+            out.words.resize(CONTAINER_WORDS);
+            out.cardinality = op == Op::AND ? words_and(a.words.data(), b.words.data(), out.words.data())
+                            : op == Op::OR ? words_or(a.words.data(), b.words.data(), out.words.data())
+                            : words_andnot(a.words.data(), b.words.data(), out.words.data());
+            out.normalize();
+            return out;
+        }
+        if (op == Op::OR) {
+            if (a.is_bitmap() || b.is_bitmap()) {
+                const Container& bits = a.is_bitmap() ? a : b;
+                const Container& list = a.is_bitmap() ? b : a;
+                out.words = bits.words;
+                out.cardinality = bits.cardinality;
+                for (uint16_t v : list.values) {
+                    uint64_t& w = out.words[v >> 6];
+                    uint64_t bit = uint64_t(1) << (v & 63);
+                    out.cardinality += (w & bit) == 0;
+                    w |= bit;
+                }
+                return out;
+            }
+            std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                           std::back_inserter(out.values));
+            out.cardinality = static_cast<uint32_t>(out.values.size());
+            if (out.cardinality > ARRAY_LIMIT) out.to_bitmap();
+            return out;
+        }
+        // AND / ANDNOT: 結果はaの部分集合
+        if (!a.is_bitmap()) {
+            for (uint16_t v : a.values) {
+                if (b.contains(v) == (op == Op::AND)) out.values.push_back(v);
+            }
+            out.cardinality = static_cast<uint32_t>(out.values.size());
+            return out;
+        }
+        // aがビット列、bが配列
+        if (op == Op::AND) {
+            for (uint16_t v : b.values) {
+                if (a.contains(v)) out.values.push_back(v);
+            }
+            out.cardinality = static_cast<uint32_t>(out.values.size());
+            return out;
+        }
+        out.words = a.words;
+        out.cardinality = a.cardinality;
+        for (uint16_t v : b.values) {
+            uint64_t& w = out.words[v >> 6];
+            uint64_t bit = uint64_t(1) << (v & 63);
+            out.cardinality -= (w & bit) != 0;
+            w &= ~bit;
+        }
+        out.normalize();
+        return out;
+    }
+
+    static Bitmap apply(const Bitmap& a, const Bitmap& b, Op op) {
+        Bitmap out;
+        size_t i = 0, j = 0;
+        while (i < a.containers.size() || j < b.containers.size()) {
+            bool has_a = i < a.containers.size();
+            bool has_b = j < b.containers.size();
+            if (has_a && (!has_b || a.containers[i].key < b.containers[j].key)) {
+                if (op != Op::AND) out.containers.push_back(a.containers[i]);
+                ++i;
+            } else if (has_b && (!has_a || b.containers[j].key < a.containers[i].key)) {
+                if (op == Op::OR) out.containers.push_back(b.containers[j]);
+                ++j;
+            } else {
+                Container c = combine(a.containers[i], b.containers[j], op);
+                if (c.cardinality > 0) out.containers.push_back(std::move(c));
+                ++i;
+                ++j;
+            }
+        }
+        return out;
+    }
+
+public:
+    // 末尾への追加（xは既存の全要素より大きいこと）
+    void push_back(uint32_t x) {
+        uint16_t key = static_cast<uint16_t>(x >> 16);
+        uint16_t low = static_cast<uint16_t>(x & 0xFFFF);
+        if (containers.empty() || containers.back().key != key) {
+            containers.emplace_back();
+            containers.back().key = key;
+        }
+        Container& c = containers.back();
+        if (c.is_bitmap()) {
+            c.words[low >> 6] |= uint64_t(1) << (low & 63);
+        } else {
+            c.values.push_back(low);
+            if (c.values.size() > ARRAY_LIMIT) c.to_bitmap();
+        }
+        ++c.cardinality;
+    }
+
+    // [0, n) 全体
+    static Bitmap range(uint32_t n) {
+        Bitmap out;
+        for (uint32_t base = 0; base < n; base += 65536) {
+            Container c;
+            c.key = static_cast<uint16_t>(base >> 16);
+            c.cardinality = std::min<uint32_t>(n - base, 65536);
+            c.words.assign(CONTAINER_WORDS, 0);
+            for (uint32_t k = 0; k < c.cardinality / 64; ++k) c.words[k] = ~uint64_t(0);
+            if (c.cardinality % 64 != 0) {
+                c.words[c.cardinality / 64] = (uint64_t(1) << (c.cardinality % 64)) - 1;
+            }
+            c.normalize();
+            out.containers.push_back(std::move(c));
+        }
+        return out;
+    }
+
+    friend Bitmap operator&(const Bitmap& a, const Bitmap& b) { return apply(a, b, Op::AND); }
+    friend Bitmap operator|(const Bitmap& a, const Bitmap& b) { return apply(a, b, Op::OR); }
+    friend Bitmap operator-(const Bitmap& a, const Bitmap& b) { return apply(a, b, Op::ANDNOT); }
+
+    uint64_t cardinality() const {
+        uint64_t n = 0;
+        for (const Container& c : containers) n += c.cardinality;
+        return n;
+    }
+
+    size_t bytes() const {
+        size_t n = sizeof(Bitmap);
+        for (const Container& c : containers) n += c.bytes();
+        return n;
+    }
+
+    // 昇順に f(x)
+    template <class F>
+    void for_each(F&& f) const {
+        for (const Container& c : containers) {
+            uint32_t base = uint32_t(c.key) << 16;
+            if (c.is_bitmap()) {
+                for (size_t i = 0; i < CONTAINER_WORDS; ++i) {
+                    for (uint64_t w = c.words[i]; w != 0; w &= w - 1) {
+                        f(base + static_cast<uint32_t>(i * 64 + __builtin_ctzll(w)));
+                    }
+                }
+            } else {
+                for (uint16_t v : c.values) f(base + v);
+            }
+        }
+    }
+};
+
+// ===== ハンドの属性 =====
+
+constexpr int POSITIONS = HandStore::POSITION_COUNT + 1;   // 6 = 不明
+constexpr int POT_TYPES = HandStore::POT_4BET + 1;          // 0 = 不明
+constexpr int CLASSES = HandStore::CLASS_COUNT + 1;         // 169 = 不明
+constexpr int CATEGORIES = OutsEngine::OUT_CATEGORY_COUNT;  // 0 = 役なし（ボードのみ）
+
+enum FlopFlag : int {
+    FLOP_NONE = 0, FLOP_RAINBOW, FLOP_TWO_TONE, FLOP_MONOTONE, FLOP_PAIRED, FLOP_CONNECTED,
+    FLOP_DRY, FLOP_SEMI_WET, FLOP_WET, FLOP_ULTRA_WET, FLOP_FLAG_COUNT
+};
+
+enum DrawFlag : int { DRAW_FLUSH = 0, DRAW_OESD, DRAW_GUTSHOT, DRAW_FLAG_COUNT };
+
+enum ResultFlag : int { RESULT_WON = 0, RESULT_LOST, RESULT_SHOWDOWN, RESULT_FLAG_COUNT };
+
+enum PlayersFlag : int { PLAYERS_HEADS_UP = 0, PLAYERS_MULTIWAY, PLAYERS_FLAG_COUNT };
+
+// 集計の軸（C ABIのgroup_by）
+enum GroupBy : int {
+    GROUP_NONE = 0, GROUP_POSITION, GROUP_VILLAIN, GROUP_POT_TYPE, GROUP_HOLE_CLASS,
+    GROUP_FLOP_TEXTURE, GROUP_MADE_HAND, GROUP_COUNT
+};
+
+inline bool has_straight(uint16_t ranks) {
+    uint32_t r = (uint32_t(ranks) << 1) | ((ranks >> RANK_A) & 1);   // A-5用にAを複製
+    return (r & (r >> 1) & (r >> 2) & (r >> 3) & (r >> 4)) != 0;
+}
+
+// フロップ時点のヒーローの状態
+struct FlopState {
+    int made = 0;        // ホールカードが関与する役のカテゴリ（0 = ボードの役のみ）
+    bool flush_draw = false;
+    int straight_outs = 0;   // ストレートを完成させるランクの数
+};
+
+inline FlopState flop_state(CardMask hole, CardMask flop) {
+    FlopState st;
+    SuitMajorMask board = to_suit_major(flop);
+    SuitMajorMask hand = board | to_suit_major(hole);
+    int board_category = OutsEngine::hand_category(board);
+    int hero_category = OutsEngine::hand_category(hand);
+    if (hero_category > board_category) st.made = hero_category;
+    if (hero_category >= PokerEval::RANK_FLUSH) return st;
+
+    SuitMajorMask hole_sm = to_suit_major(hole);
+    for (int s = 0; s < SUIT_COUNT; ++s) {
+        if (__builtin_popcount(suit_ranks(hand, s)) == 4 && suit_ranks(hole_sm, s) != 0) {
+            st.flush_draw = true;
+        }
+    }
+    if (hero_category < PokerEval::RANK_STRAIGHT) {
+        uint16_t ranks = rank_set(hand);
+        uint16_t board_ranks = rank_set(board);
+        for (int r = 0; r < RANK_COUNT; ++r) {
+            uint16_t bit = uint16_t(1u << r);
+            if (ranks & bit) continue;
+            if (has_straight(ranks | bit) && !has_straight(board_ranks | bit)) ++st.straight_outs;
+        }
+    }
+    return st;
+}
+
+// 集計軸ごとの値（値の数はgroup_sizeと一致）
+inline int group_value(const StoredHand& h, int group_by, int made) {
+    switch (group_by) {
+    case GROUP_POSITION: return h.position < HandStore::POSITION_COUNT ? h.position : POSITIONS - 1;
+    case GROUP_VILLAIN: return h.villain > 0 ? h.villain - 1 : POSITIONS - 1;
+    case GROUP_POT_TYPE: return h.pot_type;
+    case GROUP_HOLE_CLASS: return h.hole_class < HandStore::CLASS_COUNT ? h.hole_class : CLASSES - 1;
+    case GROUP_FLOP_TEXTURE: return h.texture < HandStore::TEXTURE_COUNT ? h.texture : HandStore::TEXTURE_COUNT;
+    case GROUP_MADE_HAND: return made;
+    default: return 0;
+    }
+}
+
+inline int group_size(int group_by) {
+    switch (group_by) {
+    case GROUP_POSITION: case GROUP_VILLAIN: return POSITIONS;
+    case GROUP_POT_TYPE: return POT_TYPES;
+    case GROUP_HOLE_CLASS: return CLASSES;
+    case GROUP_FLOP_TEXTURE: return HandStore::TEXTURE_COUNT + 1;
+    case GROUP_MADE_HAND: return CATEGORIES;
+    default: return 1;
+    }
+}
+
+// ===== 条件式 =====
+//   expr   := term ('|' term)*
+//   term   := factor ('&' factor)*
+//   factor := '!' factor | '(' expr ')' | field ('=' | '!=') value (',' value)*
+//           | numeric ('<' | '<=' | '>' | '>=' | '=') number
+//   value  := 名前 | "引用符付き文字列"（hole=にはレンジ文字列を書ける）
+// '&' '|' '!' の代わりに and / or / not も使える。
+class Index;
+
+struct Node {
+    enum Kind { LEAF, NUMERIC, NOT, AND, OR } kind = LEAF;
+    Bitmap bits;                          // LEAF
+    int field = 0;                        // NUMERIC: 0=pot, 1=profit, 2=equity, 3=timestamp
+    int op = 0;                           // NUMERIC: 0:<, 1:<=, 2:>, 3:>=, 4:=
+    double number = 0.0;
+    std::unique_ptr<Node> left, right;
+};
+
+// ===== 索引 =====
+class Index {
+private:
+    const Store& store;
+    mutable std::shared_mutex mutex;
+    uint64_t indexed = 0;
+
+    Bitmap by_position[POSITIONS];
+    Bitmap by_villain[POSITIONS];
+    Bitmap by_pot_type[POT_TYPES];
+    Bitmap by_class[CLASSES];
+    Bitmap by_flop[FLOP_FLAG_COUNT];
+    Bitmap by_made[CATEGORIES];
+    Bitmap by_draw[DRAW_FLAG_COUNT];
+    Bitmap by_result[RESULT_FLAG_COUNT];
+    Bitmap by_players[PLAYERS_FLAG_COUNT];
+    std::vector<Bitmap> by_session;
+    std::vector<uint8_t> made_hand;       // ハンド番号 -> フロップでの役（集計用）
+
+    void add(uint32_t i, const StoredHand& h) {
+        by_position[h.position < HandStore::POSITION_COUNT ? h.position : POSITIONS - 1].push_back(i);
+        by_villain[h.villain > 0 && h.villain <= HandStore::POSITION_COUNT ? h.villain - 1
+                                                                            : POSITIONS - 1].push_back(i);
+        by_pot_type[h.pot_type < POT_TYPES ? h.pot_type : 0].push_back(i);
+        by_class[h.hole_class < HandStore::CLASS_COUNT ? h.hole_class : CLASSES - 1].push_back(i);
+        if (h.session >= by_session.size()) by_session.resize(h.session + 1);
+        by_session[h.session].push_back(i);
+
+        if (h.flags & HandStore::FLAG_WON) by_result[RESULT_WON].push_back(i);
+        if (h.profit < 0) by_result[RESULT_LOST].push_back(i);
+        if (h.flags & HandStore::FLAG_SHOWDOWN) by_result[RESULT_SHOWDOWN].push_back(i);
+        if (h.flop_players == 2) by_players[PLAYERS_HEADS_UP].push_back(i);
+        if (h.flop_players > 2) by_players[PLAYERS_MULTIWAY].push_back(i);
+
+        int made = 0;
+        if (h.board_count < 3) {
+            by_flop[FLOP_NONE].push_back(i);
+        } else {
+            CardMask flop = card_to_mask(h.board_cards[0]) | card_to_mask(h.board_cards[1]) |
+                            card_to_mask(h.board_cards[2]);
+            BoardFeatureEngine::BoardFeatures f =
+                BoardFeatureEngine::BoardFeatureTable::instance().lookup(flop);
+            by_flop[FLOP_RAINBOW + f.flush_class].push_back(i);
+            if (f.paired) by_flop[FLOP_PAIRED].push_back(i);
+            if (f.straight_class == BoardFeatureEngine::STRAIGHT_POSSIBLE) {
+                by_flop[FLOP_CONNECTED].push_back(i);
+            }
+            by_flop[FLOP_DRY + f.texture].push_back(i);
+
+            if (count_cards(h.hole) == 2) {
+                FlopState st = flop_state(h.hole, flop);
+                made = st.made;
+                if (st.flush_draw) by_draw[DRAW_FLUSH].push_back(i);
+                if (st.straight_outs >= 2) by_draw[DRAW_OESD].push_back(i);
+                if (st.straight_outs == 1) by_draw[DRAW_GUTSHOT].push_back(i);
+            }
+        }
+        by_made[made].push_back(i);
+        made_hand.push_back(static_cast<uint8_t>(made));
+    }
+
+    // ===== 条件式の解析 =====
+    struct Parser {
+        const Index& index;
+        std::string_view text;
+        size_t pos = 0;
+        std::string error;
+
+        void skip_space() {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+        }
+
+        static bool word_char(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '_' || c == '+' || c == '-' || c == '.';
+        }
+
+        std::string_view word() {
+            skip_space();
+            size_t start = pos;
+            while (pos < text.size() && word_char(text[pos])) ++pos;
+            return text.substr(start, pos - start);
+        }
+
+        // 次が記号symbolかキーワードkeywordなら読み進める
+        bool accept(char symbol, std::string_view keyword) {
+            skip_space();
+            if (pos < text.size() && text[pos] == symbol) {
+                ++pos;
+                if (symbol == '&' || symbol == '|') {
+                    if (pos < text.size() && text[pos] == symbol) ++pos;   // && ||
+                }
+                return true;
+            }
+            size_t save = pos;
+            if (!keyword.empty() && word() == keyword) return true;
+            pos = save;
+            return false;
+        }
+
+        bool fail(const std::string& message) {
+            if (error.empty()) error = message + " at " + std::to_string(pos);
+            return false;
+        }
+
+        std::unique_ptr<Node> expr() {
+            auto node = term();
+            while (node && accept('|', "or")) {
+                auto rhs = term();
+                if (!rhs) return nullptr;
+                node = binary(Node::OR, std::move(node), std::move(rhs));
+            }
+            return node;
+        }
+
+        std::unique_ptr<Node> term() {
+            auto node = factor();
+            while (node && accept('&', "and")) {
+                auto rhs = factor();
+                if (!rhs) return nullptr;
+                node = binary(Node::AND, std::move(node), std::move(rhs));
+            }
+            return node;
+        }
+
+        static std::unique_ptr<Node> binary(Node::Kind kind, std::unique_ptr<Node> a,
+                                            std::unique_ptr<Node> b) {
+            auto node = std::make_unique<Node>();
+            node->kind = kind;
+            node->left = std::move(a);
+            node->right = std::move(b);
+            return node;
+        }
+
+        std::unique_ptr<Node> factor() {
+            if (accept('!', "not")) {
+                auto inner = factor();
+                if (!inner) return nullptr;
+                auto node = std::make_unique<Node>();
+                node->kind = Node::NOT;
+                node->left = std::move(inner);
+                return node;
+            }
+            if (accept('(', "")) {
+                auto node = expr();
+                if (!node) return nullptr;
+                if (!accept(')', "")) {
+                    fail("expected ')'");
+                    return nullptr;
+                }
+                return node;
+            }
+            return predicate();
+        }
+
+        // 値1つ（引用符付きなら中身をそのまま）
+        bool value(std::string& out) {
+            skip_space();
+            if (pos < text.size() && text[pos] == '"') {
+                size_t end = text.find('"', pos + 1);
+                if (end == std::string_view::npos) return fail("unterminated string");
+                out.assign(text.substr(pos + 1, end - pos - 1));
+                pos = end + 1;
+                return true;
+            }
+            out.assign(word());
+            return !out.empty() || fail("expected value");
+        }
+
+        std::unique_ptr<Node> predicate() {
+            std::string_view field = word();
+            if (field.empty()) {
+                fail("expected condition");
+                return nullptr;
+            }
+            skip_space();
+
+            static constexpr std::string_view NUMERIC_FIELDS[] = {"pot_size", "profit", "equity", "time"};
+            for (int k = 0; k < 4; ++k) {
+                if (field != NUMERIC_FIELDS[k]) continue;
+                auto node = std::make_unique<Node>();
+                node->kind = Node::NUMERIC;
+                node->field = k;
+                if (text.substr(pos, 2) == "<=") { node->op = 1; pos += 2; }
+                else if (text.substr(pos, 2) == ">=") { node->op = 3; pos += 2; }
+                else if (text.substr(pos, 1) == "<") { node->op = 0; pos += 1; }
+                else if (text.substr(pos, 1) == ">") { node->op = 2; pos += 1; }
+                else if (text.substr(pos, 1) == "=") { node->op = 4; pos += 1; }
+                else {
+                    fail("expected comparison");
+                    return nullptr;
+                }
+                std::string number(word());
+                char* end = nullptr;
+                node->number = std::strtod(number.c_str(), &end);
+                if (number.empty() || *end != '\0') {
+                    fail("expected number");
+                    return nullptr;
+                }
+                return node;
+            }
+
+            bool negate = false;
+            if (text.substr(pos, 2) == "!=") {
+                negate = true;
+                pos += 2;
+            } else if (text.substr(pos, 1) == "=") {
+                pos += 1;
+            } else {
+                fail("expected '='");
+                return nullptr;
+            }
+
+            auto node = std::make_unique<Node>();
+            std::string v;
+            do {
+                if (!value(v)) return nullptr;
+                const Bitmap* bits = nullptr;
+                Bitmap owned;
+                if (!index.lookup(field, v, bits, owned, error)) {
+                    fail("");
+                    return nullptr;
+                }
+                node->bits = node->bits | (bits != nullptr ? *bits : owned);
+            } while (accept(',', ""));
+
+            if (!negate) return node;
+            auto inverted = std::make_unique<Node>();
+            inverted->kind = Node::NOT;
+            inverted->left = std::move(node);
+            return inverted;
+        }
+    };
+
+    // field=value のビットマップ。固定の索引ならbitsに、組み立てたものはownedに返す
+    bool lookup(std::string_view field, const std::string& value, const Bitmap*& bits,
+                Bitmap& owned, std::string& error) const {
+        auto pick = [&](const Bitmap* table, std::initializer_list<std::string_view> names) {
+            int k = 0;
+            for (std::string_view name : names) {
+                if (value == name) {
+                    bits = &table[k];
+                    return true;
+                }
+                ++k;
+            }
+            error = "unknown value '" + value + "' for " + std::string(field);
+            return false;
+        };
+
+        if (field == "position") return pick(by_position, {"UTG", "MP", "CO", "BTN", "SB", "BB", "unknown"});
+        if (field == "villain") return pick(by_villain, {"UTG", "MP", "CO", "BTN", "SB", "BB", "unknown"});
+        if (field == "pot") return pick(by_pot_type, {"unknown", "limped", "srp", "3bet", "4bet"});
+        if (field == "flop") {
+            return pick(by_flop, {"none", "rainbow", "twotone", "monotone", "paired", "connected",
+                                  "dry", "semiwet", "wet", "ultrawet"});
+        }
+        if (field == "made") {
+            return pick(by_made, {"nothing", "pair", "two_pair", "trips", "straight", "flush",
+                                  "full_house", "quads", "straight_flush"});
+        }
+        if (field == "draw") return pick(by_draw, {"flush", "oesd", "gutshot"});
+        if (field == "result") return pick(by_result, {"won", "lost", "showdown"});
+        if (field == "players") return pick(by_players, {"hu", "multiway"});
+        if (field == "session") {
+            int64_t id = store.find_session(value);
+            if (id < 0 || static_cast<size_t>(id) >= by_session.size()) {
+                bits = &owned;   // 該当なし
+                return true;
+            }
+            bits = &by_session[id];
+            return true;
+        }
+        if (field == "hole") {
+            // レンジ文字列 → 重みが正のコンボを含む169クラス
+            std::string range_error;
+            auto weights = RangeParser::RangeCache::instance().get(value, range_error);
+            if (!weights) {
+                error = "invalid range '" + value + "': " + range_error;
+                return false;
+            }
+            bool seen[HandStore::CLASS_COUNT] = {};
+            for (int i = 0; i < RangeParser::COMBO_COUNT; ++i) {
+                if ((*weights)[i] > 0.0f) seen[RangeEngine::COMBO_CLASS[i]] = true;
+            }
+            for (int c = 0; c < HandStore::CLASS_COUNT; ++c) {
+                if (seen[c]) owned = owned | by_class[c];
+            }
+            return true;
+        }
+        error = "unknown field '" + std::string(field) + "'";
+        return false;
+    }
+
+    static bool compare(double lhs, int op, double rhs) {
+        switch (op) {
+        case 0: return lhs < rhs;
+        case 1: return lhs <= rhs;
+        case 2: return lhs > rhs;
+        case 3: return lhs >= rhs;
+        default: return lhs == rhs;
+        }
+    }
+
+    // 数値条件: universeの範囲でレコードを走査する（金額は通貨単位で比較）
+    Bitmap numeric(const Node& node, const Bitmap& universe) const {
+        Bitmap out;
+        store.read([&](const StoredHand* hands, uint64_t count) {
+            universe.for_each([&](uint32_t i) {
+                if (i >= count) return;
+                const StoredHand& h = hands[i];
+                double v = node.field == 0 ? h.pot / 100.0
+                         : node.field == 1 ? h.profit / 100.0
+                         : node.field == 2 ? double(h.equity) : double(h.timestamp);
+                if (compare(v, node.op, node.number)) out.push_back(i);
+            });
+        });
+        return out;
+    }
+
+    // universe: ここまでの条件で残っている集合（数値条件の走査範囲を狭めるため）
+    Bitmap evaluate(const Node& node, const Bitmap& universe) const {
+        switch (node.kind) {
+        case Node::LEAF: return node.bits & universe;
+        case Node::NUMERIC: return numeric(node, universe);
+        case Node::NOT: return universe - evaluate(*node.left, universe);
+        case Node::AND: {
+            // 索引だけで決まる側を先に評価し、その結果で他方の走査範囲を絞る
+            const Node* first = node.left.get();
+            const Node* second = node.right.get();
+            if (first->kind == Node::NUMERIC) std::swap(first, second);
+            Bitmap lhs = evaluate(*first, universe);
+            return evaluate(*second, lhs);
+        }
+        case Node::OR: return evaluate(*node.left, universe) | evaluate(*node.right, universe);
+        }
+        return Bitmap();
+    }
+
+    // ストアに追加されたハンドを索引へ加える
+    void catch_up() {
+        if (store.size() <= indexed_count()) return;
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        store.read([&](const StoredHand* hands, uint64_t count) {
+            for (; indexed < count; ++indexed) add(static_cast<uint32_t>(indexed), hands[indexed]);
+        });
+    }
+
+    uint64_t indexed_count() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return indexed;
+    }
+
+public:
+    explicit Index(const Store& s) : store(s) { catch_up(); }
+
+    // 条件式を評価する（空の式は全件）。失敗時はfalseとerror
+    bool select(std::string_view expression, Bitmap& out, std::string& error) {
+        catch_up();
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        Bitmap universe = Bitmap::range(static_cast<uint32_t>(indexed));
+        if (expression.find_first_not_of(" \t") == std::string_view::npos) {
+            out = std::move(universe);
+            return true;
+        }
+        Parser parser{*this, expression};
+        auto root = parser.expr();
+        parser.skip_space();
+        if (root && parser.pos != expression.size()) parser.fail("unexpected input");
+        if (!root || !parser.error.empty()) {
+            error = parser.error;
+            return false;
+        }
+        out = evaluate(*root, universe);
+        return true;
+    }
+
+    // 集計: out[group_size(group_by)]
+    void aggregate(const Bitmap& bits, int group_by, QueryGroup* out) const {
+        std::fill(out, out + group_size(group_by), QueryGroup{});
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        store.read([&](const StoredHand* hands, uint64_t count) {
+            bits.for_each([&](uint32_t i) {
+                if (i >= count) return;
+                const StoredHand& h = hands[i];
+                QueryGroup& g = out[group_value(h, group_by, made_hand[i])];
+                ++g.hands;
+                g.won += h.flags & HandStore::FLAG_WON;
+                g.showdown += (h.flags & HandStore::FLAG_SHOWDOWN) != 0;
+                g.profit += h.profit;
+                g.equity_sum += h.equity;
+            });
+        });
+    }
+
+    size_t bytes() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        size_t n = made_hand.capacity();
+        auto sum = [&](const Bitmap* table, int count) {
+            for (int k = 0; k < count; ++k) n += table[k].bytes();
+        };
+        sum(by_position, POSITIONS);
+        sum(by_villain, POSITIONS);
+        sum(by_pot_type, POT_TYPES);
+        sum(by_class, CLASSES);
+        sum(by_flop, FLOP_FLAG_COUNT);
+        sum(by_made, CATEGORIES);
+        sum(by_draw, DRAW_FLAG_COUNT);
+        sum(by_result, RESULT_FLAG_COUNT);
+        sum(by_players, PLAYERS_FLAG_COUNT);
+        sum(by_session.data(), static_cast<int>(by_session.size()));
+        return n;
+    }
+};
+
+// 直近のエラーメッセージ（C ABI用、スレッドごと）
+inline std::string& query_error() {
+    thread_local std::string message;
+    return message;
+}
+
+} // namespace HandQueryEngine
+
+extern "C" {
+    using namespace HandQueryEngine;
+
+    // ストア(step52)の索引を作る。ストアはこのハンドルより後に閉じること
+    void* hand_query_open(void* store_handle) {
+        return new Index(*static_cast<const Store*>(store_handle));
+    }
+
+    void hand_query_close(void* handle) {
+        delete static_cast<Index*>(handle);
+    }
+
+    // 条件式に合うハンド番号を昇順にoutへ（capacityまで）。戻り値は該当総数（構文エラーは-1）
+    int64_t hand_query_select(void* handle, const char* expression, uint32_t* out, int64_t capacity) {
+        Bitmap bits;
+        if (!static_cast<Index*>(handle)->select(expression, bits, query_error())) return -1;
+        int64_t total = 0;
+        bits.for_each([&](uint32_t i) {
+            if (total < capacity) out[total] = i;
+            ++total;
+        });
+        return total;
+    }
+
+    // 戻り値はグループ数（構文エラー・不正な軸は-1）。outはhand_query_group_size(group_by)要素
+    int hand_query_aggregate(void* handle, const char* expression, int group_by, PokerQueryGroup* out) {
+        if (group_by < 0 || group_by >= GROUP_COUNT) {
+            query_error() = "invalid group_by";
+            return -1;
+        }
+        Index* index = static_cast<Index*>(handle);
+        Bitmap bits;
+        if (!index->select(expression, bits, query_error())) return -1;
+        index->aggregate(bits, group_by, out);
+        return group_size(group_by);
+    }
+
+    int hand_query_group_size(int group_by) {
+        return group_by >= 0 && group_by < GROUP_COUNT ? group_size(group_by) : -1;
+    }
+
+    uint64_t hand_query_index_bytes(void* handle) {
+        return static_cast<Index*>(handle)->bytes();
+    }
+
+    const char* hand_query_error(void) {
+        return query_error().c_str();
+    }
+}
+
+#endif // POKER_STEP53_HAND_QUERY_CPP
@@ -0,0 +1,438 @@
+// step54_allin_ev.cpp
+// ハンドストア(step52)全体のオールインEV・運の集計（夜間バッチ）
+// リバー前にオールインになり、相手のカードが分かっているヘッズアップのハンドについて
+// オールイン時点のエクイティを残りのボードの全列挙で求め、
+//   EV調整収支 = エクイティ × (ポット - レーキ) - 投入額
+//   運         = 実際の収支 - EV調整収支（ストリートごとに、配られたカードによる変動に分解）
+//   EV損失     = 各ストリートで相手の実際のハンドに対して不利なまま投入したチップの期待損失
+// を求める。結果はハンド番号と同じ順の固定長レコードとして path.allin に追記する（列ファイル）。
+// 追記はCHUNK件ごとにfdatasyncするので、途中で止めても次回は続きから再開し、
+// 以降の実行では新しく取り込まれたハンドだけを処理する。
+// プリフロップの全列挙（約171万ボード）はスートの同型でまとめてキャッシュする。
+#ifndef POKER_STEP54_ALLIN_EV_CPP
+#define POKER_STEP54_ALLIN_EV_CPP
+
+#include "poker_engine.h"
+#include "step2_3_perfect_evaluator.cpp"
+#include "step52_hand_store.cpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace AllInEV {
+
+using namespace PokerCore;
+using HandStore::LogFile;
+using HandStore::LogHeader;
+using HandStore::Store;
+using HandStore::StoredAction;
+using HandStore::StoredHand;
+using Result = PokerAllInResult;
+using Summary = PokerAllInSummary;
+
+static_assert(sizeof(Result) == 80, "AllInResult layout must stay stable");
+
+enum Status : uint8_t { STATUS_NONE = 0, STATUS_COMPUTED, STATUS_SKIPPED };
+
+constexpr char RESULTS_MAGIC[8] = {'P', 'K', 'H', 'S', 'A', 'L', 'I', 'N'};
+constexpr size_t CHUNK = 16384;        // 1回の追記・同期の単位（再開の粒度）
+constexpr size_t BLOCK = 64;           // ワーカーが一度に取るハンド数
+constexpr int BOARD_AT_STREET[4] = {0, 3, 4, 5};
+constexpr uint8_t ACTION_POST = 5;
+constexpr uint8_t NO_STREET = 0xFF;
+
+// ===== 全列挙 =====
+
+inline uint32_t high_bit(uint32_t ranks) {
+    return ranks != 0 ? 1u << (31 - __builtin_clz(ranks)) : 0;
+}
+
+// 上位k枚のランク集合
+inline uint32_t top_ranks(uint32_t ranks, int k) {
+    while (__builtin_popcount(ranks) > k) ranks &= ranks - 1;
+    return ranks;
+}
+
+// 最も高いストレートの最上位ランク+1のビット（Aは5ハイのストレートの下端にも使う。なければ0）
+inline uint32_t straight_high(uint32_t ranks) {
+    uint32_t x = (ranks << 1) | ((ranks >> RANK_A) & 1);
+    return high_bit(x & (x >> 1) & (x >> 2) & (x >> 3) & (x >> 4)) << 4;
+}
+
+// 7枚の役の比較用の値（役の順序はstep2_3と同じだが値の体系は違う）。
+// スートごとのランク集合のビット演算だけで決める:
+//   (役 << 26) | (主となるランク集合 << 13) | キッカーのランク集合
+// 7枚ではフラッシュとフルハウス・フォーカードは同時に成立しない
+POKER_HOT_KERNEL
+inline uint32_t showdown_value(SuitMajorMask hand) {
+    uint32_t l0 = suit_ranks(hand, 0), l1 = suit_ranks(hand, 1);
+    uint32_t l2 = suit_ranks(hand, 2), l3 = suit_ranks(hand, 3);
+    for (uint32_t suited : {l0, l1, l2, l3}) {
+        if (__builtin_popcount(suited) < 5) continue;
+        if (uint32_t high = straight_high(suited)) {
+            return (uint32_t(PokerEval::RANK_STRAIGHT_FLUSH) << 26) | high;
+        }
+        return (uint32_t(PokerEval::RANK_FLUSH) << 26) | top_ranks(suited, 5);
+    }
+    uint32_t any = l0 | l1 | l2 | l3;
+    uint32_t two = (l0 & l1) | (l0 & l2) | (l0 & l3) | (l1 & l2) | (l1 & l3) | (l2 & l3);
+    uint32_t three = (l0 & l1 & (l2 | l3)) | (l2 & l3 & (l0 | l1));
+    uint32_t four = l0 & l1 & l2 & l3;
+    if (four != 0) {
+        return (uint32_t(PokerEval::RANK_FOUR_OF_KIND) << 26) | (four << 13) |
+               high_bit(any & ~four);
+    }
+    if (three != 0) {
+        uint32_t trips = high_bit(three);
+        uint32_t pair = high_bit(two & ~trips);
+        if (pair != 0) return (uint32_t(PokerEval::RANK_FULL_HOUSE) << 26) | (trips << 13) | pair;
+    }
+    if (uint32_t high = straight_high(any)) return (uint32_t(PokerEval::RANK_STRAIGHT) << 26) | high;
+    if (three != 0) {
+        uint32_t trips = high_bit(three);
+        return (uint32_t(PokerEval::RANK_THREE_OF_KIND) << 26) | (trips << 13) |
+               top_ranks(any & ~trips, 2);
+    }
+    if (__builtin_popcount(two) >= 2) {
+        uint32_t pairs = top_ranks(two, 2);
+        return (uint32_t(PokerEval::RANK_TWO_PAIR) << 26) | (pairs << 13) | high_bit(any & ~pairs);
+    }
+    if (two != 0) {
+        return (uint32_t(PokerEval::RANK_ONE_PAIR) << 26) | (two << 13) | top_ranks(any & ~two, 3);
+    }
+    return (uint32_t(PokerEval::RANK_HIGH_CARD) << 26) | top_ranks(any, 5);
+}
+
+// boardの後に残りのカードを全て配ったときのヒーローのエクイティ（引き分けは1/2）
+POKER_HOT_KERNEL
+static double enumerate_equity(CardMask hero, CardMask villain, CardMask board) {
+    CardMask dead = hero | villain | board;
+    SuitMajorMask live[DECK_SIZE];
+    int n = 0;
+    for (int c = 0; c < DECK_SIZE; ++c) {
+        if (!has_card(dead, static_cast<Card>(c))) live[n++] = suit_major_bit(static_cast<Card>(c));
+    }
+    SuitMajorMask h = to_suit_major(hero | board);
+    SuitMajorMask v = to_suit_major(villain | board);
+    uint64_t score = 0, total = 0;   // 勝ち=2, 引き分け=1
+
+    auto deal = [&](auto&& self, int start, int left, SuitMajorMask dealt) -> void {
+        if (left == 0) {
+            uint32_t hv = showdown_value(h | dealt);
+            uint32_t vv = showdown_value(v | dealt);
+            score += hv > vv ? 2 : hv == vv ? 1 : 0;
+            ++total;
+            return;
+        }
+        for (int i = start; i <= n - left; ++i) self(self, i + 1, left - 1, dealt | live[i]);
+    };
+    deal(deal, 0, 5 - count_cards(board), 0);
+    return total > 0 ? static_cast<double>(score) / (2.0 * static_cast<double>(total)) : 0.0;
+}
+
+// プリフロップのエクイティ（スートの置換で同じになる組み合わせは1回だけ列挙する）
+class PreflopCache {
+private:
+    std::unordered_map<uint32_t, float> equities;
+    std::mutex mutex;
+
+    // 24通りのスートの置換のうち、(ヒーロー2枚, 相手2枚) の並びが最小になるもの
+    static uint32_t canonical_key(const Card hero[2], const Card villain[2]) {
+        std::array<int, SUIT_COUNT> perm = {0, 1, 2, 3};
+        uint32_t best = UINT32_MAX;
+        do {
+            auto map = [&](Card c) {
+                return static_cast<uint32_t>(perm[get_suit(c)] * RANK_COUNT + get_rank(c));
+            };
+            uint32_t h0 = map(hero[0]), h1 = map(hero[1]);
+            uint32_t v0 = map(villain[0]), v1 = map(villain[1]);
+            if (h0 > h1) std::swap(h0, h1);
+            if (v0 > v1) std::swap(v0, v1);
+            best = std::min(best, h0 | (h1 << 6) | (v0 << 12) | (v1 << 18));
+        } while (std::next_permutation(perm.begin(), perm.end()));
+        return best;
+    }
+
+public:
+    static PreflopCache& instance() {
+        static PreflopCache cache;
+        return cache;
+    }
+
+    double get(const Card hero[2], const Card villain[2]) {
+        uint32_t key = canonical_key(hero, villain);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = equities.find(key);
+            if (it != equities.end()) return it->second;
+        }
+        // 列挙はロックの外（同じ組み合わせを同時に計算しても結果は同じ）
+        double equity = enumerate_equity(card_to_mask(hero[0]) | card_to_mask(hero[1]),
+                                         card_to_mask(villain[0]) | card_to_mask(villain[1]), 0);
+        std::lock_guard<std::mutex> lock(mutex);
+        equities.emplace(key, static_cast<float>(equity));
+        return equity;
+    }
+};
+
+// ===== 1ハンドの評価 =====
+
+inline int64_t round_cents(double amount) {
+    return static_cast<int64_t>(std::llround(amount));
+}
+
+inline Result evaluate_hand(const StoredHand& h, const StoredAction* actions, int action_count) {
+    Result r = {};
+    r.hand_id = h.hand_id;
+    r.ev_profit = h.profit;
+    r.street = NO_STREET;
+    if (h.allin_street == 0) return r;
+
+    r.status = STATUS_SKIPPED;
+    Card hero[2];
+    int hero_count = 0;
+    for (CardMask rest = h.hole; rest != 0 && hero_count < 2; rest &= rest - 1) {
+        hero[hero_count++] = static_cast<Card>(__builtin_ctzll(rest));
+    }
+    const Card* villain = h.villain_cards;
+    CardMask villain_mask = card_to_mask(villain[0]) | card_to_mask(villain[1]);
+    int64_t contested = h.pot - h.rake;
+    if (count_cards(h.hole) != 2 || h.board_count != 5 || villain[0] >= DECK_SIZE ||
+        villain[1] >= DECK_SIZE || villain[0] == villain[1] ||
+        (villain_mask & (h.hole | h.board)) != 0 || contested <= 0) {
+        return r;   // マルチウェイ・相手のカード不明
+    }
+
+    int s = h.allin_street - 1;
+    r.status = STATUS_COMPUTED;
+    r.street = static_cast<uint8_t>(s);
+
+    // 各ストリート開始時（そのストリートのボードが配られた後）のエクイティ。リバーは結果
+    double equity[4];
+    equity[0] = PreflopCache::instance().get(hero, villain);
+    for (int t = 1; t < 4; ++t) {
+        CardMask board = 0;
+        for (int k = 0; k < BOARD_AT_STREET[t]; ++k) board = add_card(board, h.board_cards[k]);
+        equity[t] = enumerate_equity(h.hole, villain_mask, board);
+    }
+    for (int t = 0; t < 4; ++t) r.street_equity[t] = static_cast<float>(equity[t]);
+    r.equity = r.street_equity[s];
+
+    r.ev_profit = round_cents(equity[s] * contested) - h.invested;
+    r.luck = h.profit - r.ev_profit;
+    for (int t = s + 1; t < 4; ++t) {
+        r.street_luck[t] = static_cast<int32_t>(round_cents((equity[t] - equity[t - 1]) * contested));
+    }
+
+    // ブラインド以外の投入額（返却されたベットはオールインのストリートから引く）
+    int64_t put_in[4] = {};
+    int64_t total = 0;
+    for (int k = 0; k < action_count; ++k) {
+        const StoredAction& a = actions[k];
+        total += a.amount;
+        if (a.action != ACTION_POST && a.street <= s) put_in[a.street] += a.amount;
+    }
+    put_in[s] = std::max<int64_t>(0, put_in[s] - std::max<int64_t>(0, total - h.invested));
+    for (int t = 0; t <= s; ++t) {
+        r.ev_loss[t] = static_cast<int32_t>(
+            std::max<int64_t>(0, round_cents((1.0 - 2.0 * equity[t]) * put_in[t])));
+    }
+    return r;
+}
+
+// ===== 結果の列ファイル =====
+class Job {
+private:
+    const Store& store;
+    LogFile results;
+    bool read_only = false;
+    std::mutex update_mutex;               // updateは同時に1つ
+    mutable std::shared_mutex map_mutex;   // 結果の再マップと参照
+    std::atomic<uint64_t> processed{0};
+
+    bool remap(uint64_t count, std::string& error) {
+        std::unique_lock<std::shared_mutex> lock(map_mutex);
+        if (!results.map(count * sizeof(Result))) {
+            error = "mmap failed";
+            return false;
+        }
+        processed.store(count);
+        return true;
+    }
+
+    // 書き込み済みの件数（途中で切れたレコードは捨てる）
+    uint64_t file_count() const {
+        return (results.size() - sizeof(LogHeader)) / sizeof(Result);
+    }
+
+    // [begin, end) を評価する
+    void compute(uint64_t begin, uint64_t end, int threads, std::vector<Result>& out) const {
+        std::vector<StoredHand> hands(end - begin);
+        store.read([&](const StoredHand* records, uint64_t) {
+            std::copy(records + begin, records + end, hands.begin());
+        });
+        out.assign(hands.size(), Result{});
+
+        std::atomic<size_t> next{0};
+        auto work = [&] {
+            std::vector<StoredAction> actions;
+            StoredHand copy;
+            for (size_t b = next.fetch_add(BLOCK); b < hands.size(); b = next.fetch_add(BLOCK)) {
+                for (size_t i = b; i < std::min(hands.size(), b + BLOCK); ++i) {
+                    int n = 0;
+                    if (hands[i].allin_street != 0) {
+                        actions.resize(hands[i].action_count);
+                        n = std::max(0, store.get(begin + i, copy, actions.data(), actions.size()));
+                    }
+                    out[i] = evaluate_hand(hands[i], actions.data(), n);
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; ++t) workers.emplace_back(work);
+        work();
+        for (std::thread& w : workers) w.join();
+    }
+
+public:
+    explicit Job(const Store& s) : store(s) {}
+
+    static std::unique_ptr<Job> open(const Store& store, bool read_only, std::string& error) {
+        auto job = std::make_unique<Job>(store);
+        job->read_only = read_only;
+        std::string path = store.path() + ".allin";
+        if (!job->results.open(path, read_only, RESULTS_MAGIC, sizeof(Result), error)) return nullptr;
+        if (!read_only && flock(job->results.descriptor(), LOCK_EX | LOCK_NB) != 0) {
+            error = "all-in EV job is already running: " + path;
+            return nullptr;
+        }
+        uint64_t count = job->file_count();
+        if (!job->remap(count, error)) return nullptr;
+        if (read_only) return job;
+
+        // ストアが作り直されていれば最初から（最後の結果のhand_idで照合する）
+        if (count > 0) {
+            bool stale = true;
+            const Result& last = job->results.records<Result>()[count - 1];
+            store.read([&](const StoredHand* hands, uint64_t size) {
+                stale = count > size || hands[count - 1].hand_id != last.hand_id;
+            });
+            if (stale) count = 0;
+        }
+        if (!job->results.truncate(count * sizeof(Result)) || !job->remap(count, error)) {
+            if (error.empty()) error = "cannot truncate " + path;
+            return nullptr;
+        }
+        return job;
+    }
+
+    uint64_t size() const { return processed.load(); }
+
+    // 未処理のハンドを評価して追記する。戻り値は今回処理した件数（読み取り専用なら新しく見えた件数）
+    int64_t update(int threads, std::string& error) {
+        std::lock_guard<std::mutex> lock(update_mutex);
+        uint64_t start = processed.load();
+        if (read_only) {
+            return remap(file_count(), error) ? static_cast<int64_t>(processed.load() - start) : -1;
+        }
+        if (threads <= 0) threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+        uint64_t total = store.size();
+        std::vector<Result> chunk;
+        for (uint64_t begin = start; begin < total; begin += CHUNK) {
+            uint64_t end = std::min<uint64_t>(total, begin + CHUNK);
+            compute(begin, end, threads, chunk);
+            if (!results.append(chunk.data(), chunk.size() * sizeof(Result)) ||
+                fdatasync(results.descriptor()) != 0) {
+                error = "cannot write all-in results";
+                return -1;
+            }
+            if (!remap(end, error)) return -1;
+        }
+        return static_cast<int64_t>(processed.load() - start);
+    }
+
+    bool get(uint64_t index, Result& out) const {
+        std::shared_lock<std::shared_mutex> lock(map_mutex);
+        if (index >= processed.load()) return false;
+        out = results.records<Result>()[index];
+        return true;
+    }
+
+    // 処理済みのハンドのうち条件(step52)に合うものの合計。queryがNULLなら全件
+    void summary(const PokerHandQuery* query, Summary& out) const {
+        out = Summary{};
+        std::shared_lock<std::shared_mutex> lock(map_mutex);
+        const Result* rows = results.records<Result>();
+        store.read([&](const StoredHand* hands, uint64_t size) {
+            uint64_t n = std::min<uint64_t>(processed.load(), size);
+            for (uint64_t i = 0; i < n; ++i) {
+                if (query != nullptr && !HandStore::matches(hands[i], *query)) continue;
+                const Result& r = rows[i];
+                ++out.hands;
+                out.profit += hands[i].profit;
+                out.ev_profit += r.ev_profit;
+                out.luck += r.luck;
+                if (r.status == STATUS_SKIPPED) ++out.skipped;
+                if (r.status != STATUS_COMPUTED) continue;
+                ++out.allin_hands;
+                out.allin_equity_sum += r.equity;
+                for (int t = 0; t < 4; ++t) {
+                    out.street_luck[t] += r.street_luck[t];
+                    out.ev_loss[t] += r.ev_loss[t];
+                }
+            }
+        });
+    }
+};
+
+// 直近のエラーメッセージ（C ABI用、スレッドごと）
+inline std::string& job_error() {
+    thread_local std::string message;
+    return message;
+}
+
+} // namespace AllInEV
+
+extern "C" {
+    using namespace AllInEV;
+
+    void* allin_ev_open(void* store_handle, int read_only) {
+        auto job = Job::open(*static_cast<const Store*>(store_handle), read_only != 0, job_error());
+        return job.release();
+    }
+
+    void allin_ev_close(void* handle) {
+        delete static_cast<Job*>(handle);
+    }
+
+    int64_t allin_ev_update(void* handle, int threads) {
+        return static_cast<Job*>(handle)->update(threads, job_error());
+    }
+
+    uint64_t allin_ev_count(void* handle) {
+        return static_cast<Job*>(handle)->size();
+    }
+
+    int allin_ev_get(void* handle, uint64_t index, PokerAllInResult* out) {
+        return static_cast<Job*>(handle)->get(index, *out) ? 0 : -1;
+    }
+
+    void allin_ev_summary(void* handle, const PokerHandQuery* query, PokerAllInSummary* out) {
+        static_cast<Job*>(handle)->summary(query, *out);
+    }
+
+    const char* allin_ev_error(void) {
+        return job_error().c_str();
+    }
+}
+
+#endif // POKER_STEP54_ALLIN_EV_CPP
@@ -0,0 +1,668 @@
+// step55_decision_audit.cpp
+// ハンドストア(step52)全体の判断の監査（リーク分析の夜間バッチ）
+// ヒーローの各アクションについて、記録された状態（ストリート・ボード・ポット・コール額・
+// 有効スタック）から判断時点を再現し、
+//   ・ポットの種類ごとの想定レンジ（step46）に対するエクイティ（フロップ以降は残りのボードの全列挙）
+//   ・EQR（step44のモデル、なければstep9）による実現エクイティ
+// から fold / check / call / bet / raise（候補サイズ）のEVを求め、実際のアクションとの差を損失とする。
+// ベット・レイズには相手が強い方から続ける（フォールド率はMDFで釣り合う率より少し低い）として、
+// コールされたときのエクイティを求める。
+// 判断はスートの同型で正規化したボード（プリフロップはヒーローの169クラス）ごとにまとめてから
+// 評価するので、ボードの全ランアウトでの全コンボの役の値（フロップで約156万評価）は
+// 正規ボードにつき1回だけ計算する（想定レンジはスートについて対称なので、ヒーローのカードも
+// 同じ置換で正規ボードのスートへ移して評価する）。
+#ifndef POKER_STEP55_DECISION_AUDIT_CPP
+#define POKER_STEP55_DECISION_AUDIT_CPP
+
+#include "poker_engine.h"
+#include "step9_eqr_complete.cpp"
+#include "step44_eqr_model.cpp"
+#include "step46_range_parser.cpp"
+#include "step48_board_features.cpp"
+#include "step52_hand_store.cpp"
+#include "step54_allin_ev.cpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace DecisionAudit {
+
+using namespace PokerCore;
+using AllInEV::showdown_value;
+using HandStore::Store;
+using HandStore::StoredAction;
+using HandStore::StoredHand;
+using RangeParser::COMBO_CARDS;
+using RangeParser::COMBO_COUNT;
+using Decision = PokerAuditDecision;
+using Summary = PokerAuditSummary;
+
+static_assert(sizeof(Decision) == 56, "AuditDecision layout must stay stable");
+
+enum Action : uint8_t { FOLD = 0, CHECK, CALL, BET, RAISE, POST };
+constexpr int ACTION_KINDS = 5;
+
+constexpr int BOARD_AT_STREET[4] = {0, 3, 4, 5};
+constexpr double MISTAKE_FRACTION = 0.05;   // 損失がポット(+コール額)のこの割合以上ならミス
+constexpr double BET_SIZES[] = {0.5, 1.0};  // ベット・レイズの候補（コール後のポットに対する比）
+constexpr double DEFAULT_SPR = 10.0;        // 有効スタック不明のときのEQR用SPR
+constexpr double OPPONENT_SKILL = 0.5;
+constexpr double FOLD_RESPONSE = 0.75;      // 相手のフォールド率（MDFで釣り合う率に対する比。1未満=降りなさすぎ）
+constexpr int PREFLOP_SAMPLES = 16384;      // プリフロップのモンテカルロの総ボード数（レンジ全体）
+constexpr int PREFLOP_MIN_BOARDS = 24;      // 1コンボあたりの最小ボード数
+
+// ストアのポジション(UTG, MP, CO, BTN, SB, BB) -> step9のポジション(0-8)
+constexpr int EQR_POSITION[6] = {0, 3, 5, 6, 7, 8};
+// フロップ以降の行動順（大きいほど後）
+constexpr int POSTFLOP_ORDER[6] = {2, 3, 4, 5, 0, 1};
+
+// ポットの種類ごとの相手のレンジ（想定）。0=不明は全コンボ
+constexpr const char* VILLAIN_RANGES[HandStore::POT_4BET + 1] = {
+    "",
+    "22+, A2+, K2s+, K8o+, Q5s+, Q9o+, J7s+, J9o+, T7s+, T9o, 96s+, 86s+, 75s+, 64s+, 54s",
+    "22+, A2s+, K9s+, Q9s+, J9s+, T8s+, 97s+, 86s+, 75s+, 65s, 54s, ATo+, KTo+, QTo+, JTo",
+    "99+, AJs+, KQs, AQo+, A5s, A4s",
+    "QQ+, AKs, AKo",
+};
+constexpr int RANGE_COUNT = HandStore::POT_4BET + 1;
+
+// コンボと重み
+struct WeightedCombo {
+    uint16_t combo;
+    float weight;
+};
+
+inline CardMask combo_mask(int combo) {
+    return card_to_mask(COMBO_CARDS[combo].low) | card_to_mask(COMBO_CARDS[combo].high);
+}
+
+// ボードを正規化したときと同じスートの置換を他のカードに適用する（perm[j] = 正規形のレーンjの元のスート）
+inline CardMask to_canonical(CardMask cards, const uint8_t perm[SUIT_COUNT]) {
+    SuitMajorMask sm = to_suit_major(cards);
+    SuitMajorMask result = 0;
+    for (int j = 0; j < SUIT_COUNT; ++j) result |= SuitMajorMask(suit_ranks(sm, perm[j])) << (16 * j);
+    return from_suit_major(result);
+}
+
+// ストリートの時点のボード（配られた順の先頭から）
+inline CardMask board_at(const StoredHand& h, int street) {
+    CardMask board = 0;
+    for (int k = 0; k < BOARD_AT_STREET[street]; ++k) board = add_card(board, h.board_cards[k]);
+    return board;
+}
+
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// ===== 想定レンジとプリフロップの強さ =====
+
+class Ranges {
+private:
+    std::array<std::vector<WeightedCombo>, RANGE_COUNT> combos;
+    std::array<float, COMBO_COUNT> preflop_strength;   // ランダムな手に対するクラスのエクイティ
+
+    Ranges() {
+        for (int r = 0; r < RANGE_COUNT; ++r) {
+            RangeParser::WeightVector weights;
+            weights.fill(1.0f);
+            std::string error;
+            if (VILLAIN_RANGES[r][0] != '\0') {
+                auto parsed = RangeParser::RangeCache::instance().get(VILLAIN_RANGES[r], error);
+                if (parsed) weights = *parsed;
+            }
+            for (int c = 0; c < COMBO_COUNT; ++c) {
+                if (weights[c] > 0.0f) combos[r].push_back({static_cast<uint16_t>(c), weights[c]});
+            }
+        }
+
+        // 169クラスごとに代表コンボでモンテカルロ（シードはクラス番号で固定）
+        std::array<float, HandStore::CLASS_COUNT> by_class;
+        by_class.fill(-1.0f);
+        for (int c = 0; c < COMBO_COUNT; ++c) {
+            uint8_t cls = HandStore::hole_class(combo_mask(c));
+            if (by_class[cls] < 0.0f) by_class[cls] = static_cast<float>(random_equity(c, cls));
+            preflop_strength[c] = by_class[cls];
+        }
+    }
+
+    static double random_equity(int combo, uint64_t seed) {
+        CardMask hero = combo_mask(combo);
+        SuitMajorMask hero_sm = to_suit_major(hero);
+        uint64_t state = mix64(seed);
+        uint64_t score = 0;
+        constexpr int SAMPLES = 2048;
+        for (int i = 0; i < SAMPLES; ++i) {
+            CardMask used = hero;
+            SuitMajorMask villain = 0, board = 0;
+            for (int k = 0; k < 7;) {
+                state = mix64(state);
+                Card c = static_cast<Card>(state % DECK_SIZE);
+                if (has_card(used, c)) continue;
+                used = add_card(used, c);
+                (k < 2 ? villain : board) |= suit_major_bit(c);
+                ++k;
+            }
+            uint32_t hv = showdown_value(hero_sm | board);
+            uint32_t vv = showdown_value(villain | board);
+            score += hv > vv ? 2 : hv == vv ? 1 : 0;
+        }
+        return static_cast<double>(score) / (2.0 * SAMPLES);
+    }
+
+public:
+    static const Ranges& instance() {
+        static Ranges ranges;
+        return ranges;
+    }
+
+    const std::vector<WeightedCombo>& range(int pot_type) const {
+        return combos[pot_type < RANGE_COUNT ? pot_type : 0];
+    }
+
+    float strength(int combo) const { return preflop_strength[combo]; }
+};
+
+// ===== 共有計算の単位（ボード / プリフロップのクラス） =====
+
+// 1つの判断でのヒーローと想定レンジの対戦
+struct Matchup {
+    std::vector<WeightedCombo> sorted;   // 強い順
+    std::vector<float> share;            // コンボごとのヒーローの取り分
+};
+
+class Context {
+private:
+    int street = 0;
+    CardMask board = 0;
+    SuitMajorMask board_sm = 0;
+    std::vector<CardMask> runout_masks;       // 残りのボード
+    std::vector<uint16_t> live_combos;        // 役の値を求めるコンボ（ボードと重ならず、想定レンジに含まれる）
+    std::array<int32_t, COMBO_COUNT> slot;    // コンボ -> live_combosの添字（-1=なし）
+    std::vector<uint32_t> values;             // [runout * live_combos.size() + 添字]（ランアウトと重なれば0）
+    std::vector<uint32_t> scores, counts;     // prepareの作業領域
+    std::array<uint32_t, COMBO_COUNT> strength_now;   // 現在のボードでの役の値
+    int texture = 1;
+    // プリフロップ: (レンジ, ヒーローの正規化したコンボ) -> コンボごとの取り分（強い順）
+    std::unordered_map<uint64_t, std::vector<float>> preflop_shares;
+
+    // プリフロップ: コンボごとに同じ数のボードを配るモンテカルロ（シードはキーで固定）
+    std::vector<float> sample_shares(CardMask hole, const std::vector<WeightedCombo>& sorted,
+                                     uint64_t seed) const {
+        std::vector<float> shares(sorted.size(), 0.0f);
+        if (sorted.empty()) return shares;
+        int boards = std::max(PREFLOP_MIN_BOARDS, PREFLOP_SAMPLES / static_cast<int>(sorted.size()));
+        SuitMajorMask hero = to_suit_major(hole);
+        uint64_t state = mix64(seed);
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            CardMask villain = combo_mask(sorted[i].combo);
+            SuitMajorMask villain_sm = to_suit_major(villain);
+            uint32_t score = 0;   // 勝ち=2, 引き分け=1
+            for (int b = 0; b < boards; ++b) {
+                CardMask used = hole | villain;
+                SuitMajorMask dealt = 0;
+                for (int k = 0; k < 5;) {
+                    state = mix64(state);
+                    Card c = static_cast<Card>(state % DECK_SIZE);
+                    if (has_card(used, c)) continue;
+                    used = add_card(used, c);
+                    dealt |= suit_major_bit(c);
+                    ++k;
+                }
+                uint32_t hv = showdown_value(hero | dealt);
+                uint32_t vv = showdown_value(villain_sm | dealt);
+                score += hv > vv ? 2 : hv == vv ? 1 : 0;
+            }
+            shares[i] = static_cast<float>(score / (2.0 * boards));
+        }
+        return shares;
+    }
+
+public:
+    // 正規ボード1つ分の準備。needed[c]がfalseのコンボの役の値は計算しない
+    void build(int street_index, CardMask board_mask, const std::array<bool, COMBO_COUNT>& needed) {
+        street = street_index;
+        board = board_mask;
+        board_sm = to_suit_major(board);
+        preflop_shares.clear();
+        runout_masks.clear();
+        values.clear();
+        if (street == 0) {
+            texture = 1;
+            return;
+        }
+        texture = BoardFeatureEngine::BoardFeatureTable::instance().lookup(board).eqr_texture;
+
+        int missing = 5 - BOARD_AT_STREET[street];
+        Card live[DECK_SIZE];
+        int n = 0;
+        for (int c = 0; c < DECK_SIZE; ++c) {
+            if (!has_card(board, static_cast<Card>(c))) live[n++] = static_cast<Card>(c);
+        }
+        if (missing == 0) {
+            runout_masks.push_back(0);
+        } else if (missing == 1) {
+            for (int i = 0; i < n; ++i) runout_masks.push_back(card_to_mask(live[i]));
+        } else {
+            for (int i = 0; i < n; ++i) {
+                for (int j = i + 1; j < n; ++j) {
+                    runout_masks.push_back(card_to_mask(live[i]) | card_to_mask(live[j]));
+                }
+            }
+        }
+
+        live_combos.clear();
+        slot.fill(-1);
+        for (int c = 0; c < COMBO_COUNT; ++c) {
+            CardMask cm = combo_mask(c);
+            bool live_combo = needed[c] && (cm & board) == 0;
+            strength_now[c] = live_combo ? showdown_value(board_sm | to_suit_major(cm)) : 0;
+            if (live_combo) {
+                slot[c] = static_cast<int32_t>(live_combos.size());
+                live_combos.push_back(static_cast<uint16_t>(c));
+            }
+        }
+        size_t width = live_combos.size();
+        values.assign(runout_masks.size() * width, 0);
+        for (size_t r = 0; r < runout_masks.size(); ++r) {
+            CardMask dead = board | runout_masks[r];
+            SuitMajorMask full = board_sm | to_suit_major(runout_masks[r]);
+            uint32_t* row = values.data() + r * width;
+            for (size_t j = 0; j < width; ++j) {
+                CardMask cm = combo_mask(live_combos[j]);
+                if ((cm & dead) == 0) row[j] = showdown_value(full | to_suit_major(cm));
+            }
+        }
+    }
+
+    int board_texture() const { return texture; }
+
+    // ヒーローと想定レンジの対戦を準備する（ヒーロー・ボードと重ならないコンボを強い順に並べ、
+    // コンボごとのヒーローの取り分を求める。フロップ以降は全ランアウトで1回だけ、
+    // プリフロップはモンテカルロの結果をレンジとヒーローのクラスごとに使い回す）
+    POKER_HOT_KERNEL
+    void prepare(CardMask hole, int range_id, Matchup& m) {
+        m.sorted.clear();
+        const Ranges& ranges = Ranges::instance();
+        for (const WeightedCombo& wc : ranges.range(range_id)) {
+            if ((combo_mask(wc.combo) & (hole | board)) == 0) m.sorted.push_back(wc);
+        }
+        auto key = [&](const WeightedCombo& wc) {
+            return street == 0 ? static_cast<double>(ranges.strength(wc.combo))
+                               : static_cast<double>(strength_now[wc.combo]);
+        };
+        std::stable_sort(m.sorted.begin(), m.sorted.end(),
+                         [&](const WeightedCombo& a, const WeightedCombo& b) { return key(a) > key(b); });
+
+        size_t n = m.sorted.size();
+        if (street == 0) {
+            uint64_t cache_key = uint64_t(range_id) << 56 | hole;
+            auto it = preflop_shares.find(cache_key);
+            if (it == preflop_shares.end()) {
+                it = preflop_shares.emplace(cache_key, sample_shares(hole, m.sorted, cache_key)).first;
+            }
+            m.share = it->second;
+            return;
+        }
+
+        // 全ランアウト × live_combosを分岐なしで数える（行は連続なのでベクトル化される）
+        size_t width = live_combos.size();
+        scores.assign(width, 0);   // 勝ち=2, 引き分け=1
+        counts.assign(width, 0);
+        uint32_t* __restrict score = scores.data();
+        uint32_t* __restrict count = counts.data();
+        SuitMajorMask hero = to_suit_major(hole);
+        for (size_t r = 0; r < runout_masks.size(); ++r) {
+            if ((runout_masks[r] & hole) != 0) continue;
+            uint32_t hv = showdown_value(hero | board_sm | to_suit_major(runout_masks[r]));
+            const uint32_t* __restrict row = values.data() + r * width;
+            for (size_t j = 0; j < width; ++j) {
+                uint32_t vv = row[j];
+                uint32_t live = vv != 0;   // 0 = ランアウトと重なる
+                score[j] += live * (uint32_t(hv > vv) + uint32_t(hv >= vv));
+                count[j] += live;
+            }
+        }
+        m.share.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            int32_t j = slot[m.sorted[i].combo];
+            m.share[i] = j >= 0 && count[j] > 0 ? static_cast<float>(score[j] / (2.0 * count[j])) : 0.0f;
+        }
+    }
+
+    // 強い方から重みの合計がfraction分のコンボに対するエクイティ（境界のコンボは重みを按分、
+    // 残らなければ1）
+    static double equity(const Matchup& m, double fraction) {
+        double total = 0.0;
+        for (const WeightedCombo& wc : m.sorted) total += wc.weight;
+        double keep = total * std::clamp(fraction, 0.0, 1.0);
+        double score = 0.0, kept = 0.0;
+        for (size_t i = 0; i < m.sorted.size() && kept < keep; ++i) {
+            double w = std::min<double>(m.sorted[i].weight, keep - kept);
+            score += w * m.share[i];
+            kept += w;
+        }
+        return kept > 0.0 ? score / kept : 1.0;
+    }
+};
+
+// ===== 1つの判断の評価 =====
+
+class Evaluator {
+private:
+    const EQRModel::Model* model;
+
+public:
+    explicit Evaluator(const EQRModel::Model* m) : model(m) {}
+
+    // 実現エクイティ（リバーはこの後のストリートがないのでそのまま）
+    double realize(double equity, const StoredHand& h, int street, double stack, double pot,
+                   int texture) const {
+        if (street == 3) return equity;
+        int position = h.position < 6 ? EQR_POSITION[h.position] : EQR_POSITION[2];
+        int opponents = street > 0 && h.flop_players > 1 ? h.flop_players - 1 : 1;
+        bool in_position;
+        if (h.position < 6 && h.villain > 0) {
+            in_position = POSTFLOP_ORDER[h.position] > POSTFLOP_ORDER[h.villain - 1];
+        } else {
+            in_position = h.position == 2 || h.position == 3;   // CO, BTN
+        }
+        if (model != nullptr) {
+            return EQRModel::CalibratedEQR::calculate(*model, equity, position, stack, pot, texture,
+                                                      opponents, in_position, street, OPPONENT_SKILL);
+        }
+        double eqr = EQRCalculator::EQREngine::calculate_complete(
+            equity, position, stack, pot, texture, opponents, in_position, OPPONENT_SKILL).eqr;
+        return std::min(1.0, EQRCalculator::EQREngine::adjust_for_street(eqr, street));
+    }
+
+    // 判断を評価する。評価できなければfalse
+    bool evaluate(Context& ctx, Matchup& m, const StoredHand& h, uint32_t hand_index,
+                  const StoredAction* actions, int action_index, Decision& out) const {
+        const StoredAction& a = actions[action_index];
+        int street = a.street;
+        double pot = a.pot_before;
+        if (pot <= 0.0 || count_cards(h.hole) != 2) return false;
+        uint8_t perm[SUIT_COUNT];
+        BoardFeatureEngine::canonicalize(to_suit_major(street == 0 ? h.hole : board_at(h, street)), perm);
+        CardMask hole = to_canonical(h.hole, perm);
+
+        // 有効スタック（不明なら上限なし）。コール額は残りのスタックまで
+        bool stack_known = a.stack > 0;
+        double stack = stack_known ? double(a.stack) : std::numeric_limits<double>::infinity();
+        double to_call = std::min<double>(std::max(0, a.to_call), stack);
+        double eqr_stack = stack_known ? stack : pot * DEFAULT_SPR;
+
+        ctx.prepare(hole, h.pot_type, m);
+        double equity = ctx.equity(m, 1.0);
+        double realized = realize(equity, h, street, eqr_stack, pot, ctx.board_texture());
+
+        // 投入額amountのアクションのEV（判断時点からの増減、既にポットにあるチップは埋没）
+        auto action_ev = [&](int kind, double amount) -> double {
+            switch (kind) {
+            case FOLD:
+                return 0.0;
+            case CHECK:
+                return realized * pot;
+            case CALL: {
+                bool all_in = stack_known && amount >= stack;
+                double r = all_in ? equity : realized;
+                return r * (pot + amount) - amount;
+            }
+            default: {
+                // 上乗せ分raise_byに対して相手は強い方から続ける（フォールドはMDFの補数のFOLD_RESPONSE倍）
+                double raise_by = std::max(0.0, amount - to_call);
+                if (raise_by <= 0.0) return realized * (pot + amount) - amount;
+                double fold = FOLD_RESPONSE * raise_by / (pot + amount);
+                double called_equity = ctx.equity(m, 1.0 - fold);
+                bool all_in = stack_known && amount >= stack;
+                double r = all_in ? called_equity
+                                  : realize(called_equity, h, street, std::max(0.0, eqr_stack - amount),
+                                            pot + amount + raise_by, ctx.board_texture());
+                return fold * pot + (1.0 - fold) * (r * (pot + amount + raise_by) - amount);
+            }
+            }
+        };
+
+        int kind = a.action;
+        double amount = a.amount;
+        if (kind == CALL && to_call <= 0.0) kind = CHECK;
+        if (kind == CHECK && to_call > 0.0) {
+            kind = CALL;
+            amount = to_call;
+        }
+        double actual = action_ev(kind, amount);
+
+        int best_kind = kind;
+        double best_amount = amount;
+        double best = actual;
+        auto consider = [&](int k, double amt) {
+            double ev = action_ev(k, amt);
+            if (ev > best + 1e-9) {
+                best = ev;
+                best_kind = k;
+                best_amount = amt;
+            }
+        };
+        if (to_call > 0.0) {
+            consider(FOLD, 0.0);
+            consider(CALL, to_call);
+        } else {
+            consider(CHECK, 0.0);
+        }
+        if (stack > to_call) {
+            int aggressive = to_call > 0.0 ? RAISE : BET;
+            for (double size : BET_SIZES) {
+                consider(aggressive, std::min(stack, to_call + size * (pot + to_call)));
+            }
+            if (stack_known) consider(aggressive, stack);
+        }
+
+        out = Decision{};
+        out.hand_id = h.hand_id;
+        out.hand_index = hand_index;
+        out.action_index = static_cast<uint16_t>(action_index);
+        out.street = static_cast<uint8_t>(street);
+        out.action = static_cast<uint8_t>(kind);
+        out.best_action = static_cast<uint8_t>(best_kind);
+        out.equity = static_cast<float>(equity);
+        out.realized = static_cast<float>(realized);
+        out.pot = a.pot_before;
+        out.to_call = static_cast<int32_t>(to_call);
+        out.amount = static_cast<int32_t>(amount);
+        out.best_amount = static_cast<int32_t>(std::llround(best_amount));
+        out.ev_actual = static_cast<int32_t>(std::llround(actual));
+        out.ev_best = static_cast<int32_t>(std::llround(best));
+        out.ev_loss = std::max(0, out.ev_best - out.ev_actual);
+        return true;
+    }
+};
+
+// ===== 全体 =====
+
+// 判断1つ分のタスク。keyは正規ボード（プリフロップはクラス）
+struct Task {
+    uint64_t key;
+    uint32_t hand;
+    uint16_t action;
+    uint8_t pot_type;
+};
+
+inline bool is_mistake(const Decision& d) {
+    return d.ev_loss > 0 && d.ev_loss >= MISTAKE_FRACTION * (double(d.pot) + double(d.to_call));
+}
+
+// 損失の大きい順（同じなら古いハンドから）
+inline bool worse(const Decision& a, const Decision& b) {
+    if (a.ev_loss != b.ev_loss) return a.ev_loss > b.ev_loss;
+    if (a.hand_index != b.hand_index) return a.hand_index < b.hand_index;
+    return a.action_index < b.action_index;
+}
+
+// 監査を実行する。worstには損失の大きい順に最大capacity件
+inline void run(const Store& store, const EQRModel::Model* model, const PokerHandQuery* query,
+                int threads, size_t capacity, std::vector<Decision>& worst, Summary& out) {
+    out = Summary{};
+    worst.clear();
+    if (threads <= 0) threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    // 判断を集めてボードごとに並べる
+    std::vector<Task> tasks;
+    {
+        std::vector<uint32_t> selected;
+        store.read([&](const StoredHand* hands, uint64_t size) {
+            if (size > UINT32_MAX) size = UINT32_MAX;
+            for (uint64_t i = 0; i < size; ++i) {
+                const StoredHand& h = hands[i];
+                if (h.action_count == 0 || count_cards(h.hole) != 2) continue;
+                if (query != nullptr && !HandStore::matches(h, *query)) continue;
+                selected.push_back(static_cast<uint32_t>(i));
+            }
+        });
+        std::vector<StoredAction> actions(UINT16_MAX);
+        StoredHand h;
+        uint8_t perm[SUIT_COUNT];
+        for (uint32_t i : selected) {
+            int n = store.get(i, h, actions.data(), actions.size());
+            for (int k = 0; k < n; ++k) {
+                const StoredAction& a = actions[k];
+                if (a.action >= POST || a.pot_before <= 0) continue;
+                if (h.board_count < BOARD_AT_STREET[a.street]) continue;
+                uint64_t key = h.hole_class;
+                if (a.street > 0) {
+                    SuitMajorMask canonical =
+                        BoardFeatureEngine::canonicalize(to_suit_major(board_at(h, a.street)), perm);
+                    key = (uint64_t(a.street) << 56) | from_suit_major(canonical);
+                }
+                tasks.push_back({key, i, static_cast<uint16_t>(k), h.pot_type});
+            }
+        }
+    }
+    if (tasks.empty()) return;
+    std::sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
+        if (a.key != b.key) return a.key < b.key;
+        if (a.hand != b.hand) return a.hand < b.hand;
+        return a.action < b.action;
+    });
+    std::vector<size_t> groups;   // グループの先頭
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        if (t == 0 || tasks[t].key != tasks[t - 1].key) groups.push_back(t);
+    }
+    groups.push_back(tasks.size());
+    Ranges::instance();   // 初期化をワーカーの外で済ませる
+
+    // ワーカーごとに集計と損失上位を持ち、最後にまとめる
+    struct Partial {
+        Summary summary = {};
+        std::vector<Decision> worst;
+        std::vector<uint32_t> hands;
+    };
+    std::vector<Partial> partials(static_cast<size_t>(threads));
+    std::atomic<size_t> next{0};
+    Evaluator evaluator(model);
+    auto work = [&](Partial& part) {
+        Context ctx;
+        Matchup matchup;
+        std::array<bool, COMBO_COUNT> needed;
+        std::vector<StoredAction> actions(UINT16_MAX);
+        StoredHand h;
+        for (size_t g = next.fetch_add(1); g + 1 < groups.size(); g = next.fetch_add(1)) {
+            const Task& first = tasks[groups[g]];
+            int street = first.key >> 56;
+            CardMask board = street == 0 ? 0 : first.key & ((CardMask(1) << DECK_SIZE) - 1);
+            // グループ内のハンドの想定レンジに含まれるコンボだけ役の値を求める
+            uint32_t range_ids = 0;
+            for (size_t t = groups[g]; t < groups[g + 1]; ++t) range_ids |= 1u << tasks[t].pot_type;
+            needed.fill(false);
+            for (int r = 0; r < RANGE_COUNT; ++r) {
+                if (!((range_ids >> r) & 1)) continue;
+                for (const WeightedCombo& wc : Ranges::instance().range(r)) needed[wc.combo] = true;
+            }
+            ctx.build(street, board, needed);
+            ++part.summary.groups;
+            for (size_t t = groups[g]; t < groups[g + 1]; ++t) {
+                int n = store.get(tasks[t].hand, h, actions.data(), actions.size());
+                Decision d;
+                if (tasks[t].action >= n ||
+                    !evaluator.evaluate(ctx, matchup, h, tasks[t].hand, actions.data(), tasks[t].action, d)) {
+                    continue;
+                }
+                PokerAuditCell& cell = part.summary.cells[d.street][d.action];
+                ++cell.decisions;
+                cell.ev_loss += d.ev_loss;
+                ++cell.recommended[d.best_action];
+                if (is_mistake(d)) ++cell.mistakes;
+                part.hands.push_back(d.hand_index);
+                if (capacity == 0) continue;
+                if (part.worst.size() < capacity) {
+                    part.worst.push_back(d);
+                    std::push_heap(part.worst.begin(), part.worst.end(), worse);
+                } else if (worse(d, part.worst.front())) {
+                    std::pop_heap(part.worst.begin(), part.worst.end(), worse);
+                    part.worst.back() = d;
+                    std::push_heap(part.worst.begin(), part.worst.end(), worse);
+                }
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) workers.emplace_back(work, std::ref(partials[t]));
+    work(partials[0]);
+    for (std::thread& w : workers) w.join();
+
+    std::vector<uint32_t> audited;
+    for (Partial& part : partials) {
+        out.groups += part.summary.groups;
+        for (int s = 0; s < 4; ++s) {
+            for (int k = 0; k < ACTION_KINDS; ++k) {
+                const PokerAuditCell& src = part.summary.cells[s][k];
+                PokerAuditCell& dst = out.cells[s][k];
+                dst.decisions += src.decisions;
+                dst.mistakes += src.mistakes;
+                dst.ev_loss += src.ev_loss;
+                for (int b = 0; b < ACTION_KINDS; ++b) dst.recommended[b] += src.recommended[b];
+                out.decisions += src.decisions;
+                out.mistakes += src.mistakes;
+                out.ev_loss += src.ev_loss;
+            }
+        }
+        worst.insert(worst.end(), part.worst.begin(), part.worst.end());
+        audited.insert(audited.end(), part.hands.begin(), part.hands.end());
+    }
+    std::sort(audited.begin(), audited.end());
+    out.hands = static_cast<uint64_t>(std::unique(audited.begin(), audited.end()) - audited.begin());
+    std::sort(worst.begin(), worst.end(), worse);
+    if (worst.size() > capacity) worst.resize(capacity);
+}
+
+} // namespace DecisionAudit
+
+extern "C" {
+    using namespace DecisionAudit;
+
+    int64_t decision_audit(void* store_handle, void* eqr_model, const PokerHandQuery* query,
+                           int threads, PokerAuditDecision* worst, int64_t capacity,
+                           PokerAuditSummary* out) {
+        std::shared_ptr<const EQRModel::Model> model;
+        if (eqr_model != nullptr) model = static_cast<EQRModel::ModelStore*>(eqr_model)->get();
+        std::vector<Decision> top;
+        PokerAuditSummary summary;
+        run(*static_cast<const Store*>(store_handle), model.get(), query, threads,
+            worst != nullptr ? static_cast<size_t>(std::max<int64_t>(0, capacity)) : 0, top, summary);
+        if (out != nullptr) *out = summary;
+        if (worst != nullptr) std::copy(top.begin(), top.end(), worst);
+        return static_cast<int64_t>(top.size());
+    }
+}
+
+#endif // POKER_STEP55_DECISION_AUDIT_CPP
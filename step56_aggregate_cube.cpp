@@ -0,0 +1,496 @@
+// step56_aggregate_cube.cpp
+// レポート・ダッシュボード用の集計キューブ（step35 ReportGenerator / step37 PerformanceTracker）
+// 次元: セッション × ポジション × ステーク × 日付 × ハンドクラス
+// 値:   件数・勝ち数・収支の合計・二乗和・最小・最大
+// ・次元の部分集合ごと(2^5 = 32通り)に小計の表（直方体）を持ち、ハンドの追加時に全ての表を更新する。
+//   「BTNの勝率」「このセッションの分散」などは表引き1回で、履歴の長さに依存しない
+// ・キーは5次元を64ビットに詰めたもので、ある直方体のキーは最も細かいキーを次元のマスクで
+//   切り落としたものになる。追加はまず最も細かいセルへまとめてから32通りに配る
+// ・保存するのは最も細かいセルだけで、開く時に小計を作り直す（ハンド数ではなくセル数に比例）
+// ・ハンドストア(step52)の取り込み済み件数を覚えておき、syncは新しいハンドだけを足す
+#ifndef POKER_STEP56_AGGREGATE_CUBE_CPP
+#define POKER_STEP56_AGGREGATE_CUBE_CPP
+
+#include "poker_engine.h"
+#include "step52_hand_store.cpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
+
+namespace AggregateCube {
+
+using HandStore::Store;
+using HandStore::StoredHand;
+using Fact = PokerCubeFact;
+using Cell = PokerCubeCell;
+using Query = PokerCubeQuery;
+
+static_assert(sizeof(Fact) == 32, "CubeFact layout must stay stable");
+static_assert(sizeof(Cell) == 48, "CubeCell layout must stay stable");
+
+enum Dimension : int {
+    DIM_SESSION = 0, DIM_POSITION, DIM_STAKE, DIM_DAY, DIM_CLASS, DIM_COUNT
+};
+constexpr int CUBOID_COUNT = 1 << DIM_COUNT;
+
+// キーのビット配置（上位から セッション24 | ポジション3 | ステーク10 | 日付19 | クラス8）
+constexpr int SHIFT[DIM_COUNT] = {40, 37, 27, 8, 0};
+constexpr int BITS[DIM_COUNT] = {24, 3, 10, 19, 8};
+
+constexpr uint64_t field_mask(int d) {
+    return ((uint64_t(1) << BITS[d]) - 1) << SHIFT[d];
+}
+
+constexpr uint64_t cuboid_mask(int cuboid) {
+    uint64_t mask = 0;
+    for (int d = 0; d < DIM_COUNT; ++d) {
+        if ((cuboid >> d) & 1) mask |= field_mask(d);
+    }
+    return mask;
+}
+
+inline uint64_t field(uint64_t key, int d) {
+    return (key >> SHIFT[d]) & ((uint64_t(1) << BITS[d]) - 1);
+}
+
+constexpr uint32_t MAX_SESSION = (1u << 24) - 1;     // これ以上は最後の番号にまとめる
+constexpr uint32_t MAX_STAKES = 1u << 10;
+constexpr uint32_t OVERFLOW_STAKE = MAX_STAKES - 1;  // 登録しきれないステークをまとめる専用の番号
+constexpr int64_t MAX_DAY = (int64_t(1) << 19) - 1;  // 1970年から約1400年
+constexpr int UNKNOWN_POSITION = 6;
+constexpr int UNKNOWN_CLASS = 169;
+constexpr int64_t SECONDS_PER_DAY = 86400;
+
+// ===== セル =====
+
+inline void merge(Cell& into, const Cell& from) {
+    if (from.count == 0) return;
+    if (into.count == 0) {
+        into = from;
+        return;
+    }
+    into.count += from.count;
+    into.won += from.won;
+    into.sum += from.sum;
+    into.sum_sq += from.sum_sq;
+    into.min = std::min(into.min, from.min);
+    into.max = std::max(into.max, from.max);
+}
+
+inline Cell single(int64_t profit, bool won) {
+    Cell c;
+    c.count = 1;
+    c.won = won ? 1 : 0;
+    c.sum = profit;
+    c.min = profit;
+    c.max = profit;
+    c.sum_sq = double(profit) * double(profit);
+    return c;
+}
+
+using CellMap = std::unordered_map<uint64_t, Cell>;
+
+// ===== ファイル形式 =====
+//   FileHeader
+//   int32_t stakes[stake_count]（ステーク番号 -> ビッグブラインド）
+//   SavedCell cells[cell_count]（最も細かいセル、キーの昇順）
+constexpr char FILE_MAGIC[8] = {'P', 'K', 'A', 'G', 'C', 'U', 'B', 'E'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t format_version;
+    int32_t utc_offset;
+    uint64_t synced;          // 取り込み済みのハンドストアの件数
+    uint64_t facts;           // 取り込んだハンドの総数
+    uint64_t stake_count;
+    uint64_t cell_count;
+    uint64_t padding[2];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout must stay stable");
+
+struct SavedCell {
+    uint64_t key;
+    Cell cell;
+};
+static_assert(sizeof(SavedCell) == 56, "SavedCell layout must stay stable");
+
+// ===== キューブ =====
+class Cube {
+private:
+    mutable std::shared_mutex mutex;
+    int32_t utc_offset;
+    uint64_t synced = 0;
+    uint64_t facts = 0;
+    CellMap cuboids[CUBOID_COUNT];   // [次元の部分集合のビット] -> キー -> 小計
+    std::vector<int32_t> stakes;     // ステーク番号 -> ビッグブラインド
+    std::unordered_map<int32_t, uint32_t> stake_ids;
+
+    int64_t day_of(int64_t timestamp) const {
+        int64_t t = timestamp + utc_offset;
+        int64_t day = t >= 0 ? t / SECONDS_PER_DAY : (t - SECONDS_PER_DAY + 1) / SECONDS_PER_DAY;
+        return std::clamp<int64_t>(day, 0, MAX_DAY);
+    }
+
+    // ステーク番号（未登録なら追加、表が一杯ならOVERFLOW_STAKEにまとめ、既存のステークには混ぜない）
+    uint32_t stake_id(int32_t big_blind) {
+        auto it = stake_ids.find(big_blind);
+        if (it != stake_ids.end()) return it->second;
+        if (stakes.size() >= OVERFLOW_STAKE) return OVERFLOW_STAKE;
+        uint32_t id = static_cast<uint32_t>(stakes.size());
+        stakes.push_back(big_blind);
+        stake_ids.emplace(big_blind, id);
+        return id;
+    }
+
+    uint64_t key_of(const Fact& f) {
+        uint64_t position = f.position < UNKNOWN_POSITION ? f.position : UNKNOWN_POSITION;
+        uint64_t hole_class = f.hole_class < UNKNOWN_CLASS ? f.hole_class : UNKNOWN_CLASS;
+        return (uint64_t(std::min(f.session, MAX_SESSION)) << SHIFT[DIM_SESSION]) |
+               (position << SHIFT[DIM_POSITION]) |
+               (uint64_t(stake_id(std::max(f.big_blind, 0))) << SHIFT[DIM_STAKE]) |
+               (uint64_t(day_of(f.timestamp)) << SHIFT[DIM_DAY]) |
+               (hole_class << SHIFT[DIM_CLASS]);
+    }
+
+    // 最も細かいセルの差分を全ての直方体へ配る（排他ロック中に呼ぶ）
+    void commit(const CellMap& delta) {
+        for (int c = 0; c < CUBOID_COUNT; ++c) {
+            uint64_t mask = cuboid_mask(c);
+            CellMap& table = cuboids[c];
+            for (const auto& [key, cell] : delta) merge(table[key & mask], cell);
+        }
+    }
+
+    // 絞り込みのうち固定された次元（日付以外）のビットとキー。該当するセルが無ければfalse
+    bool fixed_key(const Query& q, int& cuboid, uint64_t& key) const {
+        cuboid = 0;
+        key = 0;
+        if (q.session >= 0) {
+            if (q.session > MAX_SESSION) return false;
+            cuboid |= 1 << DIM_SESSION;
+            key |= uint64_t(q.session) << SHIFT[DIM_SESSION];
+        }
+        if (q.position >= 0) {
+            if (q.position > UNKNOWN_POSITION) return false;
+            cuboid |= 1 << DIM_POSITION;
+            key |= uint64_t(q.position) << SHIFT[DIM_POSITION];
+        }
+        if (q.big_blind >= 0) {
+            auto it = q.big_blind <= INT32_MAX ? stake_ids.find(static_cast<int32_t>(q.big_blind))
+                                               : stake_ids.end();
+            if (it == stake_ids.end()) return false;
+            cuboid |= 1 << DIM_STAKE;
+            key |= uint64_t(it->second) << SHIFT[DIM_STAKE];
+        }
+        if (q.hole_class >= 0) {
+            if (q.hole_class > UNKNOWN_CLASS) return false;
+            cuboid |= 1 << DIM_CLASS;
+            key |= uint64_t(q.hole_class) << SHIFT[DIM_CLASS];
+        }
+        return true;
+    }
+
+    // 日付の範囲（firstとlastを含む）。end_timeはハンドストアと同じく含まないので、その1秒前の日まで。
+    // 制限が無ければfalse
+    bool day_range(const Query& q, int64_t& first, int64_t& last) const {
+        if (q.start_time == 0 && q.end_time == 0) return false;
+        first = q.start_time != 0 ? day_of(q.start_time) : 0;
+        last = q.end_time != 0 ? day_of(q.end_time - 1) : MAX_DAY;
+        return true;
+    }
+
+    int64_t group_key(uint64_t key, int dimension) const {
+        int64_t value = static_cast<int64_t>(field(key, dimension));
+        switch (dimension) {
+        case DIM_STAKE:   // OVERFLOW_STAKEは-1
+            return value < static_cast<int64_t>(stakes.size()) ? stakes[value] : -1;
+        case DIM_DAY:
+            return value * SECONDS_PER_DAY - utc_offset;
+        default:
+            return value;
+        }
+    }
+
+public:
+    explicit Cube(int32_t offset) : utc_offset(offset) {}
+    Cube(const Cube&) = delete;
+    Cube& operator=(const Cube&) = delete;
+
+    uint64_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return facts;
+    }
+
+    void add(const Fact* batch, size_t count) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        CellMap delta;
+        for (size_t i = 0; i < count; ++i) {
+            merge(delta[key_of(batch[i])], single(batch[i].profit, batch[i].won != 0));
+        }
+        commit(delta);
+        facts += count;
+    }
+
+    // ハンドストアの未取り込み分を足す
+    int64_t sync(const Store& store, std::string& error) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        CellMap delta;
+        uint64_t added = 0;
+        bool ok = true;
+        store.read([&](const StoredHand* hands, uint64_t size) {
+            if (size < synced) {
+                ok = false;
+                return;
+            }
+            for (uint64_t i = synced; i < size; ++i) {
+                const StoredHand& h = hands[i];
+                Fact f = {};
+                f.timestamp = h.timestamp;
+                f.profit = h.profit;
+                f.session = h.session;
+                f.big_blind = h.big_blind;
+                f.position = h.position;
+                f.hole_class = h.hole_class;
+                f.won = h.flags & HandStore::FLAG_WON;
+                merge(delta[key_of(f)], single(f.profit, f.won != 0));
+            }
+            added = size - synced;
+        });
+        if (!ok) {
+            error = "hand store has fewer hands than the cube has synced (different store?)";
+            return -1;
+        }
+        commit(delta);
+        synced += added;
+        facts += added;
+        return static_cast<int64_t>(added);
+    }
+
+    Cell rollup(const Query& q) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        Cell out = {};
+        int cuboid;
+        uint64_t key;
+        if (!fixed_key(q, cuboid, key)) return out;
+        int64_t first, last;
+        if (!day_range(q, first, last)) {
+            auto it = cuboids[cuboid].find(key);
+            if (it != cuboids[cuboid].end()) out = it->second;
+            return out;
+        }
+        // 日付の範囲: 日数が表より小さければ1日ずつ引き、そうでなければ表を走査する
+        cuboid |= 1 << DIM_DAY;
+        const CellMap& table = cuboids[cuboid];
+        if (last < first) return out;
+        if (uint64_t(last - first) < table.size()) {
+            for (int64_t day = first; day <= last; ++day) {
+                auto it = table.find(key | (uint64_t(day) << SHIFT[DIM_DAY]));
+                if (it != table.end()) merge(out, it->second);
+            }
+        } else {
+            uint64_t others = cuboid_mask(cuboid) & ~field_mask(DIM_DAY);
+            for (const auto& [k, cell] : table) {
+                int64_t day = static_cast<int64_t>(field(k, DIM_DAY));
+                if ((k & others) == key && day >= first && day <= last) merge(out, cell);
+            }
+        }
+        return out;
+    }
+
+    // 1次元でのグループ別集計（キーの昇順）
+    std::vector<std::pair<int64_t, Cell>> group(const Query& q, int dimension) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        std::vector<std::pair<int64_t, Cell>> out;
+        int cuboid;
+        uint64_t key;
+        if (!fixed_key(q, cuboid, key)) return out;
+        int64_t first = 0, last = MAX_DAY;
+        bool dated = day_range(q, first, last);
+        uint64_t others = cuboid_mask(cuboid);
+        cuboid |= 1 << dimension;
+        if (dated) cuboid |= 1 << DIM_DAY;
+
+        std::map<uint64_t, Cell> groups;
+        for (const auto& [k, cell] : cuboids[cuboid]) {
+            if ((k & others) != key) continue;
+            int64_t day = static_cast<int64_t>(field(k, DIM_DAY));
+            if (dated && (day < first || day > last)) continue;
+            merge(groups[field(k, dimension)], cell);
+        }
+        out.reserve(groups.size());
+        for (const auto& [value, cell] : groups) {
+            out.emplace_back(group_key(value << SHIFT[dimension], dimension), cell);
+        }
+        // ステークは登録順の番号なのでビッグブラインドで並べ直す
+        if (dimension == DIM_STAKE) {
+            std::sort(out.begin(), out.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+        }
+        return out;
+    }
+
+    // ファイルへ保存（一時ファイルに書いてからrename）
+    bool save(const std::string& path, std::string& error) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        const CellMap& finest = cuboids[CUBOID_COUNT - 1];
+        std::vector<SavedCell> cells;
+        cells.reserve(finest.size());
+        for (const auto& [key, cell] : finest) cells.push_back({key, cell});
+        std::sort(cells.begin(), cells.end(),
+                  [](const SavedCell& a, const SavedCell& b) { return a.key < b.key; });
+
+        FileHeader header = {};
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.format_version = FORMAT_VERSION;
+        header.utc_offset = utc_offset;
+        header.synced = synced;
+        header.facts = facts;
+        header.stake_count = stakes.size();
+        header.cell_count = cells.size();
+
+        std::string tmp = path + ".tmp";
+        FILE* fp = std::fopen(tmp.c_str(), "wb");
+        if (fp == nullptr) {
+            error = "cannot create " + tmp;
+            return false;
+        }
+        bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1;
+        ok = ok && std::fwrite(stakes.data(), sizeof(int32_t), stakes.size(), fp) == stakes.size();
+        ok = ok && std::fwrite(cells.data(), sizeof(SavedCell), cells.size(), fp) == cells.size();
+        ok = (std::fflush(fp) == 0) && ok;
+        ok = (fsync(fileno(fp)) == 0) && ok;
+        ok = (std::fclose(fp) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            error = "failed to write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    static std::unique_ptr<Cube> open(const std::string& path, std::string& error) {
+        FILE* fp = std::fopen(path.c_str(), "rb");
+        if (fp == nullptr) {
+            error = "cannot open " + path;
+            return nullptr;
+        }
+        std::unique_ptr<FILE, int (*)(FILE*)> guard(fp, std::fclose);
+        FileHeader header;
+        if (std::fread(&header, sizeof(header), 1, fp) != 1) {
+            error = "file too small: " + path;
+            return nullptr;
+        }
+        if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            error = "bad magic";
+            return nullptr;
+        }
+        if (header.format_version != FORMAT_VERSION) {
+            error = "unsupported format version";
+            return nullptr;
+        }
+        if (header.stake_count > OVERFLOW_STAKE || header.cell_count > (uint64_t(1) << 40)) {
+            error = "corrupt header";
+            return nullptr;
+        }
+
+        auto cube = std::make_unique<Cube>(header.utc_offset);
+        cube->synced = header.synced;
+        cube->facts = header.facts;
+        cube->stakes.resize(header.stake_count);
+        std::vector<SavedCell> cells(header.cell_count);
+        if (std::fread(cube->stakes.data(), sizeof(int32_t), cube->stakes.size(), fp) !=
+                cube->stakes.size() ||
+            std::fread(cells.data(), sizeof(SavedCell), cells.size(), fp) != cells.size()) {
+            error = "file size does not match header";
+            return nullptr;
+        }
+        for (uint32_t i = 0; i < cube->stakes.size(); ++i) cube->stake_ids.emplace(cube->stakes[i], i);
+
+        CellMap finest;
+        finest.reserve(cells.size());
+        for (const SavedCell& c : cells) {
+            uint64_t stake = field(c.key, DIM_STAKE);
+            if ((stake >= std::max<size_t>(cube->stakes.size(), 1) && stake != OVERFLOW_STAKE) ||
+                field(c.key, DIM_POSITION) > UNKNOWN_POSITION ||
+                field(c.key, DIM_CLASS) > UNKNOWN_CLASS) {
+                error = "corrupt cell";
+                return nullptr;
+            }
+            finest.emplace(c.key, c.cell);
+        }
+        cube->commit(finest);
+        return cube;
+    }
+};
+
+// 直近のエラーメッセージ（C ABI用、スレッドごと）
+inline std::string& cube_error() {
+    thread_local std::string message;
+    return message;
+}
+
+} // namespace AggregateCube
+
+extern "C" {
+    using namespace AggregateCube;
+
+    void* aggregate_cube_create(int32_t utc_offset) {
+        return new Cube(utc_offset);
+    }
+
+    void* aggregate_cube_open(const char* path) {
+        return Cube::open(path, cube_error()).release();
+    }
+
+    void aggregate_cube_close(void* handle) {
+        delete static_cast<Cube*>(handle);
+    }
+
+    int aggregate_cube_save(void* handle, const char* path) {
+        return static_cast<Cube*>(handle)->save(path, cube_error()) ? 0 : -1;
+    }
+
+    void aggregate_cube_add(void* handle, const PokerCubeFact* facts, int64_t count) {
+        if (count > 0) static_cast<Cube*>(handle)->add(facts, static_cast<size_t>(count));
+    }
+
+    int64_t aggregate_cube_sync(void* handle, void* store_handle) {
+        return static_cast<Cube*>(handle)->sync(*static_cast<const Store*>(store_handle),
+                                                cube_error());
+    }
+
+    uint64_t aggregate_cube_count(void* handle) {
+        return static_cast<Cube*>(handle)->size();
+    }
+
+    void aggregate_cube_rollup(void* handle, const PokerCubeQuery* query, PokerCubeCell* out) {
+        *out = static_cast<Cube*>(handle)->rollup(*query);
+    }
+
+    int64_t aggregate_cube_group(void* handle, const PokerCubeQuery* query, int dimension,
+                                 int64_t* keys, PokerCubeCell* cells, int64_t capacity) {
+        if (dimension < 0 || dimension >= DIM_COUNT) return -1;
+        auto groups = static_cast<Cube*>(handle)->group(*query, dimension);
+        int64_t n = std::min<int64_t>(capacity, static_cast<int64_t>(groups.size()));
+        for (int64_t i = 0; i < n; ++i) {
+            keys[i] = groups[static_cast<size_t>(i)].first;
+            cells[i] = groups[static_cast<size_t>(i)].second;
+        }
+        return static_cast<int64_t>(groups.size());
+    }
+
+    const char* aggregate_cube_error(void) {
+        return cube_error().c_str();
+    }
+}
+
+#endif // POKER_STEP56_AGGREGATE_CUBE_CPP
@@ -0,0 +1,408 @@
+// step57_performance_stream.cpp
+// ダッシュボード用の収支の逐次集計（step37 PerformanceTrackerの移動平均・トレンド・連勝連敗・分散）
+// 1ハンドの追加ごとにO(1)で更新し、参照は保持している値を返すだけにする:
+//   全体      Welfordの平均・二乗偏差和、最小・最大
+//   窓        直近window件 / trend_window件の合計・二乗和・位置つき和 Σx·y
+//             （窓から出る値は履歴から引く。丸め誤差が溜まらないよう窓の長さごとに足し直す）
+//   トレンド  位置つき和から線形回帰の傾き・決定係数・p値（scipy.stats.linregressと同じ）
+//   EWMA      指数移動平均と指数加重分散（信頼帯用）
+//   連勝連敗  現在の連続数と最大値
+// 過去の配列をまとめて入れる時と全履歴の移動平均の再計算は、レーンごとの部分和に分けて
+// 自動ベクトル化されるカーネルで処理する。
+#ifndef POKER_STEP57_PERFORMANCE_STREAM_CPP
+#define POKER_STEP57_PERFORMANCE_STREAM_CPP
+
+#include "poker_engine.h"
+#include "step1_card_system_advanced.cpp"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace PerformanceStream {
+
+using State = PokerPerformanceState;
+
+constexpr double Z95 = 1.959963984540054;   // 標準正規分布の97.5%点
+constexpr int LANES = 8;                    // 部分和のレーン数（AVX-512の倍精度8要素）
+
+// ===== t分布 =====
+
+// 正則化不完全ベータ関数の連分数部分（Lentz法）
+inline double beta_fraction(double a, double b, double x) {
+    constexpr int MAX_ITERATIONS = 300;
+    constexpr double EPSILON = 1e-15;
+    constexpr double TINY = 1e-300;
+    auto guard = [](double v) { return std::fabs(v) < TINY ? TINY : v; };
+    double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+    double c = 1.0;
+    double d = 1.0 / guard(1.0 - qab * x / qap);
+    double h = d;
+    for (int m = 1; m <= MAX_ITERATIONS; ++m) {
+        double m2 = 2.0 * m;
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1.0 / guard(1.0 + aa * d);
+        c = guard(1.0 + aa / c);
+        h *= d * c;
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1.0 / guard(1.0 + aa * d);
+        c = guard(1.0 + aa / c);
+        double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1.0) < EPSILON) break;
+    }
+    return h;
+}
+
+// 正則化不完全ベータ関数 I_x(a, b)
+inline double incomplete_beta(double a, double b, double x) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+                            a * std::log(x) + b * std::log1p(-x));
+    if (x < (a + 1.0) / (a + b + 2.0)) return front * beta_fraction(a, b, x) / a;
+    return 1.0 - front * beta_fraction(b, a, 1.0 - x) / b;
+}
+
+// 自由度dfのt分布での両側p値
+inline double t_two_sided_p(double t, double df) {
+    return incomplete_beta(0.5 * df, 0.5, df / (df + t * t));
+}
+
+// ===== バッチ処理カーネル =====
+
+// 窓の合計・二乗和・位置つき和（位置は先頭を0とする）
+POKER_HOT_KERNEL
+static void window_sums(const double* v, size_t n, double& sum, double& sum_sq, double& sum_xy) {
+    double s[LANES] = {}, q[LANES] = {}, xy[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (int l = 0; l < LANES; ++l) {
+            double y = v[i + l];
+            s[l] += y;
+            q[l] += y * y;
+            xy[l] += double(i + l) * y;
+        }
+    }
+    for (; i < n; ++i) {
+        s[0] += v[i];
+        q[0] += v[i] * v[i];
+        xy[0] += double(i) * v[i];
+    }
+    sum = sum_sq = sum_xy = 0.0;
+    for (int l = 0; l < LANES; ++l) {
+        sum += s[l];
+        sum_sq += q[l];
+        sum_xy += xy[l];
+    }
+}
+
+// 平均・二乗偏差和・最小・最大（2パス。バッチをWelfordの状態へ結合する用）
+POKER_HOT_KERNEL
+static void moments(const double* v, size_t n, double& mean, double& m2, double& lo, double& hi) {
+    double s[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (int l = 0; l < LANES; ++l) s[l] += v[i + l];
+    }
+    for (; i < n; ++i) s[0] += v[i];
+    double total = 0.0;
+    for (int l = 0; l < LANES; ++l) total += s[l];
+    mean = total / double(n);
+
+    double q[LANES] = {}, mn[LANES], mx[LANES];
+    std::fill(mn, mn + LANES, v[0]);
+    std::fill(mx, mx + LANES, v[0]);
+    for (i = 0; i + LANES <= n; i += LANES) {
+        for (int l = 0; l < LANES; ++l) {
+            double d = v[i + l] - mean;
+            q[l] += d * d;
+            mn[l] = std::min(mn[l], v[i + l]);
+            mx[l] = std::max(mx[l], v[i + l]);
+        }
+    }
+    for (; i < n; ++i) {
+        double d = v[i] - mean;
+        q[0] += d * d;
+        mn[0] = std::min(mn[0], v[i]);
+        mx[0] = std::max(mx[0], v[i]);
+    }
+    m2 = 0.0;
+    lo = mn[0];
+    hi = mx[0];
+    for (int l = 0; l < LANES; ++l) {
+        m2 += q[l];
+        lo = std::min(lo, mn[l]);
+        hi = std::max(hi, mx[l]);
+    }
+}
+
+// 移動平均: prefix[i] = 先頭i件の合計（n+1要素）。窓に満たない先頭は先頭からの平均
+POKER_HOT_KERNEL
+static void rolling_mean(const double* prefix, size_t n, size_t window, double* out) {
+    size_t head = std::min(n, window);
+    for (size_t i = 0; i < head; ++i) out[i] = prefix[i + 1] / double(i + 1);
+    double inv = 1.0 / double(window);
+    for (size_t i = head; i < n; ++i) out[i] = (prefix[i + 1] - prefix[i + 1 - window]) * inv;
+}
+
+// ===== 窓 =====
+struct Window {
+    uint32_t capacity;
+    uint32_t count = 0;
+    uint32_t since_rebuild = 0;
+    double sum = 0.0, sum_sq = 0.0, sum_xy = 0.0;
+
+    explicit Window(uint32_t c) : capacity(std::max<uint32_t>(c, 1)) {}
+
+    // valuesの末尾に1件足した直後に呼ぶ
+    void push(const std::vector<double>& values) {
+        double y = values.back();
+        if (count < capacity) {
+            sum_xy += double(count) * y;
+            sum += y;
+            sum_sq += y * y;
+            ++count;
+            return;
+        }
+        // 先頭が抜けると残りの位置が1つずつ下がり、新しい値は位置capacity-1に入る
+        double y0 = values[values.size() - 1 - capacity];
+        sum_xy += double(capacity - 1) * y - (sum - y0);
+        sum += y - y0;
+        sum_sq += y * y - y0 * y0;
+        if (++since_rebuild >= capacity) rebuild(values);
+    }
+
+    void rebuild(const std::vector<double>& values) {
+        count = static_cast<uint32_t>(std::min<size_t>(capacity, values.size()));
+        since_rebuild = 0;
+        window_sums(values.data() + values.size() - count, count, sum, sum_sq, sum_xy);
+    }
+
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+
+    double variance() const {
+        if (count == 0) return 0.0;
+        double m = mean();
+        return std::max(0.0, sum_sq / count - m * m);
+    }
+};
+
+// ===== ストリーム =====
+class Stream {
+private:
+    mutable std::mutex mutex;
+    double alpha;
+    std::vector<double> values;      // 全履歴（窓から出る値と再計算用）
+    double mean = 0.0, m2 = 0.0, lo = 0.0, hi = 0.0;
+    Window rolling, trend;
+    double ewma = 0.0, ew_variance = 0.0;
+    int64_t streak = 0;
+    uint64_t max_win = 0, max_lose = 0;
+
+    void push_outcome(double y, bool won) {
+        if (values.size() == 1) {
+            ewma = y;
+        } else {
+            double diff = y - ewma;
+            double increment = alpha * diff;
+            ewma += increment;
+            ew_variance = (1.0 - alpha) * (ew_variance + diff * increment);
+        }
+        if (won) {
+            streak = streak > 0 ? streak + 1 : 1;
+            max_win = std::max<uint64_t>(max_win, uint64_t(streak));
+        } else {
+            streak = streak < 0 ? streak - 1 : -1;
+            max_lose = std::max<uint64_t>(max_lose, uint64_t(-streak));
+        }
+    }
+
+public:
+    Stream(uint32_t window, uint32_t trend_window, double ewma_alpha)
+        : alpha(std::clamp(ewma_alpha, 1e-6, 1.0)), rolling(window), trend(trend_window) {}
+
+    uint32_t window() const { return rolling.capacity; }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return values.size();
+    }
+
+    void push(const double* profits, const uint8_t* won, size_t count) {
+        if (count == 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t before = values.size();
+
+        // 全体: 1件ならWelford、まとめてならバッチのモーメントを結合する
+        if (count == 1) {
+            double y = profits[0];
+            double n = double(before + 1);
+            double delta = y - mean;
+            mean += delta / n;
+            m2 += delta * (y - mean);
+            lo = before == 0 ? y : std::min(lo, y);
+            hi = before == 0 ? y : std::max(hi, y);
+        } else {
+            double b_mean, b_m2, b_lo, b_hi;
+            moments(profits, count, b_mean, b_m2, b_lo, b_hi);
+            double na = double(before), nb = double(count), n = na + nb;
+            double delta = b_mean - mean;
+            mean += delta * nb / n;
+            m2 += b_m2 + delta * delta * na * nb / n;
+            lo = before == 0 ? b_lo : std::min(lo, b_lo);
+            hi = before == 0 ? b_hi : std::max(hi, b_hi);
+        }
+
+        if (values.capacity() < before + count) {
+            values.reserve(std::max(before + count, values.capacity() * 2));
+        }
+        bool bulk = count >= rolling.capacity && count >= trend.capacity;
+        for (size_t i = 0; i < count; ++i) {
+            values.push_back(profits[i]);
+            if (!bulk) {
+                rolling.push(values);
+                trend.push(values);
+            }
+            push_outcome(profits[i], won != nullptr ? won[i] != 0 : profits[i] > 0.0);
+        }
+        if (bulk) {
+            rolling.rebuild(values);
+            trend.rebuild(values);
+        }
+    }
+
+    State state() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        State s = {};
+        uint64_t n = values.size();
+        s.hands = n;
+        if (n == 0) return s;
+
+        s.total = mean * double(n);
+        s.mean = mean;
+        s.std_dev = std::sqrt(m2 / double(n));
+        s.min = lo;
+        s.max = hi;
+        double se = s.std_dev / std::sqrt(double(n));
+        s.mean_low = mean - Z95 * se;
+        s.mean_high = mean + Z95 * se;
+
+        s.rolling_count = rolling.count;
+        s.rolling_mean = rolling.mean();
+        s.rolling_std = std::sqrt(rolling.variance());
+        double rolling_se = s.rolling_std / std::sqrt(double(rolling.count));
+        s.rolling_low = s.rolling_mean - Z95 * rolling_se;
+        s.rolling_high = s.rolling_mean + Z95 * rolling_se;
+
+        s.ewma = ewma;
+        s.ewma_std = std::sqrt(ew_variance);
+
+        // 直近trend_window件の線形回帰（x = 0..k-1）
+        double k = double(trend.count);
+        s.trend_count = trend.count;
+        s.trend_mean = trend.mean();
+        s.trend_std = std::sqrt(trend.variance());
+        s.p_value = 1.0;
+        if (trend.count >= 2) {
+            double sx = k * (k - 1.0) / 2.0;
+            double sxx = (k - 1.0) * k * (2.0 * k - 1.0) / 6.0 - sx * sx / k;
+            double sxy = trend.sum_xy - sx * trend.sum / k;
+            double syy = std::max(0.0, trend.sum_sq - trend.sum * trend.sum / k);
+            s.slope = sxy / sxx;
+            s.intercept = (trend.sum - s.slope * sx) / k;
+            double r = syy > 0.0 ? std::clamp(sxy / std::sqrt(sxx * syy), -1.0, 1.0) : 0.0;
+            s.r_squared = r * r;
+            if (trend.count > 2 && syy > 0.0) {
+                double df = k - 2.0;
+                if (s.r_squared >= 1.0) {
+                    s.p_value = 0.0;
+                } else {
+                    double t = r * std::sqrt(df / (1.0 - s.r_squared));
+                    s.p_value = t_two_sided_p(t, df);
+                }
+            }
+        }
+
+        s.streak = streak;
+        s.max_win_streak = max_win;
+        s.max_lose_streak = max_lose;
+        return s;
+    }
+
+    // 全履歴の移動平均（先頭からcapacity件）
+    size_t rolling_series(uint32_t window, double* out, size_t capacity) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t n = values.size();
+        if (window == 0) window = rolling.capacity;
+        std::vector<double> prefix(n + 1, 0.0);
+        for (size_t i = 0; i < n; ++i) prefix[i + 1] = prefix[i] + values[i];
+        if (capacity >= n) {
+            rolling_mean(prefix.data(), n, window, out);
+        } else {
+            std::vector<double> all(n);
+            rolling_mean(prefix.data(), n, window, all.data());
+            std::copy(all.begin(), all.begin() + capacity, out);
+        }
+        return n;
+    }
+
+    void percentiles(const double* q, int count, double* out) const {
+        std::vector<double> sorted;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sorted = values;
+        }
+        if (sorted.empty()) {
+            std::fill(out, out + count, 0.0);
+            return;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        size_t n = sorted.size();
+        for (int i = 0; i < count; ++i) {
+            double pos = std::clamp(q[i], 0.0, 100.0) / 100.0 * double(n - 1);
+            size_t below = static_cast<size_t>(pos);
+            size_t above = std::min(below + 1, n - 1);
+            double frac = pos - double(below);
+            out[i] = sorted[below] + (sorted[above] - sorted[below]) * frac;
+        }
+    }
+};
+
+} // namespace PerformanceStream
+
+extern "C" {
+    using namespace PerformanceStream;
+
+    void* performance_stream_create(uint32_t window, uint32_t trend_window, double ewma_alpha) {
+        return new Stream(window, trend_window, ewma_alpha);
+    }
+
+    void performance_stream_destroy(void* handle) {
+        delete static_cast<Stream*>(handle);
+    }
+
+    void performance_stream_push(void* handle, const double* profits, const uint8_t* won,
+                                 int64_t count) {
+        if (count > 0) static_cast<Stream*>(handle)->push(profits, won, static_cast<size_t>(count));
+    }
+
+    uint64_t performance_stream_count(void* handle) {
+        return static_cast<Stream*>(handle)->size();
+    }
+
+    void performance_stream_state(void* handle, PokerPerformanceState* out) {
+        *out = static_cast<Stream*>(handle)->state();
+    }
+
+    int64_t performance_stream_rolling(void* handle, uint32_t window, double* out, int64_t capacity) {
+        return static_cast<int64_t>(static_cast<Stream*>(handle)->rolling_series(
+            window, out, static_cast<size_t>(std::max<int64_t>(capacity, 0))));
+    }
+
+    void performance_stream_percentiles(void* handle, const double* q, int count, double* out) {
+        static_cast<Stream*>(handle)->percentiles(q, count, out);
+    }
+}
+
+#endif // POKER_STEP57_PERFORMANCE_STREAM_CPP
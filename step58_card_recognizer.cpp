@@ -0,0 +1,546 @@
+// step58_card_recognizer.cpp
+// 画面キャプチャのカード認識（gui/auto_capture_system.py のカードごとのTesseract OCRの置き換え）
+// テーブルのスキンごとに、ラベル付きのカード画像からランク13種・スート4種のテンプレートを学習する:
+//   切り出し  カード矩形のうちレイアウトで指定したランク・スートの領域
+//   二値化    大津の方法で閾値を決め、少ない側をインクとする（暗い背景のスキンでも同じ）
+//   正規化    インクの外接矩形を16x16に縮小した被覆率（位置・大きさ・太さの違いを吸収）
+//   照合      正規化相互相関（平均0・ノルム1に揃えた256要素の内積）か、
+//             被覆率を2値化した256bitハッシュのハミング距離
+//   スート    形に加えてインクの色（輝度からの差）をテンプレートの色と比べる（赤黒・4色デッキ）
+// テンプレートは学習した被覆率の平均。保存ファイルには合計を残し、読み込み後も追加で学習できる。
+// 1枚あたり数千ピクセルの走査と17個のテンプレートとの内積で済むので、1フレームの全カードをまとめて
+// 数マイクロ秒〜数十マイクロ秒で認識する。
+#ifndef POKER_STEP58_CARD_RECOGNIZER_CPP
+#define POKER_STEP58_CARD_RECOGNIZER_CPP
+
+#include "poker_engine.h"
+#include "step1_card_system_advanced.cpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace CardRecognizer {
+
+using namespace PokerCore;
+
+constexpr int GLYPH_SIDE = 16;
+constexpr int GLYPH_PIXELS = GLYPH_SIDE * GLYPH_SIDE;
+constexpr int HASH_WORDS = GLYPH_PIXELS / 64;
+constexpr int LANES = 16;                           // 内積の部分和のレーン数（AVX-512の単精度16要素）
+constexpr int CLASS_COUNT = RANK_COUNT + SUIT_COUNT;   // 0-12: ランク, 13-16: スート
+constexpr int MIN_CONTRAST = 32;                    // 領域内の輝度差がこれ未満なら何も無いとみなす
+constexpr int MIN_INK_PIXELS = 4;
+constexpr float AMBIGUITY_MARGIN = 0.2f;            // 2番目との差がこれ未満なら確信度を下げる
+constexpr float COLOR_WEIGHT = 2.0f;                // スートの色の差を類似度から引く重み
+
+enum Method { METHOD_NCC = 0, METHOD_HAMMING = 1 };
+
+// 既定の配置: 旧実装（64x96に縮小して rank=[5:25, 5:25], suit=[25:45, 5:25]）と同じ位置
+constexpr PokerCardLayout DEFAULT_LAYOUT = {
+    {5.0f / 64, 5.0f / 96, 25.0f / 64, 25.0f / 96},
+    {5.0f / 64, 25.0f / 96, 25.0f / 64, 45.0f / 96},
+};
+
+inline bool valid_box(const float* box) {
+    return box[0] >= 0.0f && box[1] >= 0.0f && box[2] <= 1.0f && box[3] <= 1.0f &&
+           box[0] < box[2] && box[1] < box[3];
+}
+
+inline bool valid_layout(const PokerCardLayout& layout) {
+    return valid_box(layout.rank_box) && valid_box(layout.suit_box);
+}
+
+// ===== グリフの抽出 =====
+
+struct Glyph {
+    alignas(64) float coverage[GLYPH_PIXELS];     // 各マスのインクの割合（0-1）
+    alignas(64) float normalized[GLYPH_PIXELS];   // 平均0・ノルム1（全て同じ値なら0）
+    uint64_t hash[HASH_WORDS];                    // coverage >= 0.5
+    float chroma[3];                              // インクのB,G,Rと輝度の差の平均（0-1）
+};
+
+// 1フレーム分の作業領域（呼び出しごとに確保し、カード間で使い回す）
+struct Scratch {
+    std::vector<uint8_t> gray;
+    std::vector<uint8_t> ink;
+};
+
+inline void finish_glyph(Glyph& g) {
+    float mean = 0.0f;
+    for (float v : g.coverage) mean += v;
+    mean /= GLYPH_PIXELS;
+    float norm = 0.0f;
+    for (int i = 0; i < GLYPH_PIXELS; ++i) {
+        g.normalized[i] = g.coverage[i] - mean;
+        norm += g.normalized[i] * g.normalized[i];
+    }
+    float scale = norm > 1e-12f ? 1.0f / std::sqrt(norm) : 0.0f;
+    for (float& v : g.normalized) v *= scale;
+    std::fill(std::begin(g.hash), std::end(g.hash), 0);
+    for (int i = 0; i < GLYPH_PIXELS; ++i) {
+        if (g.coverage[i] >= 0.5f) g.hash[i / 64] |= uint64_t(1) << (i % 64);
+    }
+}
+
+// 1行分の輝度（BT.601の整数近似）
+POKER_HOT_KERNEL
+static void luma_row(const uint8_t* row, int channels, int n, uint8_t* dst) {
+    if (channels == 1) {
+        std::memcpy(dst, row, static_cast<size_t>(n));
+    } else if (channels == 3) {
+        for (int x = 0; x < n; ++x) {
+            dst[x] = static_cast<uint8_t>((29 * row[3 * x] + 150 * row[3 * x + 1] + 77 * row[3 * x + 2] + 128) >> 8);
+        }
+    } else {
+        for (int x = 0; x < n; ++x) {
+            dst[x] = static_cast<uint8_t>((29 * row[4 * x] + 150 * row[4 * x + 1] + 77 * row[4 * x + 2] + 128) >> 8);
+        }
+    }
+}
+
+// 輝度のヒストグラム（同じ値が続くと1つの区間への加算が直列になるので4本に分けて足す）
+POKER_HOT_KERNEL
+static void add_histogram(const uint8_t* values, size_t n, uint32_t* histogram) {
+    uint32_t partial[4][256] = {};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        ++partial[0][values[i]];
+        ++partial[1][values[i + 1]];
+        ++partial[2][values[i + 2]];
+        ++partial[3][values[i + 3]];
+    }
+    for (; i < n; ++i) ++partial[0][values[i]];
+    for (int v = 0; v < 256; ++v) histogram[v] += partial[0][v] + partial[1][v] + partial[2][v] + partial[3][v];
+}
+
+// 画像の矩形 (x0, y0, w, h) を大津の方法で二値化し、scratch.grayに輝度、scratch.inkにインク(0/1)を書く。
+// インクは少ない側（白いカードの黒い文字・暗いスキンの明るい文字のどちらも）。コントラストが無ければfalse
+inline bool binarize(const PokerImageView& image, int x0, int y0, int w, int h, Scratch& scratch) {
+    size_t n = static_cast<size_t>(w) * h;
+    scratch.gray.resize(n);
+    scratch.ink.resize(n);
+    uint32_t histogram[256] = {};
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* row = image.pixels + static_cast<size_t>(y0 + y) * image.stride +
+                             static_cast<size_t>(x0) * image.channels;
+        luma_row(row, image.channels, w, scratch.gray.data() + static_cast<size_t>(y) * w);
+    }
+    add_histogram(scratch.gray.data(), n, histogram);
+
+    // 大津の方法（クラス間分散が最大の閾値）
+    int lo = 0, hi = 255;
+    while (histogram[lo] == 0) ++lo;
+    while (histogram[hi] == 0) --hi;
+    if (hi - lo < MIN_CONTRAST) return false;
+    double total = 0.0;
+    for (int v = 0; v < 256; ++v) total += double(v) * histogram[v];
+    double below_count = 0.0, below_sum = 0.0, best = -1.0;
+    int threshold = lo;
+    for (int t = lo; t < hi; ++t) {
+        below_count += histogram[t];
+        below_sum += double(t) * histogram[t];
+        double above_count = double(n) - below_count;
+        double diff = below_sum / below_count - (total - below_sum) / above_count;
+        double between = below_count * above_count * diff * diff;
+        if (between > best) {
+            best = between;
+            threshold = t;
+        }
+    }
+
+    size_t dark = 0;
+    for (int v = 0; v <= threshold; ++v) dark += histogram[v];
+    const bool ink_is_dark = dark * 2 <= n;
+    for (size_t i = 0; i < n; ++i) scratch.ink[i] = (scratch.gray[i] <= threshold) == ink_is_dark;
+    return true;
+}
+
+// カード矩形cardのうちfrac（比率）の領域からグリフを作る。インクが無ければfalse
+inline bool extract_glyph(const PokerImageView& image, const PokerImageBox& card, const float* frac,
+                          Scratch& scratch, Glyph& out) {
+    int x0 = card.x + static_cast<int>(std::lround(frac[0] * card.width));
+    int y0 = card.y + static_cast<int>(std::lround(frac[1] * card.height));
+    int x1 = card.x + static_cast<int>(std::lround(frac[2] * card.width));
+    int y1 = card.y + static_cast<int>(std::lround(frac[3] * card.height));
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, image.width);
+    y1 = std::min(y1, image.height);
+    int w = x1 - x0, h = y1 - y0;
+    if (w < 2 || h < 2) return false;
+    if (!binarize(image, x0, y0, w, h, scratch)) return false;
+
+    int bx0 = w, by0 = h, bx1 = -1, by1 = -1;
+    size_t ink_count = 0;
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* mask = scratch.ink.data() + static_cast<size_t>(y) * w;
+        for (int x = 0; x < w; ++x) {
+            if (mask[x]) {
+                bx0 = std::min(bx0, x);
+                bx1 = std::max(bx1, x);
+                by0 = std::min(by0, y);
+                by1 = std::max(by1, y);
+                ++ink_count;
+            }
+        }
+    }
+    if (ink_count < MIN_INK_PIXELS) return false;
+
+    // インクの色
+    const int channels = image.channels;
+    double chroma[3] = {};
+    if (channels >= 3) {
+        for (int y = by0; y <= by1; ++y) {
+            const uint8_t* row = image.pixels + static_cast<size_t>(y0 + y) * image.stride +
+                                 static_cast<size_t>(x0) * channels;
+            const uint8_t* mask = scratch.ink.data() + static_cast<size_t>(y) * w;
+            const uint8_t* gray = scratch.gray.data() + static_cast<size_t>(y) * w;
+            for (int x = bx0; x <= bx1; ++x) {
+                if (!mask[x]) continue;
+                const uint8_t* p = row + static_cast<size_t>(x) * channels;
+                for (int c = 0; c < 3; ++c) chroma[c] += int(p[c]) - int(gray[x]);
+            }
+        }
+    }
+    for (int c = 0; c < 3; ++c) out.chroma[c] = static_cast<float>(chroma[c] / (255.0 * ink_count));
+
+    // 外接矩形を16x16のマスに分けて被覆率を求める（矩形が16未満の辺は同じ画素を繰り返す）
+    int bw = bx1 - bx0 + 1, bh = by1 - by0 + 1;
+    for (int gy = 0; gy < GLYPH_SIDE; ++gy) {
+        int sy0 = by0 + gy * bh / GLYPH_SIDE;
+        int sy1 = std::max(by0 + (gy + 1) * bh / GLYPH_SIDE, sy0 + 1);
+        for (int gx = 0; gx < GLYPH_SIDE; ++gx) {
+            int sx0 = bx0 + gx * bw / GLYPH_SIDE;
+            int sx1 = std::max(bx0 + (gx + 1) * bw / GLYPH_SIDE, sx0 + 1);
+            int count = 0;
+            for (int y = sy0; y < sy1; ++y) {
+                const uint8_t* mask = scratch.ink.data() + static_cast<size_t>(y) * w;
+                for (int x = sx0; x < sx1; ++x) count += mask[x];
+            }
+            out.coverage[gy * GLYPH_SIDE + gx] =
+                static_cast<float>(count) / static_cast<float>((sy1 - sy0) * (sx1 - sx0));
+        }
+    }
+    finish_glyph(out);
+    return true;
+}
+
+// ===== 照合カーネル =====
+
+// glyphと各テンプレート（classes × 256、連続）の内積
+POKER_HOT_KERNEL
+static void correlate(const float* glyph, const float* templates, int classes, float* out) {
+    for (int c = 0; c < classes; ++c) {
+        const float* t = templates + static_cast<size_t>(c) * GLYPH_PIXELS;
+        float acc[LANES] = {};
+        for (int i = 0; i < GLYPH_PIXELS; i += LANES) {
+            for (int l = 0; l < LANES; ++l) acc[l] += glyph[i + l] * t[i + l];
+        }
+        float sum = 0.0f;
+        for (int l = 0; l < LANES; ++l) sum += acc[l];
+        out[c] = sum;
+    }
+}
+
+// ハミング距離を相関と同じ -1〜1 の類似度にする
+inline float hash_similarity(const uint64_t* a, const uint64_t* b) {
+    int distance = 0;
+    for (int i = 0; i < HASH_WORDS; ++i) distance += __builtin_popcountll(a[i] ^ b[i]);
+    return 1.0f - 2.0f * static_cast<float>(distance) / GLYPH_PIXELS;
+}
+
+// 最良・次点から確信度（類似度が高く、次点との差が十分なほど1に近い）
+inline float confidence(float best, float second) {
+    float margin = std::min(1.0f, std::max(0.0f, best - second) / AMBIGUITY_MARGIN);
+    return std::clamp(best, 0.0f, 1.0f) * margin;
+}
+
+// ===== ファイル形式 =====
+//   FileHeader
+//   SavedClass classes[CLASS_COUNT]（ランク13種、スート4種の順）
+constexpr char FILE_MAGIC[8] = {'P', 'K', 'C', 'A', 'R', 'D', 'T', 'M'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t class_count;
+    PokerCardLayout layout;
+    uint64_t padding[2];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout must stay stable");
+
+// 学習サンプルの合計（平均がテンプレート）
+struct SavedClass {
+    uint64_t samples;
+    double chroma_sum[3];
+    double coverage_sum[GLYPH_PIXELS];
+};
+static_assert(sizeof(SavedClass) == 32 + 8 * GLYPH_PIXELS, "SavedClass layout must stay stable");
+
+// ===== 認識器 =====
+class Recognizer {
+private:
+    mutable std::shared_mutex mutex;
+    PokerCardLayout layout;
+    std::array<SavedClass, CLASS_COUNT> sums = {};
+    // 合計から作ったテンプレート（照合用）
+    alignas(64) float templates[CLASS_COUNT][GLYPH_PIXELS] = {};
+    uint64_t hashes[CLASS_COUNT][HASH_WORDS] = {};
+    float chromas[CLASS_COUNT][3] = {};
+
+    void rebuild(int cls) {
+        const SavedClass& s = sums[cls];
+        Glyph g;
+        double inv = s.samples ? 1.0 / double(s.samples) : 0.0;
+        for (int i = 0; i < GLYPH_PIXELS; ++i) g.coverage[i] = static_cast<float>(s.coverage_sum[i] * inv);
+        finish_glyph(g);
+        std::copy(std::begin(g.normalized), std::end(g.normalized), templates[cls]);
+        std::copy(std::begin(g.hash), std::end(g.hash), hashes[cls]);
+        for (int c = 0; c < 3; ++c) chromas[cls][c] = static_cast<float>(s.chroma_sum[c] * inv);
+    }
+
+    void add(int cls, const Glyph& g) {
+        SavedClass& s = sums[cls];
+        ++s.samples;
+        for (int c = 0; c < 3; ++c) s.chroma_sum[c] += g.chroma[c];
+        for (int i = 0; i < GLYPH_PIXELS; ++i) s.coverage_sum[i] += g.coverage[i];
+        rebuild(cls);
+    }
+
+    // first..first+classes-1 のうち学習済みのクラスで最良・次点を選ぶ
+    void best_of(const Glyph& g, int first, int classes, int method, bool use_color,
+                 int& best_class, float& best, float& second) const {
+        float scores[CLASS_COUNT];
+        if (method == METHOD_HAMMING) {
+            for (int c = 0; c < classes; ++c) scores[c] = hash_similarity(g.hash, hashes[first + c]);
+        } else {
+            correlate(g.normalized, templates[first], classes, scores);
+        }
+        best_class = -1;
+        best = -1.0f;
+        second = -1.0f;
+        for (int c = 0; c < classes; ++c) {
+            if (sums[first + c].samples == 0) continue;
+            float score = scores[c];
+            if (use_color) {
+                const float* t = chromas[first + c];
+                float dist = std::sqrt((g.chroma[0] - t[0]) * (g.chroma[0] - t[0]) +
+                                       (g.chroma[1] - t[1]) * (g.chroma[1] - t[1]) +
+                                       (g.chroma[2] - t[2]) * (g.chroma[2] - t[2]));
+                score = std::max(score - COLOR_WEIGHT * dist, -1.0f);
+            }
+            if (score > best) {
+                second = best;
+                best = score;
+                best_class = c;
+            } else if (score > second) {
+                second = score;
+            }
+        }
+    }
+
+public:
+    explicit Recognizer(const PokerCardLayout& layout) : layout(layout) {}
+
+    bool learn(const PokerImageView& image, const PokerImageBox& box, int card, std::string& error) {
+        if (card < 0 || card >= DECK_SIZE) {
+            error = "invalid card id " + std::to_string(card);
+            return false;
+        }
+        Scratch scratch;
+        Glyph rank, suit;
+        if (!extract_glyph(image, box, layout.rank_box, scratch, rank)) {
+            error = "no rank glyph found in the rank box";
+            return false;
+        }
+        if (!extract_glyph(image, box, layout.suit_box, scratch, suit)) {
+            error = "no suit glyph found in the suit box";
+            return false;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        add(get_rank(static_cast<Card>(card)), rank);
+        add(RANK_COUNT + get_suit(static_cast<Card>(card)), suit);
+        return true;
+    }
+
+    size_t match(const PokerImageView& image, const PokerImageBox* boxes, size_t count, int method,
+                 PokerCardMatch* out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        Scratch scratch;
+        Glyph rank, suit;
+        size_t recognized = 0;
+        for (size_t i = 0; i < count; ++i) {
+            PokerCardMatch& m = out[i];
+            m = {};
+            m.card = -1;
+            m.rank = -1;
+            m.suit = -1;
+            m.rank_score = -1.0f;
+            m.suit_score = -1.0f;
+            if (!extract_glyph(image, boxes[i], layout.rank_box, scratch, rank) ||
+                !extract_glyph(image, boxes[i], layout.suit_box, scratch, suit)) {
+                continue;
+            }
+            int r, s;
+            float rank_second, suit_second;
+            best_of(rank, 0, RANK_COUNT, method, false, r, m.rank_score, rank_second);
+            best_of(suit, RANK_COUNT, SUIT_COUNT, method, image.channels >= 3, s, m.suit_score,
+                    suit_second);
+            if (r < 0 || s < 0) continue;
+            m.rank = static_cast<int8_t>(r);
+            m.suit = static_cast<int8_t>(s);
+            m.card = make_card(static_cast<Rank>(r), static_cast<Suit>(s));
+            m.confidence = std::min(confidence(m.rank_score, rank_second),
+                                    confidence(m.suit_score, suit_second));
+            ++recognized;
+        }
+        return recognized;
+    }
+
+    void samples(uint32_t* ranks, uint32_t* suits) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (int r = 0; r < RANK_COUNT; ++r) ranks[r] = static_cast<uint32_t>(sums[r].samples);
+        for (int s = 0; s < SUIT_COUNT; ++s) suits[s] = static_cast<uint32_t>(sums[RANK_COUNT + s].samples);
+    }
+
+    // ファイルへ保存（一時ファイルに書いてからrename）
+    bool save(const std::string& path, std::string& error) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        FileHeader header = {};
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.format_version = FORMAT_VERSION;
+        header.class_count = CLASS_COUNT;
+        header.layout = layout;
+
+        std::string tmp = path + ".tmp";
+        FILE* fp = std::fopen(tmp.c_str(), "wb");
+        if (fp == nullptr) {
+            error = "cannot create " + tmp;
+            return false;
+        }
+        bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1;
+        ok = ok && std::fwrite(sums.data(), sizeof(SavedClass), sums.size(), fp) == sums.size();
+        ok = (std::fflush(fp) == 0) && ok;
+        ok = (fsync(fileno(fp)) == 0) && ok;
+        ok = (std::fclose(fp) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            error = "failed to write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    static std::unique_ptr<Recognizer> open(const std::string& path, std::string& error) {
+        FILE* fp = std::fopen(path.c_str(), "rb");
+        if (fp == nullptr) {
+            error = "cannot open " + path;
+            return nullptr;
+        }
+        std::unique_ptr<FILE, int (*)(FILE*)> guard(fp, std::fclose);
+        FileHeader header;
+        if (std::fread(&header, sizeof(header), 1, fp) != 1) {
+            error = "file too small: " + path;
+            return nullptr;
+        }
+        if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            error = "bad magic";
+            return nullptr;
+        }
+        if (header.format_version != FORMAT_VERSION) {
+            error = "unsupported format version";
+            return nullptr;
+        }
+        if (header.class_count != CLASS_COUNT || !valid_layout(header.layout)) {
+            error = "corrupt header";
+            return nullptr;
+        }
+        auto recognizer = std::make_unique<Recognizer>(header.layout);
+        if (std::fread(recognizer->sums.data(), sizeof(SavedClass), CLASS_COUNT, fp) != CLASS_COUNT) {
+            error = "file size does not match header";
+            return nullptr;
+        }
+        for (int c = 0; c < CLASS_COUNT; ++c) recognizer->rebuild(c);
+        return recognizer;
+    }
+};
+
+// 直近のエラーメッセージ（C ABI用、スレッドごと）
+inline std::string& recognizer_error() {
+    thread_local std::string message;
+    return message;
+}
+
+inline bool valid_image(const PokerImageView& image) {
+    if (image.pixels == nullptr || image.width <= 0 || image.height <= 0 ||
+        (image.channels != 1 && image.channels != 3 && image.channels != 4) ||
+        image.stride < image.width * image.channels) {
+        recognizer_error() = "invalid image";
+        return false;
+    }
+    return true;
+}
+
+} // namespace CardRecognizer
+
+extern "C" {
+    using namespace CardRecognizer;
+
+    void* card_recognizer_create(const PokerCardLayout* layout) {
+        PokerCardLayout l = layout ? *layout : DEFAULT_LAYOUT;
+        auto unset = [](const float* box) { return box[0] == 0 && box[1] == 0 && box[2] == 0 && box[3] == 0; };
+        if (unset(l.rank_box)) std::copy(DEFAULT_LAYOUT.rank_box, DEFAULT_LAYOUT.rank_box + 4, l.rank_box);
+        if (unset(l.suit_box)) std::copy(DEFAULT_LAYOUT.suit_box, DEFAULT_LAYOUT.suit_box + 4, l.suit_box);
+        if (!valid_layout(l)) {
+            recognizer_error() = "layout boxes must lie within the card (0 <= x0 < x1 <= 1)";
+            return nullptr;
+        }
+        return new Recognizer(l);
+    }
+
+    void* card_recognizer_open(const char* path) {
+        return Recognizer::open(path, recognizer_error()).release();
+    }
+
+    void card_recognizer_close(void* handle) {
+        delete static_cast<Recognizer*>(handle);
+    }
+
+    int card_recognizer_save(void* handle, const char* path) {
+        return static_cast<Recognizer*>(handle)->save(path, recognizer_error()) ? 0 : -1;
+    }
+
+    int card_recognizer_learn(void* handle, const PokerImageView* image, const PokerImageBox* box,
+                              int card) {
+        if (!valid_image(*image)) return -1;
+        PokerImageBox whole = {0, 0, image->width, image->height};
+        return static_cast<Recognizer*>(handle)->learn(*image, box ? *box : whole, card,
+                                                        recognizer_error()) ? 0 : -1;
+    }
+
+    int64_t card_recognizer_match(void* handle, const PokerImageView* image, const PokerImageBox* boxes,
+                                  int64_t count, int method, PokerCardMatch* out) {
+        if (count <= 0 || !valid_image(*image)) return 0;
+        return static_cast<int64_t>(static_cast<Recognizer*>(handle)->match(
+            *image, boxes, static_cast<size_t>(count), method, out));
+    }
+
+    void card_recognizer_samples(void* handle, uint32_t* ranks, uint32_t* suits) {
+        static_cast<Recognizer*>(handle)->samples(ranks, suits);
+    }
+
+    const char* card_recognizer_error(void) {
+        return recognizer_error().c_str();
+    }
+}
+
+#endif // POKER_STEP58_CARD_RECOGNIZER_CPP
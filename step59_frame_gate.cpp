@@ -0,0 +1,247 @@
+// step59_frame_gate.cpp
+// 画面キャプチャの変化検出（gui/auto_capture_system.py の capture_loop の前段）
+// テーブル上の注目領域（ヒーローのカード・ボード・ポット・各席など）をタイルに分け、
+// タイルごとに知覚ハッシュを求めて前のフレームと比べる:
+//   縮小      タイルを8x8のマスに分けた輝度の平均（列ごとの部分和を行ごとに足す自動ベクトル化カーネル）
+//   ハッシュ  64bitの平均ハッシュ（マスの輝度 > タイルの平均輝度）と8x8の縮小画像そのもの
+//   判定      ハミング距離がhash_thresholdを超えるか、どれかのマスの輝度の差がcell_thresholdを
+//             超えたら変化（平均ハッシュだけでは金額の1桁の書き換えのような小さな変化を取りこぼす）
+// 変化した領域だけを呼び出し側で抽出し直せばよく、静止中のフレームは輝度の足し算だけで捨てられる。
+#ifndef POKER_STEP59_FRAME_GATE_CPP
+#define POKER_STEP59_FRAME_GATE_CPP
+
+#include "poker_engine.h"
+#include "step1_card_system_advanced.cpp"
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace FrameGate {
+
+constexpr int THUMB_SIDE = 8;
+constexpr int THUMB_CELLS = THUMB_SIDE * THUMB_SIDE;
+constexpr int MIN_TILE = THUMB_SIDE;
+constexpr int MAX_TILE = 256;                 // 列の部分和(uint32)が溢れない上限
+constexpr int LUMA_SCALE = 256;               // 輝度は256倍の整数（BT.601の整数近似）のまま足す
+
+// ===== 縮小カーネル =====
+
+// 1行分の輝度（256倍）を列ごとの部分和へ足す
+POKER_HOT_KERNEL
+static void accumulate_row(const uint8_t* row, int channels, int n, uint32_t* sums) {
+    if (channels == 1) {
+        for (int x = 0; x < n; ++x) sums[x] += uint32_t(row[x]) * LUMA_SCALE;
+    } else if (channels == 3) {
+        for (int x = 0; x < n; ++x) {
+            sums[x] += 29u * row[3 * x] + 150u * row[3 * x + 1] + 77u * row[3 * x + 2];
+        }
+    } else {
+        for (int x = 0; x < n; ++x) {
+            sums[x] += 29u * row[4 * x] + 150u * row[4 * x + 1] + 77u * row[4 * x + 2];
+        }
+    }
+}
+
+// 列の部分和の区間和
+POKER_HOT_KERNEL
+static uint64_t range_sum(const uint32_t* sums, int begin, int end) {
+    uint64_t total = 0;
+    for (int x = begin; x < end; ++x) total += sums[x];
+    return total;
+}
+
+// 2つの縮小画像のマスごとの輝度の差の最大
+POKER_HOT_KERNEL
+static int max_cell_difference(const uint8_t* a, const uint8_t* b) {
+    int result = 0;
+    for (int i = 0; i < THUMB_CELLS; ++i) result = std::max(result, std::abs(int(a[i]) - int(b[i])));
+    return result;
+}
+
+// マスの区間（辺が8未満のタイルは同じ画素を繰り返す）
+inline void cell_range(int start, int length, int cell, int& begin, int& end) {
+    begin = start + cell * length / THUMB_SIDE;
+    end = std::max(start + (cell + 1) * length / THUMB_SIDE, begin + 1);
+}
+
+// ===== 領域 =====
+
+struct Region {
+    PokerImageBox box;
+    int tile_size;
+    std::vector<uint64_t> hashes;     // タイルごと（行優先）
+    std::vector<uint8_t> thumbs;      // タイルごとの8x8縮小（64バイト）
+    bool hashed = false;              // 前のフレームのハッシュがあるか
+};
+
+class Gate {
+private:
+    mutable std::mutex mutex;
+    int hash_threshold;
+    int cell_threshold;
+    std::vector<Region> regions;
+    int32_t frame_width = 0, frame_height = 0;
+    std::vector<uint32_t> column_sums;
+    std::vector<uint8_t> row_thumbs;  // 1タイル行分の8x8縮小
+
+    // 1領域のハッシュを更新して変化したタイル数を返す
+    int update_region(const PokerImageView& frame, Region& region) {
+        int x0 = std::max(region.box.x, 0), y0 = std::max(region.box.y, 0);
+        int x1 = std::min(region.box.x + region.box.width, frame.width);
+        int y1 = std::min(region.box.y + region.box.height, frame.height);
+        if (x1 <= x0 || y1 <= y0) return 0;
+        const int w = x1 - x0, h = y1 - y0;
+        const int tile = region.tile_size;
+        const int tiles_x = (w + tile - 1) / tile, tiles_y = (h + tile - 1) / tile;
+        const size_t tile_count = static_cast<size_t>(tiles_x) * tiles_y;
+        if (region.hashes.size() != tile_count) {
+            region.hashes.assign(tile_count, 0);
+            region.thumbs.assign(tile_count * THUMB_CELLS, 0);
+            region.hashed = false;
+        }
+        column_sums.resize(static_cast<size_t>(w));
+        row_thumbs.resize(static_cast<size_t>(tiles_x) * THUMB_CELLS);
+
+        int changed = 0;
+        for (int ty = 0; ty < tiles_y; ++ty) {
+            const int tile_y = ty * tile, tile_h = std::min(tile, h - tile_y);
+            for (int cy = 0; cy < THUMB_SIDE; ++cy) {
+                int row_begin, row_end;
+                cell_range(tile_y, tile_h, cy, row_begin, row_end);
+                std::fill(column_sums.begin(), column_sums.end(), 0u);
+                for (int y = row_begin; y < row_end; ++y) {
+                    const uint8_t* row = frame.pixels + static_cast<size_t>(y0 + y) * frame.stride +
+                                         static_cast<size_t>(x0) * frame.channels;
+                    accumulate_row(row, frame.channels, w, column_sums.data());
+                }
+                for (int tx = 0; tx < tiles_x; ++tx) {
+                    const int tile_x = tx * tile, tile_w = std::min(tile, w - tile_x);
+                    uint8_t* thumb = row_thumbs.data() + static_cast<size_t>(tx) * THUMB_CELLS;
+                    for (int cx = 0; cx < THUMB_SIDE; ++cx) {
+                        int col_begin, col_end;
+                        cell_range(tile_x, tile_w, cx, col_begin, col_end);
+                        uint64_t area = uint64_t(col_end - col_begin) * (row_end - row_begin) * LUMA_SCALE;
+                        thumb[cy * THUMB_SIDE + cx] = static_cast<uint8_t>(
+                            range_sum(column_sums.data(), col_begin, col_end) / area);
+                    }
+                }
+            }
+            for (int tx = 0; tx < tiles_x; ++tx) {
+                const uint8_t* thumb = row_thumbs.data() + static_cast<size_t>(tx) * THUMB_CELLS;
+                uint32_t total = 0;
+                for (int i = 0; i < THUMB_CELLS; ++i) total += thumb[i];
+                uint64_t hash = 0;
+                for (int i = 0; i < THUMB_CELLS; ++i) {
+                    if (uint32_t(thumb[i]) * THUMB_CELLS > total) hash |= uint64_t(1) << i;
+                }
+                size_t index = static_cast<size_t>(ty) * tiles_x + tx;
+                uint8_t* previous = region.thumbs.data() + index * THUMB_CELLS;
+                if (!region.hashed ||
+                    __builtin_popcountll(hash ^ region.hashes[index]) > hash_threshold ||
+                    max_cell_difference(thumb, previous) > cell_threshold) {
+                    ++changed;
+                }
+                region.hashes[index] = hash;
+                std::copy(thumb, thumb + THUMB_CELLS, previous);
+            }
+        }
+        region.hashed = true;
+        return changed;
+    }
+
+public:
+    Gate(int hash_threshold, int cell_threshold)
+        : hash_threshold(std::max(hash_threshold, 0)), cell_threshold(std::max(cell_threshold, 0)) {}
+
+    int add_region(const PokerImageBox& box, int tile_size) {
+        if (box.width <= 0 || box.height <= 0) return -1;
+        std::lock_guard<std::mutex> lock(mutex);
+        Region region;
+        region.box = box;
+        region.tile_size = std::clamp(tile_size, MIN_TILE, MAX_TILE);
+        regions.push_back(std::move(region));
+        return static_cast<int>(regions.size() - 1);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        regions.clear();
+    }
+
+    // 次のupdateで全ての領域を変化ありとする
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Region& region : regions) region.hashed = false;
+    }
+
+    int size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return static_cast<int>(regions.size());
+    }
+
+    // 領域のタイル数（まだupdateしていなければ0）
+    int tiles(int region) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return static_cast<int>(regions[static_cast<size_t>(region)].hashes.size());
+    }
+
+    // changed_tiles[i]: 領域iで変化したタイル数（NULL可）。戻り値は変化した領域の数
+    int update(const PokerImageView& frame, int32_t* changed_tiles) {
+        std::lock_guard<std::mutex> lock(mutex);
+        // 画面の大きさが変わったら座標が対応しないので全て変化とする
+        if (frame.width != frame_width || frame.height != frame_height) {
+            frame_width = frame.width;
+            frame_height = frame.height;
+            for (Region& region : regions) region.hashed = false;
+        }
+        int changed_regions = 0;
+        for (size_t i = 0; i < regions.size(); ++i) {
+            int changed = update_region(frame, regions[i]);
+            if (changed_tiles) changed_tiles[i] = changed;
+            changed_regions += changed > 0;
+        }
+        return changed_regions;
+    }
+};
+
+} // namespace FrameGate
+
+extern "C" {
+    using namespace FrameGate;
+
+    void* frame_gate_create(int hash_threshold, int cell_threshold) {
+        return new Gate(hash_threshold, cell_threshold);
+    }
+
+    void frame_gate_destroy(void* handle) {
+        delete static_cast<Gate*>(handle);
+    }
+
+    int frame_gate_add_region(void* handle, const PokerImageBox* box, int tile_size) {
+        return static_cast<Gate*>(handle)->add_region(*box, tile_size);
+    }
+
+    void frame_gate_clear(void* handle) {
+        static_cast<Gate*>(handle)->clear();
+    }
+
+    void frame_gate_reset(void* handle) {
+        static_cast<Gate*>(handle)->reset();
+    }
+
+    int frame_gate_region_count(void* handle) {
+        return static_cast<Gate*>(handle)->size();
+    }
+
+    int frame_gate_update(void* handle, const PokerImageView* frame, int32_t* changed_tiles) {
+        if (frame->pixels == nullptr || frame->width <= 0 || frame->height <= 0 ||
+            (frame->channels != 1 && frame->channels != 3 && frame->channels != 4) ||
+            frame->stride < frame->width * frame->channels) {
+            return -1;
+        }
+        return static_cast<Gate*>(handle)->update(*frame, changed_tiles);
+    }
+}
+
+#endif // POKER_STEP59_FRAME_GATE_CPP
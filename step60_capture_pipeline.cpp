@@ -0,0 +1,635 @@
+// step60_capture_pipeline.cpp
+// 複数テーブルの画面キャプチャのパイプライン（gui/multi_table_capture.py の段の間の受け渡し）
+// 画像処理（テーブル検出・OCR・カード認識）はPython側のワーカーが行い、ここでは段の間の受け渡しと
+// 優先順位・フレームの間引きを受け持つ:
+//   取り込み  submit（1スレッド）: テーブルごとのFrameGate(step59)で変化した領域を求め、
+//             変化したテーブルの矩形だけをバッファのプールへコピーして抽出待ちにする
+//   抽出      next_job（複数ワーカー）: テーブルごとに最新の画像だけを保持する郵便受け。
+//             処理待ちの間に新しいフレームが来たら古い画像を捨て、変化した領域を合わせる。
+//             同じテーブルを2つのワーカーが同時に処理することは無いので、使用中のバッファは
+//             1テーブルあたり最大2つ（処理待ち・処理中）
+//   再検出    テーブル全体のタイルの大半が一度に変わった時（ウィンドウの移動・開閉）、画面の大きさが
+//             変わった時、それ以外は一定間隔で、フレーム全体でのテーブルの再検出を依頼する
+//             （フレーム全体の画像はテーブル用とは別の小さなプールに入れる）
+//   分析      next_analysis: ヒーローの手番のテーブルを優先する
+// 段の間は有界のロックフリーキュー（Vyukov型MPMC）で、各キューには1テーブル1件までしか入らない。
+// 待ち合わせ（キューが空の時だけ）にはmutexと条件変数を使う。
+#ifndef POKER_STEP60_CAPTURE_PIPELINE_CPP
+#define POKER_STEP60_CAPTURE_PIPELINE_CPP
+
+#include "poker_engine.h"
+#include "step59_frame_gate.cpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace CapturePipeline {
+
+constexpr int MAX_TABLES = 64;
+constexpr int LAYOUT_ID = MAX_TABLES;        // スケジューラ上の再検出の番号
+constexpr int MAX_REGIONS = 48;              // 1テーブルの領域数（郵便受けのビット数）
+constexpr int TABLE_BUFFERS = 4 * MAX_TABLES;       // テーブルごと2つ + 余裕
+constexpr int LAYOUT_BUFFERS = 4;                   // 再検出（フレーム全体）専用
+constexpr int MAX_BUFFERS = TABLE_BUFFERS + LAYOUT_BUFFERS;
+constexpr size_t SHRINK_FACTOR = 2;                 // 必要量のこの倍より大きいバッファは確保し直す
+constexpr int LAYOUT_TILE = 64;              // テーブル全体の変化を見るタイル
+constexpr int REGION_TILE = 32;
+constexpr uint64_t MASK_BITS = (uint64_t(1) << MAX_REGIONS) - 1;
+
+enum JobKind { JOB_EXTRACT = 0, JOB_LAYOUT = 1 };
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ===== 有界ロックフリーキュー（複数生産者・複数消費者） =====
+template <typename T>
+class BoundedQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueue_pos{0};
+    alignas(64) std::atomic<size_t> dequeue_pos{0};
+
+public:
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool try_push(const T& value) {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // 満杯
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& value) {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // 空
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// ===== テーブル番号の2段階キュー（急ぎ・通常、各キューに1テーブル1件まで） =====
+class TableScheduler {
+private:
+    static constexpr uint8_t QUEUED_NORMAL = 1, QUEUED_URGENT = 2;
+    BoundedQueue<uint16_t> urgent{MAX_TABLES + 1};
+    BoundedQueue<uint16_t> normal{MAX_TABLES + 1};
+    std::atomic<uint8_t> queued[MAX_TABLES + 1] = {};
+
+public:
+    void push(int table, bool is_urgent) {
+        uint8_t bit = is_urgent ? QUEUED_URGENT : QUEUED_NORMAL;
+        if (queued[table].fetch_or(bit) & bit) return;   // 既に入っている
+        (is_urgent ? urgent : normal).try_push(static_cast<uint16_t>(table));
+    }
+
+    bool try_pop(int& table) {
+        uint16_t id;
+        if (urgent.try_pop(id)) {
+            queued[id].fetch_and(static_cast<uint8_t>(~QUEUED_URGENT));
+        } else if (normal.try_pop(id)) {
+            queued[id].fetch_and(static_cast<uint8_t>(~QUEUED_NORMAL));
+        } else {
+            return false;
+        }
+        table = id;
+        return true;
+    }
+};
+
+// キューが空の時の待ち合わせ
+class Parking {
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<int> waiters{0};
+
+public:
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load() > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        }
+    }
+
+    // try_getが成功するか、停止か、timeout_msが過ぎるまで待つ
+    template <typename F>
+    bool wait(F&& try_get, const std::atomic<bool>& stopped, int timeout_ms) {
+        if (try_get()) return true;
+        if (timeout_ms <= 0 || stopped.load()) return false;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        std::unique_lock<std::mutex> lock(mutex);
+        waiters.fetch_add(1);
+        bool got = false;
+        while (!(got = try_get()) && !stopped.load()) {
+            if (cv.wait_until(lock, deadline) == std::cv_status::timeout) {
+                got = try_get();
+                break;
+            }
+        }
+        waiters.fetch_sub(1);
+        return got;
+    }
+};
+
+// ===== バッファとテーブル =====
+
+// 空いているバッファ番号（後に返ったものから使う）。よく使うバッファだけが画素を持ち、
+// 使われないバッファは確保しないままになる
+class FreeList {
+private:
+    std::mutex mutex;
+    std::vector<uint32_t> stack;
+
+public:
+    void push(uint32_t index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stack.push_back(index);
+    }
+
+    bool try_pop(uint32_t& index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stack.empty()) return false;
+        index = stack.back();
+        stack.pop_back();
+        return true;
+    }
+};
+
+// テーブルの矩形（再検出はフレーム全体）を切り出した画像
+struct Buffer {
+    std::vector<uint8_t> pixels;
+    PokerImageBox box = {};                 // フレーム上の位置
+    int32_t channels = 0;
+    uint64_t sequence = 0;
+    int64_t grabbed_ns = 0;
+    std::atomic<int> refs{0};
+};
+
+// 郵便受け: 0=空、それ以外は (バッファ番号+1) << 48 | 変化した領域のビット
+inline uint64_t pack_mail(uint32_t buffer, uint64_t mask) { return (uint64_t(buffer) + 1) << MAX_REGIONS | mask; }
+inline uint32_t mail_buffer(uint64_t mail) { return static_cast<uint32_t>((mail >> MAX_REGIONS) - 1); }
+
+struct Table {
+    PokerImageBox box;
+    FrameGate::Gate gate{0, 4};             // 領域0はテーブル全体（再検出の判定用）
+    int region_count = 0;
+    bool primed = false;                    // 比較できる前のフレームがあるか
+    uint64_t carry = 0;                     // バッファが無くて渡せなかった変化
+    std::atomic<uint64_t> mailbox{0};
+    std::atomic<bool> busy{false};          // 抽出中
+    std::atomic<bool> hero_to_act{false};   // 最後に抽出した状態
+    // 分析待ち: 0=無し、それ以外はフレームの通し番号+1
+    std::atomic<uint64_t> analysis{0};
+    std::atomic<int64_t> analysis_grabbed_ns{0};
+};
+
+class Pipeline {
+private:
+    std::vector<std::unique_ptr<Buffer>> buffers;   // [0, TABLE_BUFFERS)はテーブル、残りは再検出用
+    FreeList free_buffers;
+    FreeList free_layout_buffers;
+    std::atomic<uint64_t> buffer_bytes{0};          // プールが確保している画素の総量
+    mutable std::shared_mutex tables_mutex;    // テーブル構成の変更のみ排他
+    std::vector<std::unique_ptr<Table>> tables;
+    uint32_t generation = 0;
+
+    TableScheduler extract_queue;
+    TableScheduler analysis_queue;
+    Parking extract_parking;
+    Parking analysis_parking;
+    std::atomic<bool> stopped{false};
+
+    // 再検出
+    std::atomic<uint64_t> layout_mailbox{0};   // (バッファ番号+1) << 48
+    std::atomic<bool> layout_busy{false};
+    int64_t redetect_interval_ns;
+    double layout_threshold;
+    int64_t last_layout_ns = 0;
+    int32_t last_width = 0, last_height = 0;
+    bool layout_carry = false;
+    uint64_t sequence = 0;
+
+    // 統計
+    std::atomic<uint64_t> frames_submitted{0}, frames_unchanged{0}, frames_dropped{0}, superseded{0};
+    std::atomic<uint64_t> extract_jobs{0}, layout_jobs{0}, analyses{0}, urgent_analyses{0};
+    std::mutex latency_mutex;
+    double urgent_latency_sum = 0.0, urgent_latency_max = 0.0;
+    double latency_sum = 0.0, latency_max = 0.0;
+
+    void release_buffer(uint32_t index) {
+        if (buffers[index]->refs.fetch_sub(1) != 1) return;
+        (index < TABLE_BUFFERS ? free_buffers : free_layout_buffers).push(index);
+    }
+
+    // フレームのbox（クリップ済み）をバッファへコピーする。プールが空なら-1
+    // 再検出はテーブル用とは別のプールを使うので、テーブル用のバッファがフレーム全体の大きさにならない
+    int64_t copy_out(const PokerImageView& image, const PokerImageBox& box, int64_t now, bool layout) {
+        uint32_t index;
+        if (!(layout ? free_layout_buffers : free_buffers).try_pop(index)) return -1;
+        Buffer& buffer = *buffers[index];
+        const size_t row_bytes = static_cast<size_t>(box.width) * image.channels;
+        const size_t bytes = row_bytes * box.height;
+        const size_t before = buffer.pixels.capacity();
+        if (before > SHRINK_FACTOR * bytes) std::vector<uint8_t>().swap(buffer.pixels);
+        buffer.pixels.resize(bytes);
+        buffer_bytes.fetch_add(buffer.pixels.capacity() - before);   // 減った時は2の補数で引かれる
+        for (int y = 0; y < box.height; ++y) {
+            std::memcpy(buffer.pixels.data() + row_bytes * y,
+                        image.pixels + static_cast<size_t>(image.stride) * (box.y + y) +
+                            static_cast<size_t>(box.x) * image.channels,
+                        row_bytes);
+        }
+        buffer.box = box;
+        buffer.channels = image.channels;
+        buffer.sequence = sequence;
+        buffer.grabbed_ns = now;
+        buffer.refs.store(1);
+        return index;
+    }
+
+    // 郵便受けへ入れる（処理待ちがあれば古い画像を捨てて領域を合わせる）。新しく入れたらtrue
+    // バッファの参照は郵便受けへ移る
+    bool deposit(std::atomic<uint64_t>& mailbox, uint32_t buffer, uint64_t mask) {
+        uint64_t current = mailbox.load();
+        uint64_t merged;
+        do {
+            merged = pack_mail(buffer, mask | (current ? (current & MASK_BITS) : 0));
+        } while (!mailbox.compare_exchange_weak(current, merged));
+        if (current == 0) return true;
+        release_buffer(mail_buffer(current));
+        superseded.fetch_add(1);
+        return false;
+    }
+
+    bool try_take_job(PokerCaptureJob& job) {
+        std::shared_lock<std::shared_mutex> lock(tables_mutex);
+        int id;
+        while (extract_queue.try_pop(id)) {
+            if (id != LAYOUT_ID && static_cast<size_t>(id) >= tables.size()) continue;
+            std::atomic<bool>& busy = id == LAYOUT_ID ? layout_busy : tables[static_cast<size_t>(id)]->busy;
+            std::atomic<uint64_t>& mailbox =
+                id == LAYOUT_ID ? layout_mailbox : tables[static_cast<size_t>(id)]->mailbox;
+            bool expected = false;
+            if (!busy.compare_exchange_strong(expected, true)) continue;   // 処理中（完了時に入れ直す）
+            uint64_t mail = mailbox.exchange(0);
+            if (mail == 0) {                                                // 古い番号
+                busy.store(false);
+                continue;
+            }
+            uint32_t index = mail_buffer(mail);
+            const Buffer& buffer = *buffers[index];
+            job = {};
+            job.kind = id == LAYOUT_ID ? JOB_LAYOUT : JOB_EXTRACT;
+            job.table = id == LAYOUT_ID ? -1 : id;
+            job.generation = generation;
+            job.buffer = index;
+            job.sequence = buffer.sequence;
+            job.regions = mail & MASK_BITS;
+            job.grabbed_ns = buffer.grabbed_ns;
+            job.box = buffer.box;
+            return true;
+        }
+        return false;
+    }
+
+    bool try_take_analysis(PokerCaptureAnalysis& out) {
+        std::shared_lock<std::shared_mutex> lock(tables_mutex);
+        int id;
+        while (analysis_queue.try_pop(id)) {
+            if (static_cast<size_t>(id) >= tables.size()) continue;
+            Table& table = *tables[static_cast<size_t>(id)];
+            uint64_t pending = table.analysis.exchange(0);
+            if (pending == 0) continue;
+            out = {};
+            out.table = id;
+            out.generation = generation;
+            out.hero_to_act = table.hero_to_act.load();
+            out.sequence = pending - 1;
+            out.grabbed_ns = table.analysis_grabbed_ns.load();
+            double latency_ms = double(now_ns() - out.grabbed_ns) / 1e6;
+            out.latency_ms = latency_ms;
+            analyses.fetch_add(1);
+            std::lock_guard<std::mutex> stats_lock(latency_mutex);
+            latency_sum += latency_ms;
+            latency_max = std::max(latency_max, latency_ms);
+            if (out.hero_to_act) {
+                urgent_analyses.fetch_add(1);
+                urgent_latency_sum += latency_ms;
+                urgent_latency_max = std::max(urgent_latency_max, latency_ms);
+            }
+            return true;
+        }
+        return false;
+    }
+
+public:
+    Pipeline(int redetect_interval_ms, double layout_threshold)
+        : redetect_interval_ns(int64_t(std::max(redetect_interval_ms, 0)) * 1000000),
+          layout_threshold(std::clamp(layout_threshold, 0.0, 1.0)) {
+        // 画素は最初に使う時に確保する
+        for (int i = 0; i < MAX_BUFFERS; ++i) buffers.push_back(std::make_unique<Buffer>());
+        for (int i = TABLE_BUFFERS - 1; i >= 0; --i) free_buffers.push(static_cast<uint32_t>(i));
+        for (int i = MAX_BUFFERS - 1; i >= TABLE_BUFFERS; --i) free_layout_buffers.push(static_cast<uint32_t>(i));
+    }
+
+    ~Pipeline() { stop(); }
+
+    // テーブル構成を置き換える。regionsはテーブルごとにregion_counts[i]個（フレーム上の座標）
+    int set_tables(const PokerImageBox* boxes, int count, const PokerImageBox* regions,
+                   const int32_t* region_counts) {
+        if (count < 0 || count > MAX_TABLES) return -1;
+        for (int i = 0; i < count; ++i) {
+            if (region_counts[i] < 0 || region_counts[i] > MAX_REGIONS) return -1;
+        }
+        std::unique_lock<std::shared_mutex> lock(tables_mutex);
+        for (auto& table : tables) {
+            uint64_t mail = table->mailbox.exchange(0);
+            if (mail) release_buffer(mail_buffer(mail));
+        }
+        tables.clear();
+        for (int i = 0; i < count; ++i) {
+            auto table = std::make_unique<Table>();
+            table->box = boxes[i];
+            table->gate.add_region(boxes[i], LAYOUT_TILE);
+            for (int r = 0; r < region_counts[i]; ++r) table->gate.add_region(regions[r], REGION_TILE);
+            table->region_count = region_counts[i];
+            regions += region_counts[i];
+            tables.push_back(std::move(table));
+        }
+        return static_cast<int>(++generation);
+    }
+
+    // 取り込み段（1スレッドから呼ぶ）。戻り値は抽出・再検出の依頼数
+    int submit(const PokerImageView& image) {
+        const int64_t now = now_ns();
+        frames_submitted.fetch_add(1);
+        std::shared_lock<std::shared_mutex> lock(tables_mutex);
+
+        bool layout = layout_carry || now - last_layout_ns >= redetect_interval_ns ||
+                      image.width != last_width || image.height != last_height;
+        last_width = image.width;
+        last_height = image.height;
+        std::vector<uint64_t> masks(tables.size(), 0);
+        std::vector<int32_t> changed;
+        bool any = false;
+        for (size_t t = 0; t < tables.size(); ++t) {
+            Table& table = *tables[t];
+            changed.assign(static_cast<size_t>(table.region_count) + 1, 0);
+            table.gate.update(image, changed.data());
+            // テーブル全体が一度に変わったらウィンドウの移動・開閉とみなす
+            int layout_tiles = table.gate.tiles(0);
+            if (table.primed && layout_tiles > 0 && changed[0] >= layout_threshold * layout_tiles) {
+                layout = true;
+            }
+            table.primed = true;
+            masks[t] = table.carry;
+            for (int r = 0; r < table.region_count; ++r) {
+                if (changed[static_cast<size_t>(r) + 1] > 0) masks[t] |= uint64_t(1) << r;
+            }
+            any = any || masks[t] != 0;
+        }
+        if (!any && !layout) {
+            frames_unchanged.fetch_add(1);
+            ++sequence;
+            return 0;
+        }
+
+        int queued = 0;
+        for (size_t t = 0; t < tables.size(); ++t) {
+            Table& table = *tables[t];
+            table.carry = 0;
+            if (masks[t] == 0) continue;
+            PokerImageBox box = table.box;
+            int x1 = std::min(box.x + box.width, image.width), y1 = std::min(box.y + box.height, image.height);
+            box.x = std::clamp(box.x, 0, image.width);
+            box.y = std::clamp(box.y, 0, image.height);
+            box.width = x1 - box.x;
+            box.height = y1 - box.y;
+            if (box.width <= 0 || box.height <= 0) continue;   // 画面外（次の再検出で消える）
+            int64_t index = copy_out(image, box, now, false);
+            if (index < 0) {
+                // プールが空: 変化は次のフレームへ持ち越す
+                table.carry = masks[t];
+                frames_dropped.fetch_add(1);
+                continue;
+            }
+            if (deposit(table.mailbox, static_cast<uint32_t>(index), masks[t])) {
+                extract_queue.push(static_cast<int>(t), table.hero_to_act.load());
+            }
+            extract_jobs.fetch_add(1);
+            ++queued;
+        }
+        if (layout) {
+            int64_t index = copy_out(image, PokerImageBox{0, 0, image.width, image.height}, now, true);
+            layout_carry = index < 0;
+            if (index >= 0) {
+                last_layout_ns = now;
+                if (deposit(layout_mailbox, static_cast<uint32_t>(index), 0)) extract_queue.push(LAYOUT_ID, true);
+                layout_jobs.fetch_add(1);
+                ++queued;
+            } else {
+                frames_dropped.fetch_add(1);
+            }
+        }
+        ++sequence;
+        extract_parking.notify();
+        return queued;
+    }
+
+    bool next_job(int timeout_ms, PokerCaptureJob& job) {
+        return extract_parking.wait([&] { return try_take_job(job); }, stopped, timeout_ms);
+    }
+
+    // ジョブの画像（releaseするまで有効）
+    bool buffer_view(uint32_t index, PokerImageView& out) const {
+        if (index >= buffers.size()) return false;
+        const Buffer& buffer = *buffers[index];
+        out.pixels = buffer.pixels.data();
+        out.width = buffer.box.width;
+        out.height = buffer.box.height;
+        out.channels = buffer.channels;
+        out.stride = buffer.box.width * buffer.channels;
+        return true;
+    }
+
+    void release(uint32_t index) {
+        if (index < buffers.size()) release_buffer(index);
+    }
+
+    // 抽出の完了。hero_to_act: 1=手番, 0=手番でない, -1=不明（前回のまま）。changedなら分析待ちにする
+    void complete(const PokerCaptureJob& job, int hero_to_act, bool changed) {
+        std::shared_lock<std::shared_mutex> lock(tables_mutex);
+        if (job.kind == JOB_LAYOUT) {
+            layout_busy.store(false);
+            if (layout_mailbox.load() != 0) {
+                extract_queue.push(LAYOUT_ID, true);
+                extract_parking.notify();
+            }
+            return;
+        }
+        if (job.generation != generation || job.table < 0 ||
+            static_cast<size_t>(job.table) >= tables.size()) {
+            return;   // テーブル構成が変わった後の古い結果
+        }
+        Table& table = *tables[static_cast<size_t>(job.table)];
+        if (hero_to_act >= 0) table.hero_to_act.store(hero_to_act != 0);
+        bool urgent = table.hero_to_act.load();
+        if (changed) {
+            table.analysis_grabbed_ns.store(job.grabbed_ns);
+            table.analysis.store(job.sequence + 1);
+            analysis_queue.push(job.table, urgent);
+            analysis_parking.notify();
+        }
+        table.busy.store(false);
+        if (table.mailbox.load() != 0) {
+            extract_queue.push(job.table, urgent);
+            extract_parking.notify();
+        }
+    }
+
+    bool next_analysis(int timeout_ms, PokerCaptureAnalysis& out) {
+        return analysis_parking.wait([&] { return try_take_analysis(out); }, stopped, timeout_ms);
+    }
+
+    void stop() {
+        stopped.store(true);
+        extract_parking.notify();
+        analysis_parking.notify();
+    }
+
+    bool is_stopped() const { return stopped.load(); }
+
+    PokerCaptureStats stats() {
+        PokerCaptureStats s = {};
+        s.frames = frames_submitted.load();
+        s.unchanged = frames_unchanged.load();
+        s.dropped = frames_dropped.load();
+        s.superseded = superseded.load();
+        s.extract_jobs = extract_jobs.load();
+        s.layout_jobs = layout_jobs.load();
+        s.analyses = analyses.load();
+        s.urgent_analyses = urgent_analyses.load();
+        {
+            std::lock_guard<std::mutex> lock(latency_mutex);
+            s.mean_latency_ms = s.analyses ? latency_sum / double(s.analyses) : 0.0;
+            s.max_latency_ms = latency_max;
+            s.urgent_mean_latency_ms = s.urgent_analyses ? urgent_latency_sum / double(s.urgent_analyses) : 0.0;
+            s.urgent_max_latency_ms = urgent_latency_max;
+        }
+        {
+            std::shared_lock<std::shared_mutex> lock(tables_mutex);
+            s.tables = static_cast<uint32_t>(tables.size());
+        }
+        for (const auto& buffer : buffers) s.buffers_in_use += buffer->refs.load() > 0;
+        s.buffer_bytes = buffer_bytes.load();
+        return s;
+    }
+};
+
+} // namespace CapturePipeline
+
+extern "C" {
+    using namespace CapturePipeline;
+
+    void* capture_pipeline_create(int redetect_interval_ms, double layout_threshold) {
+        return new Pipeline(redetect_interval_ms, layout_threshold);
+    }
+
+    void capture_pipeline_destroy(void* handle) {
+        delete static_cast<Pipeline*>(handle);
+    }
+
+    int capture_pipeline_set_tables(void* handle, const PokerImageBox* tables, int count,
+                                    const PokerImageBox* regions, const int32_t* region_counts) {
+        return static_cast<Pipeline*>(handle)->set_tables(tables, count, regions, region_counts);
+    }
+
+    int capture_pipeline_submit(void* handle, const PokerImageView* frame) {
+        if (frame->pixels == nullptr || frame->width <= 0 || frame->height <= 0 ||
+            (frame->channels != 1 && frame->channels != 3 && frame->channels != 4) ||
+            frame->stride < frame->width * frame->channels) {
+            return -1;
+        }
+        return static_cast<Pipeline*>(handle)->submit(*frame);
+    }
+
+    int capture_pipeline_next_job(void* handle, int timeout_ms, PokerCaptureJob* out) {
+        Pipeline* pipeline = static_cast<Pipeline*>(handle);
+        if (pipeline->next_job(timeout_ms, *out)) return 1;
+        return pipeline->is_stopped() ? -1 : 0;
+    }
+
+    int capture_pipeline_buffer(void* handle, uint32_t buffer, PokerImageView* out) {
+        return static_cast<Pipeline*>(handle)->buffer_view(buffer, *out) ? 0 : -1;
+    }
+
+    void capture_pipeline_release(void* handle, uint32_t buffer) {
+        static_cast<Pipeline*>(handle)->release(buffer);
+    }
+
+    void capture_pipeline_complete(void* handle, const PokerCaptureJob* job, int hero_to_act, int changed) {
+        static_cast<Pipeline*>(handle)->complete(*job, hero_to_act, changed != 0);
+    }
+
+    int capture_pipeline_next_analysis(void* handle, int timeout_ms, PokerCaptureAnalysis* out) {
+        Pipeline* pipeline = static_cast<Pipeline*>(handle);
+        if (pipeline->next_analysis(timeout_ms, *out)) return 1;
+        return pipeline->is_stopped() ? -1 : 0;
+    }
+
+    void capture_pipeline_stop(void* handle) {
+        static_cast<Pipeline*>(handle)->stop();
+    }
+
+    void capture_pipeline_stats(void* handle, PokerCaptureStats* out) {
+        *out = static_cast<Pipeline*>(handle)->stats();
+    }
+}
+
+#endif // POKER_STEP60_CAPTURE_PIPELINE_CPP
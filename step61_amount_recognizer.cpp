@@ -0,0 +1,565 @@
+// step61_amount_recognizer.cpp
+// 画面キャプチャの金額認識（gui/auto_capture_system.py の extract_amount のTesseract OCRの置き換え）
+// ポット・ベット・各席のスタックの数字は固定のフォントなので、スキンごとに文字のテンプレートを学習する:
+//   二値化    step58と同じ大津の方法（少ない側がインク）
+//   分割      8近傍の連結成分（ランに仮ラベルを付ける2パスのラベリング＋union-find）。
+//             x方向に重なる成分は1文字にまとめる
+//   句読点    行の高さに対して小さくベースライン付近にある文字は形の照合をせず、
+//             ベースラインより下に出るか縦長なら',' そうでなければ'.'
+//   照合      文字の高さ（横長なら幅）の正方形で16x16の被覆率にし（'1'の細さを残す）、
+//             step58の相関カーネルで0-9, $, K, Mのテンプレートと比べる
+//   解釈      '$'と桁区切りの','を除き、'.'は小数点、末尾のK/Mは千倍・百万倍
+// 1フレームの全ての金額（ポット・ベット・全席のスタック）をまとめて1回の呼び出しで読む。
+#ifndef POKER_STEP61_AMOUNT_RECOGNIZER_CPP
+#define POKER_STEP61_AMOUNT_RECOGNIZER_CPP
+
+#include "poker_engine.h"
+#include "step58_card_recognizer.cpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace AmountRecognizer {
+
+using CardRecognizer::GLYPH_SIDE;
+using CardRecognizer::GLYPH_PIXELS;
+using CardRecognizer::Glyph;
+using CardRecognizer::SavedClass;
+
+constexpr char CLASS_CHARS[] = "0123456789$KM";
+constexpr int CLASS_COUNT = sizeof(CLASS_CHARS) - 1;
+constexpr int DIGIT_COUNT = 10;
+constexpr int MAX_GLYPHS = 23;                  // PokerAmountMatch::textの長さ - 1
+constexpr int MIN_COMPONENT_PIXELS = 2;         // これ未満の成分はノイズ（ベースライン上で文字の間なら'.'）
+constexpr float OVERLAP_MERGE = 0.5f;           // 狭い方の幅に対するx方向の重なりがこれ以上なら1文字
+constexpr float SMALL_GLYPH = 0.45f;            // 行の高さに対してこれ未満の高さは句読点の候補
+constexpr float TALL_GLYPH = 0.6f;              // ベースラインを決める文字の高さ
+constexpr float COMMA_DESCENT = 0.08f;          // これより下に出た小さな文字は','（行の高さに対して、1画素未満も可）
+
+inline int class_of(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    switch (c) {
+        case '$': return 10;
+        case 'K': case 'k': return 11;
+        case 'M': case 'm': return 12;
+        default: return -1;
+    }
+}
+
+inline bool is_punctuation(char c) { return c == '.' || c == ','; }
+
+// ===== 分割 =====
+
+struct Component {
+    int x0, y0, x1, y1;     // 外接矩形（両端を含む）
+    int pixels;
+    int group;
+};
+
+// 1文字（x方向に重なる成分をまとめたもの）
+struct Segment {
+    int x0, y0, x1, y1;
+    char punctuation;       // 句読点なら'.'か','、形で照合する文字は0、識別できない小さな文字は'?'
+};
+
+// 1行のインクの連続
+struct Run {
+    int y, x0, x1;          // x1を含む
+    int32_t label;          // 仮ラベル
+};
+
+struct Scratch : CardRecognizer::Scratch {
+    std::vector<int32_t> labels;      // 0=背景、それ以外は成分の番号+1
+    std::vector<Run> runs;
+    std::vector<int32_t> parent;      // union-find（ランの仮ラベル）
+    std::vector<Component> components;
+    std::vector<Segment> segments;
+};
+
+inline int32_t find_root(std::vector<int32_t>& parent, int32_t a) {
+    while (parent[a] != a) {
+        parent[a] = parent[parent[a]];
+        a = parent[a];
+    }
+    return a;
+}
+
+inline void unite(std::vector<int32_t>& parent, int32_t a, int32_t b) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a != b) parent[std::max(a, b)] = std::min(a, b);
+}
+
+// orderの成分をx0順に並べ、x方向に重なるものを1文字にまとめてscratch.segmentsを作り直す
+inline void merge_components(Scratch& scratch, std::vector<int32_t>& order) {
+    scratch.segments.clear();
+    std::sort(order.begin(), order.end(), [&](int32_t a, int32_t b) {
+        return scratch.components[static_cast<size_t>(a)].x0 < scratch.components[static_cast<size_t>(b)].x0;
+    });
+    for (int32_t i : order) {
+        Component& c = scratch.components[static_cast<size_t>(i)];
+        if (!scratch.segments.empty()) {
+            Segment& last = scratch.segments.back();
+            int overlap = std::min(last.x1, c.x1) - std::max(last.x0, c.x0) + 1;
+            int narrower = std::min(last.x1 - last.x0, c.x1 - c.x0) + 1;
+            if (overlap >= OVERLAP_MERGE * narrower) {
+                last.x0 = std::min(last.x0, c.x0);
+                last.y0 = std::min(last.y0, c.y0);
+                last.x1 = std::max(last.x1, c.x1);
+                last.y1 = std::max(last.y1, c.y1);
+                c.group = static_cast<int>(scratch.segments.size() - 1);
+                continue;
+            }
+        }
+        c.group = static_cast<int>(scratch.segments.size());
+        scratch.segments.push_back({c.x0, c.y0, c.x1, c.y1, 0});
+    }
+}
+
+// boxを二値化して文字に分ける（左から順にscratch.segments）。インクが無ければfalse
+inline bool segment(const PokerImageView& image, const PokerImageBox& box, Scratch& scratch) {
+    scratch.segments.clear();
+    const int x0 = std::max(box.x, 0), y0 = std::max(box.y, 0);
+    const int w = std::min(box.x + box.width, image.width) - x0;
+    const int h = std::min(box.y + box.height, image.height) - y0;
+    if (w < 2 || h < 2) return false;
+    if (!CardRecognizer::binarize(image, x0, y0, w, h, scratch)) return false;
+
+    // 1パス目: 行ごとのインクの連続（ラン）に仮ラベルを付け、上の行で8近傍に接するランと同値にする
+    scratch.runs.clear();
+    scratch.parent.clear();
+    size_t previous_begin = 0, previous_end = 0;
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* ink = scratch.ink.data() + static_cast<size_t>(y) * w;
+        const size_t row_begin = scratch.runs.size();
+        size_t above = previous_begin;
+        for (int x = 0; x < w;) {
+            if (!ink[x]) {
+                ++x;
+                continue;
+            }
+            int end = x;
+            while (end + 1 < w && ink[end + 1]) ++end;
+            int32_t label = static_cast<int32_t>(scratch.parent.size());
+            scratch.parent.push_back(label);
+            // 上の行のランは左から順なので、接する範囲だけを見る
+            while (above < previous_end && scratch.runs[above].x1 < x - 1) ++above;
+            for (size_t a = above; a < previous_end && scratch.runs[a].x0 <= end + 1; ++a) {
+                unite(scratch.parent, label, scratch.runs[a].label);
+            }
+            scratch.runs.push_back({y, x, end, label});
+            x = end + 1;
+        }
+        previous_begin = row_begin;
+        previous_end = scratch.runs.size();
+    }
+
+    // 2パス目: ランを代表に付け替えて成分ごとの外接矩形を求め、画素のラベルを書く
+    const size_t n = static_cast<size_t>(w) * h;
+    scratch.labels.assign(n, 0);
+    std::vector<int32_t> index(scratch.parent.size(), -1);
+    scratch.components.clear();
+    for (const Run& run : scratch.runs) {
+        int32_t root = find_root(scratch.parent, run.label);
+        if (index[root] < 0) {
+            index[root] = static_cast<int32_t>(scratch.components.size());
+            scratch.components.push_back({run.x0, run.y, run.x1, run.y, 0, -1});
+        }
+        Component& c = scratch.components[static_cast<size_t>(index[root])];
+        c.x0 = std::min(c.x0, run.x0);
+        c.x1 = std::max(c.x1, run.x1);
+        c.y1 = run.y;
+        c.pixels += run.x1 - run.x0 + 1;
+        int32_t* row = scratch.labels.data() + static_cast<size_t>(run.y) * w;
+        std::fill(row + run.x0, row + run.x1 + 1, index[root] + 1);
+    }
+
+    // x方向に重なる成分を1文字にまとめる（途切れた線・'$'の縦線など）
+    std::vector<int32_t> order;
+    for (size_t i = 0; i < scratch.components.size(); ++i) {
+        if (scratch.components[i].pixels >= MIN_COMPONENT_PIXELS) order.push_back(static_cast<int32_t>(i));
+    }
+    merge_components(scratch, order);
+    if (scratch.segments.empty()) return false;
+
+    // 行の高さとベースラインから句読点を決める
+    int line_height = 0;
+    for (const Segment& s : scratch.segments) line_height = std::max(line_height, s.y1 - s.y0 + 1);
+    // ベースラインは高い文字の下端の中央値（'$'のように下に出る文字があっても数字の下端になる）
+    std::vector<int> bottoms;
+    for (const Segment& s : scratch.segments) {
+        if (s.y1 - s.y0 + 1 >= TALL_GLYPH * line_height) bottoms.push_back(s.y1);
+    }
+    std::nth_element(bottoms.begin(), bottoms.begin() + bottoms.size() / 2, bottoms.end());
+    const int baseline = bottoms[bottoms.size() / 2];
+    // 小さいフォントでは','は1画素しか下に出ないので、下限を1画素にしない
+    const float descent = COMMA_DESCENT * line_height;
+
+    // ノイズとして捨てた小さな成分でも、ベースライン上で高い文字2つの間にあれば残す（小さいフォントの'.'）
+    const size_t kept = order.size();
+    auto tall = [&](const Segment& s) { return s.y1 - s.y0 + 1 >= TALL_GLYPH * line_height; };
+    for (size_t i = 0; i < scratch.components.size(); ++i) {
+        const Component& c = scratch.components[i];
+        if (c.pixels >= MIN_COMPONENT_PIXELS || std::abs(c.y1 - baseline) > descent) continue;
+        auto next = std::find_if(scratch.segments.begin(), scratch.segments.end(),
+                                 [&](const Segment& s) { return s.x0 > c.x1; });
+        if (next == scratch.segments.begin() || next == scratch.segments.end()) continue;
+        const Segment& previous = *(next - 1);
+        if (previous.x1 < c.x0 && tall(previous) && tall(*next)) order.push_back(static_cast<int32_t>(i));
+    }
+    if (order.size() > kept) merge_components(scratch, order);
+
+    for (Segment& s : scratch.segments) {
+        int sh = s.y1 - s.y0 + 1, sw = s.x1 - s.x0 + 1;
+        if (sh >= SMALL_GLYPH * line_height) continue;
+        if (s.y1 < baseline - SMALL_GLYPH * line_height) {
+            s.punctuation = '?';   // 宙に浮いた小さな文字（'-'・記号など）
+        } else if (s.y1 > baseline + descent || sh > 1.5f * sw) {
+            s.punctuation = ',';
+        } else {
+            s.punctuation = '.';
+        }
+    }
+    return true;
+}
+
+// 文字segを高さ（横長なら幅）の正方形で16x16の被覆率にする。他の文字の画素は数えない
+inline void segment_glyph(const Scratch& scratch, int w, int group, const Segment& seg, Glyph& out) {
+    const int sw = seg.x1 - seg.x0 + 1, sh = seg.y1 - seg.y0 + 1;
+    const int side = std::max(sw, sh);
+    const int ox = seg.x0 - (side - sw) / 2, oy = seg.y0 - (side - sh) / 2;
+    for (int gy = 0; gy < GLYPH_SIDE; ++gy) {
+        int sy0 = oy + gy * side / GLYPH_SIDE;
+        int sy1 = std::max(oy + (gy + 1) * side / GLYPH_SIDE, sy0 + 1);
+        for (int gx = 0; gx < GLYPH_SIDE; ++gx) {
+            int sx0 = ox + gx * side / GLYPH_SIDE;
+            int sx1 = std::max(ox + (gx + 1) * side / GLYPH_SIDE, sx0 + 1);
+            int count = 0;
+            for (int y = std::max(sy0, seg.y0); y < std::min(sy1, seg.y1 + 1); ++y) {
+                const int32_t* row = scratch.labels.data() + static_cast<size_t>(y) * w;
+                for (int x = std::max(sx0, seg.x0); x < std::min(sx1, seg.x1 + 1); ++x) {
+                    count += row[x] != 0 && scratch.components[static_cast<size_t>(row[x] - 1)].group == group;
+                }
+            }
+            out.coverage[gy * GLYPH_SIDE + gx] =
+                static_cast<float>(count) / static_cast<float>((sy1 - sy0) * (sx1 - sx0));
+        }
+    }
+    CardRecognizer::finish_glyph(out);
+}
+
+// ===== 金額の解釈 =====
+
+// "$1,250.50" → 1250.5、"12.5K" → 12500。'$'は先頭、K/Mは末尾だけ、小数点は1つまで
+// ','の無い"1.250"は','を'.'と読み違えた可能性が高いので受け付けない。
+// 同じ理由で','の後は（次の','・'.'・末尾まで）ちょうど3桁でなければ受け付けない（"1,25"は$1.25の読み違い）
+inline bool parse_amount(const char* text, double& value) {
+    std::string digits;
+    double multiplier = 1.0;
+    size_t n = std::strlen(text);
+    bool seen_point = false, seen_digit = false, seen_comma = false;
+    int decimals = 0;
+    int group = -1;     // 直前の','からの桁数（','がまだ無ければ-1）
+    for (size_t i = 0; i < n; ++i) {
+        char c = text[i];
+        if (c >= '0' && c <= '9') {
+            digits += c;
+            seen_digit = true;
+            decimals += seen_point;
+            group += group >= 0 && !seen_point;
+        } else if (c == '.') {
+            if (seen_point || (group >= 0 && group != 3)) return false;
+            seen_point = true;
+            digits += c;
+        } else if (c == ',') {
+            if (!seen_digit || seen_point || (group >= 0 && group != 3)) return false;
+            seen_comma = true;
+            group = 0;
+        } else if (c == '$') {
+            if (seen_digit || seen_point) return false;
+        } else if ((c == 'K' || c == 'M') && i + 1 == n && seen_digit) {
+            multiplier = c == 'K' ? 1e3 : 1e6;
+        } else {
+            return false;
+        }
+    }
+    if (!seen_digit || (seen_point && !seen_comma && decimals == 3)) return false;
+    if (!seen_point && group >= 0 && group != 3) return false;
+    value = std::strtod(digits.c_str(), nullptr) * multiplier;
+    return true;
+}
+
+// ===== ファイル形式 =====
+//   FileHeader
+//   SavedClass classes[CLASS_COUNT]（CLASS_CHARSの順、step58と同じ合計の形式）
+constexpr char FILE_MAGIC[8] = {'P', 'K', 'A', 'M', 'O', 'U', 'N', 'T'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t class_count;
+    uint64_t padding[6];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout must stay stable");
+
+// ===== 認識器 =====
+class Recognizer {
+private:
+    mutable std::shared_mutex mutex;
+    std::array<SavedClass, CLASS_COUNT> sums = {};
+    alignas(64) float templates[CLASS_COUNT][GLYPH_PIXELS] = {};
+
+    void rebuild(int cls) {
+        const SavedClass& s = sums[cls];
+        Glyph g;
+        double inv = s.samples ? 1.0 / double(s.samples) : 0.0;
+        for (int i = 0; i < GLYPH_PIXELS; ++i) g.coverage[i] = static_cast<float>(s.coverage_sum[i] * inv);
+        CardRecognizer::finish_glyph(g);
+        std::copy(std::begin(g.normalized), std::end(g.normalized), templates[cls]);
+    }
+
+    void add(int cls, const Glyph& g) {
+        SavedClass& s = sums[cls];
+        ++s.samples;
+        for (int i = 0; i < GLYPH_PIXELS; ++i) s.coverage_sum[i] += g.coverage[i];
+        rebuild(cls);
+    }
+
+    // 学習済みのクラスで最良を選び、確信度を返す（学習済みが無ければ-1）
+    int classify(const Glyph& g, float& conf) const {
+        float scores[CLASS_COUNT];
+        CardRecognizer::correlate(g.normalized, templates[0], CLASS_COUNT, scores);
+        int best_class = -1;
+        float best = -1.0f, second = -1.0f;
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            if (sums[c].samples == 0) continue;
+            if (scores[c] > best) {
+                second = best;
+                best = scores[c];
+                best_class = c;
+            } else if (scores[c] > second) {
+                second = scores[c];
+            }
+        }
+        conf = best_class < 0 ? 0.0f : CardRecognizer::confidence(best, second);
+        return best_class;
+    }
+
+public:
+    bool learn(const PokerImageView& image, const PokerImageBox& box, const char* text, std::string& error) {
+        std::string label;
+        for (const char* p = text; *p; ++p) {
+            if (*p == ' ') continue;
+            if (class_of(*p) < 0 && !is_punctuation(*p)) {
+                error = std::string("unsupported character '") + *p + "' in label";
+                return false;
+            }
+            label += *p;
+        }
+        Scratch scratch;
+        if (!segment(image, box, scratch)) {
+            error = "no text found in the box";
+            return false;
+        }
+        const int w = std::min(box.x + box.width, image.width) - std::max(box.x, 0);
+        bool matches = scratch.segments.size() == label.size();
+        for (size_t i = 0; matches && i < label.size(); ++i) {
+            // 句読点は'.'と','の区別まで一致すること（取り違えると桁が変わる）
+            matches = scratch.segments[i].punctuation == (is_punctuation(label[i]) ? label[i] : 0);
+        }
+        if (!matches) {
+            std::string found;
+            for (const Segment& s : scratch.segments) found += s.punctuation ? s.punctuation : '#';
+            error = "segmented \"" + found + "\" does not match label \"" + label + "\"";
+            return false;
+        }
+        std::vector<Glyph> glyphs(label.size());
+        for (size_t i = 0; i < label.size(); ++i) {
+            if (!is_punctuation(label[i])) {
+                segment_glyph(scratch, w, static_cast<int>(i), scratch.segments[i], glyphs[i]);
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (size_t i = 0; i < label.size(); ++i) {
+            if (!is_punctuation(label[i])) add(class_of(label[i]), glyphs[i]);
+        }
+        return true;
+    }
+
+    size_t read(const PokerImageView& image, const PokerImageBox* boxes, size_t count,
+                PokerAmountMatch* out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        Scratch scratch;
+        Glyph glyph;
+        size_t parsed = 0;
+        for (size_t i = 0; i < count; ++i) {
+            PokerAmountMatch& m = out[i];
+            m = {};
+            if (!segment(image, boxes[i], scratch)) continue;
+            const PokerImageBox& box = boxes[i];
+            const int w = std::min(box.x + box.width, image.width) - std::max(box.x, 0);
+            float confidence = 1.0f;
+            int length = 0;
+            for (size_t s = 0; s < scratch.segments.size() && length < MAX_GLYPHS; ++s) {
+                const Segment& seg = scratch.segments[s];
+                char c = seg.punctuation;
+                if (c == 0) {
+                    segment_glyph(scratch, w, static_cast<int>(s), seg, glyph);
+                    float conf;
+                    int cls = classify(glyph, conf);
+                    c = cls < 0 ? '?' : CLASS_CHARS[cls];
+                    confidence = std::min(confidence, conf);
+                } else if (c == '?') {
+                    confidence = 0.0f;
+                }
+                m.text[length++] = c;
+            }
+            m.text[length] = '\0';
+            m.glyphs = static_cast<int16_t>(length);
+            if (length < static_cast<int>(scratch.segments.size())) confidence = 0.0f;   // 長すぎる
+            if (parse_amount(m.text, m.value)) {
+                m.valid = 1;
+                m.confidence = confidence;
+                ++parsed;
+            }
+        }
+        return parsed;
+    }
+
+    void samples(uint32_t* out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (int c = 0; c < CLASS_COUNT; ++c) out[c] = static_cast<uint32_t>(sums[c].samples);
+    }
+
+    // ファイルへ保存（一時ファイルに書いてからrename）
+    bool save(const std::string& path, std::string& error) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        FileHeader header = {};
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.format_version = FORMAT_VERSION;
+        header.class_count = CLASS_COUNT;
+
+        std::string tmp = path + ".tmp";
+        FILE* fp = std::fopen(tmp.c_str(), "wb");
+        if (fp == nullptr) {
+            error = "cannot create " + tmp;
+            return false;
+        }
+        bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1;
+        ok = ok && std::fwrite(sums.data(), sizeof(SavedClass), sums.size(), fp) == sums.size();
+        ok = (std::fflush(fp) == 0) && ok;
+        ok = (fsync(fileno(fp)) == 0) && ok;
+        ok = (std::fclose(fp) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            error = "failed to write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    static std::unique_ptr<Recognizer> open(const std::string& path, std::string& error) {
+        FILE* fp = std::fopen(path.c_str(), "rb");
+        if (fp == nullptr) {
+            error = "cannot open " + path;
+            return nullptr;
+        }
+        std::unique_ptr<FILE, int (*)(FILE*)> guard(fp, std::fclose);
+        FileHeader header;
+        if (std::fread(&header, sizeof(header), 1, fp) != 1) {
+            error = "file too small: " + path;
+            return nullptr;
+        }
+        if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            error = "bad magic";
+            return nullptr;
+        }
+        if (header.format_version != FORMAT_VERSION) {
+            error = "unsupported format version";
+            return nullptr;
+        }
+        if (header.class_count != CLASS_COUNT) {
+            error = "corrupt header";
+            return nullptr;
+        }
+        auto recognizer = std::make_unique<Recognizer>();
+        if (std::fread(recognizer->sums.data(), sizeof(SavedClass), CLASS_COUNT, fp) != CLASS_COUNT) {
+            error = "file size does not match header";
+            return nullptr;
+        }
+        for (int c = 0; c < CLASS_COUNT; ++c) recognizer->rebuild(c);
+        return recognizer;
+    }
+};
+
+// 直近のエラーメッセージ（C ABI用、スレッドごと）
+inline std::string& recognizer_error() {
+    thread_local std::string message;
+    return message;
+}
+
+inline bool valid_image(const PokerImageView& image) {
+    if (image.pixels == nullptr || image.width <= 0 || image.height <= 0 ||
+        (image.channels != 1 && image.channels != 3 && image.channels != 4) ||
+        image.stride < image.width * image.channels) {
+        recognizer_error() = "invalid image";
+        return false;
+    }
+    return true;
+}
+
+} // namespace AmountRecognizer
+
+extern "C" {
+    void* amount_recognizer_create(void) {
+        return new AmountRecognizer::Recognizer();
+    }
+
+    void* amount_recognizer_open(const char* path) {
+        return AmountRecognizer::Recognizer::open(path, AmountRecognizer::recognizer_error()).release();
+    }
+
+    void amount_recognizer_close(void* handle) {
+        delete static_cast<AmountRecognizer::Recognizer*>(handle);
+    }
+
+    int amount_recognizer_save(void* handle, const char* path) {
+        return static_cast<AmountRecognizer::Recognizer*>(handle)->save(
+            path, AmountRecognizer::recognizer_error()) ? 0 : -1;
+    }
+
+    int amount_recognizer_learn(void* handle, const PokerImageView* image, const PokerImageBox* box,
+                                const char* text) {
+        if (!AmountRecognizer::valid_image(*image)) return -1;
+        PokerImageBox whole = {0, 0, image->width, image->height};
+        return static_cast<AmountRecognizer::Recognizer*>(handle)->learn(
+            *image, box ? *box : whole, text, AmountRecognizer::recognizer_error()) ? 0 : -1;
+    }
+
+    int64_t amount_recognizer_read(void* handle, const PokerImageView* image, const PokerImageBox* boxes,
+                                   int64_t count, PokerAmountMatch* out) {
+        if (count <= 0 || !AmountRecognizer::valid_image(*image)) return 0;
+        return static_cast<int64_t>(static_cast<AmountRecognizer::Recognizer*>(handle)->read(
+            *image, boxes, static_cast<size_t>(count), out));
+    }
+
+    void amount_recognizer_samples(void* handle, uint32_t* counts) {
+        static_cast<AmountRecognizer::Recognizer*>(handle)->samples(counts);
+    }
+
+    const char* amount_recognizer_error(void) {
+        return AmountRecognizer::recognizer_error().c_str();
+    }
+}
+
+#endif // POKER_STEP61_AMOUNT_RECOGNIZER_CPP
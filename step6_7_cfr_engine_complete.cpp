@@ -1,10 +1,15 @@
 // step6_7_cfr_engine_complete.cpp
+#ifndef POKER_STEP6_7_CFR_ENGINE_COMPLETE_CPP
+#define POKER_STEP6_7_CFR_ENGINE_COMPLETE_CPP
+
 #include <map>
 #include <vector>
 #include <string>
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
 #include <memory>
+#include <set>
 
 namespace CFREngine {
 
@@ -23,7 +28,7 @@ struct InfoSet {
         double normalizing_sum = 0.0;
         
         for (Action a : legal_actions) {
-            // CFR+: 負の後悔値を0にクリップ
+            // Regret Matching: 累積後悔値の正の部分に比例させる（負の後悔値は保持したまま無視する）
             double regret = std::max(0.0, regret_sum[a]);
             strategy[a] = regret;
             normalizing_sum += regret;
@@ -68,23 +73,64 @@ struct InfoSet {
         return avg_strategy;
     }
     
-    // 戦略を蓄積（Linear CFR）
-    void accumulate_strategy(const std::map<Action, double>& strategy, int iteration) {
-        // Linear weighting: より最近の戦略に重みを付ける
-        double weight = static_cast<double>(iteration) / (iteration + 1);
+    // 戦略を蓄積（自分の到達確率で重み付け。古い分の割引はdiscountで行う）
+    void accumulate_strategy(const std::map<Action, double>& strategy, double reach) {
         for (const auto& [action, prob] : strategy) {
-            strategy_sum[action] += prob * weight;
+            strategy_sum[action] += reach * prob;
         }
     }
     
-    // 後悔値を更新（CFR+）
+    // 後悔値を更新（負の後悔値も残し、discountで減衰させる）
     void update_regrets(const std::map<Action, double>& regrets, double weight) {
         for (const auto& [action, regret] : regrets) {
             regret_sum[action] += weight * regret;
-            // CFR+: 負の後悔値を即座に0にする
-            regret_sum[action] = std::max(0.0, regret_sum[action]);
         }
     }
+    
+    // Discounted CFR: イテレーションtの終わりに、正の後悔値をpositive倍・負の後悔値をnegative倍、
+    // 戦略の累計をstrategy倍する
+    void discount(double positive, double negative, double strategy) {
+        for (auto& [action, regret] : regret_sum) {
+            regret *= regret > 0 ? positive : negative;
+        }
+        for (auto& [action, sum] : strategy_sum) {
+            sum *= strategy;
+        }
+    }
+};
+
+// ===== ベンチマーク用のゲーム =====
+// クーン・ポーカー（J/Q/Kの3枚、1ラウンド、レイズ1回まで）と
+// レデュック・ホールデム（J/Q/K×2枚、2ラウンド、2ラウンド目の前に公開カード1枚、レイズ2回まで）。
+// どちらもアンティ1のリミットベットで、ゲームの木が小さく毎イテレーション全て辿れる。
+enum GameKind { GAME_KUHN = 0, GAME_LEDUC = 1 };
+
+// コールは賭けが無ければチェック、レイズは賭けが無ければベット
+enum : Action { ACTION_FOLD = 0, ACTION_CALL = 1, ACTION_RAISE = 2 };
+
+struct GameRules {
+    int ranks, suits;
+    int rounds;
+    int max_raises;         // 1ラウンドのレイズ回数の上限
+    int bet_size[2];        // ラウンドごとのベット額
+};
+
+constexpr GameRules GAME_RULES[] = {
+    {3, 1, 1, 1, {1, 1}},   // GAME_KUHN
+    {3, 2, 2, 2, {2, 4}},   // GAME_LEDUC
+};
+
+struct GameState {
+    int hole[2] = {-1, -1};         // カード番号（rank * suits + suit）、-1=未配布
+    int board = -1;
+    int round = 0;
+    int player = 0;                 // 手番
+    int raises = 0;                 // このラウンドのレイズ回数
+    int actions = 0;                // このラウンドのアクション数
+    int folded = -1;                // フォールドしたプレイヤー
+    bool showdown = false;
+    int committed[2] = {1, 1};      // アンティ込みの拠出額
+    std::string history;            // 'f'/'c'/'r'、ラウンドの区切りは'/'
 };
 
 // CFRソルバー
@@ -92,10 +138,19 @@ class CFRSolver {
 private:
     std::map<std::string, InfoSet> info_sets;
     int iteration = 0;
-    double discount_alpha = 1.5;  // Discounted CFR用
-    double discount_beta = 0.5;
+    // Discounted CFR (Brown & Sandholm) の推奨値 α=1.5, β=0, γ=2
+    double discount_alpha = 1.5;
+    double discount_beta = 0.0;
+    double discount_gamma = 2.0;
+    GameRules rules;
+    GameState state;
+    std::vector<GameState> saved_states;   // apply_*の前の状態（revert_*で戻す）
     
 public:
+    explicit CFRSolver(GameKind game = GAME_KUHN) : rules(GAME_RULES[game]) {}
+    
+    size_t info_set_count() const { return info_sets.size(); }
+    
     // CFRイテレーション
     void train(int iterations) {
         for (int i = 0; i < iterations; ++i) {
@@ -106,10 +161,8 @@ public:
                 cfr_recursive(0, player, 1.0, 1.0);
             }
             
-            // Discounted CFR: 定期的に後悔値を割引
-            if (iteration % 100 == 0) {
-                discount_regrets();
-            }
+            // Discounted CFR: 毎イテレーション後悔値と戦略の累計を割引
+            discount_regrets();
         }
     }
     
@@ -152,12 +205,14 @@ private:
             double action_prob = strategy[action];
             
             // 再帰的に子ノードを評価
+            apply_action(action);
             Utility utility = cfr_recursive(
                 depth + 1, 
                 player,
                 pi_reach_player * action_prob,
                 pi_reach_opponent
             );
+            revert_action();
             
             action_utilities[action] = utility;
             node_utility += action_prob * utility;
@@ -173,7 +228,7 @@ private:
         info_set.update_regrets(regrets, pi_reach_opponent);
         
         // 戦略を蓄積
-        info_set.accumulate_strategy(strategy, iteration);
+        info_set.accumulate_strategy(strategy, pi_reach_player);
         info_set.visit_count++;
         
         return node_utility;
@@ -192,12 +247,14 @@ private:
         for (Action action : legal_actions) {
             double action_prob = strategy[action];
             
+            apply_action(action);
             Utility utility = cfr_recursive(
                 depth + 1,
                 player,
                 pi_reach_player,
                 pi_reach_opponent * action_prob
             );
+            revert_action();
             
             node_utility += action_prob * utility;
         }
@@ -223,27 +280,228 @@ private:
     }
     
     void discount_regrets() {
-        // Discounted CFR: 古い後悔値を割引
+        // 係数はいずれも1未満なので、累計は長時間学習しても発散しない
+        const double t = static_cast<double>(iteration);
+        const double ta = std::pow(t, discount_alpha);
+        const double tb = std::pow(t, discount_beta);
+        const double positive = ta / (ta + 1.0);
+        const double negative = tb / (tb + 1.0);
+        const double strategy = std::pow(t / (t + 1.0), discount_gamma);
         for (auto& [key, info_set] : info_sets) {
-            for (auto& [action, regret] : info_set.regret_sum) {
-                regret *= std::pow(discount_alpha, -1.0);
+            info_set.discount(positive, negative, strategy);
+        }
+    }
+    
+    // playerの手番のノードの履歴の長さ
+    void collect_levels(int player, std::set<size_t>& levels) {
+        if (is_terminal()) return;
+        if (is_chance_node()) {
+            for (const auto& [outcome, probability] : get_chance_outcomes()) {
+                apply_chance_outcome(outcome);
+                collect_levels(player, levels);
+                revert_chance_outcome(outcome);
             }
-            for (auto& [action, strategy] : info_set.strategy_sum) {
-                strategy *= std::pow(discount_beta, -1.0);
+            return;
+        }
+        if (state.player == player) levels.insert(state.history.size());
+        for (Action action : get_legal_actions()) {
+            apply_action(action);
+            collect_levels(player, levels);
+            revert_action();
+        }
+    }
+    
+    // 最適反応の走査。weight = チャンスと相手の到達確率の積
+    // 行動が決まった情報セットはその行動だけを辿る。履歴の長さがlevelの未決定の情報セットでは
+    // 行動ごとの価値をweightで重み付けしてaction_valuesへ加え、それより浅い未決定の手番は全行動を辿る
+    Utility best_response_traverse(int player, size_t level, double weight,
+                                   const std::map<std::string, Action>& response,
+                                   std::map<std::string, std::map<Action, double>>* action_values) {
+        if (is_terminal()) return get_payoff(player);
+        if (is_chance_node()) {
+            Utility value = 0.0;
+            for (const auto& [outcome, probability] : get_chance_outcomes()) {
+                apply_chance_outcome(outcome);
+                value += probability * best_response_traverse(player, level, weight * probability,
+                                                              response, action_values);
+                revert_chance_outcome(outcome);
             }
+            return value;
         }
+        
+        std::vector<Action> legal_actions = get_legal_actions();
+        std::string key = get_info_set_key();
+        if (state.player != player) {
+            auto strategy = get_strategy(key, legal_actions);
+            Utility value = 0.0;
+            for (Action action : legal_actions) {
+                apply_action(action);
+                value += strategy[action] * best_response_traverse(
+                    player, level, weight * strategy[action], response, action_values);
+                revert_action();
+            }
+            return value;
+        }
+        
+        auto decided = response.find(key);
+        if (decided != response.end()) {
+            apply_action(decided->second);
+            Utility value = best_response_traverse(player, level, weight, response, action_values);
+            revert_action();
+            return value;
+        }
+        
+        // 未決定: このレベルなら行動価値を集計し、浅ければ下のレベルへ進む（戻り値は使われない）
+        const bool at_level = state.history.size() == level;
+        for (Action action : legal_actions) {
+            apply_action(action);
+            Utility value = best_response_traverse(player, level, weight, response, action_values);
+            revert_action();
+            if (at_level) (*action_values)[key][action] += weight * value;
+        }
+        return 0.0;
+    }
+    
+    // 平均戦略どうしで対戦した時のプレイヤー0の期待値
+    Utility average_strategy_value() {
+        if (is_terminal()) return get_payoff(0);
+        if (is_chance_node()) {
+            Utility value = 0.0;
+            for (const auto& [outcome, probability] : get_chance_outcomes()) {
+                apply_chance_outcome(outcome);
+                value += probability * average_strategy_value();
+                revert_chance_outcome(outcome);
+            }
+            return value;
+        }
+        std::vector<Action> legal_actions = get_legal_actions();
+        auto strategy = get_strategy(get_info_set_key(), legal_actions);
+        Utility value = 0.0;
+        for (Action action : legal_actions) {
+            apply_action(action);
+            value += strategy[action] * average_strategy_value();
+            revert_action();
+        }
+        return value;
     }
     
-    // ゲーム状態の判定（実際のポーカーロジックを実装）
-    bool is_terminal() { return false; }
-    bool is_chance_node() { return false; }
-    int get_current_player() { return 0; }
-    std::string get_info_set_key() { return "example_state"; }
-    std::vector<Action> get_legal_actions() { return {0, 1, 2}; }
-    Utility get_payoff(int player) { return 0.0; }
-    std::vector<std::pair<int, double>> get_chance_outcomes() { return {}; }
-    void apply_chance_outcome(int outcome) {}
-    void revert_chance_outcome(int outcome) {}
+    // ゲーム状態の判定（ベンチマーク用のゲームのルール）
+    int deck_size() const { return rules.ranks * rules.suits; }
+    int rank_of(int card) const { return card / rules.suits; }
+    
+    bool is_terminal() { return state.folded >= 0 || state.showdown; }
+    
+    bool is_chance_node() {
+        return state.hole[0] < 0 || (state.round > 0 && state.board < 0);
+    }
+    
+    int get_current_player() { return state.player; }
+    
+    // 手番のプレイヤーから見える情報: 自分のカード・公開カード・アクションの履歴
+    std::string get_info_set_key() {
+        std::string key(1, static_cast<char>('0' + rank_of(state.hole[state.player])));
+        if (state.board >= 0) key += static_cast<char>('0' + rank_of(state.board));
+        key += ':';
+        key += state.history;
+        return key;
+    }
+    
+    std::vector<Action> get_legal_actions() {
+        std::vector<Action> actions;
+        const int p = state.player;
+        if (state.committed[p] < state.committed[1 - p]) actions.push_back(ACTION_FOLD);
+        actions.push_back(ACTION_CALL);
+        if (state.raises < rules.max_raises) actions.push_back(ACTION_RAISE);
+        return actions;
+    }
+    
+    Utility get_payoff(int player) {
+        const int opponent = 1 - player;
+        if (state.folded >= 0) {
+            return state.folded == player ? -state.committed[player] : state.committed[opponent];
+        }
+        // 公開カードとペアなら最強、それ以外はランクの高い方
+        auto strength = [&](int p) {
+            int rank = rank_of(state.hole[p]);
+            bool paired = state.board >= 0 && rank_of(state.board) == rank;
+            return rank + (paired ? rules.ranks : 0);
+        };
+        int ours = strength(player), theirs = strength(opponent);
+        if (ours == theirs) return 0.0;
+        return ours > theirs ? state.committed[opponent] : -state.committed[player];
+    }
+    
+    // 結果 = 配るカード（手札は hole0 * deck_size + hole1）と確率
+    std::vector<std::pair<int, double>> get_chance_outcomes() {
+        std::vector<std::pair<int, double>> outcomes;
+        const int n = deck_size();
+        if (state.hole[0] < 0) {
+            const double probability = 1.0 / (n * (n - 1));
+            for (int a = 0; a < n; ++a) {
+                for (int b = 0; b < n; ++b) {
+                    if (a != b) outcomes.emplace_back(a * n + b, probability);
+                }
+            }
+        } else {
+            const double probability = 1.0 / (n - 2);
+            for (int c = 0; c < n; ++c) {
+                if (c != state.hole[0] && c != state.hole[1]) outcomes.emplace_back(c, probability);
+            }
+        }
+        return outcomes;
+    }
+    
+    void apply_chance_outcome(int outcome) {
+        saved_states.push_back(state);
+        if (state.hole[0] < 0) {
+            state.hole[0] = outcome / deck_size();
+            state.hole[1] = outcome % deck_size();
+        } else {
+            state.board = outcome;
+        }
+    }
+    
+    void revert_chance_outcome(int outcome) {
+        state = std::move(saved_states.back());
+        saved_states.pop_back();
+    }
+    
+    void apply_action(Action action) {
+        saved_states.push_back(state);
+        const int p = state.player;
+        ++state.actions;
+        if (action == ACTION_FOLD) {
+            state.history += 'f';
+            state.folded = p;
+            return;
+        }
+        if (action == ACTION_RAISE) {
+            state.history += 'r';
+            state.committed[p] = state.committed[1 - p] + rules.bet_size[state.round];
+            ++state.raises;
+            state.player = 1 - p;
+            return;
+        }
+        state.history += 'c';
+        state.committed[p] = state.committed[1 - p];
+        // ラウンド最初のチェック以外のコールでラウンドが終わる
+        if (state.actions < 2) {
+            state.player = 1 - p;
+        } else if (state.round + 1 < rules.rounds) {
+            ++state.round;
+            state.player = 0;
+            state.raises = 0;
+            state.actions = 0;
+            state.history += '/';
+        } else {
+            state.showdown = true;
+        }
+    }
+    
+    void revert_action() {
+        state = std::move(saved_states.back());
+        saved_states.pop_back();
+    }
     
 public:
     // 最適戦略を取得
@@ -262,26 +520,37 @@ public:
         return info_sets[info_set_key].get_average_strategy(legal_actions);
     }
     
-    // エクスプロイタビリティを計算（収束度の指標）
+    // 平均戦略のゲーム価値（プレイヤー0視点。クーン・ポーカーの均衡では-1/18）
+    double game_value() {
+        return average_strategy_value();
+    }
+    
+    // エクスプロイタビリティ（チップ/ゲーム）: 平均戦略に対する各プレイヤーの最適反応の
+    // 期待値の平均。均衡で0。学習前（情報セットが無い）は0を返す
     double compute_exploitability() {
-        double total_exploit = 0.0;
-        
-        for (const auto& [key, info_set] : info_sets) {
-            if (info_set.visit_count > 0) {
-                // ベストレスポンスとの差
-                double best_response_value = 0.0;
-                double strategy_value = 0.0;
-                
-                // 簡易計算
-                for (const auto& [action, regret] : info_set.regret_sum) {
-                    best_response_value += std::max(0.0, regret);
+        if (info_sets.empty()) return 0.0;
+        return (best_response_value(0) + best_response_value(1)) / 2.0;
+    }
+    
+    // 相手が平均戦略に従う時のplayerの最適反応の期待値
+    Utility best_response_value(int player) {
+        // 情報セットのキーは履歴を含むので、深い（履歴の長い）情報セットから順に
+        // 行動を決めれば、各情報セットの行動価値は下の行動が確定した状態で求まる
+        std::set<size_t> levels;
+        collect_levels(player, levels);
+        std::map<std::string, Action> response;
+        for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+            std::map<std::string, std::map<Action, double>> action_values;
+            best_response_traverse(player, *level, 1.0, response, &action_values);
+            for (const auto& [key, values] : action_values) {
+                auto best = values.begin();
+                for (auto it = values.begin(); it != values.end(); ++it) {
+                    if (it->second > best->second) best = it;
                 }
-                
-                total_exploit += best_response_value;
+                response[key] = best->first;
             }
         }
-        
-        return total_exploit / info_sets.size();
+        return best_response_traverse(player, SIZE_MAX, 1.0, response, nullptr);
     }
 };
 
@@ -294,6 +563,11 @@ extern "C" {
         return new CFRSolver();
     }
     
+    void* create_cfr_solver_game(int game) {
+        if (game != GAME_KUHN && game != GAME_LEDUC) return nullptr;
+        return new CFRSolver(static_cast<GameKind>(game));
+    }
+    
     void destroy_cfr_solver(void* solver) {
         delete static_cast<CFRSolver*>(solver);
     }
@@ -305,4 +579,10 @@ extern "C" {
     double cfr_exploitability(void* solver) {
         return static_cast<CFRSolver*>(solver)->compute_exploitability();
     }
+    
+    int cfr_info_set_count(void* solver) {
+        return static_cast<int>(static_cast<CFRSolver*>(solver)->info_set_count());
+    }
 }
+
+#endif // POKER_STEP6_7_CFR_ENGINE_COMPLETE_CPP
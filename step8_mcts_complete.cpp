@@ -1,8 +1,12 @@
 // step8_mcts_complete.cpp
+#ifndef POKER_STEP8_MCTS_COMPLETE_CPP
+#define POKER_STEP8_MCTS_COMPLETE_CPP
+
 #include <vector>
 #include <cmath>
 #include <memory>
 #include <random>
+#include <cstdint>
 
 namespace MCTSEngine {
 
@@ -249,3 +253,27 @@ private:
 };
 
 } // namespace MCTSEngine
+
+extern "C" {
+    using namespace MCTSEngine;
+    
+    // 合法手が無ければNULL
+    void* create_mcts_search(const int32_t* legal_actions, int count, uint64_t seed) {
+        if (legal_actions == nullptr || count <= 0) return nullptr;
+        return new MCTSSearch(std::vector<int>(legal_actions, legal_actions + count), seed);
+    }
+    
+    void destroy_mcts_search(void* search) {
+        delete static_cast<MCTSSearch*>(search);
+    }
+    
+    void mcts_search(void* search, int iterations) {
+        static_cast<MCTSSearch*>(search)->search(iterations);
+    }
+    
+    int mcts_best_action(void* search) {
+        return static_cast<MCTSSearch*>(search)->get_best_action();
+    }
+}
+
+#endif // POKER_STEP8_MCTS_COMPLETE_CPP
@@ -1,7 +1,13 @@
 // step9_eqr_complete.cpp
+#ifndef POKER_STEP9_EQR_COMPLETE_CPP
+#define POKER_STEP9_EQR_COMPLETE_CPP
+
+#include "step1_card_system_advanced.cpp"
 #include <cmath>
 #include <algorithm>
 #include <array>
+#include <cstdint>
+#include <cfloat>
 
 namespace EQRCalculator {
 
@@ -19,45 +25,67 @@ struct PositionFactors {
         0.68   // BB (Big Blind)
     };
     
+    // 範囲外のポジションを0-8に丸めたテーブルインデックス
+    // (64bit幅にするとバッチ処理でgather命令に落ちる)
+    static int64_t index(int position) {
+        return std::min<int64_t>(std::max<int64_t>(position, 0), 8);
+    }
+    
     static double get_factor(int position) {
-        return FACTORS[std::min(position, 8)];
+        return FACTORS[index(position)];
     }
 };
 
 // スタックデプスファクター
 class StackDepthAdjustment {
 public:
+    // SPRブラケットの上限と対応するファクター
+    static constexpr std::array<double, 5> BRACKETS = {1.0, 3.0, 7.0, 13.0, 25.0};
+    static constexpr std::array<double, 6> FACTORS = {
+        1.25,  // SPR < 1: ほぼコミット状態
+        1.15,  // SPR < 3: ショートスタック
+        1.05,  // SPR < 7: ミディアムスタック
+        1.00,  // SPR < 13: 標準
+        0.95,  // SPR < 25: ディープスタック
+        0.90   // 非常にディープ
+    };
+    
     static double calculate(double spr) {
         // SPR (Stack-to-Pot Ratio) に基づく調整
-        if (spr < 1.0) {
-            return 1.25;  // ほぼコミット状態
-        } else if (spr < 3.0) {
-            return 1.15;  // ショートスタック
-        } else if (spr < 7.0) {
-            return 1.05;  // ミディアムスタック
-        } else if (spr < 13.0) {
-            return 1.00;  // 標準
-        } else if (spr < 25.0) {
-            return 0.95;  // ディープスタック
-        } else {
-            return 0.90;  // 非常にディープ
+        // 境界を超えるごとに次のファクターを選ぶ比較+選択の連鎖（分岐なし）
+        double factor = FACTORS[0];
+        for (size_t i = 0; i < BRACKETS.size(); ++i) {
+            factor = spr < BRACKETS[i] ? factor : FACTORS[i + 1];
         }
+        return factor;
+    }
+    
+    // ポットが0以下ならSPR=100扱い（最もディープ）。
+    // 除算は常に実行して結果を選ぶ（条件付き除算はバッチのループを分岐に分割しSIMD化を妨げる）
+    static double from_stack(double stack, double pot) {
+        double factor = calculate(stack / std::max(pot, DBL_MIN));
+        return pot > 0 ? factor : FACTORS.back();
     }
 };
 
 // ボードテクスチャファクター
 class BoardTextureAdjustment {
 public:
+    // [texture * 2 + in_position]
+    static constexpr std::array<double, 6> FACTORS = {
+        0.95, 1.08,  // Dry board (OOP, IP)
+        0.98, 1.02,  // Semi-wet
+        0.92, 0.95   // Wet board
+    };
+    
+    // texture_score: 0=dry, 1=semi-wet, それ以外=wet
+    static int64_t index(int texture_score, bool in_position) {
+        int64_t texture = std::min(static_cast<uint32_t>(texture_score), 2u);
+        return texture * 2 + (in_position ? 1 : 0);
+    }
+    
     static double calculate(int texture_score, bool in_position) {
-        // texture_score: 0=dry, 1=semi-wet, 2=wet
-        
-        if (texture_score == 0) { // Dry board
-            return in_position ? 1.08 : 0.95;
-        } else if (texture_score == 1) { // Semi-wet
-            return in_position ? 1.02 : 0.98;
-        } else { // Wet board
-            return in_position ? 0.95 : 0.92;
-        }
+        return FACTORS[index(texture_score, in_position)];
     }
 };
 
@@ -80,6 +108,17 @@ public:
     }
 };
 
+// ストリートファクター（EQREngine::adjust_for_streetとstep44の組み込みモデルで共有）
+class StreetAdjustment {
+public:
+    // 0=preflop, 1=flop, 2=turn, 3=river
+    static constexpr std::array<double, 4> FACTORS = {0.95, 1.00, 1.03, 1.05};
+    
+    static double calculate(int street) {
+        return FACTORS[std::min(static_cast<uint32_t>(street), 3u)];
+    }
+};
+
 // 統合EQR計算
 class EQREngine {
 public:
@@ -109,8 +148,7 @@ public:
         // 各ファクターを計算
         result.position_factor = PositionFactors::get_factor(position);
         
-        double spr = pot > 0 ? stack / pot : 100.0;
-        result.stack_factor = StackDepthAdjustment::calculate(spr);
+        result.stack_factor = StackDepthAdjustment::from_stack(stack, pot);
         
         result.board_factor = BoardTextureAdjustment::calculate(board_texture, in_position);
         result.multiway_factor = MultiwayAdjustment::calculate(opponents);
@@ -133,8 +171,78 @@ public:
     // ストリート別のEQR調整
     static double adjust_for_street(double eqr, int street) {
         // street: 0=preflop, 1=flop, 2=turn, 3=river
-        constexpr std::array<double, 4> STREET_FACTORS = {0.95, 1.00, 1.03, 1.05};
-        return eqr * STREET_FACTORS[std::min(street, 3)];
+        return eqr * StreetAdjustment::calculate(street);
+    }
+    
+    // ===== バッチEQR (Structure of Arrays) =====
+    // 入力・出力とも列ごとの連続配列（互いに重ならないこと）。全ファクターを
+    // 分岐なしのテーブル参照と算術で求めるため、ループはそのままSIMD化される。
+    struct BatchInput {
+        const double* raw_equity;
+        const int32_t* position;
+        const double* stack;
+        const double* pot;
+        const int32_t* board_texture;
+        const int32_t* opponents;
+        const uint8_t* in_position;
+        const double* opponent_skill;
+    };
+    
+    struct BatchOutput {
+        double* eqr;
+        double* position_factor;
+        double* stack_factor;
+        double* board_factor;
+        double* multiway_factor;
+        double* skill_factor;
+    };
+    
+    static void calculate_batch(const BatchInput& in, const BatchOutput& out, int count) {
+        batch_kernel(count,
+                     in.raw_equity, in.position, in.stack, in.pot,
+                     in.board_texture, in.opponents, in.in_position, in.opponent_skill,
+                     out.eqr, out.position_factor, out.stack_factor,
+                     out.board_factor, out.multiway_factor, out.skill_factor);
+    }
+    
+private:
+    // __restrictは関数引数でないとGCCが別名解析に使わないため、列を個別の引数で受け取る
+    POKER_HOT_KERNEL
+    static void batch_kernel(
+        int count,
+        const double* __restrict raw_equity,
+        const int32_t* __restrict position,
+        const double* __restrict stack,
+        const double* __restrict pot,
+        const int32_t* __restrict board_texture,
+        const int32_t* __restrict opponents,
+        const uint8_t* __restrict in_position,
+        const double* __restrict opponent_skill,
+        double* __restrict out_eqr,
+        double* __restrict out_position,
+        double* __restrict out_stack,
+        double* __restrict out_board,
+        double* __restrict out_multiway,
+        double* __restrict out_skill
+    ) {
+        // スカラー版(calculate_complete)と同じファクター関数を使う（どれも分岐なしのテーブル参照と算術）
+        for (int i = 0; i < count; ++i) {
+            double position_factor = PositionFactors::get_factor(position[i]);
+            double stack_factor = StackDepthAdjustment::from_stack(stack[i], pot[i]);
+            double board_factor = BoardTextureAdjustment::calculate(board_texture[i], in_position[i] != 0);
+            double multiway_factor = MultiwayAdjustment::calculate(opponents[i]);
+            double skill_factor = SkillAdjustment::calculate(opponent_skill[i]);
+            
+            double eqr = raw_equity[i] * position_factor * stack_factor *
+                         board_factor * multiway_factor * skill_factor;
+            
+            out_eqr[i] = std::min(1.0, std::max(0.0, eqr));
+            out_position[i] = position_factor;
+            out_stack[i] = stack_factor;
+            out_board[i] = board_factor;
+            out_multiway[i] = multiway_factor;
+            out_skill[i] = skill_factor;
+        }
     }
 };
 
@@ -159,4 +267,35 @@ extern "C" {
         );
         return result.eqr;
     }
+    
+    // SoA入力のバッチEQR。全ファクターを列として返す
+    void calculate_eqr_batch(
+        int count,
+        const double* raw_equity,
+        const int32_t* position,
+        const double* stack,
+        const double* pot,
+        const int32_t* board_texture,
+        const int32_t* opponents,
+        const uint8_t* in_position,
+        const double* opponent_skill,
+        double* out_eqr,
+        double* out_position_factor,
+        double* out_stack_factor,
+        double* out_board_factor,
+        double* out_multiway_factor,
+        double* out_skill_factor
+    ) {
+        EQREngine::BatchInput in = {
+            raw_equity, position, stack, pot,
+            board_texture, opponents, in_position, opponent_skill
+        };
+        EQREngine::BatchOutput out = {
+            out_eqr, out_position_factor, out_stack_factor,
+            out_board_factor, out_multiway_factor, out_skill_factor
+        };
+        EQREngine::calculate_batch(in, out, count);
+    }
 }
+
+#endif // POKER_STEP9_EQR_COMPLETE_CPP